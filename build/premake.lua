@@ -73,6 +73,17 @@ include "premake-inc/sys-openssl.lua"
 include "premake-inc/sys-superluminal.lua"
 
 
+-- ==============================================================================
+newoption {
+    trigger     = "alloc-counting",
+    description = "Replace the global operator new / delete to count heap allocations per thread, shown in the Profiling window"
+}
+
+newoption {
+    trigger     = "rt-sentinel",
+    description = "Build with the real-time safety sentinel, reporting allocations / locks / blocking calls made on the audio thread"
+}
+
 -- ==============================================================================
 workspace ("ouroveon_" .. _ACTION)
 
@@ -157,6 +168,25 @@ workspace ("ouroveon_" .. _ACTION)
         }
     filter {}
 
+    filter "options:alloc-counting"
+        defines
+        {
+            "OURO_FEATURE_ALLOC_COUNTING=1",
+        }
+    filter {}
+
+    filter "options:rt-sentinel"
+        defines
+        {
+            "OURO_FEATURE_RT_SENTINEL=1",
+        }
+    filter {}
+
+    -- export symbols so the sentinel's call-site stacks can be resolved by backtrace_symbols
+    filter { "options:rt-sentinel", "system:linux" }
+        linkoptions { "-rdynamic" }
+    filter {}
+
     filter { "system:macosx", "configurations:Release" }
     xcodebuildsettings 
     {
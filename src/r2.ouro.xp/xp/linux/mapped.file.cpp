@@ -0,0 +1,70 @@
+//   _______ _______ ______ _______ ___ ___ _______ _______ _______ 
+//  |       |   |   |   __ \       |   |   |    ___|       |    |  |
+//  |   -   |   |   |      <   -   |   |   |    ___|   -   |       |
+//  |_______|_______|___|__|_______|\_____/|_______|_______|__|____|
+//  \\ harry denholm \\ ishani            ishani.org/shelf/ouroveon/
+//
+//  
+//
+
+#include "pch.h"
+
+#include "xp/mapped.file.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace xp {
+
+// ---------------------------------------------------------------------------------------------------------------------
+bool MappedFile::open( const fs::path& filePath )
+{
+    close();
+
+    const int fd = ::open( filePath.c_str(), O_RDONLY );
+    if ( fd < 0 )
+        return false;
+
+    struct stat fileStat;
+    if ( ::fstat( fd, &fileStat ) != 0 || fileStat.st_size <= 0 )
+    {
+        ::close( fd );
+        return false;
+    }
+
+    const std::size_t fileSize = (std::size_t)fileStat.st_size;
+
+    void* memoryBuffer = ::mmap( nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0 );
+    if ( memoryBuffer == MAP_FAILED )
+    {
+        ::close( fd );
+        return false;
+    }
+
+    // we expect to walk the whole thing front to back
+    ::madvise( memoryBuffer, fileSize, MADV_SEQUENTIAL );
+
+    m_view      = memoryBuffer;
+    m_viewSize  = fileSize;
+    m_handle    = fd;
+
+    return true;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void MappedFile::close()
+{
+    if ( m_view != nullptr )
+        ::munmap( const_cast<void*>( m_view ), m_viewSize );
+
+    if ( m_handle != -1 )
+        ::close( (int)m_handle );
+
+    m_view      = nullptr;
+    m_viewSize  = 0;
+    m_handle    = -1;
+}
+
+} // namespace xp
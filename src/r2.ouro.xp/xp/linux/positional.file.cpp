@@ -0,0 +1,71 @@
+//   _______ _______ ______ _______ ___ ___ _______ _______ _______ 
+//  |       |   |   |   __ \       |   |   |    ___|       |    |  |
+//  |   -   |   |   |      <   -   |   |   |    ___|   -   |       |
+//  |_______|_______|___|__|_______|\_____/|_______|_______|__|____|
+//  \\ harry denholm \\ ishani            ishani.org/shelf/ouroveon/
+//
+//  
+//
+
+#include "pch.h"
+
+#include "xp/positional.file.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace xp {
+
+// ---------------------------------------------------------------------------------------------------------------------
+bool PositionalFile::open( const fs::path& filePath )
+{
+    close();
+
+    const int fd = ::open( filePath.c_str(), O_RDONLY );
+    if ( fd < 0 )
+        return false;
+
+    m_handle = fd;
+    return true;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void PositionalFile::close()
+{
+    if ( m_handle != -1 )
+        ::close( (int)m_handle );
+
+    m_handle = -1;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+bool PositionalFile::readAt( const uint64_t offset, void* destination, const std::size_t byteCount ) const
+{
+    if ( m_handle == -1 )
+        return false;
+
+    uint8_t* writeTo = static_cast<uint8_t*>( destination );
+    std::size_t remaining = byteCount;
+    uint64_t readOffset = offset;
+
+    // pread is allowed to return short, keep going until we have it all or hit the end of the file
+    while ( remaining > 0 )
+    {
+        const ssize_t bytesRead = ::pread( (int)m_handle, writeTo, remaining, (off_t)readOffset );
+        if ( bytesRead < 0 )
+        {
+            if ( errno == EINTR )
+                continue;
+            return false;
+        }
+        if ( bytesRead == 0 )
+            return false;
+
+        writeTo    += bytesRead;
+        remaining  -= (std::size_t)bytesRead;
+        readOffset += (uint64_t)bytesRead;
+    }
+    return true;
+}
+
+} // namespace xp
@@ -0,0 +1,100 @@
+//   _______ _______ ______ _______ ___ ___ _______ _______ _______ 
+//  |       |   |   |   __ \       |   |   |    ___|       |    |  |
+//  |   -   |   |   |      <   -   |   |   |    ___|   -   |       |
+//  |_______|_______|___|__|_______|\_____/|_______|_______|__|____|
+//  \\ harry denholm \\ ishani            ishani.org/shelf/ouroveon/
+//
+//  
+//
+
+#include "pch.h"
+
+#include "xp/shared.memory.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace xp {
+
+// ---------------------------------------------------------------------------------------------------------------------
+void* SharedMemory::open( const char* name, const Access requestedAccess, const std::size_t bufferSize )
+{
+    close();
+
+    // POSIX shared memory object names must begin with a single slash
+    std::string objectName = name;
+    if ( objectName.empty() || objectName.front() != '/' )
+        objectName.insert( objectName.begin(), '/' );
+
+    const bool bWrite = ( requestedAccess == Access::Write );
+
+    const int fd = ::shm_open( objectName.c_str(), bWrite ? ( O_CREAT | O_RDWR ) : O_RDONLY, 0644 );
+    if ( fd < 0 )
+        return nullptr;
+
+    if ( bWrite )
+    {
+        // ignore the process umask, external readers may well be running as a different user
+        ::fchmod( fd, 0644 );
+
+        if ( ::ftruncate( fd, (off_t)bufferSize ) != 0 )
+        {
+            ::close( fd );
+            ::shm_unlink( objectName.c_str() );
+            return nullptr;
+        }
+    }
+    else
+    {
+        // don't map past the end of whatever the publisher sized the object to
+        struct stat objectStat;
+        if ( ::fstat( fd, &objectStat ) != 0 || (std::size_t)objectStat.st_size < bufferSize )
+        {
+            ::close( fd );
+            return nullptr;
+        }
+    }
+
+    void* memoryBuffer = ::mmap( nullptr, bufferSize, bWrite ? ( PROT_READ | PROT_WRITE ) : PROT_READ, MAP_SHARED, fd, 0 );
+    if ( memoryBuffer == MAP_FAILED )
+    {
+        ::close( fd );
+        if ( bWrite )
+            ::shm_unlink( objectName.c_str() );
+        return nullptr;
+    }
+
+    if ( bWrite )
+        memset( memoryBuffer, 0, bufferSize );
+
+    m_view      = memoryBuffer;
+    m_viewSize  = bufferSize;
+    m_access    = requestedAccess;
+    m_handle    = fd;
+    m_name      = std::move( objectName );
+
+    return m_view;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void SharedMemory::close()
+{
+    if ( m_view != nullptr )
+        ::munmap( m_view, m_viewSize );
+
+    if ( m_handle != -1 )
+        ::close( (int)m_handle );
+
+    // the publisher owns the name; readers already attached keep their mapping alive until they unmap
+    if ( m_view != nullptr && m_access == Access::Write )
+        ::shm_unlink( m_name.c_str() );
+
+    m_view      = nullptr;
+    m_viewSize  = 0;
+    m_handle    = -1;
+    m_name.clear();
+}
+
+} // namespace xp
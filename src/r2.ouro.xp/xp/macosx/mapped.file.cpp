@@ -0,0 +1,11 @@
+//   _______ _______ ______ _______ ___ ___ _______ _______ _______ 
+//  |       |   |   |   __ \       |   |   |    ___|       |    |  |
+//  |   -   |   |   |      <   -   |   |   |    ___|   -   |       |
+//  |_______|_______|___|__|_______|\_____/|_______|_______|__|____|
+//  \\ harry denholm \\ ishani            ishani.org/shelf/ouroveon/
+//
+//  
+//
+
+// macOS offers the same open / mmap interface, so share the Linux implementation
+#include "../linux/mapped.file.cpp"
@@ -0,0 +1,47 @@
+//   _______ _______ ______ _______ ___ ___ _______ _______ _______ 
+//  |       |   |   |   __ \       |   |   |    ___|       |    |  |
+//  |   -   |   |   |      <   -   |   |   |    ___|   -   |       |
+//  |_______|_______|___|__|_______|\_____/|_______|_______|__|____|
+//  \\ harry denholm \\ ishani            ishani.org/shelf/ouroveon/
+//
+//  
+//
+
+#pragma once
+
+#include "base/construction.h"
+
+namespace xp {
+
+// ---------------------------------------------------------------------------------------------------------------------
+// read-only view of an entire file on disk; CreateFileMapping on Windows, mmap() on POSIX. the mapping stays valid
+// until close() or destruction, so anything pointing into data() must not outlive this object
+//
+struct MappedFile
+{
+    DECLARE_NO_COPY_NO_MOVE( MappedFile );
+
+    MappedFile() = default;
+    ~MappedFile()
+    {
+        close();
+    }
+
+    // map the whole of `filePath`; returns false if the file can't be opened, is empty or the mapping fails
+    bool open( const fs::path& filePath );
+    void close();
+
+    ouro_nodiscard constexpr bool isOpen() const { return m_view != nullptr; }
+
+    ouro_nodiscard constexpr const uint8_t* data() const { return static_cast<const uint8_t*>( m_view ); }
+    ouro_nodiscard constexpr std::size_t size() const { return m_viewSize; }
+
+private:
+
+    const void*     m_view          = nullptr;
+    std::size_t     m_viewSize      = 0;
+
+    intptr_t        m_handle        = -1;           // HANDLE of the mapping object on Windows, file descriptor on POSIX
+};
+
+} // namespace xp
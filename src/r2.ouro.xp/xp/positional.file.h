@@ -0,0 +1,44 @@
+//   _______ _______ ______ _______ ___ ___ _______ _______ _______ 
+//  |       |   |   |   __ \       |   |   |    ___|       |    |  |
+//  |   -   |   |   |      <   -   |   |   |    ___|   -   |       |
+//  |_______|_______|___|__|_______|\_____/|_______|_______|__|____|
+//  \\ harry denholm \\ ishani            ishani.org/shelf/ouroveon/
+//
+//  
+//
+
+#pragma once
+
+#include "base/construction.h"
+
+namespace xp {
+
+// ---------------------------------------------------------------------------------------------------------------------
+// read-only file handle that reads at explicit offsets; pread() on POSIX, ReadFile with an OVERLAPPED offset on
+// Windows. there is no shared file cursor so readAt() is safe to call from many threads at once, and it will see
+// data appended to the file by another handle after that data has been flushed
+//
+struct PositionalFile
+{
+    DECLARE_NO_COPY_NO_MOVE( PositionalFile );
+
+    PositionalFile() = default;
+    ~PositionalFile()
+    {
+        close();
+    }
+
+    bool open( const fs::path& filePath );
+    void close();
+
+    ouro_nodiscard constexpr bool isOpen() const { return m_handle != -1; }
+
+    // read exactly `byteCount` bytes from `offset` into `destination`; false on error or if the file is too short
+    ouro_nodiscard bool readAt( const uint64_t offset, void* destination, const std::size_t byteCount ) const;
+
+private:
+
+    intptr_t        m_handle        = -1;           // HANDLE on Windows, file descriptor on POSIX
+};
+
+} // namespace xp
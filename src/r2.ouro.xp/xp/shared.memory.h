@@ -0,0 +1,56 @@
+//   _______ _______ ______ _______ ___ ___ _______ _______ _______ 
+//  |       |   |   |   __ \       |   |   |    ___|       |    |  |
+//  |   -   |   |   |      <   -   |   |   |    ___|   -   |       |
+//  |_______|_______|___|__|_______|\_____/|_______|_______|__|____|
+//  \\ harry denholm \\ ishani            ishani.org/shelf/ouroveon/
+//
+//  
+//
+
+#pragma once
+
+#include "base/construction.h"
+
+namespace xp {
+
+// ---------------------------------------------------------------------------------------------------------------------
+// thin platform wrapper around a named, process-shared block of memory; on Windows this is a named file mapping, on
+// POSIX a shm_open() object (which lives at /dev/shm/<name> on Linux). the owner that opens with Write access creates
+// (and on POSIX, unlinks on close) the object; Read access attaches to an existing one and fails if nobody is publishing
+//
+// no synchronisation is offered here, that is left to the layout of whatever is stored in the block
+//
+struct SharedMemory
+{
+    DECLARE_NO_COPY_NO_MOVE( SharedMemory );
+
+    enum class Access
+    {
+        Read,
+        Write
+    };
+
+    SharedMemory() = default;
+    ~SharedMemory()
+    {
+        close();
+    }
+
+    // map a block of at least `bufferSize` bytes; returns null on failure. Write access zero-fills the block
+    void* open( const char* name, const Access requestedAccess, const std::size_t bufferSize );
+    void close();
+
+    ouro_nodiscard constexpr bool isOpen() const { return m_view != nullptr; }
+    ouro_nodiscard constexpr Access getAccess() const { return m_access; }
+
+private:
+
+    void*           m_view          = nullptr;
+    std::size_t     m_viewSize      = 0;
+    Access          m_access        = Access::Read;
+
+    intptr_t        m_handle        = -1;           // HANDLE on Windows, file descriptor on POSIX
+    std::string     m_name;                         // name the object was opened with, used to unlink on close
+};
+
+} // namespace xp
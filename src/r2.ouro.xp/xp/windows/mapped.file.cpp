@@ -0,0 +1,76 @@
+//   _______ _______ ______ _______ ___ ___ _______ _______ _______ 
+//  |       |   |   |   __ \       |   |   |    ___|       |    |  |
+//  |   -   |   |   |      <   -   |   |   |    ___|   -   |       |
+//  |_______|_______|___|__|_______|\_____/|_______|_______|__|____|
+//  \\ harry denholm \\ ishani            ishani.org/shelf/ouroveon/
+//
+//  
+//
+
+#include "pch.h"
+
+#include "xp/mapped.file.h"
+
+namespace xp {
+
+// ---------------------------------------------------------------------------------------------------------------------
+bool MappedFile::open( const fs::path& filePath )
+{
+    close();
+
+    HANDLE hFile = ::CreateFileW(
+        filePath.c_str(),
+        GENERIC_READ,
+        FILE_SHARE_READ,
+        nullptr,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+        nullptr );
+
+    if ( hFile == INVALID_HANDLE_VALUE )
+        return false;
+
+    LARGE_INTEGER fileSize;
+    if ( !::GetFileSizeEx( hFile, &fileSize ) || fileSize.QuadPart <= 0 )
+    {
+        ::CloseHandle( hFile );
+        return false;
+    }
+
+    HANDLE hFileMapping = ::CreateFileMappingW( hFile, nullptr, PAGE_READONLY, 0, 0, nullptr );
+
+    // the mapping object keeps its own reference to the file
+    ::CloseHandle( hFile );
+
+    if ( hFileMapping == nullptr )
+        return false;
+
+    const void* memoryBuffer = ::MapViewOfFile( hFileMapping, FILE_MAP_READ, 0, 0, 0 );
+    if ( memoryBuffer == nullptr )
+    {
+        ::CloseHandle( hFileMapping );
+        return false;
+    }
+
+    m_view      = memoryBuffer;
+    m_viewSize  = (std::size_t)fileSize.QuadPart;
+    m_handle    = (intptr_t)hFileMapping;
+
+    return true;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void MappedFile::close()
+{
+    if ( m_view != nullptr )
+        ::UnmapViewOfFile( m_view );
+
+    if ( m_handle != -1 )
+        ::CloseHandle( (HANDLE)m_handle );
+
+    m_view      = nullptr;
+    m_viewSize  = 0;
+    m_handle    = -1;
+}
+
+} // namespace xp
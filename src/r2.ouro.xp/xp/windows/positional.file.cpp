@@ -0,0 +1,78 @@
+//   _______ _______ ______ _______ ___ ___ _______ _______ _______ 
+//  |       |   |   |   __ \       |   |   |    ___|       |    |  |
+//  |   -   |   |   |      <   -   |   |   |    ___|   -   |       |
+//  |_______|_______|___|__|_______|\_____/|_______|_______|__|____|
+//  \\ harry denholm \\ ishani            ishani.org/shelf/ouroveon/
+//
+//  
+//
+
+#include "pch.h"
+
+#include "xp/positional.file.h"
+
+namespace xp {
+
+// ---------------------------------------------------------------------------------------------------------------------
+bool PositionalFile::open( const fs::path& filePath )
+{
+    close();
+
+    // share write + delete so the pack writer can keep appending and compaction can remove the file
+    HANDLE hFile = ::CreateFileW(
+        filePath.c_str(),
+        GENERIC_READ,
+        FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+        nullptr,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS,
+        nullptr );
+
+    if ( hFile == INVALID_HANDLE_VALUE )
+        return false;
+
+    m_handle = (intptr_t)hFile;
+    return true;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void PositionalFile::close()
+{
+    if ( m_handle != -1 )
+        ::CloseHandle( (HANDLE)m_handle );
+
+    m_handle = -1;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+bool PositionalFile::readAt( const uint64_t offset, void* destination, const std::size_t byteCount ) const
+{
+    if ( m_handle == -1 )
+        return false;
+
+    uint8_t* writeTo = static_cast<uint8_t*>( destination );
+    std::size_t remaining = byteCount;
+    uint64_t readOffset = offset;
+
+    while ( remaining > 0 )
+    {
+        // ReadFile takes a DWORD length, so walk large reads in chunks
+        const DWORD chunkSize = (DWORD)std::min< std::size_t >( remaining, 64 * 1024 * 1024 );
+
+        // on a synchronous handle the offset in OVERLAPPED is honoured and the call still blocks until done
+        OVERLAPPED overlapped = {};
+        overlapped.Offset     = (DWORD)( readOffset & 0xFFFFFFFF );
+        overlapped.OffsetHigh = (DWORD)( readOffset >> 32 );
+
+        DWORD bytesRead = 0;
+        if ( !::ReadFile( (HANDLE)m_handle, writeTo, chunkSize, &bytesRead, &overlapped ) || bytesRead == 0 )
+            return false;
+
+        writeTo    += bytesRead;
+        remaining  -= bytesRead;
+        readOffset += bytesRead;
+    }
+    return true;
+}
+
+} // namespace xp
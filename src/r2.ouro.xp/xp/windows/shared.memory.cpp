@@ -0,0 +1,77 @@
+//   _______ _______ ______ _______ ___ ___ _______ _______ _______ 
+//  |       |   |   |   __ \       |   |   |    ___|       |    |  |
+//  |   -   |   |   |      <   -   |   |   |    ___|   -   |       |
+//  |_______|_______|___|__|_______|\_____/|_______|_______|__|____|
+//  \\ harry denholm \\ ishani            ishani.org/shelf/ouroveon/
+//
+//  
+//
+
+#include "pch.h"
+
+#include "xp/shared.memory.h"
+
+namespace xp {
+
+// ---------------------------------------------------------------------------------------------------------------------
+void* SharedMemory::open( const char* name, const Access requestedAccess, const std::size_t bufferSize )
+{
+    close();
+
+    HANDLE hFileMapping = nullptr;
+    DWORD  mapAccess    = FILE_MAP_WRITE;
+
+    if ( requestedAccess == Access::Write )
+    {
+        hFileMapping = ::CreateFileMappingA(
+            INVALID_HANDLE_VALUE,
+            nullptr,
+            PAGE_READWRITE,
+            0,
+            (DWORD)bufferSize,
+            name );
+    }
+    else
+    {
+        hFileMapping = ::OpenFileMappingA( FILE_MAP_READ, FALSE, name );
+        mapAccess    = FILE_MAP_READ;
+    }
+
+    if ( hFileMapping == nullptr )
+        return nullptr;
+
+    void* memoryBuffer = ::MapViewOfFile( hFileMapping, mapAccess, 0, 0, bufferSize );
+    if ( memoryBuffer == nullptr )
+    {
+        ::CloseHandle( hFileMapping );
+        return nullptr;
+    }
+
+    if ( requestedAccess == Access::Write )
+        memset( memoryBuffer, 0, bufferSize );
+
+    m_view      = memoryBuffer;
+    m_viewSize  = bufferSize;
+    m_access    = requestedAccess;
+    m_handle    = (intptr_t)hFileMapping;
+    m_name      = name;
+
+    return m_view;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void SharedMemory::close()
+{
+    if ( m_view != nullptr )
+        ::UnmapViewOfFile( m_view );
+
+    if ( m_handle != -1 )
+        ::CloseHandle( (HANDLE)m_handle );
+
+    m_view      = nullptr;
+    m_viewSize  = 0;
+    m_handle    = -1;
+    m_name.clear();
+}
+
+} // namespace xp
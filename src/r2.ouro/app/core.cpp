@@ -11,6 +11,7 @@
 
 #include "base/instrumentation.h"
 #include "base/operations.h"
+#include "base/text.h"
 
 #include "config/base.h"
 #include "config/frontend.h"
@@ -203,7 +204,7 @@ std::string osxGetBundlePath()
 #endif // OURO_PLATFORM_OSX
 
 // ---------------------------------------------------------------------------------------------------------------------
-int Core::Run()
+int Core::Run( int argc, char** argv )
 {
 #if OURO_PLATFORM_WIN
     // ansi colouring via fmt{} seems to fail on consoles launched from outside VS without jamming these on
@@ -221,6 +222,18 @@ int Core::Run()
     // sup
     blog::core( FMTX( "Hello from OUROVEON {} [{}]" ), GetAppNameWithVersion(), getOuroveonPlatform() );
 
+#if OURO_FEATURE_RT_SENTINEL
+    // check for headless jobs before touching any configuration, they have to run on a bare build machine
+    for ( int argIndex = 1; argIndex < argc; argIndex++ )
+    {
+        if ( std::string_view( argv[argIndex] ) == cRealtimeSentinelCheckArg )
+        {
+            m_headlessRun = true;
+            return runRealtimeSentinelCheck();
+        }
+    }
+#endif // OURO_FEATURE_RT_SENTINEL
+
     // scripting
     blog::core( FMTX( "initialising {}" ), LUA_VERSION );
     {
@@ -433,12 +446,8 @@ int Core::Run()
 #endif // OURO_FEATURE_VST24
 #endif // OURO_PLATFORM_WIN
 
-#if OURO_EXCHANGE_IPC
     // create shared buffer for exchanging data with other apps
-    if ( !m_endlesssExchangeIPC.init(
-        endlesss::toolkit::Exchange::GlobalMapppingNameW,
-        endlesss::toolkit::Exchange::GlobalMutexNameW,
-        win32::details::IPC::Access::Write ) )
+    if ( !m_endlesssExchangeIPC.init( endlesss::toolkit::ExchangeIPC::Access::Write ) )
     {
         blog::error::core( FMTX( "Failed to open global memory for data exchange; feature disabled" ) );
     }
@@ -446,7 +455,31 @@ int Core::Run()
     {
         blog::core( FMTX( "Broadcasting data exchange on [{}]" ), endlesss::toolkit::Exchange::GlobalMapppingNameA );
     }
-#endif // OURO_EXCHANGE_IPC
+
+    // optionally also send it out over the network; okay if the config is missing, it's off by default
+    const auto exchangeBroadcastLoad = config::load( *this, m_configExchangeBroadcast );
+    if ( exchangeBroadcastLoad == config::LoadResult::Success && m_configExchangeBroadcast.enabled )
+    {
+        endlesss::toolkit::ExchangeBroadcaster::Options broadcastOptions;
+        broadcastOptions.m_address          = m_configExchangeBroadcast.address;
+        broadcastOptions.m_port             = (uint16_t)m_configExchangeBroadcast.port;
+        broadcastOptions.m_multicastTTL     = m_configExchangeBroadcast.multicastTTL;
+        broadcastOptions.m_sendRateHz       = m_configExchangeBroadcast.sendRateHz;
+        broadcastOptions.m_keyframeInterval = m_configExchangeBroadcast.keyframeInterval;
+
+        const auto broadcastStatus = m_endlesssExchangeBroadcaster.start( broadcastOptions );
+        if ( !broadcastStatus.ok() )
+        {
+            blog::error::core( FMTX( "Failed to start network data exchange; {}" ), broadcastStatus.ToString() );
+        }
+        else
+        {
+            blog::core( FMTX( "Broadcasting data exchange to [{}:{}] at {} Hz" ),
+                m_configExchangeBroadcast.address,
+                m_configExchangeBroadcast.port,
+                m_configExchangeBroadcast.sendRateHz );
+        }
+    }
 
 
     // create our wrapper around PA; this doesn't connect to a device, just does initial startup & enumeration
@@ -491,6 +524,42 @@ int Core::Run()
     return appResult;
 }
 
+#if OURO_FEATURE_RT_SENTINEL
+// ---------------------------------------------------------------------------------------------------------------------
+int Core::runRealtimeSentinelCheck()
+{
+    static constexpr uint32_t cSampleRate       = 48000;
+    static constexpr uint32_t cCallbackCount    = 2000;
+    static constexpr uint32_t cFramesPerBuffer  = 512;
+
+    blog::core( FMTX( "[rt-sentinel] headless check, {} callbacks of {} samples" ), cCallbackCount, cFramesPerBuffer );
+
+    // no PortAudio required, initOfflineOutput() sets up everything the mix callback touches
+    app::module::Audio offlineAudio;
+
+    const auto initStatus = offlineAudio.initOfflineOutput( cSampleRate, config::Spectrum{} );
+    if ( !initStatus.ok() )
+    {
+        blog::error::core( FMTX( "[rt-sentinel] unable to set up offline output; {}" ), initStatus.ToString() );
+        return -2;
+    }
+
+    const auto reportOrStatus = offlineAudio.renderOffline( cCallbackCount, cFramesPerBuffer );
+    offlineAudio.termOutput();
+
+    if ( !reportOrStatus.ok() )
+    {
+        blog::error::core( FMTX( "[rt-sentinel] offline render failed; {}" ), reportOrStatus.status().ToString() );
+        return -2;
+    }
+
+    const auto& report = reportOrStatus.value();
+    base::instr::logRealtimeReport( report );
+
+    return report.passed() ? 0 : 1;
+}
+#endif // OURO_FEATURE_RT_SENTINEL
+
 // ---------------------------------------------------------------------------------------------------------------------
 void Core::waitForConsoleKey()
 {
@@ -503,15 +572,14 @@ void Core::waitForConsoleKey()
 // ---------------------------------------------------------------------------------------------------------------------
 void Core::emitAndClearExchangeData()
 {
-#if OURO_EXCHANGE_IPC
+    // wait-free; the write counter is managed by the IPC publisher as the seqlock sequence
     if ( m_endlesssExchangeIPC.canWrite() )
         m_endlesssExchangeIPC.writeType( m_endlesssExchange );
-#endif // OURO_EXCHANGE_IPC
+
+    // rate-limited internally, non-blocking
+    m_endlesssExchangeBroadcaster.publish( m_endlesssExchange );
 
     m_endlesssExchange.clear();
-#if OURO_EXCHANGE_IPC
-    m_endlesssExchange.m_dataWriteCounter = m_endlesssExchangeWriteCounter++;
-#endif // OURO_EXCHANGE_IPC
 }
 
 // ---------------------------------------------------------------------------------------------------------------------
@@ -739,6 +807,148 @@ int CoreGUI::Entrypoint()
             {
                 ImGui::MenuItem( developerFlag.first.c_str(), "", developerFlag.second );
             }
+            ImGui::Separator();
+            // longer-running checks and benchmarks; these go to the task executor, one at a time
+            const bool checkAvailable = !m_developerCheckRunning;
+
+            if ( ImGui::MenuItem( "Verify Exchange IPC", nullptr, false, checkAvailable ) )
+            {
+                runDeveloperCheck( "Exchange IPC Verification", []() -> DeveloperCheckResult
+                {
+                    const auto verification = endlesss::toolkit::ExchangeIPC::verifyTearFreeReads( std::chrono::milliseconds( 500 ) );
+                    return {
+                        fmt::format( FMTX( "{} writes, {} reads, {} retries, {} failed, {} torn" ),
+                            verification.m_writes,
+                            verification.m_reads,
+                            verification.m_retries,
+                            verification.m_failedReads,
+                            verification.m_tornReads ),
+                        verification.passed() };
+                });
+            }
+            if ( ImGui::MenuItem( "Verify Exchange Broadcast", nullptr, false, checkAvailable ) )
+            {
+                runDeveloperCheck( "Exchange Broadcast Verification", []() -> DeveloperCheckResult
+                {
+                    const auto verification = endlesss::toolkit::ExchangeReceiver::verifyLoopback( std::chrono::milliseconds( 500 ) );
+                    return {
+                        fmt::format( FMTX( "{} sent, {} received, {} mismatched, {} lost" ),
+                            verification.m_sent,
+                            verification.m_received,
+                            verification.m_mismatched,
+                            verification.m_receiverStats.m_packetsLost ),
+                        verification.passed() };
+                });
+            }
+            if ( ImGui::MenuItem( "Benchmark Jam Cache (50k)", nullptr, false, checkAvailable ) )
+            {
+                runDeveloperCheck( "Jam Cache Benchmark", []() -> DeveloperCheckResult
+                {
+                    std::error_code tempPathError;
+                    const auto benchmark = endlesss::cache::Jams::benchmarkCacheFormats( fs::temp_directory_path( tempPathError ), 50000 );
+                    return {
+                        fmt::format( FMTX( "{} jams, startup load\nJSON   : {:.1f} ms\nbinary : {:.1f} ms" ),
+                            benchmark.m_jamCount,
+                            benchmark.m_jsonLoadMs,
+                            benchmark.m_binaryLoadMs ),
+                        benchmark.passed() };
+                });
+            }
+            if ( ImGui::MenuItem( "Benchmark Stem Pack (10k)", nullptr, false, checkAvailable ) )
+            {
+                runDeveloperCheck( "Stem Pack Benchmark", []() -> DeveloperCheckResult
+                {
+                    std::error_code tempPathError;
+                    const auto benchmark = endlesss::cache::StemPack::benchmarkAgainstLooseFiles( fs::temp_directory_path( tempPathError ), 10000, 64 * 1024 );
+                    return {
+                        fmt::format( FMTX( "{} stems, cold open / disk usage\nloose : {:.1f} ms, {}\npack  : {:.1f} ms, {}" ),
+                            benchmark.m_stemCount,
+                            benchmark.m_looseOpenMs,
+                            base::humaniseByteSize( "", benchmark.m_looseAllocatedBytes ),
+                            benchmark.m_packOpenMs,
+                            base::humaniseByteSize( "", benchmark.m_packAllocatedBytes ) ),
+                        benchmark.passed() };
+                });
+            }
+            if ( ImGui::MenuItem( "Benchmark Warehouse Search (1M)", nullptr, false, checkAvailable ) )
+            {
+                runDeveloperCheck( "Warehouse Search Benchmark", []() -> DeveloperCheckResult
+                {
+                    std::error_code tempPathError;
+                    const auto benchmark = endlesss::toolkit::Warehouse::benchmarkSearch( fs::temp_directory_path( tempPathError ), 1000000 );
+                    if ( !benchmark.m_error.empty() )
+                        return { benchmark.m_error, false };
+
+                    return {
+                        fmt::format( FMTX( "{} riffs\ntext search {:.2f} ms ({} matches)\nrange search {:.2f} ms\ntag update {:.3f} ms" ),
+                            benchmark.m_riffCount,
+                            benchmark.m_textQueryMs,
+                            benchmark.m_lastTextMatches,
+                            benchmark.m_rangeQueryMs,
+                            benchmark.m_tagUpdateMs ),
+                        benchmark.passed() };
+                });
+            }
+            if ( ImGui::MenuItem( "Benchmark Warehouse Ingest (100K)", nullptr, false, checkAvailable ) )
+            {
+                runDeveloperCheck( "Warehouse Ingest Benchmark", []() -> DeveloperCheckResult
+                {
+                    std::error_code tempPathError;
+                    const auto benchmark = endlesss::toolkit::Warehouse::benchmarkIngest( fs::temp_directory_path( tempPathError ), 100000 );
+                    if ( !benchmark.m_error.empty() )
+                        return { benchmark.m_error, false };
+
+                    return {
+                        fmt::format( FMTX( "{} riffs, rows/sec\nsnapshot : {:.0f} per-row, {:.0f} bulk\nriff data : {:.0f} per-row, {:.0f} bulk" ),
+                            benchmark.m_riffCount,
+                            benchmark.m_rowSkeletonsPerSec,
+                            benchmark.m_bulkSkeletonsPerSec,
+                            benchmark.m_rowRiffsPerSec,
+                            benchmark.m_bulkRiffsPerSec ),
+                        benchmark.passed() };
+                });
+            }
+#if OURO_FEATURE_RT_SENTINEL
+            ImGui::Separator();
+            if ( ImGui::MenuItem( "Real-time Sentinel Report" ) )
+            {
+                const auto report = base::instr::getRealtimeReport();
+                base::instr::logRealtimeReport( report );
+
+                m_appEventBus->send<::events::AddToastNotification>(
+                    report.passed() ? ::events::AddToastNotification::Type::Info : ::events::AddToastNotification::Type::Error,
+                    "Real-time Sentinel",
+                    fmt::format( FMTX( "{} of {} callbacks offended" ), report.m_offendingCallbacks, report.m_callbacks ) );
+            }
+            if ( ImGui::MenuItem( "Real-time Sentinel Reset", nullptr, false, checkAvailable ) )
+            {
+                const auto resetStatus = m_mdAudio->resetRealtimeReport();
+                if ( !resetStatus.ok() )
+                {
+                    m_appEventBus->send<::events::AddToastNotification>(
+                        ::events::AddToastNotification::Type::Error,
+                        "Real-time Sentinel",
+                        resetStatus.ToString() );
+                }
+            }
+            if ( ImGui::MenuItem( "Real-time Sentinel Offline Render", nullptr, false, checkAvailable ) )
+            {
+                runDeveloperCheck( "Real-time Sentinel Offline Render", [this]() -> DeveloperCheckResult
+                {
+                    // the report only covers the offline callbacks; the live tally is cleared as a side-effect
+                    const auto reportOrStatus = m_mdAudio->renderOffline( 2000, 512 );
+                    if ( !reportOrStatus.ok() )
+                        return { reportOrStatus.status().ToString(), false };
+
+                    const auto& report = reportOrStatus.value();
+                    base::instr::logRealtimeReport( report );
+
+                    return {
+                        fmt::format( FMTX( "{} of {} callbacks offended, {} call sites" ), report.m_offendingCallbacks, report.m_callbacks, report.m_sites.size() ),
+                        report.passed() };
+                });
+            }
+#endif // OURO_FEATURE_RT_SENTINEL
 #if OURO_DEBUG
             ImGui::Separator();
             if ( ImGui::MenuItem( "Test Toast (info)" ) )
@@ -764,6 +974,9 @@ int CoreGUI::Entrypoint()
     // run the app main loop
     int appResult = EntrypointGUI();
 
+    // let any developer check still in flight finish before the things it reports through go away
+    getTaskExecutor().wait_for_all();
+
     {
         base::EventBusClient m_eventBusClient( m_appEventBus );
         APP_EVENT_UNBIND( AddToastNotification );
@@ -775,6 +988,26 @@ int CoreGUI::Entrypoint()
     return appResult;
 }
 
+// ---------------------------------------------------------------------------------------------------------------------
+void CoreGUI::runDeveloperCheck( const char* title, DeveloperCheckFn&& checkFn )
+{
+    m_developerCheckRunning = true;
+
+    getTaskExecutor().silent_async( [this, title, checkFn = std::move( checkFn )]()
+    {
+        const DeveloperCheckResult result = checkFn();
+
+        blog::core( FMTX( "{} : {}" ), title, result.m_summary );
+
+        m_appEventBus->send<::events::AddToastNotification>(
+            result.m_passed ? ::events::AddToastNotification::Type::Info : ::events::AddToastNotification::Type::Error,
+            title,
+            result.m_summary );
+
+        m_developerCheckRunning = false;
+    });
+}
+
 // ---------------------------------------------------------------------------------------------------------------------
 void CoreGUI::activateModalPopup( const std::string_view& label, ModalPopupExecutor&& executor )
 {
@@ -790,6 +1023,20 @@ bool CoreGUI::beginInterfaceLayout( const ViewportFlags viewportFlags )
     // begin tracking perf cost of the imgui 'build' stage
     m_perfData.m_moment.setToNow();
 
+#if OURO_FEATURE_ALLOC_COUNTING
+    // count main-thread heap allocations made across the whole of the previous frame; skip the very first as
+    // that would just be measuring boot-up
+    {
+        const auto allocationCounts = base::instr::getThreadAllocationCounts();
+        if ( m_perfData.m_allocationsAtFrameStart.m_allocations > 0 )
+        {
+            m_perfData.m_frameAllocations     = ( allocationCounts - m_perfData.m_allocationsAtFrameStart ).m_allocations;
+            m_perfData.m_frameAllocationsPeak = std::max( m_perfData.m_frameAllocationsPeak, m_perfData.m_frameAllocations );
+        }
+        m_perfData.m_allocationsAtFrameStart = allocationCounts;
+    }
+#endif // OURO_FEATURE_ALLOC_COUNTING
+
     // resetting/loading new layouts has to happen before layout is underway
     if ( m_resetLayoutInNextUpdate )
     {
@@ -1162,6 +1409,38 @@ void CoreGUI::ImGuiPerformanceTracker()
             ImGui::TableNextColumn(); ImGui::Text( "%9" PRIu64 " ms", m_perfData.m_uiPreRender.count() );
             ImGui::TableNextColumn(); ImGui::TextUnformatted( "Dispatch" );
             ImGui::TableNextColumn(); ImGui::Text( "%9" PRIu64 " ms", m_perfData.m_uiPostRender.count() );
+            const auto& frameStatistics = m_mdFrontEnd->getFrameStatistics();
+
+            ImGui::TableNextColumn(); ImGui::TextUnformatted( "Frame Avg" );
+            ImGui::TableNextColumn(); ImGui::Text( "%9.2f ms", frameStatistics.m_averageCostMs );
+            ImGui::TableNextColumn(); ImGui::TextUnformatted( "Frame Worst" );
+            ImGui::TableNextColumn(); ImGui::Text( "%9.2f ms", frameStatistics.m_worstCostMs );
+            ImGui::TableNextColumn(); ImGui::TextUnformatted( "Pacing" );
+            if ( frameStatistics.m_targetFrameRate > 0 )
+            {
+                ImGui::TableNextColumn(); ImGui::Text( "%9i fps (%s)", frameStatistics.m_targetFrameRate, app::module::Frontend::getPresentationStateName( frameStatistics.m_state ) );
+            }
+            else
+            {
+                ImGui::TableNextColumn(); ImGui::Text( "    vsync (%s)", app::module::Frontend::getPresentationStateName( frameStatistics.m_state ) );
+            }
+#if OURO_FEATURE_ALLOC_COUNTING
+            ImGui::TableNextColumn(); ImGui::TextUnformatted( "Allocations" );
+            ImGui::TableNextColumn(); ImGui::Text( "%9" PRIu64 " / frame", m_perfData.m_frameAllocations );
+            ImGui::TableNextColumn(); ImGui::TextUnformatted( "Alloc Peak" );
+            ImGui::TableNextColumn(); ImGui::Text( "%9" PRIu64 " / frame", m_perfData.m_frameAllocationsPeak );
+#endif // OURO_FEATURE_ALLOC_COUNTING
+
+            ImGui::TableNextColumn();
+            ImGui::Spacing();
+            if ( ImGui::Button( "Reset##ui_peaks" ) )
+            {
+#if OURO_FEATURE_ALLOC_COUNTING
+                m_perfData.m_frameAllocationsPeak = 0;
+#endif // OURO_FEATURE_ALLOC_COUNTING
+                m_mdFrontEnd->resetWorstFrameCost();
+            }
+            ImGui::Spacing(); ImGui::TableNextColumn();
 
             ImGui::EndTable();
         }
@@ -10,34 +10,19 @@
 #pragma once
 
 #include "base/eventbus.h"
+#include "base/instrumentation.h"
 #include "colour/preset.h"
 
 #include "spacetime/moment.h"
 
 #include "config/data.h"
+#include "config/exchange.h"
 #include "config/performance.h"
 #include "config/frontend.h"
 
 #include "endlesss/all.h"
 
 
-// ---------------------------------------------------------------------------------------------------------------------
-// on Windows, declare and enable use of the global memory IPC object for pushing Exchange data out to external apps
-#if OURO_PLATFORM_WIN
-
-#include "win32/ipc.h"
-#define OURO_EXCHANGE_IPC   1
-
-namespace endlesss {
-using ExchangeIPC = win32::GlobalSharedMemory< endlesss::toolkit::Exchange >;
-} //namespace endlesss
-
-#else // OURO_PLATFORM_WIN
-
-#define OURO_EXCHANGE_IPC   0
-
-#endif
-
 template <typename T>
 concept ReturnsAbslStatus = requires (T t) {
     { t() } -> std::same_as<absl::Status>;
@@ -131,7 +116,10 @@ struct Core : CoreStart,
     ~Core();
 
     // high-level entrypoint, called by main()
-    int Run();
+    int Run( int argc, char** argv );
+
+    // true if Run() was asked on the command line for a non-interactive job (eg. --rt-sentinel-check) rather than the app
+    ouro_nodiscard constexpr bool isHeadlessRun() const { return m_headlessRun; }
 
     // used for visual identity as well as cache path differentiation
     virtual const char* GetAppName() const = 0;             // 'FOO'
@@ -154,6 +142,13 @@ protected:
     // called once basic initial configuration is done for the application to continue work
     virtual int Entrypoint() = 0;
 
+#if OURO_FEATURE_RT_SENTINEL
+    // headless gate for the real-time sentinel; renders the mix path offline into a null device, logs the report and
+    // returns non-zero if any callback offended. needs no audio hardware, configuration or network
+    static constexpr auto cRealtimeSentinelCheckArg = "--rt-sentinel-check";
+    int runRealtimeSentinelCheck();
+#endif // OURO_FEATURE_RT_SENTINEL
+
     ouro_nodiscard constexpr const char* getOuroveonPlatform() const 
     {
 #if OURO_PLATFORM_WIN
@@ -173,6 +168,8 @@ protected:
     void emitAndClearExchangeData();
 
 
+    bool                                    m_headlessRun = false;
+
     fs::path                                m_sharedConfigPath;             // R/W path for config shared between apps
     fs::path                                m_sharedDataPath;               // RO  path for app shared data in the install folder
     fs::path                                m_appConfigPath;                // R/W path for config for this specific app
@@ -211,11 +208,12 @@ protected:
     // standard state exchange data, filled when possible with the current playback state
     endlesss::toolkit::Exchange             m_endlesssExchange;
 
-#if OURO_EXCHANGE_IPC
     // constantly-updated globally-shared data block
-    endlesss::ExchangeIPC                   m_endlesssExchangeIPC;
-    uint32_t                                m_endlesssExchangeWriteCounter = 1;
-#endif
+    endlesss::toolkit::ExchangeIPC          m_endlesssExchangeIPC;
+
+    // optional network broadcast of the same data, see config::ExchangeBroadcast
+    config::ExchangeBroadcast               m_configExchangeBroadcast;
+    endlesss::toolkit::ExchangeBroadcaster  m_endlesssExchangeBroadcaster;
 
     // the interface to portaudio, make noise go bang
     app::AudioModule                        m_mdAudio;
@@ -422,6 +420,17 @@ protected:
     }
 
 
+    // developer menu checks and benchmarks; run on the task executor, the result logged and toasted when it's done
+    struct DeveloperCheckResult
+    {
+        std::string     m_summary;
+        bool            m_passed = true;
+    };
+    using DeveloperCheckFn = std::function< DeveloperCheckResult() >;
+
+    void runDeveloperCheck( const char* title, DeveloperCheckFn&& checkFn );
+
+
     config::Frontend        m_configFrontend;
     app::FrontendModule     m_mdFrontEnd;       // UI canvas management
 
@@ -434,6 +443,13 @@ protected:
         std::chrono::milliseconds   m_uiEventBus;
         std::chrono::milliseconds   m_uiPreRender;
         std::chrono::milliseconds   m_uiPostRender;
+
+#if OURO_FEATURE_ALLOC_COUNTING
+        base::instr::AllocationCounts
+                                    m_allocationsAtFrameStart;
+        uint64_t                    m_frameAllocations      = 0;    // main-thread heap allocations over the last full frame
+        uint64_t                    m_frameAllocationsPeak  = 0;
+#endif // OURO_FEATURE_ALLOC_COUNTING
     }                       m_perfData;
     AudioLoadAverage        m_audoLoadAverage;
 
@@ -556,6 +572,7 @@ private:
     bool                    m_showPerformanceWindow     = false;
     bool                    m_showCommandPaletteWindow  = false;
     bool                    m_resetLayoutInNextUpdate   = false;
+    std::atomic_bool        m_developerCheckRunning     = false;   // only one developer check runs at a time
 };
 
 } // namespace app
@@ -14,6 +14,8 @@
 static float g_cycleTimerSlow;
 static float g_cycleTimerFast;
 
+static std::atomic_bool g_redrawRequested = false;
+
 namespace ImGui {
 
 void StandardFilterBox( ImGuiTextFilter& hostFilter, const char* label, const float width )
@@ -235,6 +237,8 @@ ImU32 ParseHexColour( const char* hexColour )
 
 ImVec4 GetPulseColourVec4( float alpha )
 {
+    RequestRedraw();
+
     const auto colour1 = ImGui::GetStyleColorVec4( ImGuiCol_PlotHistogram );
     const auto colour2 = ImGui::GetStyleColorVec4( ImGuiCol_PlotHistogramHovered );
     auto pulse = lerpVec4( colour1, colour2, g_cycleTimerSlow );
@@ -249,6 +253,8 @@ ImU32 GetPulseColour( float alpha )
 
 ImU32 GetSyncBusyColour( float alpha )
 {
+    RequestRedraw();
+
     const auto colour1 = colour::shades::blue_gray.neutral( alpha );
     const auto colour2 = colour::shades::slate.dark( alpha );
     auto pulse = lerpVec4( colour1, colour2, g_cycleTimerSlow );
@@ -517,6 +523,17 @@ bool KnobFloat(
     return value_changed;
 }
 
+// ---------------------------------------------------------------------------------------------------------------------
+void RequestRedraw()
+{
+    g_redrawRequested.store( true, std::memory_order_relaxed );
+}
+
+bool ConsumeRedrawRequest()
+{
+    return g_redrawRequested.exchange( false, std::memory_order_relaxed );
+}
+
 // ---------------------------------------------------------------------------------------------------------------------
 bool Spinner( const char* label, bool active, float radius, float thickness, float yOffset, const ImU32& color )
 {
@@ -539,6 +556,8 @@ bool Spinner( const char* label, bool active, float radius, float thickness, flo
     if ( !active )
         return true;
 
+    RequestRedraw();
+
     // Render
     window->DrawList->PathClear();
 
@@ -591,6 +610,9 @@ void BeatSegments(
 
     if ( activeSegment >= 0 )
     {
+        // an active segment means something is playing through them
+        RequestRedraw();
+
         const float activeStart = activeSegment * widthPerSeg;
         const float activeEnd   = activeStart + widthPerSeg;
 
@@ -137,6 +137,15 @@ bool KnobFloat(
     float default_value = 0.0f,
     const std::function< std::string ( const float percentage01, const float value ) >& tooltipCallback = nullptr );
 
+// ---------------------------------------------------------------------------------------------------------------------
+// frame pacing hint for the frontend; anything animating from audio or background state (beat pulses, spinners,
+// playback progress) calls this while it has something changing to show, keeping the app at its full foreground
+// frame rate instead of letting it throttle down once idle. safe to call from any thread
+void RequestRedraw();
+
+// consumed once per frame by the frontend; true if anything asked for a redraw since the previous call
+bool ConsumeRedrawRequest();
+
 // ---------------------------------------------------------------------------------------------------------------------
 bool Spinner( const char* label, bool active, float radius, float thickness, float yOffset, const ImU32& color );
 
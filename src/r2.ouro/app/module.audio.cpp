@@ -157,6 +157,83 @@ void Audio::termOutput()
 }
 
 
+// ---------------------------------------------------------------------------------------------------------------------
+absl::Status Audio::initOfflineOutput( const uint32_t sampleRate, const config::Spectrum& scopeSpectrumConfig )
+{
+    ABSL_ASSERT( m_mixerBuffers == nullptr );
+
+    blog::core( "Establishing offline audio output @ {}", sampleRate );
+
+    m_sampleRate    = sampleRate;
+    m_scope         = std::make_unique< dsp::Scope8 >( 1.0f / 60.0f, m_sampleRate, scopeSpectrumConfig );
+    m_mixerBuffers  = new OutputBuffer( getMaximumBufferSize() );
+
+    return absl::OkStatus();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+absl::StatusOr< base::instr::RealtimeReport > Audio::renderOffline( const uint32_t callbackCount, const uint32_t framesPerBuffer )
+{
+    if ( m_mixerBuffers == nullptr )
+        return absl::FailedPreconditionError( "no audio output initialised" );
+
+    if ( framesPerBuffer == 0 || framesPerBuffer > (uint32_t)getMaximumBufferSize() )
+        return absl::InvalidArgumentError( fmt::format( FMTX( "buffer size {} out of range" ), framesPerBuffer ) );
+
+    // take the device out of the loop; stopping waits on any callback in flight, after which the mix state is ours
+    const bool resumeStream = ( m_paStream != nullptr && Pa_IsStreamActive( m_paStream ) == 1 );
+    if ( resumeStream )
+        Pa_StopStream( m_paStream );
+
+    // interleaved stereo output for the null device, discarded
+    std::vector< float > nullDevice( (std::size_t)framesPerBuffer * 2 );
+
+    base::instr::RealtimeReport realtimeReport;
+
+#if OURO_FEATURE_RT_SENTINEL
+    // only safe to clear the tally now nothing else is running a callback
+    base::instr::resetRealtimeReport();
+#endif // OURO_FEATURE_RT_SENTINEL
+
+    for ( uint32_t callback = 0; callback < callbackCount; callback++ )
+        PortAudioCallbackInternal( nullDevice.data(), framesPerBuffer, nullptr );
+
+#if OURO_FEATURE_RT_SENTINEL
+    // take the results before the live stream starts adding to them again
+    realtimeReport = base::instr::getRealtimeReport();
+#endif // OURO_FEATURE_RT_SENTINEL
+
+    if ( resumeStream )
+    {
+        const PaError err = Pa_StartStream( m_paStream );
+        if ( err != paNoError )
+            return absl::UnavailableError( fmt::format( FMTX( "Pa_StartStream failed [{}]" ), Pa_GetErrorText( err ) ) );
+    }
+
+    return realtimeReport;
+}
+
+#if OURO_FEATURE_RT_SENTINEL
+// ---------------------------------------------------------------------------------------------------------------------
+absl::Status Audio::resetRealtimeReport()
+{
+    const bool resumeStream = ( m_paStream != nullptr && Pa_IsStreamActive( m_paStream ) == 1 );
+    if ( resumeStream )
+        Pa_StopStream( m_paStream );
+
+    base::instr::resetRealtimeReport();
+
+    if ( resumeStream )
+    {
+        const PaError err = Pa_StartStream( m_paStream );
+        if ( err != paNoError )
+            return absl::UnavailableError( fmt::format( FMTX( "Pa_StartStream failed [{}]" ), Pa_GetErrorText( err ) ) );
+    }
+
+    return absl::OkStatus();
+}
+#endif // OURO_FEATURE_RT_SENTINEL
+
 // ---------------------------------------------------------------------------------------------------------------------
 double Audio::getAudioEngineCPULoadPercent() const
 {
@@ -274,6 +351,10 @@ void Audio::ProcessMixCommandsOnMixThread()
 // ---------------------------------------------------------------------------------------------------------------------
 int Audio::PortAudioCallbackInternal( void* outputBuffer, unsigned long framesPerBuffer, const PaStreamCallbackTimeInfo* timeInfo )
 {
+    // everything from here on is on the clock; with the rt sentinel built in, any allocation / lock / blocking call
+    // made inside this scope gets recorded against the callback
+    base::instr::RealtimeCallbackScope realtimeScope;
+
     ABSL_ASSERT( m_mixerBuffers );
     ProcessMixCommandsOnMixThread();
 
@@ -127,6 +127,23 @@ struct Audio final
     ouro_nodiscard absl::Status initOutput( const config::Audio& outputDevice, const config::Spectrum& scopeSpectrumConfig );
     void termOutput();
 
+    // set up the mixer buffers and scope as initOutput() does, but with no device attached; renderOffline() is then the
+    // only thing driving the mix. for headless runs that still want the whole audio path exercised
+    ouro_nodiscard absl::Status initOfflineOutput( const uint32_t sampleRate, const config::Spectrum& scopeSpectrumConfig );
+
+    // run `callbackCount` mix callbacks of `framesPerBuffer` samples on the calling thread into a null device, the output
+    // being thrown away; any live stream is paused for the duration and resumed afterwards. all the usual per-callback
+    // work runs - mix commands, mixer, VSTs, scope, sample processors - so this is a deterministic way to put the mix
+    // path under the real-time sentinel (or a profiler) without depending on the audio hardware.
+    // with the sentinel built in, the tally is reset once the live stream has stopped and the report returned covers
+    // only the offline callbacks; without it, the report is empty
+    ouro_nodiscard absl::StatusOr< base::instr::RealtimeReport > renderOffline( const uint32_t callbackCount, const uint32_t framesPerBuffer );
+
+#if OURO_FEATURE_RT_SENTINEL
+    // clear the sentinel tally; any live stream is briefly paused around it, as a reset with a callback in flight is unsafe
+    ouro_nodiscard absl::Status resetRealtimeReport();
+#endif // OURO_FEATURE_RT_SENTINEL
+
     ouro_nodiscard constexpr int32_t getSampleRate() const { ABSL_ASSERT( m_sampleRate > 0 ); return m_sampleRate; }
 
 
@@ -506,6 +506,8 @@ void Frontend::destroy()
 // ---------------------------------------------------------------------------------------------------------------------
 bool Frontend::appTick()
 {
+    m_frameBeginTime = glfwGetTime();
+
     bool shouldQuit = m_quitRequested;
          shouldQuit |= ( glfwWindowShouldClose( m_glfwWindow ) != 0 );
 
@@ -529,6 +531,9 @@ bool Frontend::appTick()
     ImGui_ImplGlfw_NewFrame();
     ImGui::NewFrame();
 
+    // imgui drops duplicate input events, so anything left in the trail is a real change from the user
+    m_inputThisFrame = ( GImGui->InputEventsTrail.Size > 0 ) || ImGui::IsAnyItemActive();
+
     ImGui::Scoped::TickPulses();
 
     return shouldQuit;
@@ -557,8 +562,99 @@ void Frontend::appRenderImguiDispatch()
 // ---------------------------------------------------------------------------------------------------------------------
 void Frontend::appRenderFinalise()
 {
+    const double frameCostSec = glfwGetTime() - m_frameBeginTime;
+
     glfwSwapBuffers( m_glfwWindow );
-    glfwPollEvents();
+    paceAndPollEvents( frameCostSec );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+const char* Frontend::getPresentationStateName( const PresentationState state )
+{
+    switch ( state )
+    {
+        case PresentationState::Foreground: return "Foreground";
+        case PresentationState::Idle:       return "Idle";
+        case PresentationState::Background: return "Background";
+        case PresentationState::Headless:   return "Headless";
+        default:
+            assert(0);
+    }
+    return "Unknown";
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+Frontend::PresentationState Frontend::determinePresentationState( const double timeNow ) const
+{
+    if ( glfwGetWindowAttrib( m_glfwWindow, GLFW_ICONIFIED ) != 0 ||
+         glfwGetWindowAttrib( m_glfwWindow, GLFW_VISIBLE )   == 0 ||
+         m_currentWindowGeometry.m_width  == 0 ||
+         m_currentWindowGeometry.m_height == 0 )
+    {
+        return PresentationState::Headless;
+    }
+
+    if ( glfwGetWindowAttrib( m_glfwWindow, GLFW_FOCUSED ) == 0 )
+        return PresentationState::Background;
+
+    if ( timeNow - m_lastActivityTime >= (double)m_feConfigCopy.idleAfterSeconds )
+        return PresentationState::Idle;
+
+    return PresentationState::Foreground;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+int32_t Frontend::getTargetFrameRate( const PresentationState state ) const
+{
+    switch ( state )
+    {
+        default:
+        case PresentationState::Foreground: return m_feConfigCopy.frameRateForeground;
+        case PresentationState::Idle:       return m_feConfigCopy.frameRateIdle;
+        case PresentationState::Background: return m_feConfigCopy.frameRateBackground;
+        case PresentationState::Headless:   return m_feConfigCopy.frameRateHeadless;
+    }
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void Frontend::paceAndPollEvents( const double frameCostSec )
+{
+    // smoothed average and worst-case cost of the work done per frame
+    {
+        static constexpr double averageBlend = 0.05;
+
+        const double frameCostMs = frameCostSec * 1000.0;
+
+        m_frameStatistics.m_averageCostMs += ( frameCostMs - m_frameStatistics.m_averageCostMs ) * averageBlend;
+        m_frameStatistics.m_worstCostMs    = std::max( m_frameStatistics.m_worstCostMs, frameCostMs );
+    }
+
+    const double timeNow = glfwGetTime();
+
+    if ( m_inputThisFrame || ImGui::ConsumeRedrawRequest() )
+        m_lastActivityTime = timeNow;
+
+    const PresentationState presentationState = determinePresentationState( timeNow );
+    const int32_t           targetFrameRate   = getTargetFrameRate( presentationState );
+
+    m_frameStatistics.m_state           = presentationState;
+    m_frameStatistics.m_targetFrameRate = targetFrameRate;
+
+    // no rate limit; vsync on the buffer swap does the pacing
+    if ( targetFrameRate <= 0 )
+    {
+        glfwPollEvents();
+        return;
+    }
+
+    // sleep until the next frame is due, waking early if any window events arrive so input stays responsive
+    const double nextFrameTime = m_frameBeginTime + ( 1.0 / (double)targetFrameRate );
+    const double waitTime      = nextFrameTime - timeNow;
+
+    if ( waitTime > 0 )
+        glfwWaitEventsTimeout( waitTime );
+    else
+        glfwPollEvents();
 }
 
 // ---------------------------------------------------------------------------------------------------------------------
@@ -48,6 +48,28 @@ struct Frontend final : public Module
     void toggleBorderless();
 
 
+    // frame pacing; after each frame is presented the frontend waits on window events until the next frame is
+    // due, at a rate chosen from config::Frontend depending on what state the app window is in
+    enum class PresentationState
+    {
+        Foreground,     // focused, and animating or being interacted with
+        Idle,           // focused, nothing changing
+        Background,     // unfocused
+        Headless,       // minimised / hidden
+    };
+    static const char* getPresentationStateName( const PresentationState state );
+
+    struct FrameStatistics
+    {
+        PresentationState   m_state             = PresentationState::Foreground;
+        int32_t             m_targetFrameRate   = 0;        // 0 if running at display refresh
+        double              m_averageCostMs     = 0;        // time spent building and rendering each frame, excluding
+        double              m_worstCostMs       = 0;        // any pacing wait and the buffer swap
+    };
+    ouro_nodiscard constexpr const FrameStatistics& getFrameStatistics() const { return m_frameStatistics; }
+    constexpr void resetWorstFrameCost() { m_frameStatistics.m_worstCostMs = 0; }
+
+
     // will return false from next appTick
     constexpr void requestQuit() { m_quitRequested = true; }
     ouro_nodiscard constexpr bool wasQuitRequested() const { return m_quitRequested; }
@@ -109,6 +131,13 @@ private:
     // push actual window attributes for borderless mode
     void applyBorderless() const;
 
+    // work out what state we're presenting in and the frame rate that goes with it
+    ouro_nodiscard PresentationState determinePresentationState( const double timeNow ) const;
+    ouro_nodiscard int32_t getTargetFrameRate( const PresentationState state ) const;
+
+    // record the cost of the frame just rendered, then wait for input or the next frame deadline
+    void paceAndPollEvents( const double frameCostSec );
+
     config::Frontend        m_feConfigCopy;
     std::string             m_appName;
 
@@ -131,6 +160,11 @@ private:
     ImGui::MarkdownConfig   m_markdownConfig;
 
     bool                    m_quitRequested = false;
+
+    double                  m_frameBeginTime        = 0;    // glfwGetTime() at the start of the current frame
+    double                  m_lastActivityTime      = 0;    // .. of the last frame that saw input or a redraw request
+    bool                    m_inputThisFrame        = false;
+    FrameStatistics         m_frameStatistics;
 };
 
 } // namespace module
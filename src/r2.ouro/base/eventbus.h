@@ -11,6 +11,7 @@
 #include "base/construction.h"
 #include "base/hashing.h"
 #include "base/id.simple.h"
+#include "base/instrumentation.h"
 
 namespace base {
 
@@ -152,7 +153,27 @@ private:
     std::atomic_uint32_t    m_listenerUID = 0;
 
 
-    using EventQueue   = mcc::ConcurrentQueue< IEvent* >;
+#if OURO_FEATURE_RT_SENTINEL
+    // the queues grow by calling their traits' malloc directly rather than going through operator new; route those
+    // calls past the rt sentinel so that send() from the audio thread gets the same scrutiny as everything else
+    struct QueueTraits : public mcc::ConcurrentQueueDefaultTraits
+    {
+        static inline void* malloc( std::size_t size )
+        {
+            base::instr::realtimeViolation( base::instr::RealtimeViolation::Allocation );
+            return mcc::ConcurrentQueueDefaultTraits::malloc( size );
+        }
+        static inline void free( void* ptr )
+        {
+            base::instr::realtimeViolation( base::instr::RealtimeViolation::Free );
+            mcc::ConcurrentQueueDefaultTraits::free( ptr );
+        }
+    };
+#else
+    using QueueTraits  = mcc::ConcurrentQueueDefaultTraits;
+#endif // OURO_FEATURE_RT_SENTINEL
+
+    using EventQueue   = mcc::ConcurrentQueue< IEvent*, QueueTraits >;
     using ListenerMap  = absl::flat_hash_map< EventListenerID, EventListenerFn >;
 
     // structure created on Register() to manage a single ID
@@ -161,7 +182,7 @@ private:
     {
         DECLARE_NO_COPY_NO_MOVE( EventPipe );
 
-        using MemoryBlockQueue = mcc::ConcurrentQueue< uint8_t* >;
+        using MemoryBlockQueue = mcc::ConcurrentQueue< uint8_t*, QueueTraits >;
 
         EventPipe() = delete;
         EventPipe( const EventID& id, const std::size_t eventSize, const std::size_t maxEvents );
@@ -140,6 +140,29 @@ constexpr uint64_t crush64( const uint64_t value1, const uint64_t value2, const
     return b;
 }
 
+// ---------------------------------------------------------------------------------------------------------------------
+// cheap, stable (across runs and processes) 64b hash of a block of bytes, 8 bytes at a time; suitable for on-disk
+// integrity checks, not for anything adversarial
+inline uint64_t hashBytes64( const uint8_t* bytes, const std::size_t byteCount, uint64_t hash = 0 )
+{
+    hash ^= byteCount;
+
+    std::size_t offset = 0;
+    for ( ; offset + sizeof( uint64_t ) <= byteCount; offset += sizeof( uint64_t ) )
+    {
+        uint64_t word;
+        std::memcpy( &word, bytes + offset, sizeof( uint64_t ) );
+        hash = crush64( hash, word );
+    }
+    if ( offset < byteCount )
+    {
+        uint64_t word = 0;
+        std::memcpy( &word, bytes + offset, byteCount - offset );
+        hash = crush64( hash, word );
+    }
+    return hash;
+}
+
 // ---------------------------------------------------------------------------------------------------------------------
 // mix a RDTSC value to produce a random seed
 inline uint64_t randomU64()
@@ -50,6 +50,21 @@ struct StringWrapper
     {
         _value = str;
     }
+    // .. and as a plain string in binary archives
+    template <class Archive,
+        cereal::traits::DisableIf<cereal::traits::is_text_archive<Archive>::value>
+        = cereal::traits::sfinae>
+        void save( Archive& archive ) const
+    {
+        archive( _value );
+    }
+    template <class Archive,
+        cereal::traits::DisableIf<cereal::traits::is_text_archive<Archive>::value>
+        = cereal::traits::sfinae>
+        void load( Archive& archive )
+    {
+        archive( _value );
+    }
 
     using StringWrapperType = StringWrapper<_identity>;
 
@@ -10,6 +10,10 @@
 
 #include "base/instrumentation.h"
 
+#if OURO_FEATURE_RT_SENTINEL && !OURO_PLATFORM_WIN
+#include <execinfo.h>
+#endif // OURO_FEATURE_RT_SENTINEL && !OURO_PLATFORM_WIN
+
 // ---------------------------------------------------------------------------------------------------------------------
 // Superluminal profiler support
 #ifdef OURO_FEATURE_SUPERLUMINAL
@@ -56,3 +60,364 @@ void eventEnd() {}
 } // namespace base
 
 #endif
+
+
+// ---------------------------------------------------------------------------------------------------------------------
+// allocation counting, via replacement of the global allocation functions below; aligned variants are left to the
+// runtime as they don't route through these
+#if OURO_FEATURE_ALLOC_COUNTING
+namespace base {
+namespace instr {
+
+static thread_local AllocationCounts tl_allocationCounts;
+
+AllocationCounts getThreadAllocationCounts()
+{
+    return tl_allocationCounts;
+}
+
+} // namespace instr
+} // namespace base
+#endif // OURO_FEATURE_ALLOC_COUNTING
+
+
+// ---------------------------------------------------------------------------------------------------------------------
+// real-time safety sentinel
+namespace base {
+namespace instr {
+
+const char* getRealtimeViolationName( const RealtimeViolation violation )
+{
+    switch ( violation )
+    {
+    case RealtimeViolation::Allocation:     return "allocation";
+    case RealtimeViolation::Free:           return "free";
+    case RealtimeViolation::Lock:           return "lock";
+    case RealtimeViolation::BlockingCall:   return "blocking-call";
+    default:
+        break;
+    }
+    return "unknown";
+}
+
+#if OURO_FEATURE_RT_SENTINEL
+
+static thread_local int32_t     tl_realtimeDepth        = 0;        // > 0 while inside a real-time callback
+static thread_local bool        tl_realtimeOffended     = false;    // set on any violation in the outermost callback
+static thread_local bool        tl_realtimeRecording    = false;    // re-entrancy guard, capturing a stack may itself allocate
+
+// unique call sites live in a fixed open-addressed table keyed by a hash of the stack, so recording one from the audio
+// thread never needs to allocate or lock; slots are claimed with a CAS and published once the frames are written
+struct RealtimeSiteSlot
+{
+    std::atomic_uint64_t                                    m_key;      // stack hash, 0 for an empty slot
+    std::atomic_bool                                        m_ready;
+    std::atomic_uint64_t                                    m_hits;
+    RealtimeViolation                                       m_violation;
+    uint32_t                                                m_frameCount;
+    std::array< void*, RealtimeReport::cMaxStackFrames >    m_frames;
+};
+static constexpr std::size_t cRealtimeSiteSlots = 64;
+
+static std::array< RealtimeSiteSlot, cRealtimeSiteSlots >                   gRealtimeSites;
+static std::array< std::atomic_uint64_t, RealtimeReport::cNumViolations >   gRealtimeViolations;
+static std::atomic_uint64_t                                                 gRealtimeCallbacks;
+static std::atomic_uint64_t                                                 gRealtimeOffendingCallbacks;
+static std::atomic_uint64_t                                                 gRealtimeSitesDropped;
+
+// ---------------------------------------------------------------------------------------------------------------------
+static uint32_t captureStack( std::array< void*, RealtimeReport::cMaxStackFrames >& frames )
+{
+#if OURO_PLATFORM_WIN
+    // skip ourselves and realtimeViolation()
+    return (uint32_t)::RtlCaptureStackBackTrace( 2, (DWORD)frames.size(), frames.data(), nullptr );
+#else
+    std::array< void*, RealtimeReport::cMaxStackFrames + 2 > rawFrames;
+    const int rawFrameCount = ::backtrace( rawFrames.data(), (int)rawFrames.size() );
+    if ( rawFrameCount <= 2 )
+        return 0;
+
+    const uint32_t frameCount = (uint32_t)rawFrameCount - 2;
+    std::copy_n( rawFrames.begin() + 2, frameCount, frames.begin() );
+    return frameCount;
+#endif // OURO_PLATFORM_WIN
+}
+
+#if !OURO_PLATFORM_WIN
+// glibc loads its unwinder lazily on the first call to backtrace(), which allocates; get that out of the way at startup
+// rather than having it happen (and be reported) the first time the audio thread trips over something
+static const int gBacktraceWarmup = []()
+{
+    std::array< void*, 1 > frame;
+    return ::backtrace( frame.data(), (int)frame.size() );
+}();
+#endif // !OURO_PLATFORM_WIN
+
+// ---------------------------------------------------------------------------------------------------------------------
+static void recordSite( const RealtimeViolation violation, const std::array< void*, RealtimeReport::cMaxStackFrames >& frames, const uint32_t frameCount )
+{
+    // FNV-1a over the violation and frame addresses
+    uint64_t key = 0xcbf29ce484222325ULL;
+    const auto hashIn = [&key]( const uint64_t value )
+    {
+        key ^= value;
+        key *= 0x100000001b3ULL;
+    };
+    hashIn( (uint64_t)violation );
+    for ( uint32_t frame = 0; frame < frameCount; frame++ )
+        hashIn( (uint64_t)reinterpret_cast<uintptr_t>( frames[frame] ) );
+
+    if ( key == 0 )
+        key = 1;
+
+    for ( std::size_t probe = 0; probe < cRealtimeSiteSlots; probe++ )
+    {
+        RealtimeSiteSlot& slot = gRealtimeSites[( key + probe ) % cRealtimeSiteSlots];
+
+        uint64_t slotKey = slot.m_key.load( std::memory_order_acquire );
+        if ( slotKey == 0 )
+        {
+            if ( slot.m_key.compare_exchange_strong( slotKey, key, std::memory_order_acq_rel ) )
+            {
+                slot.m_violation  = violation;
+                slot.m_frameCount = frameCount;
+                slot.m_frames     = frames;
+                slot.m_hits.fetch_add( 1, std::memory_order_relaxed );
+                slot.m_ready.store( true, std::memory_order_release );
+                return;
+            }
+            // lost the race for this slot; slotKey now holds whoever won it, which may well be this same site
+        }
+        if ( slotKey == key )
+        {
+            slot.m_hits.fetch_add( 1, std::memory_order_relaxed );
+            return;
+        }
+    }
+
+    gRealtimeSitesDropped.fetch_add( 1, std::memory_order_relaxed );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void realtimeViolation( const RealtimeViolation violation )
+{
+    if ( tl_realtimeDepth <= 0 || tl_realtimeRecording )
+        return;
+
+    tl_realtimeRecording = true;
+    tl_realtimeOffended  = true;
+
+    gRealtimeViolations[(std::size_t)violation].fetch_add( 1, std::memory_order_relaxed );
+
+    std::array< void*, RealtimeReport::cMaxStackFrames > frames;
+    const uint32_t frameCount = captureStack( frames );
+    recordSite( violation, frames, frameCount );
+
+    tl_realtimeRecording = false;
+}
+
+void realtimeBlockingCall()
+{
+    realtimeViolation( RealtimeViolation::BlockingCall );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void realtimeCallbackBegin()
+{
+    if ( tl_realtimeDepth++ == 0 )
+    {
+        tl_realtimeOffended = false;
+        gRealtimeCallbacks.fetch_add( 1, std::memory_order_relaxed );
+    }
+}
+
+void realtimeCallbackEnd()
+{
+    if ( --tl_realtimeDepth == 0 && tl_realtimeOffended )
+        gRealtimeOffendingCallbacks.fetch_add( 1, std::memory_order_relaxed );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+RealtimeReport getRealtimeReport()
+{
+    RealtimeReport report;
+    report.m_callbacks          = gRealtimeCallbacks.load( std::memory_order_relaxed );
+    report.m_offendingCallbacks = gRealtimeOffendingCallbacks.load( std::memory_order_relaxed );
+    report.m_sitesDropped       = gRealtimeSitesDropped.load( std::memory_order_relaxed );
+
+    for ( std::size_t violation = 0; violation < RealtimeReport::cNumViolations; violation++ )
+        report.m_violations[violation] = gRealtimeViolations[violation].load( std::memory_order_relaxed );
+
+    for ( const auto& slot : gRealtimeSites )
+    {
+        if ( !slot.m_ready.load( std::memory_order_acquire ) )
+            continue;
+
+        RealtimeReport::Site& site = report.m_sites.emplace_back();
+        site.m_violation    = slot.m_violation;
+        site.m_hits         = slot.m_hits.load( std::memory_order_relaxed );
+        site.m_frameCount   = slot.m_frameCount;
+        site.m_frames       = slot.m_frames;
+    }
+
+    std::sort( report.m_sites.begin(), report.m_sites.end(), []( const RealtimeReport::Site& lhs, const RealtimeReport::Site& rhs )
+        {
+            return lhs.m_hits > rhs.m_hits;
+        });
+
+    return report;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void resetRealtimeReport()
+{
+    for ( auto& slot : gRealtimeSites )
+    {
+        slot.m_ready.store( false, std::memory_order_relaxed );
+        slot.m_hits.store( 0, std::memory_order_relaxed );
+        slot.m_key.store( 0, std::memory_order_release );
+    }
+    for ( auto& violations : gRealtimeViolations )
+        violations.store( 0, std::memory_order_relaxed );
+
+    gRealtimeCallbacks.store( 0, std::memory_order_relaxed );
+    gRealtimeOffendingCallbacks.store( 0, std::memory_order_relaxed );
+    gRealtimeSitesDropped.store( 0, std::memory_order_relaxed );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void logRealtimeReport( const RealtimeReport& report )
+{
+    if ( report.passed() )
+    {
+        blog::core( "[rt-sentinel] PASS - {} callbacks, no violations", report.m_callbacks );
+        return;
+    }
+
+    blog::error::core( "[rt-sentinel] FAIL - {} of {} callbacks offended", report.m_offendingCallbacks, report.m_callbacks );
+    for ( std::size_t violation = 0; violation < RealtimeReport::cNumViolations; violation++ )
+    {
+        if ( report.m_violations[violation] > 0 )
+            blog::error::core( "[rt-sentinel]   {:>14} : {}", getRealtimeViolationName( (RealtimeViolation)violation ), report.m_violations[violation] );
+    }
+    if ( report.m_sitesDropped > 0 )
+        blog::error::core( "[rt-sentinel]   {} violations from sites that didn't fit in the table", report.m_sitesDropped );
+
+    for ( std::size_t siteIndex = 0; siteIndex < report.m_sites.size(); siteIndex++ )
+    {
+        const RealtimeReport::Site& site = report.m_sites[siteIndex];
+
+        blog::error::core( "[rt-sentinel] site #{} : {} x {}", siteIndex, getRealtimeViolationName( site.m_violation ), site.m_hits );
+
+#if OURO_PLATFORM_WIN
+        // no symbol server to hand; emit module+offset, which can be resolved against the matching PDB offline
+        for ( uint32_t frame = 0; frame < site.m_frameCount; frame++ )
+        {
+            HMODULE frameModule = nullptr;
+            char modulePath[MAX_PATH] = { 0 };
+
+            if ( ::GetModuleHandleExA( GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT, (LPCSTR)site.m_frames[frame], &frameModule ) &&
+                 ::GetModuleFileNameA( frameModule, modulePath, MAX_PATH ) > 0 )
+            {
+                const auto offset = reinterpret_cast<uintptr_t>( site.m_frames[frame] ) - reinterpret_cast<uintptr_t>( frameModule );
+                blog::error::core( "[rt-sentinel]     {:>2} {}+{:#x}", frame, fs::path( modulePath ).filename().string(), offset );
+            }
+            else
+            {
+                blog::error::core( "[rt-sentinel]     {:>2} {}", frame, site.m_frames[frame] );
+            }
+        }
+#else
+        char** symbols = ::backtrace_symbols( site.m_frames.data(), (int)site.m_frameCount );
+        for ( uint32_t frame = 0; frame < site.m_frameCount; frame++ )
+        {
+            if ( symbols != nullptr )
+                blog::error::core( "[rt-sentinel]     {:>2} {}", frame, symbols[frame] );
+            else
+                blog::error::core( "[rt-sentinel]     {:>2} {}", frame, site.m_frames[frame] );
+        }
+        std::free( symbols );
+#endif // OURO_PLATFORM_WIN
+    }
+}
+
+#endif // OURO_FEATURE_RT_SENTINEL
+
+} // namespace instr
+} // namespace base
+
+// ---------------------------------------------------------------------------------------------------------------------
+// global allocation function replacements, only compiled in when allocation counting or the sentinel needs to see them
+#if OURO_FEATURE_ALLOC_COUNTING || OURO_FEATURE_RT_SENTINEL
+
+void* operator new( std::size_t size )
+{
+#if OURO_FEATURE_ALLOC_COUNTING
+    base::instr::tl_allocationCounts.m_allocations++;
+#endif // OURO_FEATURE_ALLOC_COUNTING
+
+#if OURO_FEATURE_RT_SENTINEL
+    base::instr::realtimeViolation( base::instr::RealtimeViolation::Allocation );
+#endif // OURO_FEATURE_RT_SENTINEL
+
+    if ( size == 0 )
+        size = 1;
+
+    for (;;)
+    {
+        if ( void* block = std::malloc( size ) )
+            return block;
+
+        std::new_handler handler = std::get_new_handler();
+        if ( handler == nullptr )
+            throw std::bad_alloc();
+
+        handler();
+    }
+}
+
+void* operator new[]( std::size_t size )
+{
+    return ::operator new( size );
+}
+
+void* operator new( std::size_t size, const std::nothrow_t& ) noexcept
+{
+    try
+    {
+        return ::operator new( size );
+    }
+    catch ( ... )
+    {
+        return nullptr;
+    }
+}
+
+void* operator new[]( std::size_t size, const std::nothrow_t& ) noexcept
+{
+    return ::operator new( size, std::nothrow );
+}
+
+void operator delete( void* block ) noexcept
+{
+    if ( block == nullptr )
+        return;
+
+#if OURO_FEATURE_ALLOC_COUNTING
+    base::instr::tl_allocationCounts.m_frees++;
+#endif // OURO_FEATURE_ALLOC_COUNTING
+
+#if OURO_FEATURE_RT_SENTINEL
+    base::instr::realtimeViolation( base::instr::RealtimeViolation::Free );
+#endif // OURO_FEATURE_RT_SENTINEL
+
+    std::free( block );
+}
+
+void operator delete[]( void* block ) noexcept                          { ::operator delete( block ); }
+void operator delete( void* block, std::size_t ) noexcept               { ::operator delete( block ); }
+void operator delete[]( void* block, std::size_t ) noexcept             { ::operator delete( block ); }
+void operator delete( void* block, const std::nothrow_t& ) noexcept     { ::operator delete( block ); }
+void operator delete[]( void* block, const std::nothrow_t& ) noexcept   { ::operator delete( block ); }
+
+#endif // OURO_FEATURE_ALLOC_COUNTING || OURO_FEATURE_RT_SENTINEL
@@ -86,5 +86,121 @@ private:
     }
 };
 
+// ---------------------------------------------------------------------------------------------------------------------
+// heap allocation tracking; built in with OURO_FEATURE_ALLOC_COUNTING (premake --alloc-counting), as it means replacing
+// the global operator new / delete for everything linked with r2.ouro. every trip through them then bumps a per-thread
+// tally, so the allocation churn of a frame (or any other block of work) can be found by sampling before and after it.
+// aligned new / delete are left to the runtime and are not counted
+#if OURO_FEATURE_ALLOC_COUNTING
+
+struct AllocationCounts
+{
+    uint64_t    m_allocations   = 0;
+    uint64_t    m_frees         = 0;
+
+    constexpr AllocationCounts operator-( const AllocationCounts& rhs ) const
+    {
+        return { m_allocations - rhs.m_allocations, m_frees - rhs.m_frees };
+    }
+};
+
+// running totals for the calling thread
+AllocationCounts getThreadAllocationCounts();
+
+#endif // OURO_FEATURE_ALLOC_COUNTING
+
+
+// ---------------------------------------------------------------------------------------------------------------------
+// real-time safety sentinel; built in with OURO_FEATURE_RT_SENTINEL (premake --rt-sentinel), otherwise this all compiles
+// away. a thread running a real-time callback marks itself with a RealtimeCallbackScope and, while marked, any heap
+// allocation, rpmalloc call, CheckedMutex lock or blocking call (like logging) is recorded as a violation along with
+// the call stack that made it. the report tallies how many callbacks misbehaved and keeps each unique offending site
+//
+enum class RealtimeViolation : uint8_t
+{
+    Allocation,
+    Free,
+    Lock,
+    BlockingCall,
+    Count
+};
+const char* getRealtimeViolationName( const RealtimeViolation violation );
+
+struct RealtimeReport
+{
+    static constexpr std::size_t cMaxStackFrames = 24;
+    static constexpr std::size_t cNumViolations  = (std::size_t)RealtimeViolation::Count;
+
+    struct Site
+    {
+        RealtimeViolation                       m_violation     = RealtimeViolation::Allocation;
+        uint64_t                                m_hits          = 0;
+        uint32_t                                m_frameCount    = 0;
+        std::array< void*, cMaxStackFrames >    m_frames        = {};
+    };
+
+    uint64_t                                    m_callbacks             = 0;    // real-time callbacks run while watching
+    uint64_t                                    m_offendingCallbacks    = 0;    // .. and how many of those did something they shouldn't
+    std::array< uint64_t, cNumViolations >      m_violations            = {};   // total count of each kind of violation
+    uint64_t                                    m_sitesDropped          = 0;    // violations from new call sites after the site table filled up
+    std::vector< Site >                         m_sites;                        // unique offending call sites, most hits first
+
+    ouro_nodiscard constexpr bool passed() const { return m_offendingCallbacks == 0; }
+};
+
+#if OURO_FEATURE_RT_SENTINEL
+
+// record a violation if the calling thread is inside a real-time callback; never allocates or locks
+void realtimeViolation( const RealtimeViolation violation );
+
+// shorthand for realtimeViolation( BlockingCall ); also declared in pch.inl so that logging can report itself
+void realtimeBlockingCall();
+
+// bookends for RealtimeCallbackScope, can be nested
+void realtimeCallbackBegin();
+void realtimeCallbackEnd();
+
+// gather the results so far; sites are copied out of fixed tables, stacks are left unresolved
+RealtimeReport getRealtimeReport();
+
+// clear all counters and sites; best done while no real-time callback is running, as a site being recorded at the
+// same time may be lost
+void resetRealtimeReport();
+
+// write the report out through blog, resolving stack frames to symbols where the platform allows it
+void logRealtimeReport( const RealtimeReport& report );
+
+// mark the current thread as running a real-time callback for the lifetime of the scope
+struct RealtimeCallbackScope
+{
+    DECLARE_NO_COPY_NO_MOVE( RealtimeCallbackScope );
+
+    RealtimeCallbackScope()  { realtimeCallbackBegin(); }
+    ~RealtimeCallbackScope() { realtimeCallbackEnd(); }
+};
+
+// a std::mutex that reports to the sentinel when locked from a real-time callback; it still *is* a std::mutex, so
+// can be handed to a condition_variable's unique_lock< std::mutex > on the non real-time side
+struct CheckedMutex : public std::mutex
+{
+    inline void lock()
+    {
+        realtimeViolation( RealtimeViolation::Lock );
+        std::mutex::lock();
+    }
+};
+
+#else
+
+struct RealtimeCallbackScope
+{
+    DECLARE_NO_COPY_NO_MOVE( RealtimeCallbackScope );
+    RealtimeCallbackScope() = default;
+};
+
+using CheckedMutex = std::mutex;
+
+#endif // OURO_FEATURE_RT_SENTINEL
+
 } // namespace instr
 } // namespace base
\ No newline at end of file
@@ -0,0 +1,101 @@
+//   _______ _______ ______ _______ ___ ___ _______ _______ _______ 
+//  |       |   |   |   __ \       |   |   |    ___|       |    |  |
+//  |   -   |   |   |      <   -   |   |   |    ___|   -   |       |
+//  |_______|_______|___|__|_______|\_____/|_______|_______|__|____|
+//  \\ harry denholm \\ ishani            ishani.org/shelf/ouroveon/
+//
+//
+
+#pragma once
+
+#include "base/construction.h"
+
+#include <atomic>
+#include <type_traits>
+
+namespace base {
+
+// ---------------------------------------------------------------------------------------------------------------------
+// wait-free, latest-value channel for pushing small fixed-size blocks of data from the audio thread to a reader
+// elsewhere (typically the main thread); a triple buffer, so neither side ever blocks, allocates or retries -
+// the writer always has a free slot to fill and the reader always has a complete one to look at
+//
+// one writer, one reader. values published faster than the reader picks them up are coalesced, only the newest
+// is kept; every publish is stamped with the channel's sequence number so the reader can tell new data from old
+// and see how many it skipped
+//
+template< typename _Type >
+struct TelemetryChannel
+{
+    static_assert( std::is_trivially_copyable_v< _Type >, "telemetry is copied between threads, keep it plain data" );
+
+    DECLARE_NO_COPY_NO_MOVE( TelemetryChannel );
+
+    TelemetryChannel() = default;
+
+    // writer; copy a new value in and make it the latest
+    inline void publish( const _Type& value )
+    {
+        Slot& slot      = m_slots[m_writeIndex];
+        slot.m_value    = value;
+        slot.m_sequence = ++m_writeSequence;
+
+        // swap our freshly written slot into the middle, taking whatever was there (stale or not) to write into next
+        const uint8_t previousMiddle = m_middle.exchange( m_writeIndex | cFreshBit, std::memory_order_acq_rel );
+        m_writeIndex = previousMiddle & cIndexMask;
+
+        m_publishedSequence.store( m_writeSequence, std::memory_order_relaxed );
+    }
+
+    // reader; copy out the newest value available, returning true if it wasn't already seen by a previous read().
+    // before anything has been published, `result` is a default-constructed value
+    inline bool read( _Type& result )
+    {
+        if ( ( m_middle.load( std::memory_order_relaxed ) & cFreshBit ) != 0 )
+        {
+            const uint8_t previousMiddle = m_middle.exchange( m_readIndex, std::memory_order_acq_rel );
+            m_readIndex = previousMiddle & cIndexMask;
+        }
+
+        const Slot& slot = m_slots[m_readIndex];
+        result = slot.m_value;
+
+        const bool isNew = ( slot.m_sequence != m_readSequence );
+        m_readSequence = slot.m_sequence;
+        return isNew;
+    }
+
+    // total number of values published so far; safe to call from anywhere
+    ouro_nodiscard inline uint64_t getPublishedSequence() const { return m_publishedSequence.load( std::memory_order_relaxed ); }
+
+    // sequence number of the value the reader last picked up; reader-side only
+    ouro_nodiscard inline uint64_t getReadSequence() const { return m_readSequence; }
+
+
+private:
+
+    static constexpr uint8_t cIndexMask = 0x3;
+    static constexpr uint8_t cFreshBit  = 0x4;      // set in m_middle when the writer has put something there the reader hasn't taken
+
+    struct alignas( 64 ) Slot
+    {
+        _Type       m_value     = {};
+        uint64_t    m_sequence  = 0;
+    };
+
+    std::array< Slot, 3 >       m_slots;
+
+    alignas( 64 )
+    std::atomic_uint8_t         m_middle            = 1;
+    std::atomic_uint64_t        m_publishedSequence = 0;
+
+    alignas( 64 )               // writer-only
+    uint8_t                     m_writeIndex        = 0;
+    uint64_t                    m_writeSequence     = 0;
+
+    alignas( 64 )               // reader-only
+    uint8_t                     m_readIndex         = 2;
+    uint64_t                    m_readSequence      = 0;
+};
+
+} // namespace base
@@ -8,6 +8,8 @@
 
 #pragma once
 
+#include "base/instrumentation.h"
+
 // ---------------------------------------------------------------------------------------------------------------------
 namespace mem {
 
@@ -15,6 +17,10 @@ namespace mem {
 template< typename _T >
 inline _T* alloc16( const size_t numElements )
 {
+#if OURO_FEATURE_RT_SENTINEL
+    base::instr::realtimeViolation( base::instr::RealtimeViolation::Allocation );
+#endif // OURO_FEATURE_RT_SENTINEL
+
     _T* mblock = reinterpret_cast<_T*>( rpmalloc( sizeof( _T ) * numElements ) );
 
     return mblock;
@@ -24,6 +30,10 @@ inline _T* alloc16( const size_t numElements )
 template< typename _T >
 inline _T* alloc16To( const size_t numElements, const _T defaultValue )
 {
+#if OURO_FEATURE_RT_SENTINEL
+    base::instr::realtimeViolation( base::instr::RealtimeViolation::Allocation );
+#endif // OURO_FEATURE_RT_SENTINEL
+
     _T* mblock = reinterpret_cast<_T*>( rpmalloc( sizeof( _T ) * numElements ) );
 
     for ( size_t kI = 0; kI < numElements; kI++ )
@@ -35,6 +45,10 @@ inline _T* alloc16To( const size_t numElements, const _T defaultValue )
 // free memory allocated with allocateAlign16
 inline void free16( void* ptr )
 {
+#if OURO_FEATURE_RT_SENTINEL
+    base::instr::realtimeViolation( base::instr::RealtimeViolation::Free );
+#endif // OURO_FEATURE_RT_SENTINEL
+
     return rpfree( ptr );
 }
 
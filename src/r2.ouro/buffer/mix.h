@@ -89,4 +89,42 @@ constexpr void interleave_float_to_int24(
     }
 }
 
+
+// ---------------------------------------------------------------------------------------------------------------------
+// crossfade towards an incoming pair of channels; io = io + ( incoming - io ) * blend_t, matching base::lerp
+//
+constexpr void crossfade_stereo(
+    const float  blend_t,
+    const int    sample_count,
+    float        io_left[],
+    float        io_right[],
+    const float  incoming_left[],
+    const float  incoming_right[]
+)
+{
+    for ( auto i = 0; i < sample_count; i++ )
+    {
+        io_left[i]  = io_left[i]  + ( incoming_left[i]  - io_left[i]  ) * blend_t;
+        io_right[i] = io_right[i] + ( incoming_right[i] - io_right[i] ) * blend_t;
+    }
+}
+
+
+// ---------------------------------------------------------------------------------------------------------------------
+// crossfade towards silence; io = io + ( 0 - io ) * blend_t, matching base::lerp
+//
+constexpr void fade_to_silence_stereo(
+    const float  blend_t,
+    const int    sample_count,
+    float        io_left[],
+    float        io_right[]
+)
+{
+    for ( auto i = 0; i < sample_count; i++ )
+    {
+        io_left[i]  = io_left[i]  + ( 0.0f - io_left[i]  ) * blend_t;
+        io_right[i] = io_right[i] + ( 0.0f - io_right[i] ) * blend_t;
+    }
+}
+
 } // namespace buffer
@@ -0,0 +1,62 @@
+//   _______ _______ ______ _______ ___ ___ _______ _______ _______ 
+//  |       |   |   |   __ \       |   |   |    ___|       |    |  |
+//  |   -   |   |   |      <   -   |   |   |    ___|   -   |       |
+//  |_______|_______|___|__|_______|\_____/|_______|_______|__|____|
+//  \\ harry denholm \\ ishani            ishani.org/shelf/ouroveon/
+//
+//  
+//
+
+#pragma once
+
+#include "config/base.h"
+
+namespace config {
+
+// optional network broadcast of the live Exchange data block, for driving visuals / lighting rigs on other machines;
+// see endlesss/toolkit.exchange.net.h for the packet format
+OURO_CONFIG( ExchangeBroadcast )
+{
+    // data routing
+    static constexpr auto StoragePath       = IPathProvider::PathFor::SharedConfig;
+    static constexpr auto StorageFilename   = "exchange.broadcast.json";
+
+    bool            enabled             = false;
+
+    // multicast group or unicast host to send to
+    std::string     address             = "239.255.79.82";
+    int32_t         port                = 17520;
+
+    // multicast only; 1 keeps packets on the local subnet
+    int32_t         multicastTTL        = 1;
+
+    // packets per second; updates arriving faster than this are coalesced
+    int32_t         sendRateHz          = 60;
+
+    // a full packet including the riff metadata is sent at least this often, even if the riff hasn't changed
+    int32_t         keyframeInterval    = 30;
+
+    template<class Archive>
+    void serialize( Archive& archive )
+    {
+        archive( CEREAL_NVP( enabled )
+               , CEREAL_OPTIONAL_NVP( address )
+               , CEREAL_OPTIONAL_NVP( port )
+               , CEREAL_OPTIONAL_NVP( multicastTTL )
+               , CEREAL_OPTIONAL_NVP( sendRateHz )
+               , CEREAL_OPTIONAL_NVP( keyframeInterval )
+        );
+    }
+
+    bool postLoad()
+    {
+        port                = std::clamp( port, 1, 65535 );
+        multicastTTL        = std::clamp( multicastTTL, 0, 255 );
+        sendRateHz          = std::clamp( sendRateHz, 1, 240 );
+        keyframeInterval    = std::clamp( keyframeInterval, 1, 1000 );
+        return true;
+    }
+};
+using ExchangeBroadcastOptional = std::optional< ExchangeBroadcast >;
+
+} // namespace config
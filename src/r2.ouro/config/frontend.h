@@ -29,6 +29,13 @@ OURO_CONFIG( Frontend )
     int32_t         appPositionY = 0;
     bool            appPositionValid = false;
 
+    // frame pacing; target frame rate for each presentation state, where 0 means "run at display refresh"
+    int32_t         frameRateForeground = 0;        // focused and animating, or recently interacted with
+    int32_t         frameRateIdle       = 20;       // focused but nothing has changed for a while
+    int32_t         frameRateBackground = 15;       // another window has focus
+    int32_t         frameRateHeadless   = 2;        // minimised or otherwise not on screen
+    float           idleAfterSeconds    = 2.0f;     // time without input or redraw requests before dropping to idle rate
+
     template<class Archive>
     void serialize( Archive& archive )
     {
@@ -37,6 +44,11 @@ OURO_CONFIG( Frontend )
                , CEREAL_OPTIONAL_NVP( appPositionX )
                , CEREAL_OPTIONAL_NVP( appPositionY )
                , CEREAL_OPTIONAL_NVP( appPositionValid )
+               , CEREAL_OPTIONAL_NVP( frameRateForeground )
+               , CEREAL_OPTIONAL_NVP( frameRateIdle )
+               , CEREAL_OPTIONAL_NVP( frameRateBackground )
+               , CEREAL_OPTIONAL_NVP( frameRateHeadless )
+               , CEREAL_OPTIONAL_NVP( idleAfterSeconds )
         );
     }
 
@@ -50,6 +62,12 @@ OURO_CONFIG( Frontend )
             appWidth  = DefaultWidth;
             appHeight = DefaultHeight;
         }
+
+        frameRateForeground = std::clamp( frameRateForeground, 0, 240 );
+        frameRateIdle       = std::clamp( frameRateIdle,       0, 240 );
+        frameRateBackground = std::clamp( frameRateBackground, 0, 240 );
+        frameRateHeadless   = std::clamp( frameRateHeadless,   0, 240 );
+        idleAfterSeconds    = std::clamp( idleAfterSeconds,    0.1f, 600.0f );
         return true;
     }
 };
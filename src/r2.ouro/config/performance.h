@@ -11,10 +11,20 @@
 
 #include "config/base.h"
 
+#include "base/metaenum.h"
 #include "base/utils.h"
 
 namespace config {
 
+// how decoded stem audio is held in memory once loaded; Float32 is the original full-fat representation, the others
+// trade a little CPU during mixing (and some precision) for being able to keep a lot more stems resident
+#define _STEM_STORAGE(_action)  \
+      _action(Float32)          \
+      _action(Int16)            \
+      _action(ADPCM)
+REFLECT_ENUM( StemStorageFormat, uint32_t, _STEM_STORAGE );
+#undef _STEM_STORAGE
+
 // various cross-system performance settings
 OURO_CONFIG( Performance )
 {
@@ -32,6 +42,22 @@ OURO_CONFIG( Performance )
     // when possible viable, keep this number of live full riff instances alive once they are fully loaded
     int32_t         liveRiffInstancePoolSize = 64;
 
+    // in-memory stem format, see StemStorageFormat above; stored as a string to keep the json legible
+    std::string     stemStorageFormat = StemStorageFormat::toString( StemStorageFormat::Float32 );
+
+    // decode stems in chunks so playback can begin as soon as the start of each one is ready (Float32 storage only)
+    bool            stemProgressiveDecode = true;
+
+    // keep the on-disk stem cache in a few large pack files rather than one file per stem; far kinder to filesystems,
+    // backups and syncing once the cache grows large. stems already cached as loose files are moved in as they are used
+    bool            stemCachePackFiles = false;
+
+    // number of upcoming riffs to warm into the stem cache ahead of playback; 0 disables prefetching
+    int32_t         riffPrefetchCount = 4;
+
+    // number of batch requests the warehouse may have in flight at once while filling in riff and stem data
+    int32_t         warehouseBackfillConcurrency = 4;
+
     // for people connecting over less reliable networks that may be lossy or take a few persistent bumps to make
     // API calls land, enabling this will ramp up the retry rates in the network layer, bump up the timeouts
     bool            enableUnstableNetworkCompensation = false;
@@ -47,13 +73,35 @@ OURO_CONFIG( Performance )
                , CEREAL_NVP( liveRiffInstancePoolSize )
                , CEREAL_OPTIONAL_NVP( enableUnstableNetworkCompensation )
                , CEREAL_OPTIONAL_NVP( enableVibesRenderer )
+               , CEREAL_OPTIONAL_NVP( riffPrefetchCount )
+               , CEREAL_OPTIONAL_NVP( stemStorageFormat )
+               , CEREAL_OPTIONAL_NVP( stemProgressiveDecode )
+               , CEREAL_OPTIONAL_NVP( stemCachePackFiles )
+               , CEREAL_OPTIONAL_NVP( warehouseBackfillConcurrency )
         );
     }
 
+    // prefetching stops once the stem cache reaches this size, leaving headroom below the auto-prune level
+    ouro_nodiscard inline std::size_t riffPrefetchMemoryBudgetBytes() const
+    {
+        return static_cast<std::size_t>( stemCacheAutoPruneAtMemoryUsageMb ) * 1024 * 1024 * 3 / 4;
+    }
+
+    ouro_nodiscard inline StemStorageFormat::Enum getStemStorageFormat() const
+    {
+        const auto format = StemStorageFormat::fromString( stemStorageFormat.c_str() );
+        if ( StemStorageFormat::isValidValue( format ) )
+            return format;
+
+        return StemStorageFormat::Float32;
+    }
+
     inline void clampLimits()
     {
         stemCacheAutoPruneAtMemoryUsageMb   = std::max( stemCacheAutoPruneAtMemoryUsageMb, stemCachePruneLevelMinimumMb );
         liveRiffInstancePoolSize            = std::max( liveRiffInstancePoolSize, 1 );
+        riffPrefetchCount                   = std::clamp( riffPrefetchCount, 0, 32 );
+        stemStorageFormat                   = StemStorageFormat::toString( getStemStorageFormat() );
     }
 
     // ensure nothing weird arriving
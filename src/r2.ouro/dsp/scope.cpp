@@ -53,9 +53,7 @@ Scope8::Scope8( const float measurementLengthSeconds, const uint32_t sampleRate,
     m_outputL       = mem::alloc16<complexf>( m_fftWindowSize );
     m_outputR       = mem::alloc16<complexf>( m_fftWindowSize );
 
-    m_outputBucketsIndex = 0;
-    m_outputBuckets[0].fill( 0.0f );
-    m_outputBuckets[1].fill( 0.0f );
+    m_outputLatest.fill( 0.0f );
 
     m_octaves.configure(
         { 3, 4, 5, 6, 7, 8, 9, 10 },
@@ -120,12 +118,8 @@ void Scope8::append( const float* samplesLeft, const float* samplesRight, uint32
             pffft_transform_ordered( m_pffftPlan, m_inputL, reinterpret_cast<float*>(m_outputL), nullptr, PFFFT_FORWARD );
             pffft_transform_ordered( m_pffftPlan, m_inputR, reinterpret_cast<float*>(m_outputR), nullptr, PFFFT_FORWARD );
 
-            // grab which of the double-buffer arrays we should write into - !the current one
-            const std::size_t currentBufferIdx = m_outputBucketsIndex.load();
-            const std::size_t writeBufferIdx = !currentBufferIdx;
-
             // reset buckets
-            Result& bucketResult = m_outputBuckets[writeBufferIdx];
+            Result bucketResult;
             bucketResult.fill( 0 );
 
             // sum magnitudes into the chosen buckets
@@ -144,8 +138,8 @@ void Scope8::append( const float* samplesLeft, const float* samplesRight, uint32
                 bucketResult[bucketIndex]  = m_config.headroomNormaliseDb( bucketResult[bucketIndex] );
             }
 
-            // flip buffers by updating the current index with the one we just wrote into
-            m_outputBucketsIndex.store( writeBufferIdx );
+            // hand the finished buckets over to whoever is reading them
+            m_outputChannel.publish( bucketResult );
 
             // reset the buffer write position ready for the next batch
             m_inputWriteIndex = 0;
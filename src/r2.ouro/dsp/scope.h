@@ -9,6 +9,8 @@
 
 #pragma once
 
+#include "base/telemetry.h"
+
 #include "dsp/fft.util.h"
 #include "dsp/octave.h"
 #include "config/spectrum.h"
@@ -42,19 +44,18 @@ struct Scope8
     // FFT block is filled
     void append( const float* samplesLeft, const float* samplesRight, uint32_t sampleCount );
 
-    // fetch a copy of the current analysis
+    // fetch a copy of the current analysis; single reader only, see base::TelemetryChannel
     inline Result getCurrentResult() const
     { 
-        const std::size_t current = m_outputBucketsIndex.load();
-        return m_outputBuckets.at(current);
+        m_outputChannel.read( m_outputLatest );
+        return m_outputLatest;
     }
 
 
 private:
 
     using FFTOctaves     = dsp::FFTOctaveBuckets< 8 >;
-    using ResultBuffers  = std::array< Result, 2 >;
-    using ResultIndex    = std::atomic< std::size_t >;
+    using ResultChannel  = base::TelemetryChannel< Result >;
     using HannGen        = cycfi::q::hann_gen;
 
 
@@ -73,9 +74,10 @@ private:
     complexf*           m_outputR           = nullptr;
 
 
-    // double-buffered outputs to help avoid other bits of the tool fetching buffers while they are being modified
-    ResultIndex         m_outputBucketsIndex;
-    ResultBuffers       m_outputBuckets;
+    // results are published from the audio thread; the reader side of the channel is mutable so that fetching the
+    // latest result can stay a const operation
+    mutable ResultChannel   m_outputChannel;
+    mutable Result          m_outputLatest;
 
     FFTOctaves          m_octaves;
 
@@ -68,6 +68,21 @@ private:
     char* m_name = nullptr;
 };
 
+// per-thread heap allocation counting, off unless the build asks for it (premake --alloc-counting); see base/instrumentation.h
+#ifndef OURO_FEATURE_ALLOC_COUNTING
+#define OURO_FEATURE_ALLOC_COUNTING 0
+#endif // OURO_FEATURE_ALLOC_COUNTING
+
+// real-time safety sentinel, off unless the build asks for it (premake --rt-sentinel); see base/instrumentation.h.
+// the hook is declared here as the logging below is one of the blocking calls it watches for
+#ifndef OURO_FEATURE_RT_SENTINEL
+#define OURO_FEATURE_RT_SENTINEL    0
+#endif // OURO_FEATURE_RT_SENTINEL
+
+#if OURO_FEATURE_RT_SENTINEL
+namespace base { namespace instr { void realtimeBlockingCall(); } }
+#endif // OURO_FEATURE_RT_SENTINEL
+
 
 // ---------------------------------------------------------------------------------------------------------------------
 
@@ -207,6 +222,10 @@ namespace detail {
             outputBuffer.push_back( '\0' );
         }
 
+#if OURO_FEATURE_RT_SENTINEL
+        base::instr::realtimeBlockingCall();
+#endif // OURO_FEATURE_RT_SENTINEL
+
         std::cout << outputBuffer.data();
     }
 }
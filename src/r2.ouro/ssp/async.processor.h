@@ -8,6 +8,10 @@
 //  to a background worker thread; samples are added via appendStereoSamples() until the active buffer is expended, 
 //  at which point the worker thread is woken up and the buffer pointers exchanged so that the audio thread is not interrupted
 //
+//  page hand-over is lock-free. if a page fills before the worker has finished with the previous one, a Realtime
+//  processor drops the full page and counts the overrun rather than block the audio callback; an Offline one (eg. riff
+//  export, where the producer can afford to wait and losing audio is not acceptable) waits for the worker to catch up
+//
 //  it is intended that an ssp inherits from this processor with a chosen interleaved buffer type and
 //  implements processBufferedSamplesFromThread() that will be called (as you can imagine) from the worker thread
 //
@@ -15,6 +19,7 @@
 #pragma once
 
 #include "buffer/buffer.iquant.h"
+#include "isamplestreamprocessor.h"
 
 #include "base/instrumentation.h"
 
@@ -25,8 +30,9 @@ template< base::IQBufferType _bufferType >
 struct AsyncBufferProcessor
 {
     // choose a maximum buffer size and give profile points / diagnostics an identifier
-    AsyncBufferProcessor( const uint32_t bufferSampleSize, const char* identifier )
+    AsyncBufferProcessor( const uint32_t bufferSampleSize, const char* identifier, const SampleFeed sampleFeed = SampleFeed::Realtime )
         : m_identifier( identifier )
+        , m_sampleFeed( sampleFeed )
     {
         m_activePage    = new _bufferType( bufferSampleSize );
         m_reservePage   = new _bufferType( bufferSampleSize );
@@ -57,68 +63,51 @@ struct AsyncBufferProcessor
 
     inline void terminateProcessorThread()
     {
-        // terminate compressor thread
+        // terminate compressor thread; it will finish off any page still pending before it exits
         if ( m_processorThread )
         {
-            {
-                std::unique_lock<std::mutex> lock( m_processorMutex );
-                m_processorThreadRun = false;
-            }
-            m_processorCVar.notify_one(); // unblock
+            m_processorThreadRun = false;
+            m_processorSignal.fetch_add( 1, std::memory_order_release );
+            m_processorSignal.notify_one(); // unblock
             m_processorThread->join();
             m_processorThread = nullptr;
+
+            const uint32_t pagesDropped = m_pagesDropped.load( std::memory_order_relaxed );
+            if ( pagesDropped > 0 )
+                blog::error::core( "[{}] processor fell behind, {} page(s) of samples were dropped", m_identifier, pagesDropped );
         }
     }
 
-    // 
+    // number of full pages discarded because the worker was still busy with the previous one; Realtime feeds only
+    ouro_nodiscard uint32_t getPagesDropped() const { return m_pagesDropped.load( std::memory_order_relaxed ); }
+
+    // copy samples into the active page, handing full pages off to the worker thread as many times as it takes
     inline void appendStereoSamples( float* buffer0, float* buffer1, const uint32_t sampleCount )
     {
         if ( m_activePage == nullptr )
             return;
 
-        size_t   readOffset         = 0;
-        uint32_t samplesRemaining   = sampleCount;
-        uint32_t pageRemaining      = ( m_activePage->m_maximumSamples - m_activePage->m_currentSamples );
-        
-        // if the remaining number of samples would overrun the buffer : 
-        // first take all the samples we can, then flip buffers and trigger the background worker thread
-        if ( samplesRemaining > pageRemaining )
+        uint32_t readOffset = 0;
+        while ( readOffset < sampleCount )
         {
+            const uint32_t pageRemaining = ( m_activePage->m_maximumSamples - m_activePage->m_currentSamples );
+            const uint32_t copyCount     = std::min( sampleCount - readOffset, pageRemaining );
+
             float* currentFpPos = &m_activePage->m_interleavedFloat[m_activePage->m_currentSamples * 2];
-            for ( size_t idxIn = 0, idxOut = 0; idxIn < pageRemaining; idxIn++, idxOut +=2 )
+            for ( size_t idxIn = 0, idxOut = 0; idxIn < copyCount; idxIn++, idxOut +=2 )
             {
-                currentFpPos[idxOut + 0] = buffer0[idxIn];
-                currentFpPos[idxOut + 1] = buffer1[idxIn];
+                currentFpPos[idxOut + 0] = buffer0[readOffset + idxIn];
+                currentFpPos[idxOut + 1] = buffer1[readOffset + idxIn];
             }
 
-            m_activePage->m_currentSamples += pageRemaining;
-
-            // offset the initial values for how many samples to read and where to read from for the remaining
-            // copy code outside of this block
-            samplesRemaining -= pageRemaining;
-            readOffset       += pageRemaining;
-
+            m_activePage->m_currentSamples += copyCount;
+            m_activePage->m_committed = false;
+            readOffset += copyCount;
 
             // buffer complete - launch processor stage on background thread and swap to other buffer to continue work
-            {
-                // #HDD remove this lock
-                std::unique_lock<std::mutex> lock( m_processorMutex );
-
-                std::swap( m_activePage, m_reservePage );
-                m_activePage->m_currentSamples = 0;
-            }
-            m_processorCVar.notify_one();
-        }
-
-        float* currentFpPos = &m_activePage->m_interleavedFloat[m_activePage->m_currentSamples * 2];
-        for ( size_t idxIn = 0, idxOut = 0; idxIn < samplesRemaining; idxIn++, idxOut +=2 )
-        {
-            currentFpPos[idxOut + 0] = buffer0[readOffset + idxIn];
-            currentFpPos[idxOut + 1] = buffer1[readOffset + idxIn];
+            if ( m_activePage->m_currentSamples == m_activePage->m_maximumSamples )
+                flipPages();
         }
-
-        m_activePage->m_currentSamples += samplesRemaining;
-        m_activePage->m_committed = false;
     }
 
 
@@ -131,6 +120,31 @@ protected:
 
 private:
 
+    inline void flipPages()
+    {
+        // the worker may still be processing the page handed over last time if samples are arriving faster than it can
+        // keep up with. that's down to the producer to sort out - offline writers wait, audio-thread feeds never block
+        if ( m_reservePending.load( std::memory_order_acquire ) )
+        {
+            if ( m_sampleFeed == SampleFeed::Realtime || !m_processorThreadRun )
+            {
+                m_pagesDropped.fetch_add( 1, std::memory_order_relaxed );
+                m_activePage->m_currentSamples = 0;
+                return;
+            }
+
+            // the worker always finishes a pending page, even when asked to stop, so this is guaranteed to wake
+            m_reservePending.wait( true, std::memory_order_acquire );
+        }
+
+        std::swap( m_activePage, m_reservePage );
+        m_activePage->m_currentSamples = 0;
+
+        m_reservePending.store( true, std::memory_order_release );
+        m_processorSignal.fetch_add( 1, std::memory_order_release );
+        m_processorSignal.notify_one();
+    }
+
     inline void processorThreadWorker()
     {
         const auto threadName = fmt::format( "{}{}:Processor", OURO_THREAD_PREFIX, m_identifier );
@@ -138,24 +152,35 @@ private:
 
         blog::core( "[{}] processor thread launched", m_identifier );
 
-        ABSL_ASSERT( m_reservePage != nullptr );
         for ( ;; )
         {
-            std::unique_lock<std::mutex> lock( m_processorMutex );
-            m_processorCVar.wait( lock );
-
-            if ( !m_processorThreadRun )
-                break;
+            // sample the signal before checking for work; a page handed over after this point bumps it, so the
+            // wait below can't miss it
+            const uint32_t signalSeen = m_processorSignal.load( std::memory_order_acquire );
 
+            // a pending page is always processed before a stop request is honoured, so nothing appended gets dropped
+            if ( m_reservePending.load( std::memory_order_acquire ) )
             {
-                base::instr::ScopedEvent se( m_identifier.c_str(), "process-samples", base::instr::PresetColour::Orange );
-
-                m_reservePage->quantise();
-                processBufferedSamplesFromThread( *m_reservePage );
-                m_reservePage->m_committed = true;
+                // the reserve page is ours until m_reservePending is cleared; don't touch it otherwise, the producer
+                // owns both page pointers in between hand-overs
+                ABSL_ASSERT( m_reservePage != nullptr );
+                {
+                    base::instr::ScopedEvent se( m_identifier.c_str(), "process-samples", base::instr::PresetColour::Orange );
+
+                    m_reservePage->quantise();
+                    processBufferedSamplesFromThread( *m_reservePage );
+                    m_reservePage->m_committed = true;
+                }
+
+                m_reservePending.store( false, std::memory_order_release );
+                m_reservePending.notify_one();
+                continue;
             }
 
-            lock.unlock();
+            if ( !m_processorThreadRun )
+                break;
+
+            m_processorSignal.wait( signalSeen, std::memory_order_acquire );
         }
     }
 
@@ -163,11 +188,13 @@ private:
     std::unique_ptr< std::thread >  m_processorThread;
     std::atomic_bool                m_processorThreadRun    = false;
 
-    // inter-thread communication to signal compression jobs ready
-    std::mutex                      m_processorMutex;
-    std::condition_variable         m_processorCVar;
+    // inter-thread communication to signal compression jobs ready; atomics only, page flips happen on the audio thread
+    std::atomic_uint32_t            m_processorSignal       = 0;        // bumped on every hand-over (and on stop), worker waits on it
+    std::atomic_bool                m_reservePending        = false;    // reserve page is full and waiting on the worker
+    std::atomic_uint32_t            m_pagesDropped          = 0;
 
     std::string                     m_identifier;
+    SampleFeed                      m_sampleFeed            = SampleFeed::Realtime;
 
     _bufferType*                    m_activePage            = nullptr;
     _bufferType*                    m_reservePage           = nullptr;
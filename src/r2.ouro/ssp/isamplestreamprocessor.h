@@ -17,6 +17,14 @@ namespace ssp {
 struct _stream_processor_id {};
 using StreamProcessorInstanceID = base::id::Simple<_stream_processor_id, uint32_t, 1, 0>;
 
+// where a processor's samples come from; anything fed from the audio callback must never block in appendSamples(),
+// whereas offline producers (eg. riff export) would rather wait for a processor to catch up than lose audio
+enum class SampleFeed
+{
+    Realtime,
+    Offline
+};
+
 // ---------------------------------------------------------------------------------------------------------------------
 struct ISampleStreamProcessor
 {
@@ -39,9 +39,9 @@ struct FLACWriter::StreamInstance final : public FLAC::Encoder::File,
         m_flacFileBytesWritten = bytes_written;
     }
 
-    StreamInstance( const uint32_t bufferSizeInSamples )
+    StreamInstance( const uint32_t bufferSizeInSamples, const SampleFeed sampleFeed )
         : FLAC::Encoder::File()
-        , AsyncBufferProcessorIQ24( bufferSizeInSamples, "FLAC" )
+        , AsyncBufferProcessorIQ24( bufferSizeInSamples, "FLAC", sampleFeed )
     {
         launchProcessorThread();
     }
@@ -98,7 +98,7 @@ struct FLACWriter::StreamInstance final : public FLAC::Encoder::File,
         }
     }
 
-    // called from audio thread
+    // called from audio thread, or from an export worker for Offline writers
     void appendStereo( float* buffer0, float* buffer1, const uint32_t sampleCount )
     {
         appendStereoSamples( buffer0, buffer1, sampleCount );
@@ -115,7 +115,8 @@ struct FLACWriter::StreamInstance final : public FLAC::Encoder::File,
 std::shared_ptr<FLACWriter> FLACWriter::Create(
     const fs::path&     outputFile,
     const uint32_t      sampleRate,
-    const float         writeBufferInSeconds )
+    const float         writeBufferInSeconds,
+    const SampleFeed    sampleFeed )
 {
     // produce a 8 and 16-bit encoded version of the filename, supporting utf8 characters in the input
     const std::u16string outputFileU16 = outputFile.u16string();
@@ -123,7 +124,7 @@ std::shared_ptr<FLACWriter> FLACWriter::Create(
 
     const uint32_t writeBufferInSamples = (uint32_t)std::ceil( (float)sampleRate * std::max( 0.25f, writeBufferInSeconds ) );
 
-    std::unique_ptr< FLACWriter::StreamInstance > newState = std::make_unique< FLACWriter::StreamInstance >( writeBufferInSamples );
+    std::unique_ptr< FLACWriter::StreamInstance > newState = std::make_unique< FLACWriter::StreamInstance >( writeBufferInSamples, sampleFeed );
 
     bool flacConfig = true;
     flacConfig &= newState->set_verify( true );
@@ -25,7 +25,8 @@ public:
     static std::shared_ptr<FLACWriter> Create(
         const fs::path&     outputFile,
         const uint32_t      sampleRate,
-        const float         writeBufferInSeconds );
+        const float         writeBufferInSeconds,
+        const SampleFeed    sampleFeed = SampleFeed::Realtime );    // Offline writers wait for the encoder rather than drop audio
 
     void appendSamples( float* buffer0, float* buffer1, const uint32_t sampleCount ) override;
     uint64_t getStorageUsageInBytes() const override;
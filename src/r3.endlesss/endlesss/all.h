@@ -10,6 +10,8 @@
 #include "endlesss/api.h"
 #include "endlesss/cache.jams.h"
 #include "endlesss/cache.stems.h"
+#include "endlesss/cache.stems.maintenance.h"
+#include "endlesss/cache.stems.pack.h"
 #include "endlesss/config.h"
 #include "endlesss/core.constants.h"
 #include "endlesss/core.services.h"
@@ -19,9 +21,12 @@
 #include "endlesss/live.riff.cache.h"
 #include "endlesss/live.stem.h"
 #include "endlesss/toolkit.exchange.h"
+#include "endlesss/toolkit.exchange.ipc.h"
+#include "endlesss/toolkit.exchange.net.h"
 #include "endlesss/toolkit.jam.sentinel.h"
 #include "endlesss/toolkit.population.h"
 #include "endlesss/toolkit.riff.export.h"
 #include "endlesss/toolkit.riff.pipeline.h"
+#include "endlesss/toolkit.riff.prefetch.h"
 #include "endlesss/toolkit.shares.h"
 #include "endlesss/toolkit.warehouse.h"
@@ -143,6 +143,19 @@ public:
         }
     }
 
+    // how many requests a bulk operation should keep in flight at once; on an unstable connection we
+    // halve it so we don't end up with a pile of parallel timeouts
+    ouro_nodiscard constexpr int32_t getConcurrentRequestLimit() const
+    {
+        const int32_t limit = std::clamp( m_api.networkConcurrentRequestLimit, 1, 32 );
+        switch ( m_quality )
+        {
+        default:
+        case NetworkQuality::Stable:    return limit;
+        case NetworkQuality::Unstable:  return std::max( 1, limit / 2 );
+        }
+    }
+
     // spin an RNG to produce a new LB=live## cookie value
     ouro_nodiscard std::string generateRandomLoadBalancerCookie() const;
 
@@ -9,6 +9,7 @@
 
 #include "pch.h"
 
+#include "base/hashing.h"
 #include "base/text.transform.h"
 
 #include "spacetime/chronicle.h"
@@ -22,15 +23,134 @@
 #include "endlesss/cache.jams.h"
 #include "endlesss/config.h"
 
+#include "xp/mapped.file.h"
+
 using namespace std::chrono_literals;
 
 
 namespace endlesss {
 namespace cache {
 
+namespace {
+namespace binary {
+
+// ---------------------------------------------------------------------------------------------------------------------
+// cache.jams.bin layout; a single header, then for each jam type a block of fixed-size records followed by the three
+// sort orders as u32 index arrays, then one pool holding every string. offsets are all from the start of the file and
+// the payload hash covers everything after the header. records are 8-byte aligned, so on load they can be read
+// straight out of the mapping
+//
+static constexpr uint32_t Magic         = 0x434D4A4F;   // 'OJMC'
+static constexpr uint32_t FormatVersion = 1;
+
+struct StringRef
+{
+    uint32_t    m_offset    = 0;        // relative to the string pool
+    uint32_t    m_length    = 0;
+};
+
+struct Record
+{
+    StringRef   m_jamCID;
+    StringRef   m_displayName;
+    StringRef   m_description;
+    StringRef   m_timestampOrderingDescription;
+    int64_t     m_timestampOrdering     = -1;
+    int64_t     m_timestampEarliestStem = -1;
+    int64_t     m_timestampLatestStem   = -1;
+    int32_t     m_riffCount             = -1;
+    uint32_t    m_reserved              = 0;
+};
+static_assert( sizeof( Record ) == 64 );
+
+struct Section
+{
+    uint32_t    m_recordCount       = 0;
+    uint32_t    m_reserved          = 0;
+    uint64_t    m_recordsOffset     = 0;
+    uint64_t    m_sortOffsets[3]    = { 0, 0, 0 };  // by time, by name, by riffs
+};
+static_assert( sizeof( Section ) == 40 );
+
+struct Header
+{
+    uint32_t                    m_magic                 = Magic;
+    uint32_t                    m_formatVersion         = FormatVersion;
+    uint32_t                    m_jamSerialisedVersion  = 0;
+    uint32_t                    m_reserved              = 0;
+    uint64_t                    m_fileSize              = 0;
+    uint64_t                    m_payloadHash           = 0;
+    Jams::SourceFileStamps      m_sources;
+    Section                     m_sections[Jams::cJamTypeCount];
+    uint64_t                    m_stringPoolOffset      = 0;
+    uint64_t                    m_stringPoolSize        = 0;
+};
+static_assert( sizeof( Header ) == 256 );
+
+// ---------------------------------------------------------------------------------------------------------------------
+inline std::size_t alignTo8( const std::size_t value )
+{
+    return ( value + 7 ) & ~std::size_t( 7 );
+}
+
+} // namespace binary
+} // anonymous namespace
+
+
+// ---------------------------------------------------------------------------------------------------------------------
+Jams::SourceFileStamp Jams::SourceFileStamp::fromFile( const fs::path& filePath )
+{
+    SourceFileStamp result;
+
+    std::error_code fileError;
+    const auto fileSize = fs::file_size( filePath, fileError );
+    if ( fileError )
+        return result;
+
+    const auto fileTime = fs::last_write_time( filePath, fileError );
+    if ( fileError )
+        return result;
+
+    result.m_size       = (int64_t)fileSize;
+    result.m_writeTime  = (int64_t)fileTime.time_since_epoch().count();
+    return result;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+Jams::SourceFileStamps Jams::gatherSourceStamps( const config::IPathProvider& pathProvider )
+{
+    fs::path jamLibraryCacheFile = pathProvider.getPath( config::IPathProvider::PathFor::SharedConfig );
+    jamLibraryCacheFile.append( cFilename );
+
+    return {
+        SourceFileStamp::fromFile( config::getFullPath< config::endlesss::PublicJamManifest >( pathProvider ) ),
+        SourceFileStamp::fromFile( config::getFullPath< config::endlesss::CollectibleJamManifest >( pathProvider ) ),
+        SourceFileStamp::fromFile( jamLibraryCacheFile )
+    };
+}
+
 // ---------------------------------------------------------------------------------------------------------------------
 bool Jams::load( const config::IPathProvider& pathProvider )
 {
+    // dynamic jam cache is shared between apps
+    const fs::path sharedConfigPath = pathProvider.getPath( config::IPathProvider::PathFor::SharedConfig );
+
+    const fs::path jamLibraryCacheFile  = fs::path( sharedConfigPath ).append( cFilename );
+    const fs::path jamLibraryBinaryFile = fs::path( sharedConfigPath ).append( cBinaryFilename );
+
+    // first choice is the binary cache, which already holds every jam type (including the public archive) with their
+    // sort orders built; it is only used if none of the files it was built from have changed since
+    if ( fs::exists( jamLibraryBinaryFile ) )
+    {
+        spacetime::ScopedTimer perfTimer( "load binary jam cache" );
+
+        if ( loadBinary( jamLibraryBinaryFile, gatherSourceStamps( pathProvider ) ) )
+        {
+            updateCacheFileState( jamLibraryBinaryFile );
+            return true;
+        }
+    }
+
     // load the fixed public jam snapshot, assuming it shipped with the build correctly
     const auto publicsLoadResult = config::load( pathProvider, m_configEndlesssPublics );
     if ( publicsLoadResult != config::LoadResult::Success )
@@ -40,6 +160,7 @@ bool Jams::load( const config::IPathProvider& pathProvider )
             config::getFullPath< config::endlesss::PublicJamManifest >( pathProvider ).string() );
     }
     blog::core( "loaded {} public jams from snapshot manifest", m_configEndlesssPublics.jams.size() );
+    m_publicsManifestLoaded = true;
 
     // try and load the cached collectibles data
     m_configEndlesssCollectibles.jams.clear();
@@ -65,87 +186,556 @@ bool Jams::load( const config::IPathProvider& pathProvider )
         }
     }
     blog::core( FMTX("loaded {} collectible jams from snapshot manifest"), m_configEndlesssCollectibles.jams.size());
+    m_collectiblesManifestLoaded = true;
 
 
-    // dynamic jam cache is shared between apps
-    fs::path jamLibraryCacheFile = pathProvider.getPath( config::IPathProvider::PathFor::SharedConfig );
-    jamLibraryCacheFile.append( cFilename );
-
     if ( fs::exists( jamLibraryCacheFile ) )
     {
         blog::cache( FMTX("loading dynamic jam cache [{}]"), jamLibraryCacheFile.string() );
-        try
+        if ( loadJson( jamLibraryCacheFile ) )
         {
-            std::ifstream is( jamLibraryCacheFile );
-            cereal::JSONInputArchive archive( is );
+            updateCacheFileState( jamLibraryCacheFile );
 
-            serialize( archive );
+            postProcessNewData();
 
-            // snag the last write time of the cache file
-            {
-                const auto filetime       = std::filesystem::last_write_time( jamLibraryCacheFile );
+            // write out the binary version so the next boot can skip all of the above
+            saveBinary( jamLibraryBinaryFile, gatherSourceStamps( pathProvider ) );
+            return true;
+        }
+    }
+
+    m_cacheFileState = "Not found";
+    return false;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+bool Jams::save( const config::IPathProvider& pathProvider )
+{
+    // if we booted from the binary cache and haven't since re-fetched collectibles, the manifest on disk is
+    // still the one the cache was built from; leave it be
+    if ( m_collectiblesManifestLoaded )
+    {
+        const auto collectibleSaveResult = config::save( pathProvider, m_configEndlesssCollectibles );
+        if ( collectibleSaveResult != config::SaveResult::Success )
+        {
+            blog::error::cache( "unable to save collectibles manifest" );
+        }
+    }
+
+    const fs::path sharedConfigPath = pathProvider.getPath( config::IPathProvider::PathFor::SharedConfig );
+
+    const fs::path jamLibraryCacheFile  = fs::path( sharedConfigPath ).append( cFilename );
+    const fs::path jamLibraryBinaryFile = fs::path( sharedConfigPath ).append( cBinaryFilename );
+
+    blog::cache( "... saving jam library cache to '{}'", jamLibraryCacheFile.string() );
+
+    // JSON goes first, the binary cache records its timestamp
+    if ( !saveJson( jamLibraryCacheFile ) )
+        return false;
+
+    if ( !saveBinary( jamLibraryBinaryFile, gatherSourceStamps( pathProvider ) ) )
+    {
+        // not fatal, we'll just be importing from JSON on the next boot
+        blog::error::cache( "unable to write binary jam cache [{}]", jamLibraryBinaryFile.string() );
+    }
+
+    m_cacheFileState = fmt::format( "Synchronised" );
+    return true;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void Jams::updateCacheFileState( const fs::path& cacheFile )
+{
+    // snag the last write time of the cache file
+    std::error_code fileError;
+    const auto filetime       = std::filesystem::last_write_time( cacheFile, fileError );
+    if ( fileError )
+        return;
 #if OURO_PLATFORM_WIN
-                const auto systemTime     = std::chrono::utc_clock::to_sys( std::chrono::file_clock::to_utc( filetime ) );
+    const auto systemTime     = std::chrono::utc_clock::to_sys( std::chrono::file_clock::to_utc( filetime ) );
 #else
-                const auto systemTime     = std::chrono::file_clock::to_sys( filetime );
+    const auto systemTime     = std::chrono::file_clock::to_sys( filetime );
 #endif
-                const auto timePointSec   = std::chrono::time_point_cast<std::chrono::seconds>(systemTime);
+    const auto timePointSec   = std::chrono::time_point_cast<std::chrono::seconds>(systemTime);
+
+    const auto cacheTimeDelta = spacetime::calculateDeltaFromNow( timePointSec ).asPastTenseString(2);
 
-                const auto cacheTimeDelta = spacetime::calculateDeltaFromNow( timePointSec ).asPastTenseString(2);
+    m_cacheFileState = fmt::format( "Updated {}", cacheTimeDelta );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+bool Jams::loadJson( const fs::path& cacheFile )
+{
+    try
+    {
+        std::ifstream is( cacheFile );
+        cereal::JSONInputArchive archive( is );
 
-                m_cacheFileState = fmt::format( "Updated {}", cacheTimeDelta );
+        serialize( archive );
+        return true;
+    }
+    catch ( cereal::Exception& cEx )
+    {
+        blog::error::cache( "{}", cacheFile.string() );
+        blog::error::cache( "cache load failure | {}", cEx.what() );
+    }
+    return false;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+bool Jams::saveJson( const fs::path& cacheFile ) const
+{
+    try
+    {
+        std::ofstream is( cacheFile );
+        cereal::JSONOutputArchive archive( is );
+
+        serialize( archive );
+        return true;
+    }
+    catch ( cereal::Exception& cEx )
+    {
+        blog::error::cache( "{}", cacheFile.string() );
+        blog::error::cache( "cache save failure | {}", cEx.what() );
+    }
+    return false;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+bool Jams::loadBinary( const fs::path& cacheFile, const SourceFileStamps& sources )
+{
+    xp::MappedFile mappedCache;
+    if ( !mappedCache.open( cacheFile ) )
+        return false;
+
+    const uint8_t*    fileBytes = mappedCache.data();
+    const std::size_t fileSize  = mappedCache.size();
+
+    if ( fileSize < sizeof( binary::Header ) )
+    {
+        blog::cache( FMTX( "discarding binary jam cache, truncated" ) );
+        return false;
+    }
+
+    binary::Header header;
+    std::memcpy( &header, fileBytes, sizeof( binary::Header ) );
+
+    if ( header.m_magic != binary::Magic || header.m_formatVersion != binary::FormatVersion )
+    {
+        blog::cache( FMTX( "discarding binary jam cache, format v{} vs v{}" ), header.m_formatVersion, binary::FormatVersion );
+        return false;
+    }
+    if ( header.m_fileSize != fileSize )
+    {
+        blog::cache( FMTX( "discarding binary jam cache, size mismatch" ) );
+        return false;
+    }
+    if ( header.m_sources != sources )
+    {
+        blog::cache( FMTX( "binary jam cache is out of date with its source files" ) );
+        return false;
+    }
+    if ( base::hashBytes64( fileBytes + sizeof( binary::Header ), fileSize - sizeof( binary::Header ) ) != header.m_payloadHash )
+    {
+        blog::error::cache( FMTX( "discarding binary jam cache, payload hash mismatch" ) );
+        return false;
+    }
+
+    // check every offset lands inside the file before we touch anything
+    const auto rangeIsValid = [fileSize]( const uint64_t offset, const uint64_t bytes, const uint64_t alignment ) -> bool
+    {
+        return ( offset % alignment ) == 0 &&
+               offset >= sizeof( binary::Header ) &&
+               offset <= fileSize &&
+               bytes  <= fileSize - offset;
+    };
+
+    if ( !rangeIsValid( header.m_stringPoolOffset, header.m_stringPoolSize, 1 ) )
+        return false;
+
+    const char* stringPool = reinterpret_cast<const char*>( fileBytes + header.m_stringPoolOffset );
+    const auto  unpackString = [&]( const binary::StringRef& ref, std::string& result ) -> bool
+    {
+        if ( (uint64_t)ref.m_offset + ref.m_length > header.m_stringPoolSize )
+            return false;
+        result.assign( stringPool + ref.m_offset, ref.m_length );
+        return true;
+    };
+
+    std::array< std::vector< Data >, cJamTypeCount > loadedData;
+    std::array< JamIndicesPerType, 3 >              loadedIndices;
+
+    for ( const auto jamType : cEachJamType )
+    {
+        const std::size_t        jamTypeIndex = (std::size_t)jamType;
+        const binary::Section&   section      = header.m_sections[jamTypeIndex];
+        const uint64_t           recordCount  = section.m_recordCount;
+
+        if ( !rangeIsValid( section.m_recordsOffset, recordCount * sizeof( binary::Record ), alignof( binary::Record ) ) )
+            return false;
+
+        const auto* records = reinterpret_cast<const binary::Record*>( fileBytes + section.m_recordsOffset );
+
+        auto& dataArray = loadedData[jamTypeIndex];
+        dataArray.resize( recordCount );
+
+        for ( std::size_t idx = 0; idx < recordCount; idx++ )
+        {
+            const binary::Record& record = records[idx];
+            Data& data = dataArray[idx];
+
+            if ( !unpackString( record.m_jamCID, data.m_jamCID.value() ) ||
+                 !unpackString( record.m_displayName, data.m_displayName ) ||
+                 !unpackString( record.m_description, data.m_description ) ||
+                 !unpackString( record.m_timestampOrderingDescription, data.m_timestampOrderingDescription ) )
+            {
+                blog::error::cache( FMTX( "discarding binary jam cache, bad string reference" ) );
+                return false;
             }
 
-            postProcessNewData();
-            return true;
+            data.m_riffCount                = record.m_riffCount;
+            data.m_timestampOrdering        = record.m_timestampOrdering;
+            data.m_timestampEarliestStem    = record.m_timestampEarliestStem;
+            data.m_timestampLatestStem      = record.m_timestampLatestStem;
         }
-        catch ( cereal::Exception& cEx )
+
+        for ( std::size_t sortIndex = 0; sortIndex < 3; sortIndex++ )
         {
-            blog::error::cache( "{}", jamLibraryCacheFile.string() );
-            blog::error::cache( "cache load failure | {}", cEx.what() );
+            const uint64_t sortOffset = section.m_sortOffsets[sortIndex];
+            if ( !rangeIsValid( sortOffset, recordCount * sizeof( uint32_t ), alignof( uint32_t ) ) )
+                return false;
+
+            const auto* sortOrder = reinterpret_cast<const uint32_t*>( fileBytes + sortOffset );
+
+            auto& indices = loadedIndices[sortIndex][jamTypeIndex];
+            indices.resize( recordCount );
+            for ( std::size_t idx = 0; idx < recordCount; idx++ )
+            {
+                if ( sortOrder[idx] >= recordCount )
+                {
+                    blog::error::cache( FMTX( "discarding binary jam cache, bad sort index" ) );
+                    return false;
+                }
+                indices[idx] = sortOrder[idx];
+            }
         }
     }
 
-    m_cacheFileState = "Not found";
-    return false;
+    // everything checked out, swap it all in
+    {
+        std::scoped_lock<std::mutex> lockProc( m_dataProcessMutex );
+
+        m_jamSerialisedVersion  = header.m_jamSerialisedVersion;
+
+        m_jamDataPublicArchive  = std::move( loadedData[(std::size_t)JamType::PublicArchive] );
+        m_jamDataJoinIn         = std::move( loadedData[(std::size_t)JamType::PublicJoinIn] );
+        m_jamDataUserSubscribed = std::move( loadedData[(std::size_t)JamType::UserSubscribed] );
+        m_jamDataCollectibles   = std::move( loadedData[(std::size_t)JamType::Collectible] );
+
+        m_idxSortedByTime       = std::move( loadedIndices[0] );
+        m_idxSortedByName       = std::move( loadedIndices[1] );
+        m_idxSortedByRiffs      = std::move( loadedIndices[2] );
+
+        m_jamCouchIDToJamIndexMap.clear();
+        for ( const auto jamType : cEachJamType )
+        {
+            const std::vector< Data >* dataArray = getArrayPtrForType( jamType );
+            for ( size_t idx = 0; idx < dataArray->size(); idx++ )
+                m_jamCouchIDToJamIndexMap.try_emplace( dataArray->at( idx ).m_jamCID, CacheIndex( jamType, idx ) );
+        }
+    }
+
+    blog::cache( FMTX( "loaded binary jam cache, {} public / {} join-in / {} subscribed / {} collectible" ),
+        m_jamDataPublicArchive.size(),
+        m_jamDataJoinIn.size(),
+        m_jamDataUserSubscribed.size(),
+        m_jamDataCollectibles.size() );
+
+    return true;
 }
 
 // ---------------------------------------------------------------------------------------------------------------------
-bool Jams::save( const config::IPathProvider& pathProvider )
+bool Jams::saveBinary( const fs::path& cacheFile, const SourceFileStamps& sources ) const
 {
-    const auto collectibleSaveResult = config::save( pathProvider, m_configEndlesssCollectibles );
-    if ( collectibleSaveResult != config::SaveResult::Success )
+    std::scoped_lock<std::mutex> lockProc( m_dataProcessMutex );
+
+    binary::Header header;
+    header.m_jamSerialisedVersion   = m_jamSerialisedVersion;
+    header.m_sources                = sources;
+
+    // lay out the sections and count how big the string pool needs to be
+    std::size_t writeOffset     = sizeof( binary::Header );
+    std::size_t stringPoolSize  = 0;
+    for ( const auto jamType : cEachJamType )
     {
-        blog::error::cache( "unable to save collectibles manifest" );
+        const std::vector< Data >* dataArray = getArrayPtrForType( jamType );
+        binary::Section& section = header.m_sections[(std::size_t)jamType];
+
+        section.m_recordCount   = (uint32_t)dataArray->size();
+        section.m_recordsOffset = writeOffset;
+        writeOffset += dataArray->size() * sizeof( binary::Record );
+
+        for ( auto& sortOffset : section.m_sortOffsets )
+        {
+            sortOffset   = writeOffset;
+            writeOffset  = binary::alignTo8( writeOffset + dataArray->size() * sizeof( uint32_t ) );
+        }
+
+        for ( const Data& data : *dataArray )
+        {
+            stringPoolSize += data.m_jamCID.size() +
+                              data.m_displayName.size() +
+                              data.m_description.size() +
+                              data.m_timestampOrderingDescription.size();
+        }
     }
+    if ( stringPoolSize > std::numeric_limits<uint32_t>::max() )
+        return false;
 
+    header.m_stringPoolOffset   = writeOffset;
+    header.m_stringPoolSize     = stringPoolSize;
+    header.m_fileSize           = writeOffset + stringPoolSize;
 
-    fs::path jamLibraryCacheFile = pathProvider.getPath( config::IPathProvider::PathFor::SharedConfig );
-    jamLibraryCacheFile.append( cFilename );
+    std::vector< uint8_t > fileImage( header.m_fileSize, 0 );
 
-    try
+    char*    stringPool      = reinterpret_cast<char*>( fileImage.data() + header.m_stringPoolOffset );
+    uint32_t stringPoolUsed  = 0;
+    const auto packString = [&]( std::string_view value ) -> binary::StringRef
     {
-        std::ofstream is( jamLibraryCacheFile );
-        cereal::JSONOutputArchive archive( is );
+        binary::StringRef ref{ stringPoolUsed, (uint32_t)value.size() };
+        std::memcpy( stringPool + stringPoolUsed, value.data(), value.size() );
+        stringPoolUsed += (uint32_t)value.size();
+        return ref;
+    };
 
-        blog::cache( "... saving jam library cache to '{}'", jamLibraryCacheFile.string() );
+    for ( const auto jamType : cEachJamType )
+    {
+        const std::size_t          jamTypeIndex = (std::size_t)jamType;
+        const std::vector< Data >* dataArray    = getArrayPtrForType( jamType );
+        const binary::Section&     section      = header.m_sections[jamTypeIndex];
 
-        serialize( archive );
+        auto* records = reinterpret_cast<binary::Record*>( fileImage.data() + section.m_recordsOffset );
+        for ( std::size_t idx = 0; idx < dataArray->size(); idx++ )
+        {
+            const Data& data = dataArray->at( idx );
+            binary::Record& record = records[idx];
+
+            record.m_jamCID                         = packString( data.m_jamCID.value() );
+            record.m_displayName                    = packString( data.m_displayName );
+            record.m_description                    = packString( data.m_description );
+            record.m_timestampOrderingDescription   = packString( data.m_timestampOrderingDescription );
+            record.m_timestampOrdering              = data.m_timestampOrdering;
+            record.m_timestampEarliestStem          = data.m_timestampEarliestStem;
+            record.m_timestampLatestStem            = data.m_timestampLatestStem;
+            record.m_riffCount                      = data.m_riffCount;
+        }
 
+        const std::array< const std::vector< size_t >*, 3 > sortOrders = {
+            &m_idxSortedByTime[jamTypeIndex],
+            &m_idxSortedByName[jamTypeIndex],
+            &m_idxSortedByRiffs[jamTypeIndex]
+        };
+        for ( std::size_t sortIndex = 0; sortIndex < 3; sortIndex++ )
         {
-            m_cacheFileState = fmt::format( "Synchronised" );
+            // sort orders should always cover the whole array; if not, postProcessNewData() hasn't been run
+            if ( sortOrders[sortIndex]->size() != dataArray->size() )
+                return false;
+
+            auto* sortOrder = reinterpret_cast<uint32_t*>( fileImage.data() + section.m_sortOffsets[sortIndex] );
+            for ( std::size_t idx = 0; idx < dataArray->size(); idx++ )
+                sortOrder[idx] = (uint32_t)sortOrders[sortIndex]->at( idx );
         }
+    }
 
-        return true;
+    header.m_payloadHash = base::hashBytes64( fileImage.data() + sizeof( binary::Header ), fileImage.size() - sizeof( binary::Header ) );
+    std::memcpy( fileImage.data(), &header, sizeof( binary::Header ) );
+
+    // write to a temporary and then swap it in so that another app booting never sees a partial file
+    fs::path writeFile = cacheFile;
+    writeFile += ".tmp";
+    {
+        std::basic_ofstream<char> ofs( writeFile, std::ios::out | std::ios::binary | std::ios::trunc );
+        ofs.write( reinterpret_cast<const char*>( fileImage.data() ), (std::streamsize)fileImage.size() );
+
+        if ( !ofs )
+            return false;
     }
-    catch ( cereal::Exception& cEx )
+
+    std::error_code fileError;
+    fs::rename( writeFile, cacheFile, fileError );
+
+    return !fileError;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+Jams::CacheFormatBenchmark Jams::benchmarkCacheFormats( const fs::path& scratchPath, const std::size_t jamCount )
+{
+    CacheFormatBenchmark result;
+    result.m_jamCount = jamCount;
+
+    const fs::path jsonFile   = fs::path( scratchPath ).append( "benchmark.cache.jams.json" );
+    const fs::path binaryFile = fs::path( scratchPath ).append( "benchmark.cache.jams.bin" );
+
+    // fill out a cache with randomised subscribed jams; fixed seed so runs are comparable
     {
-        blog::error::cache( "{}", jamLibraryCacheFile.string() );
-        blog::error::cache( "cache save failure | {}", cEx.what() );
+        Jams source;
+
+        std::mt19937 rng( 0x0ABCDEF );
+        std::uniform_int_distribution< int32_t > riffCountDist( 0, 250000 );
+        std::uniform_int_distribution< int64_t > timestampDist( 1577836800, 1704067200 );
+
+        static constexpr std::array< std::string_view, 8 > nameWords = { "deep", "lunar", "static", "velvet", "broken", "signal", "garden", "orbit" };
+
+        source.m_jamDataUserSubscribed.reserve( jamCount );
+        for ( std::size_t idx = 0; idx < jamCount; idx++ )
+        {
+            auto& jam = source.m_jamDataUserSubscribed.emplace_back(
+                fmt::format( FMTX( "band{:010x}" ), rng() ),
+                fmt::format( FMTX( "{} {} {}" ), nameWords[rng() % nameWords.size()], nameWords[rng() % nameWords.size()], idx ),
+                fmt::format( FMTX( "synthetic jam #{}" ), idx ),
+                timestampDist( rng ) );
+            jam.m_riffCount = riffCountDist( rng );
+        }
+        source.postProcessNewData();
+
+        source.saveJson( jsonFile );
+        source.saveBinary( binaryFile, {} );
     }
-    return false;
+
+    std::error_code fileError;
+    result.m_jsonBytes   = (std::size_t)fs::file_size( jsonFile, fileError );
+    result.m_binaryBytes = (std::size_t)fs::file_size( binaryFile, fileError );
+
+    Jams viaJson;
+    {
+        spacetime::Moment loadTimer;
+        viaJson.loadJson( jsonFile );
+        viaJson.postProcessNewData();
+        result.m_jsonLoadMs = (double)loadTimer.delta< std::chrono::microseconds >().count() / 1000.0;
+    }
+    Jams viaBinary;
+    {
+        spacetime::Moment loadTimer;
+        const bool binaryLoaded = viaBinary.loadBinary( binaryFile, {} );
+        result.m_binaryLoadMs = (double)loadTimer.delta< std::chrono::microseconds >().count() / 1000.0;
+
+        result.m_resultsMatch = binaryLoaded;
+    }
+
+    // both paths should produce identical data and identical sort orders
+    for ( const auto jamType : cEachJamType )
+    {
+        const std::size_t jamTypeIndex = (std::size_t)jamType;
+
+        const std::vector< Data >* jsonData   = viaJson.getArrayPtrForType( jamType );
+        const std::vector< Data >* binaryData = viaBinary.getArrayPtrForType( jamType );
+
+        result.m_resultsMatch &= ( jsonData->size() == binaryData->size() );
+        result.m_resultsMatch &= ( viaJson.m_idxSortedByTime[jamTypeIndex]  == viaBinary.m_idxSortedByTime[jamTypeIndex] );
+        result.m_resultsMatch &= ( viaJson.m_idxSortedByName[jamTypeIndex]  == viaBinary.m_idxSortedByName[jamTypeIndex] );
+        result.m_resultsMatch &= ( viaJson.m_idxSortedByRiffs[jamTypeIndex] == viaBinary.m_idxSortedByRiffs[jamTypeIndex] );
+
+        for ( std::size_t idx = 0; result.m_resultsMatch && idx < jsonData->size(); idx++ )
+        {
+            const Data& lhs = jsonData->at( idx );
+            const Data& rhs = binaryData->at( idx );
+
+            result.m_resultsMatch &= ( lhs.m_jamCID                         == rhs.m_jamCID &&
+                                       lhs.m_displayName                    == rhs.m_displayName &&
+                                       lhs.m_description                    == rhs.m_description &&
+                                       lhs.m_riffCount                      == rhs.m_riffCount &&
+                                       lhs.m_timestampOrdering              == rhs.m_timestampOrdering &&
+                                       lhs.m_timestampEarliestStem          == rhs.m_timestampEarliestStem &&
+                                       lhs.m_timestampLatestStem            == rhs.m_timestampLatestStem &&
+                                       lhs.m_timestampOrderingDescription   == rhs.m_timestampOrderingDescription );
+        }
+    }
+
+    fs::remove( jsonFile, fileError );
+    fs::remove( binaryFile, fileError );
+
+    return result;
 }
 
+namespace {
+
+// hard limit on how far we'll page through collectibles; there doesn't seem to be a way to ask for the total count
+static constexpr int32_t cMaxCollectiblePages = 100;
+
+// ---------------------------------------------------------------------------------------------------------------------
+// everything the rebuild graph's tasks share; held by shared_ptr in each task so it lives exactly as long as the flow
+// does. network results are written into pre-sized slots by index and then stitched together in the final task, so
+// the output order is identical to what a sequential walk would have produced regardless of completion order
+struct CacheRebuildState
+{
+    enum class LookupSource
+    {
+        JoinIn,
+        Subscribed,
+        Collectible
+    };
+
+    // one network lookup to do per jam; profile fetch for join-in / subscribed, riff count (optionally) for all
+    struct Lookup
+    {
+        LookupSource                    m_source        = LookupSource::JoinIn;
+        size_t                          m_sourceIndex   = 0;
+        endlesss::types::JamCouchID     m_jamCID;
+        bool                            m_wantProfile   = false;
+
+        bool                            m_profileOk     = false;
+        api::JamProfile                 m_profile;
+        int32_t                         m_riffCount     = -1;
+    };
+
+    CacheRebuildState( const Jams::AsyncCallback& asyncCallback )
+        : m_asyncCallback( asyncCallback )
+    {}
+
+    // progress reports can now come from any worker, serialise them so the callback only ever sees one at a time
+    void report( const Jams::AsyncFetchState state, const std::string& status )
+    {
+        std::scoped_lock<std::mutex> callbackLock( m_callbackMutex );
+        m_asyncCallback( state, status );
+    }
+
+    void fail( const std::string& reason )
+    {
+        std::scoped_lock<std::mutex> failureLock( m_failureMutex );
+        if ( m_failureReason.empty() )
+            m_failureReason = reason;
+        m_failed = true;
+    }
+
+    ouro_nodiscard bool hasFailed() const { return m_failed; }
+
+
+    Jams::AsyncCallback                                     m_asyncCallback;
+    std::mutex                                              m_callbackMutex;
+
+    std::atomic_bool                                        m_failed = false;
+    std::mutex                                              m_failureMutex;
+    std::string                                             m_failureReason;
+
+    api::SubscribedJams                                     m_jamSubscribed;
+    api::CurrentJoinInJams                                  m_jamJoinIn;
+
+    // collectible pages are claimed by lanes in ascending order; once any page comes back empty, nothing past it
+    // is started and anything past it that was already speculatively fetched is ignored
+    std::array< std::vector< api::CurrentCollectibleJams::Data >, cMaxCollectiblePages >
+                                                            m_collectiblePages;
+    std::atomic_int32_t                                     m_nextCollectiblePage   = 0;
+    std::atomic_int32_t                                     m_firstEmptyPage        = cMaxCollectiblePages;
+
+    std::vector< api::CurrentCollectibleJams::Data >        m_collectibles;
+
+    std::vector< Lookup >                                   m_lookups;
+    std::atomic_size_t                                      m_nextLookup            = 0;
+    std::atomic_size_t                                      m_lookupsComplete       = 0;
+};
+
+} // anonymous namespace
+
 // ---------------------------------------------------------------------------------------------------------------------
 void Jams::asyncCacheRebuild(
     const endlesss::api::NetConfiguration& netConfig,
@@ -153,152 +743,266 @@ void Jams::asyncCacheRebuild(
     tf::Taskflow& taskFlow,
     const AsyncCallback& asyncCallback )
 {
-    taskFlow.emplace( [this, &netConfig, syncOptions, asyncCallback]()
+    auto rebuildState = std::make_shared< CacheRebuildState >( asyncCallback );
+
+    // number of request 'lanes' we run side-by-side; each lane pulls work off a shared counter until it runs dry,
+    // which keeps the number of connections in flight bounded no matter how many jams the user is subscribed to
+    const int32_t concurrentRequests = netConfig.getConcurrentRequestLimit();
+
+    tf::Task taskFetchSubscribed = taskFlow.emplace( [rebuildState, &netConfig]()
     {
-        static constexpr std::array< char, 4> busyAscii = { '\\', '|', '/', '-' };
-        int32_t busyCounter = 0;
+        rebuildState->report( AsyncFetchState::Working, "Fetching subscribed jams ..." );
 
-        asyncCallback( AsyncFetchState::Working, "Fetching subscribed jams ..." );
+        if ( !rebuildState->m_jamSubscribed.fetch( netConfig, netConfig.auth().user_id ) )
+            rebuildState->fail( "Failed to get subscribed jam data" );
+    });
 
-        api::SubscribedJams jamSubscribed;
-        if ( !jamSubscribed.fetch( netConfig, netConfig.auth().user_id ) )
-        {
-            asyncCallback( AsyncFetchState::Failed, "Failed to get subscribed jam data" );
-            return;
-        }
+    tf::Task taskFetchJoinIn = taskFlow.emplace( [rebuildState, &netConfig]()
+    {
+        rebuildState->report( AsyncFetchState::Working, "Fetching current public jams ..." );
 
-        asyncCallback( AsyncFetchState::Working, "Fetching current public jams ..." );
+        if ( !rebuildState->m_jamJoinIn.fetch( netConfig ) )
+            rebuildState->fail( "Failed to get public jam data" );
+    });
 
-        api::CurrentJoinInJams jamJoinIn;
-        if ( !jamJoinIn.fetch( netConfig ) )
-        {
-            asyncCallback( AsyncFetchState::Failed, "Failed to get public jam data" );
+    // build a full list of per-jam lookups once we know what all the jams are
+    tf::Task taskPlanLookups = taskFlow.emplace( [rebuildState, syncOptions, concurrentRequests]()
+    {
+        if ( rebuildState->hasFailed() )
             return;
-        }
 
+        CacheRebuildState& state = *rebuildState;
+
+        // concatenate collectible pages in page order, stopping at the first empty one
         if ( syncOptions.sync_collectibles )
         {
-            // fetch all known pages of collectibles
-            std::vector< api::CurrentCollectibleJams::Data > collectedCollectibles;
-            for ( int32_t page = 0; page < 100; page++ )    // just putting some kind of limit on this nonsense, don't know if there's a way to get total pages
+            const int32_t validPages = state.m_firstEmptyPage.load();
+            for ( int32_t page = 0; page < validPages; page++ )
             {
-                asyncCallback( AsyncFetchState::Working, fmt::format( FMTX( "Fetching collectibles, page {} ..." ), page ) );
-
-                // if the fetch works, bolt the new list onto the existing pile
-                api::CurrentCollectibleJams collectibles;
-                bool fetchOk = collectibles.fetch( netConfig, page );
-                if ( fetchOk && collectibles.ok && !collectibles.data.empty() )
-                {
-                    collectedCollectibles.insert( collectedCollectibles.end(), collectibles.data.begin(), collectibles.data.end() );
-                }
-                else
-                {
-                    break;
-                }
+                auto& pageData = state.m_collectiblePages[page];
+                state.m_collectibles.insert( state.m_collectibles.end(), pageData.begin(), pageData.end() );
             }
-            // convert to our cached collectibles type
+        }
+
+        state.m_lookups.reserve( state.m_jamJoinIn.band_ids.size() + state.m_jamSubscribed.rows.size() + state.m_collectibles.size() );
+
+        for ( size_t idx = 0; idx < state.m_jamJoinIn.band_ids.size(); idx++ )
+        {
+            auto& lookup = state.m_lookups.emplace_back();
+            lookup.m_source         = CacheRebuildState::LookupSource::JoinIn;
+            lookup.m_sourceIndex    = idx;
+            lookup.m_jamCID         = endlesss::types::JamCouchID{ state.m_jamJoinIn.band_ids[idx] };
+            lookup.m_wantProfile    = true;
+        }
+        for ( size_t idx = 0; idx < state.m_jamSubscribed.rows.size(); idx++ )
+        {
+            auto& lookup = state.m_lookups.emplace_back();
+            lookup.m_source         = CacheRebuildState::LookupSource::Subscribed;
+            lookup.m_sourceIndex    = idx;
+            lookup.m_jamCID         = endlesss::types::JamCouchID{ state.m_jamSubscribed.rows[idx].id };
+            lookup.m_wantProfile    = true;
+        }
+        // collectibles only need a lookup if we're going to ask for riff counts
+        if ( syncOptions.sync_state )
+        {
+            for ( size_t idx = 0; idx < state.m_collectibles.size(); idx++ )
             {
-                m_configEndlesssCollectibles.jams.clear();
-                for ( const api::CurrentCollectibleJams::Data& cdata : collectedCollectibles )
-                {
-                    if ( cdata.name.empty() )
-                        continue;
+                if ( state.m_collectibles[idx].name.empty() )
+                    continue;
+
+                auto& lookup = state.m_lookups.emplace_back();
+                lookup.m_source         = CacheRebuildState::LookupSource::Collectible;
+                lookup.m_sourceIndex    = idx;
+                lookup.m_jamCID         = endlesss::types::JamCouchID{ state.m_collectibles[idx].legacy_id };
+                lookup.m_wantProfile    = false;
+            }
+        }
 
-                    config::endlesss::CollectibleJamManifest::Jam cjam;
+        blog::cache( FMTX( "jam cache rebuild planned {} lookups across {} request lanes" ), state.m_lookups.size(), concurrentRequests );
+        state.report( AsyncFetchState::Working, "Updating jam metadata ..." );
+    });
 
-                    cjam.jamId    = cdata.jamId;
-                    cjam.name     = cdata.name;
-                    cjam.bio      = cdata.bio;
-                    cjam.bandId   = cdata.legacy_id;
-                    cjam.owner    = cdata.owner;
-                    cjam.members  = cdata.members;
-                    cjam.rifftime = cdata.rifff.created;
+    taskPlanLookups.succeed( taskFetchSubscribed, taskFetchJoinIn );
 
-                    asyncCallback( AsyncFetchState::Working, fmt::format( FMTX( "Analysing Collectibles ({})" ), busyAscii[busyCounter] ) );
-                    busyCounter = (busyCounter + 1) % 4;
+    // stitch everything back together in source order and hand it over to the cache
+    tf::Task taskMerge = taskFlow.emplace( [this, rebuildState, syncOptions]()
+    {
+        CacheRebuildState& state = *rebuildState;
 
-                    if ( syncOptions.sync_state )
-                    {
-                        api::JamRiffCount riffCount;
-                        if ( riffCount.fetch( netConfig, endlesss::types::JamCouchID{ cjam.bandId } ) )
-                        {
-                            cjam.riffCount = riffCount.total_rows;
-                        }
-                    }
+        if ( state.hasFailed() )
+        {
+            state.report( AsyncFetchState::Failed, state.m_failureReason );
+            return;
+        }
 
-                    m_configEndlesssCollectibles.jams.emplace_back( cjam );
-                }
-                blog::cache( "extracted {} collectible jams", m_configEndlesssCollectibles.jams.size() );
+        // index lookups by their source position
+        std::vector< const CacheRebuildState::Lookup* > joinInLookups( state.m_jamJoinIn.band_ids.size(), nullptr );
+        std::vector< const CacheRebuildState::Lookup* > subscribedLookups( state.m_jamSubscribed.rows.size(), nullptr );
+        std::vector< const CacheRebuildState::Lookup* > collectibleLookups( state.m_collectibles.size(), nullptr );
+        for ( const auto& lookup : state.m_lookups )
+        {
+            switch ( lookup.m_source )
+            {
+                case CacheRebuildState::LookupSource::JoinIn:       joinInLookups[lookup.m_sourceIndex]      = &lookup; break;
+                case CacheRebuildState::LookupSource::Subscribed:   subscribedLookups[lookup.m_sourceIndex]  = &lookup; break;
+                case CacheRebuildState::LookupSource::Collectible:  collectibleLookups[lookup.m_sourceIndex] = &lookup; break;
             }
         }
 
-        asyncCallback( AsyncFetchState::Working, "Updating jam metadata ..." );
+        if ( syncOptions.sync_collectibles )
+        {
+            m_configEndlesssCollectibles.jams.clear();
+            for ( size_t idx = 0; idx < state.m_collectibles.size(); idx++ )
+            {
+                const api::CurrentCollectibleJams::Data& cdata = state.m_collectibles[idx];
+                if ( cdata.name.empty() )
+                    continue;
 
+                config::endlesss::CollectibleJamManifest::Jam cjam;
+
+                cjam.jamId    = cdata.jamId;
+                cjam.name     = cdata.name;
+                cjam.bio      = cdata.bio;
+                cjam.bandId   = cdata.legacy_id;
+                cjam.owner    = cdata.owner;
+                cjam.members  = cdata.members;
+                cjam.rifftime = cdata.rifff.created;
+
+                if ( collectibleLookups[idx] != nullptr && collectibleLookups[idx]->m_riffCount >= 0 )
+                    cjam.riffCount = collectibleLookups[idx]->m_riffCount;
+
+                m_configEndlesssCollectibles.jams.emplace_back( cjam );
+            }
+            blog::cache( "extracted {} collectible jams", m_configEndlesssCollectibles.jams.size() );
+            m_collectiblesManifestLoaded = true;
+        }
 
         m_jamDataJoinIn.clear();
 
         int64_t dummyTimestamp = 0;
-        for ( const auto& jdb : jamJoinIn.band_ids )
+        for ( size_t idx = 0; idx < joinInLookups.size(); idx++ )
         {
-            api::JamProfile jamProfile;
-            if ( !jamProfile.fetch( netConfig, endlesss::types::JamCouchID{ jdb } ) )
+            const auto* lookup = joinInLookups[idx];
+            if ( lookup == nullptr || !lookup->m_profileOk )
             {
-                blog::error::cache( "jam profile failed on {}", jdb );
+                blog::error::cache( "jam profile failed on {}", state.m_jamJoinIn.band_ids[idx] );
                 continue;
             }
 
-            auto& newJamData = m_jamDataJoinIn.emplace_back( jdb,
-                                                             jamProfile.displayName,
-                                                             jamProfile.bio,
+            auto& newJamData = m_jamDataJoinIn.emplace_back( state.m_jamJoinIn.band_ids[idx],
+                                                             lookup->m_profile.displayName,
+                                                             lookup->m_profile.bio,
                                                              dummyTimestamp++ );
-
-            asyncCallback( AsyncFetchState::Working, fmt::format( FMTX( "Analysing Public ({})" ), busyAscii[busyCounter] ) );
-            busyCounter = (busyCounter + 1) % 4;
-
-            if ( syncOptions.sync_state )
-            {
-                api::JamRiffCount riffCount;
-                if ( riffCount.fetch( netConfig, endlesss::types::JamCouchID{ jdb } ) )
-                {
-                    newJamData.m_riffCount = riffCount.total_rows;
-                }
-            }
+            newJamData.m_riffCount = lookup->m_riffCount;
         }
 
         m_jamDataUserSubscribed.clear();
 
-        for ( const auto& jdb : jamSubscribed.rows )
+        for ( size_t idx = 0; idx < subscribedLookups.size(); idx++ )
         {
-            api::JamProfile jamProfile;
-            if ( !jamProfile.fetch( netConfig, endlesss::types::JamCouchID{ jdb.id }  ) )
+            const auto* lookup = subscribedLookups[idx];
+            if ( lookup == nullptr || !lookup->m_profileOk )
             {
-                blog::error::cache( "jam profile failed on {}", jdb.id );
+                blog::error::cache( "jam profile failed on {}", state.m_jamSubscribed.rows[idx].id );
                 continue;
             }
 
-            const auto jamTimestamp = spacetime::parseISO8601( jdb.key );
+            const auto jamTimestamp = spacetime::parseISO8601( state.m_jamSubscribed.rows[idx].key );
 
-            auto& newJamData = m_jamDataUserSubscribed.emplace_back( jdb.id,
-                                                                     jamProfile.displayName,
-                                                                     jamProfile.bio,
+            auto& newJamData = m_jamDataUserSubscribed.emplace_back( state.m_jamSubscribed.rows[idx].id,
+                                                                     lookup->m_profile.displayName,
+                                                                     lookup->m_profile.bio,
                                                                      jamTimestamp );
+            newJamData.m_riffCount = lookup->m_riffCount;
+        }
 
-            asyncCallback( AsyncFetchState::Working, fmt::format( FMTX( "Analysing Subscribed ({})" ), busyAscii[busyCounter] ) );
-            busyCounter = (busyCounter + 1) % 4;
+        postProcessNewData();
+        state.report( AsyncFetchState::Success, "" );
+    });
 
-            if ( syncOptions.sync_state )
+    // speculatively fetch collectible pages across a set of lanes; each lane claims the next page number and
+    // keeps going until it claims one at or beyond the first empty page anyone has seen
+    if ( syncOptions.sync_collectibles )
+    {
+        const int32_t pageLanes = std::min( concurrentRequests, cMaxCollectiblePages );
+        for ( int32_t lane = 0; lane < pageLanes; lane++ )
+        {
+            tf::Task taskPageLane = taskFlow.emplace( [rebuildState, &netConfig]()
             {
-                api::JamRiffCount riffCount;
-                if ( riffCount.fetch( netConfig, endlesss::types::JamCouchID{ jdb.id } ) )
+                CacheRebuildState& state = *rebuildState;
+                for ( ;; )
                 {
-                    newJamData.m_riffCount = riffCount.total_rows;
+                    if ( state.hasFailed() )
+                        break;
+
+                    const int32_t page = state.m_nextCollectiblePage++;
+                    if ( page >= state.m_firstEmptyPage.load() )
+                        break;
+
+                    state.report( AsyncFetchState::Working, fmt::format( FMTX( "Fetching collectibles, page {} ..." ), page ) );
+
+                    api::CurrentCollectibleJams collectibles;
+                    const bool fetchOk = collectibles.fetch( netConfig, page );
+                    if ( fetchOk && collectibles.ok && !collectibles.data.empty() )
+                    {
+                        state.m_collectiblePages[page] = std::move( collectibles.data );
+                    }
+                    else
+                    {
+                        // lower the cut-off to this page if we're the earliest to find the end
+                        int32_t firstEmpty = state.m_firstEmptyPage.load();
+                        while ( page < firstEmpty && !state.m_firstEmptyPage.compare_exchange_weak( firstEmpty, page ) ) {}
+                        break;
+                    }
                 }
-            }
+            });
+            taskPageLane.precede( taskPlanLookups );
         }
+    }
 
-        postProcessNewData();
-        asyncCallback( AsyncFetchState::Success, "" );
-    });
+    // per-jam profile and riff count lookups, same lane approach
+    for ( int32_t lane = 0; lane < concurrentRequests; lane++ )
+    {
+        tf::Task taskLookupLane = taskFlow.emplace( [rebuildState, &netConfig, syncOptions]()
+        {
+            static constexpr std::array< char, 4> busyAscii = { '\\', '|', '/', '-' };
+
+            CacheRebuildState& state = *rebuildState;
+            if ( state.hasFailed() )
+                return;
+
+            for ( ;; )
+            {
+                const size_t lookupIndex = state.m_nextLookup++;
+                if ( lookupIndex >= state.m_lookups.size() )
+                    break;
+
+                CacheRebuildState::Lookup& lookup = state.m_lookups[lookupIndex];
+
+                if ( lookup.m_wantProfile )
+                    lookup.m_profileOk = lookup.m_profile.fetch( netConfig, lookup.m_jamCID );
+
+                // no point getting counts for a jam we're going to discard
+                const bool keepJam = !lookup.m_wantProfile || lookup.m_profileOk;
+                if ( keepJam && syncOptions.sync_state )
+                {
+                    api::JamRiffCount riffCount;
+                    if ( riffCount.fetch( netConfig, lookup.m_jamCID ) )
+                    {
+                        lookup.m_riffCount = riffCount.total_rows;
+                    }
+                }
+
+                const size_t lookupsComplete = ++state.m_lookupsComplete;
+                state.report( AsyncFetchState::Working, fmt::format( FMTX( "Analysing Jams {} / {} ({})" ),
+                    lookupsComplete,
+                    state.m_lookups.size(),
+                    busyAscii[lookupsComplete % 4] ) );
+            }
+        });
+        taskLookupLane.succeed( taskPlanLookups );
+        taskLookupLane.precede( taskMerge );
+    }
 
     asyncCallback( AsyncFetchState::Working, "Fetching data ..." );
 }
@@ -321,23 +1025,32 @@ void Jams::postProcessNewData()
 
     std::scoped_lock<std::mutex> lockProc( m_dataProcessMutex );
 
-    m_jamDataPublicArchive.clear();
-
-    for ( const auto& pjam : m_configEndlesssPublics.jams )
+    // if these were restored from the binary cache, their manifests were never parsed; keep what we have
+    if ( m_publicsManifestLoaded )
     {
-        auto& pjd = m_jamDataPublicArchive.emplace_back( pjam.band_id,
-                                                         pjam.jam_name,
-                                                         fmt::format("started by [{}]\nest. {} days of activity", pjam.earliest_user, pjam.estimated_days_of_activity ),
-                                                         pjam.earliest_unixtime );
-        pjd.m_riffCount = pjam.total_riffs;
+        m_jamDataPublicArchive.clear();
+
+        for ( const auto& pjam : m_configEndlesssPublics.jams )
+        {
+            auto& pjd = m_jamDataPublicArchive.emplace_back( pjam.band_id,
+                                                             pjam.jam_name,
+                                                             fmt::format("started by [{}]\nest. {} days of activity", pjam.earliest_user, pjam.estimated_days_of_activity ),
+                                                             pjam.earliest_unixtime );
+            pjd.m_riffCount = pjam.total_riffs;
+        }
     }
-    for ( const auto& cjam : m_configEndlesssCollectibles.jams )
+    if ( m_collectiblesManifestLoaded )
     {
-        auto& pjd = m_jamDataCollectibles.emplace_back(  cjam.bandId,
-                                                         cjam.name,
-                                                         fmt::format("owned by [{}], with:\n{}", cjam.owner, fmt::join(cjam.members, "\n")),
-                                                         cjam.rifftime / 1000 );    // riff time is unix-nano
-        pjd.m_riffCount = cjam.riffCount;
+        m_jamDataCollectibles.clear();
+
+        for ( const auto& cjam : m_configEndlesssCollectibles.jams )
+        {
+            auto& pjd = m_jamDataCollectibles.emplace_back(  cjam.bandId,
+                                                             cjam.name,
+                                                             fmt::format("owned by [{}], with:\n{}", cjam.owner, fmt::join(cjam.members, "\n")),
+                                                             cjam.rifftime / 1000 );    // riff time is unix-nano
+            pjd.m_riffCount = cjam.riffCount;
+        }
     }
 
     for ( auto& innerVec : m_idxSortedByTime )
@@ -23,7 +23,8 @@ namespace cache {
 //
 struct Jams
 {
-    static constexpr auto cFilename = "cache.jams.json";
+    static constexpr auto cFilename       = "cache.jams.json";      // portable export, also the import fallback
+    static constexpr auto cBinaryFilename = "cache.jams.bin";       // mapped on load, includes prebuilt sort orders
 
     struct Data
     {
@@ -110,6 +111,35 @@ struct Jams
     bool load( const config::IPathProvider& pathProvider );
     bool save( const config::IPathProvider& pathProvider );
 
+
+    // timings for loading a synthetic cache through the JSON + sort path vs the mapped binary path
+    struct CacheFormatBenchmark
+    {
+        std::size_t                 m_jamCount          = 0;
+        std::size_t                 m_jsonBytes         = 0;
+        std::size_t                 m_binaryBytes       = 0;
+        double                      m_jsonLoadMs        = 0;    // parse + postProcessNewData()
+        double                      m_binaryLoadMs      = 0;    // map + validate + unpack
+        bool                        m_resultsMatch      = false;
+
+        ouro_nodiscard bool passed() const { return m_resultsMatch && m_binaryLoadMs < m_jsonLoadMs; }
+    };
+    // build a cache of `jamCount` randomised subscribed jams, write it out in both formats to `scratchPath` and time
+    // reloading each; the scratch files are removed afterwards
+    static CacheFormatBenchmark benchmarkCacheFormats( const fs::path& scratchPath, const std::size_t jamCount );
+
+    // size and modification time of a file the binary cache was built from; if any of these differ from what
+    // was recorded at save time, the binary cache is considered stale and we fall back to the JSON path
+    struct SourceFileStamp
+    {
+        int64_t     m_size      = -1;
+        int64_t     m_writeTime = 0;
+
+        static SourceFileStamp fromFile( const fs::path& filePath );
+        ouro_nodiscard bool operator==( const SourceFileStamp& ) const = default;
+    };
+    using SourceFileStamps = std::array< SourceFileStamp, 3 >;  // public manifest, collectibles manifest, JSON cache
+
     ouro_nodiscard bool hasJamData() const
     { 
         // overbearing but ensures on the ouro boot page we aren't talking to vectors that are being
@@ -254,6 +284,9 @@ private:
                                 m_configEndlesssCollectibles;
 
 
+    bool                        m_publicsManifestLoaded = false;        // false if the public archive came from the binary cache
+    bool                        m_collectiblesManifestLoaded = false;   // .. similarly for collectibles
+
     uint32_t                    m_jamSerialisedVersion = 0;     // version of the data on disk, used to force obsolescence 
     std::vector< Data >         m_jamDataPublicArchive;         // conversion of data from PublicJamManifest to Data type
     std::vector< Data >         m_jamDataCollectibles;          // conversion of data from CollectibleJamManifest to Data type
@@ -274,6 +307,17 @@ private:
     void postProcessNewData();
 
 
+    static SourceFileStamps gatherSourceStamps( const config::IPathProvider& pathProvider );
+
+    bool loadJson( const fs::path& cacheFile );
+    bool saveJson( const fs::path& cacheFile ) const;
+
+    bool loadBinary( const fs::path& cacheFile, const SourceFileStamps& sources );
+    bool saveBinary( const fs::path& cacheFile, const SourceFileStamps& sources ) const;
+
+    void updateCacheFileState( const fs::path& cacheFile );
+
+
     ouro_nodiscard constexpr const std::vector< Data >* getArrayPtrForType( const JamType type ) const
     {
         switch ( type )
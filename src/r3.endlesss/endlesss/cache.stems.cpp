@@ -10,11 +10,13 @@
 #include "pch.h"
 
 #include "app/module.frontend.h"
+#include "base/text.h"
 
 #include "filesys/fsutil.h"
 #include "spacetime/moment.h"
 
 #include "endlesss/cache.stems.h"
+#include "endlesss/cache.stems.pack.h"
 #include "endlesss/live.stem.h"
 
 using recursive_directory_iterator = std::filesystem::recursive_directory_iterator;
@@ -61,12 +63,14 @@ Stems::Stems()
 }
 
 // ---------------------------------------------------------------------------------------------------------------------
-absl::Status Stems::initialise( const fs::path& cachePath, const uint32_t targetSampleRate )
+absl::Status Stems::initialise( const fs::path& cachePath, const uint32_t targetSampleRate, const endlesss::live::StemStorage::Format::Enum storageFormat, const bool progressiveDecode, const bool usePackFiles )
 {
     const fs::path stemSubdir = getCachePathRoot( CacheVersion::Version2 );
 
     m_cacheStemRoot     = cachePath / stemSubdir;
     m_targetSampleRate  = targetSampleRate;
+    m_storageFormat     = storageFormat;
+    m_progressiveDecode = progressiveDecode;
 
     const auto stemRootStatus = filesys::ensureDirectoryExists( m_cacheStemRoot );
     if ( !stemRootStatus.ok() )
@@ -75,6 +79,19 @@ absl::Status Stems::initialise( const fs::path& cachePath, const uint32_t target
             "Failed to create directory inside [{}], {}", m_cacheStemRoot.string(), stemRootStatus.ToString() ) );
     }
 
+    m_pack.reset();
+    if ( usePackFiles )
+    {
+        auto stemPack = std::make_shared< StemPack >();
+
+        // not fatal, we can still work from loose files
+        const auto packStatus = stemPack->open( cachePath / StemPack::cPackDirectory );
+        if ( packStatus.ok() )
+            m_pack = std::move( stemPack );
+        else
+            blog::error::stem( "unable to open stem pack, using loose files instead; {}", packStatus.ToString() );
+    }
+
     m_stemGeneration = 0;
 
     // single processing instance, used during post-fetch stem analysis
@@ -97,7 +114,7 @@ endlesss::live::StemPtr Stems::request( const endlesss::types::Stem& stemData )
         auto stemIter = m_stems.find( stemDocumentID );
         if ( stemIter == m_stems.end() )
         {
-            auto newStem = std::make_shared<endlesss::live::Stem>( stemData, m_targetSampleRate );
+            auto newStem = std::make_shared<endlesss::live::Stem>( stemData, m_targetSampleRate, m_storageFormat, m_progressiveDecode, m_pack );
 
             m_usages.emplace( stemDocumentID, m_stemGeneration );
             m_stems.emplace( stemDocumentID, newStem );
@@ -113,6 +130,23 @@ endlesss::live::StemPtr Stems::request( const endlesss::types::Stem& stemData )
     }
 }
 
+// ---------------------------------------------------------------------------------------------------------------------
+void Stems::releaseIfUnused( const endlesss::types::Stem& stemData )
+{
+    std::scoped_lock<std::mutex> lock( m_pruneLock );
+
+    auto stemIter = m_stems.find( stemData.couchID );
+    if ( stemIter == m_stems.end() )
+        return;
+
+    // same rule as lockAndPrune(), anyone else still holding it gets to keep it
+    if ( stemIter->second.use_count() > 1 )
+        return;
+
+    m_stems.erase( stemIter );
+    m_usages.erase( stemData.couchID );
+}
+
 // ---------------------------------------------------------------------------------------------------------------------
 ouro_nodiscard std::size_t Stems::estimateMemoryUsageBytes()
 {
@@ -187,6 +221,17 @@ void Stems::lockAndPrune( const bool verbose, const uint32_t generationsToKeep )
             blog::stem( "stem cache prune : ... now has {}", afterSize );
 
         blog::stem( "stem cache prune trimmed {} entries, took {}", (beforeSize - afterSize), pruneTimer.delta< std::chrono::milliseconds >() );
+
+        if ( verbose )
+        {
+            const auto slabStats = endlesss::live::StemSlabArena::getStatistics();
+            blog::stem( "stem cache prune : {} sample slabs live, {} reserved ({:.1f}% fragmentation), high water {} slabs / {}",
+                slabStats.m_liveSlabs,
+                base::humaniseByteSize( "", slabStats.m_liveReservedBytes ),
+                slabStats.getFragmentation() * 100.0f,
+                slabStats.m_highWaterSlabs,
+                base::humaniseByteSize( "", slabStats.m_highWaterReservedBytes ) );
+        }
     }
 }
 
@@ -198,6 +243,51 @@ fs::path Stems::getCachePathForStem( const endlesss::types::Stem& stemData ) con
     return getCachePathForStemData( m_cacheStemRoot, stemData.jamCouchID, stemData.couchID );
 }
 
+// ---------------------------------------------------------------------------------------------------------------------
+bool Stems::isCached( const endlesss::types::Stem& stemData ) const
+{
+    if ( m_pack != nullptr && m_pack->getStoredSize( stemData.couchID.value() ).has_value() )
+        return true;
+
+    // loose files still count with a pack enabled, they get moved into it the next time the stem is loaded
+    return fs::exists( getCachePathForStem( stemData ) / stemData.couchID.value() );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void Stems::compactPackIfWorthwhile()
+{
+    if ( m_pack == nullptr )
+        return;
+
+    static constexpr uint64_t minimumReclaimableBytes = 256 * 1024 * 1024;
+
+    const auto packStats = m_pack->getStatistics();
+    const uint64_t reclaimableBytes = packStats.getReclaimableBytes();
+
+    blog::stem( "stem pack : {} stems in {} segments, {} live, {} saved by deduplication, {} reclaimable",
+        packStats.m_keyCount,
+        packStats.m_segmentCount,
+        base::humaniseByteSize( "", packStats.m_liveBytes ),
+        base::humaniseByteSize( "", packStats.m_dedupedBytes ),
+        base::humaniseByteSize( "", reclaimableBytes ) );
+
+    // only worth the churn once a quarter of the pack is dead space
+    if ( reclaimableBytes < minimumReclaimableBytes || reclaimableBytes * 4 < packStats.m_segmentBytes )
+        return;
+
+    const auto compactStatus = m_pack->compact();
+    if ( absl::IsCancelled( compactStatus ) )
+        blog::stem( "stem pack compaction cancelled" );
+    else if ( !compactStatus.ok() )
+        blog::error::stem( "stem pack compaction failed; {}", compactStatus.ToString() );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void Stems::cancelPackCompaction()
+{
+    if ( m_pack != nullptr )
+        m_pack->cancelCompaction();
+}
 
 } // namespace cache
 } // namespace endlesss
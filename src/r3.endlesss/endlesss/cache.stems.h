@@ -19,6 +19,8 @@ namespace api  { struct NetConfiguration; }
 
 namespace cache {
 
+struct StemPack;
+
 // ---------------------------------------------------------------------------------------------------------------------
 // 
 struct Stems
@@ -45,11 +47,18 @@ struct Stems
 
     absl::Status initialise( 
         const fs::path& cachePath,          // the root path of where to build the stored stems
-        const uint32_t targetSampleRate     // the chosen sample rate, stems will be resampled to this if they don't match
+        const uint32_t targetSampleRate,    // the chosen sample rate, stems will be resampled to this if they don't match
+        const endlesss::live::StemStorage::Format::Enum storageFormat,  // in-memory representation for loaded stems
+        const bool progressiveDecode,       // let stems start playing before they are fully decoded, see Stem::completeDecode()
+        const bool usePackFiles             // keep stem data in a StemPack rather than one file per stem
     );
 
     ouro_nodiscard endlesss::live::StemPtr request( const endlesss::types::Stem& stemData );
 
+    // drop a stem from the cache straight away if nothing outside of it holds a reference; for callers that only
+    // request() a stem to get it onto disk and don't want it to linger in memory until the next prune
+    void releaseIfUnused( const endlesss::types::Stem& stemData );
+
     // tot up all live stems' approximate memory usage; not const as it locks the mutex, dont call it every frame
     ouro_nodiscard std::size_t estimateMemoryUsageBytes();
 
@@ -59,6 +68,17 @@ struct Stems
     // given stem data, return a suitable path to write the cached data to
     ouro_nodiscard fs::path getCachePathForStem( const endlesss::types::Stem& stemData ) const;
 
+    // true if the audio for this stem is already on disk, either in the stem pack or as a loose file
+    ouro_nodiscard bool isCached( const endlesss::types::Stem& stemData ) const;
+
+    // the stem pack in use, if any; pass to any live::Stem built outside of request() so it reads and writes the same place
+    ouro_nodiscard const std::shared_ptr< StemPack >& getPack() const { return m_pack; }
+
+    // if stems are being stored in a pack and enough of it is dead space, rewrite it; can take a while on a big
+    // cache, run it in the background - requests carry on as normal while it works
+    void compactPackIfWorthwhile();
+    void cancelPackCompaction();
+
     // return the single shared instance of read-only stem processing state
     // used by riff resolving code after fetching audio data in
     const endlesss::live::Stem::Processing& getStemProcessing() const
@@ -74,6 +94,8 @@ private:
     using StemUsage         = absl::flat_hash_map< endlesss::types::StemCouchID, uint32_t >;
     
     fs::path            m_cacheStemRoot;
+    std::shared_ptr< StemPack >
+                        m_pack;
 
     StemProcessing      m_processing;
 
@@ -81,6 +103,9 @@ private:
     StemUsage           m_usages;
 
     uint32_t            m_targetSampleRate = 0;
+    endlesss::live::StemStorage::Format::Enum
+                        m_storageFormat = endlesss::live::StemStorage::Format::Float32;
+    bool                m_progressiveDecode = false;
     uint32_t            m_stemGeneration = 0;
     std::mutex          m_pruneLock;
 };
@@ -0,0 +1,944 @@
+//   _______ _______ ______ _______ ___ ___ _______ _______ _______ 
+//  |       |   |   |   __ \       |   |   |    ___|       |    |  |
+//  |   -   |   |   |      <   -   |   |   |    ___|   -   |       |
+//  |_______|_______|___|__|_______|\_____/|_______|_______|__|____|
+//  \\ harry denholm \\ ishani            ishani.org/shelf/ouroveon/
+//
+//  
+//
+
+#include "pch.h"
+
+#include <charconv>
+
+#include "base/hashing.h"
+#include "filesys/fsutil.h"
+#include "spacetime/moment.h"
+
+#include "endlesss/cache.stems.h"
+#include "endlesss/cache.stems.maintenance.h"
+
+#include "xp/mapped.file.h"
+
+// vorbis decode
+#define STB_VORBIS_HEADER_ONLY
+#include "stb_vorbis.c"
+
+// foxen flac
+#include <foxen/flac.h>
+
+namespace endlesss {
+namespace cache {
+
+namespace {
+
+// how many V1 stems to hand to the jam resolver at once
+static constexpr std::size_t cResolverBatchSize = 256;
+
+// how many journal lines to buffer before flushing them to disk
+static constexpr std::size_t cJournalFlushInterval = 64;
+
+// ---------------------------------------------------------------------------------------------------------------------
+// one line in the manifest, keyed by path relative to the V2 cache root;
+//   <relative path> \t <size> \t <write time> \t <checksum> \t <verdict> \t <depth>
+// the file is appended to as a run progresses and compacted once it completes; when loading, later lines win
+//
+struct ManifestEntry
+{
+    uint64_t                    m_size          = 0;
+    int64_t                     m_writeTime     = 0;
+    uint64_t                    m_checksum      = 0;
+    StemMaintenance::Verdict    m_verdict       = StemMaintenance::Verdict::Valid;
+    bool                        m_fullDecode    = false;    // checked with a full decode, rather than just headers
+};
+using ManifestMap = absl::flat_hash_map< std::string, ManifestEntry >;
+
+// ---------------------------------------------------------------------------------------------------------------------
+void loadManifest( const fs::path& manifestFile, ManifestMap& result )
+{
+    std::ifstream manifestStream( manifestFile );
+    if ( !manifestStream.is_open() )
+        return;
+
+    const auto parseField = []( std::string_view field, auto& value, const int base = 10 ) -> bool
+    {
+        const auto parseResult = std::from_chars( field.data(), field.data() + field.size(), value, base );
+        return parseResult.ec == std::errc() && parseResult.ptr == field.data() + field.size();
+    };
+
+    std::string line;
+    while ( std::getline( manifestStream, line ) )
+    {
+        std::array< std::string_view, 6 > fields;
+        std::size_t fieldCount = 0;
+        {
+            std::string_view remaining = line;
+            while ( fieldCount < fields.size() )
+            {
+                const auto tabPosition = remaining.find( '\t' );
+                fields[fieldCount++] = remaining.substr( 0, tabPosition );
+                if ( tabPosition == std::string_view::npos )
+                    break;
+                remaining.remove_prefix( tabPosition + 1 );
+            }
+        }
+        if ( fieldCount != fields.size() )
+            continue;   // most likely a line torn by an interrupted write
+
+        ManifestEntry entry;
+        int32_t verdict = 0;
+        if ( !parseField( fields[1], entry.m_size ) ||
+             !parseField( fields[2], entry.m_writeTime ) ||
+             !parseField( fields[3], entry.m_checksum, 16 ) ||
+             !parseField( fields[4], verdict ) )
+            continue;
+
+        entry.m_verdict     = static_cast< StemMaintenance::Verdict >( verdict );
+        entry.m_fullDecode  = ( fields[5] == "d" );
+
+        result.insert_or_assign( std::string( fields[0] ), entry );
+    }
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+std::string formatManifestLine( const std::string& relativePath, const ManifestEntry& entry )
+{
+    return fmt::format( FMTX( "{}\t{}\t{}\t{:016x}\t{}\t{}\n" ),
+        relativePath,
+        entry.m_size,
+        entry.m_writeTime,
+        entry.m_checksum,
+        static_cast<int32_t>( entry.m_verdict ),
+        entry.m_fullDecode ? "d" : "h" );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+bool wasWrittenRecently( const fs::path& filePath )
+{
+    std::error_code fileError;
+    const auto fileTime = fs::last_write_time( filePath, fileError );
+    if ( fileError )
+        return false;
+    return ( fs::file_time_type::clock::now() - fileTime ) < StemMaintenance::cRecentWriteGrace;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+int64_t getWriteTime( const fs::path& filePath )
+{
+    std::error_code fileError;
+    const auto fileTime = fs::last_write_time( filePath, fileError );
+    if ( fileError )
+        return 0;
+    return (int64_t)fileTime.time_since_epoch().count();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+// read a big-endian value of N bytes
+template< std::size_t _bytes >
+uint64_t readBigEndian( const uint8_t* data )
+{
+    uint64_t result = 0;
+    for ( std::size_t i = 0; i < _bytes; i++ )
+        result = ( result << 8 ) | data[i];
+    return result;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+StemMaintenance::Verdict checkFlacHeader( const uint8_t* data, const std::size_t size, uint64_t& outSampleCount )
+{
+    // fLaC, then a metadata block header that must be STREAMINFO (type 0) with its fixed 34 byte payload
+    static constexpr std::size_t cStreamInfoOffset = 8;
+    static constexpr std::size_t cStreamInfoLength = 34;
+
+    if ( size < cStreamInfoOffset + cStreamInfoLength )
+        return StemMaintenance::Verdict::Truncated;
+
+    const uint8_t  blockType   = data[4] & 0x7F;
+    const uint64_t blockLength = readBigEndian<3>( data + 5 );
+    if ( blockType != 0 || blockLength != cStreamInfoLength )
+        return StemMaintenance::Verdict::BadHeader;
+
+    // 20 bits sample rate, 3 bits channels-1, 5 bits bits-per-sample-1, 36 bits total samples
+    const uint64_t packed       = readBigEndian<8>( data + cStreamInfoOffset + 10 );
+    const uint64_t sampleRate   = packed >> 44;
+    const uint64_t channels     = ( ( packed >> 41 ) & 0x7 ) + 1;
+    outSampleCount              = packed & 0xFFFFFFFFFULL;
+
+    if ( sampleRate == 0 || channels != 2 || outSampleCount == 0 )
+        return StemMaintenance::Verdict::BadHeader;
+
+    return StemMaintenance::Verdict::Valid;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+StemMaintenance::Verdict decodeFlac( const uint8_t* data, const std::size_t size, const uint64_t expectedSampleCount )
+{
+    const uint32_t flacWorkingMemorySize = fx_flac_size( FLAC_MAX_BLOCK_SIZE, FLAC_MAX_CHANNEL_COUNT );
+    void* flacWorkingMemory = mem::alloc16< uint8_t >( flacWorkingMemorySize );
+    absl::Cleanup freeWorkingMemory = [flacWorkingMemory]() { mem::free16( flacWorkingMemory ); };
+
+    fx_flac_t* flac = fx_flac_init( flacWorkingMemory, FLAC_MAX_BLOCK_SIZE, FLAC_MAX_CHANNEL_COUNT );
+    if ( flac == nullptr )
+        return StemMaintenance::Verdict::DecodeFailed;
+
+    static constexpr std::size_t flacDecoderBufferSize = 1024 * 4;
+    std::array< int32_t, flacDecoderBufferSize > decodeBuffer;
+
+    const uint8_t* rawAudio     = data;
+    std::size_t    rawAudioLen  = size;
+    uint64_t       decodedPairs = 0;
+
+    while ( rawAudioLen > 0 )
+    {
+        uint32_t rawAudioInBytes     = (uint32_t)std::min< std::size_t >( rawAudioLen, std::numeric_limits<uint32_t>::max() );
+        uint32_t flacAudioOutSamples = flacDecoderBufferSize;
+
+        const fx_flac_state_t flacState = fx_flac_process( flac, rawAudio, &rawAudioInBytes, decodeBuffer.data(), &flacAudioOutSamples );
+        if ( flacState == FLAC_ERR )
+            return StemMaintenance::Verdict::DecodeFailed;
+
+        decodedPairs += flacAudioOutSamples / 2;
+
+        // decoder wants more than we have to give; a partial final frame
+        if ( rawAudioInBytes == 0 && flacAudioOutSamples == 0 )
+            break;
+
+        rawAudio    += rawAudioInBytes;
+        rawAudioLen -= rawAudioInBytes;
+    }
+
+    if ( decodedPairs < expectedSampleCount )
+        return StemMaintenance::Verdict::Truncated;
+
+    return StemMaintenance::Verdict::Valid;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+// ogg pages carry a CRC-32 over the whole page (with the checksum field itself zeroed); unlike the usual zlib flavour
+// this one is unreflected with a zero initial value, polynomial 0x04c11db7
+static constexpr std::array< uint32_t, 256 > cOggCrcTable = []()
+{
+    std::array< uint32_t, 256 > table{};
+    for ( uint32_t index = 0; index < 256; index++ )
+    {
+        uint32_t crc = index << 24;
+        for ( int bit = 0; bit < 8; bit++ )
+            crc = ( crc & 0x80000000 ) ? ( ( crc << 1 ) ^ 0x04c11db7 ) : ( crc << 1 );
+        table[index] = crc;
+    }
+    return table;
+}();
+
+bool isValidOggPage( const uint8_t* page, const std::size_t pageSize )
+{
+    static constexpr std::size_t cChecksumOffset = 22;
+
+    uint32_t crc = 0;
+    for ( std::size_t byteI = 0; byteI < pageSize; byteI++ )
+    {
+        const uint8_t byte = ( byteI >= cChecksumOffset && byteI < cChecksumOffset + 4 ) ? 0 : page[byteI];
+        crc = ( crc << 8 ) ^ cOggCrcTable[( ( crc >> 24 ) ^ byte ) & 0xff];
+    }
+
+    const uint32_t storedCrc = (uint32_t)page[cChecksumOffset]
+                             | ( (uint32_t)page[cChecksumOffset + 1] << 8 )
+                             | ( (uint32_t)page[cChecksumOffset + 2] << 16 )
+                             | ( (uint32_t)page[cChecksumOffset + 3] << 24 );
+    return crc == storedCrc;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+StemMaintenance::Verdict checkOggHeader( const uint8_t* data, const std::size_t size )
+{
+    static constexpr std::size_t cPageHeaderSize = 27;
+
+    if ( size < cPageHeaderSize )
+        return StemMaintenance::Verdict::Truncated;
+
+    // first page must be a beginning-of-stream page carrying the vorbis identification header
+    const uint8_t headerType    = data[5];
+    const uint8_t segmentCount  = data[26];
+    if ( data[4] != 0 || ( headerType & 0x02 ) == 0 )
+        return StemMaintenance::Verdict::BadHeader;
+
+    const std::size_t packetOffset = cPageHeaderSize + segmentCount;
+    if ( size < packetOffset + 12 )
+        return StemMaintenance::Verdict::Truncated;
+
+    if ( data[packetOffset] != 0x01 || std::memcmp( data + packetOffset + 1, "vorbis", 6 ) != 0 )
+        return StemMaintenance::Verdict::BadHeader;
+
+    const uint8_t channels = data[packetOffset + 11];
+    if ( channels != 2 )
+        return StemMaintenance::Verdict::BadHeader;
+
+    // find the final page; it should be complete, end exactly at the end of the file and be flagged end-of-stream.
+    // "OggS" can turn up by chance inside compressed audio, so only a match that checks out as a whole page with a
+    // matching CRC counts; anything else (including a real final page cut short) is skipped and the search goes on,
+    // leaving the last intact page to decide the verdict
+    static constexpr std::size_t cTailSearch = 64 * 1024;
+    const std::size_t searchFrom = ( size > cTailSearch ) ? ( size - cTailSearch ) : 0;
+    for ( std::size_t pageStart = size - 4; pageStart > searchFrom; pageStart-- )
+    {
+        if ( std::memcmp( data + pageStart, "OggS", 4 ) != 0 )
+            continue;
+
+        if ( pageStart + cPageHeaderSize > size || data[pageStart + 4] != 0 )
+            continue;
+
+        const uint8_t lastSegmentCount = data[pageStart + 26];
+        if ( pageStart + cPageHeaderSize + lastSegmentCount > size )
+            continue;
+
+        std::size_t pageBodySize = 0;
+        for ( std::size_t seg = 0; seg < lastSegmentCount; seg++ )
+            pageBodySize += data[pageStart + cPageHeaderSize + seg];
+
+        const std::size_t pageEnd = pageStart + cPageHeaderSize + lastSegmentCount + pageBodySize;
+        if ( pageEnd > size || !isValidOggPage( data + pageStart, pageEnd - pageStart ) )
+            continue;
+
+        if ( pageEnd != size || ( data[pageStart + 5] & 0x04 ) == 0 )
+            return StemMaintenance::Verdict::Truncated;
+
+        return StemMaintenance::Verdict::Valid;
+    }
+
+    // no page boundary anywhere near the end of the file
+    return StemMaintenance::Verdict::Truncated;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+StemMaintenance::Verdict decodeOgg( const uint8_t* data, const std::size_t size )
+{
+    short* oggData = nullptr;
+    int32_t oggChannels = 0;
+    int32_t oggSampleRate = 0;
+
+    const int32_t sampleCount = stb_vorbis_decode_memory( data, (int32_t)size, &oggChannels, &oggSampleRate, &oggData );
+
+    // stb mallocs, we only wanted to know if it would decode
+    free( oggData );
+
+    if ( sampleCount <= 0 )
+        return StemMaintenance::Verdict::DecodeFailed;
+    if ( oggChannels != 2 )
+        return StemMaintenance::Verdict::BadHeader;
+
+    return StemMaintenance::Verdict::Valid;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+struct WorkItem
+{
+    fs::path        m_file;             // file in the V2 cache to validate
+    fs::path        m_migrateFrom;      // if set, copy this V1 file to m_file first
+    std::string     m_relativePath;     // manifest key
+};
+
+} // anonymous namespace
+
+
+// ---------------------------------------------------------------------------------------------------------------------
+struct StemMaintenance::State
+{
+    State() = default;
+
+    fs::path                        m_rootPathVersion1;
+    fs::path                        m_rootPathVersion2;
+    fs::path                        m_quarantineRoot;
+    fs::path                        m_manifestFile;
+
+    Options                         m_options;
+    JamResolver                     m_jamResolver;
+
+    tf::Taskflow                    m_taskflow;
+    std::optional< tf::Future<void> >
+                                    m_future;
+
+    std::atomic< Phase >            m_phase                 = Phase::Idle;
+    std::atomic_bool                m_cancelRequested       = false;
+
+    std::atomic_uint64_t            m_filesFound            = 0;
+    std::atomic_uint64_t            m_filesProcessed        = 0;
+    std::atomic_uint64_t            m_filesUnchanged        = 0;
+    std::atomic_uint64_t            m_filesMigrated         = 0;
+    std::atomic_uint64_t            m_filesUnresolved       = 0;
+    std::atomic_uint64_t            m_filesValid            = 0;
+    std::atomic_uint64_t            m_filesCorrupt          = 0;
+    std::atomic_uint64_t            m_filesQuarantined      = 0;
+    std::atomic_uint64_t            m_filesRecent           = 0;
+    std::atomic_uint64_t            m_bytesExamined         = 0;
+
+    // manifest as loaded at the start of the run; read-only once scanning begins
+    ManifestMap                     m_previousManifest;
+
+    // results from this run, plus entries carried over for unchanged files
+    std::mutex                      m_journalMutex;
+    ManifestMap                     m_currentManifest;
+    std::ofstream                   m_journal;
+    std::string                     m_journalBuffer;
+    std::size_t                     m_journalPending        = 0;
+
+    std::vector< WorkItem >         m_work;
+    std::atomic_size_t              m_nextWork              = 0;
+
+
+    void reset()
+    {
+        m_cancelRequested   = false;
+        m_filesFound        = 0;
+        m_filesProcessed    = 0;
+        m_filesUnchanged    = 0;
+        m_filesMigrated     = 0;
+        m_filesUnresolved   = 0;
+        m_filesValid        = 0;
+        m_filesCorrupt      = 0;
+        m_filesQuarantined  = 0;
+        m_filesRecent       = 0;
+        m_bytesExamined     = 0;
+
+        m_previousManifest.clear();
+        m_currentManifest.clear();
+        m_journalBuffer.clear();
+        m_journalPending    = 0;
+
+        m_work.clear();
+        m_nextWork          = 0;
+    }
+
+    void scan();
+    void processLane();
+    void finalise();
+
+    void record( const std::string& relativePath, const ManifestEntry& entry, const bool forceFlush );
+    void flushJournal();
+
+    ouro_nodiscard bool isUpToDate( const std::string& relativePath, const uint64_t size, const int64_t writeTime ) const
+    {
+        if ( m_options.m_revalidateAll )
+            return false;
+
+        const auto previous = m_previousManifest.find( relativePath );
+        if ( previous == m_previousManifest.end() )
+            return false;
+
+        const ManifestEntry& entry = previous->second;
+        return entry.m_verdict   == Verdict::Valid &&
+               entry.m_size      == size &&
+               entry.m_writeTime == writeTime &&
+               ( entry.m_fullDecode || !m_options.m_fullDecode );
+    }
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+void StemMaintenance::State::record( const std::string& relativePath, const ManifestEntry& entry, const bool forceFlush )
+{
+    std::scoped_lock<std::mutex> journalLock( m_journalMutex );
+
+    m_currentManifest.insert_or_assign( relativePath, entry );
+
+    m_journalBuffer += formatManifestLine( relativePath, entry );
+    m_journalPending++;
+
+    if ( forceFlush || m_journalPending >= cJournalFlushInterval )
+        flushJournal();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+// call with m_journalMutex held
+void StemMaintenance::State::flushJournal()
+{
+    if ( m_journal.is_open() && !m_journalBuffer.empty() )
+    {
+        m_journal.write( m_journalBuffer.data(), (std::streamsize)m_journalBuffer.size() );
+        m_journal.flush();
+    }
+    m_journalBuffer.clear();
+    m_journalPending = 0;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void StemMaintenance::State::scan()
+{
+    OuroveonThreadScope ots( "StemMaint::Scan" );
+
+    m_phase = Phase::Scanning;
+
+    loadManifest( m_manifestFile, m_previousManifest );
+    blog::cache( FMTX( "[maintenance] loaded {} manifest entries" ), m_previousManifest.size() );
+
+    // anything previously known to be fine and untouched gets carried straight over
+    absl::flat_hash_set< std::string > queuedPaths;
+
+    const auto considerFile = [&]( const fs::path& filePath, const fs::path& migrateFrom )
+    {
+        const std::string relativePath = filePath.lexically_relative( m_rootPathVersion2 ).generic_string();
+        if ( queuedPaths.contains( relativePath ) )
+            return;
+
+        m_filesFound++;
+
+        std::error_code fileError;
+        const uint64_t fileSize  = migrateFrom.empty() ? (uint64_t)fs::file_size( filePath, fileError ) : 0;
+        const int64_t  writeTime = migrateFrom.empty() ? getWriteTime( filePath ) : 0;
+
+        if ( migrateFrom.empty() && !fileError && isUpToDate( relativePath, fileSize, writeTime ) )
+        {
+            m_filesUnchanged++;
+            m_filesValid++;
+
+            std::scoped_lock<std::mutex> journalLock( m_journalMutex );
+            m_currentManifest.insert_or_assign( relativePath, m_previousManifest.at( relativePath ) );
+            return;
+        }
+
+        queuedPaths.emplace( relativePath );
+        m_work.emplace_back( WorkItem{ filePath, migrateFrom, relativePath } );
+    };
+
+    // walk the existing V2 cache; stems are stored under their plain couch ID, anything with an extension is
+    // analysis data, a temporary or our own manifest
+    try
+    {
+        std::error_code osError;
+        for ( auto it = fs::recursive_directory_iterator( m_rootPathVersion2, fs::directory_options::skip_permission_denied, osError );
+              it != fs::recursive_directory_iterator();
+              it.increment( osError ) )
+        {
+            if ( osError || m_cancelRequested )
+                break;
+
+            if ( it->is_directory() || it->path().has_extension() )
+                continue;
+
+            considerFile( it->path(), {} );
+        }
+    }
+    catch ( std::exception& cEx )
+    {
+        blog::error::cache( FMTX( "[maintenance] stopping V2 cache walk on exception : {}" ), cEx.what() );
+    }
+
+    // optionally pull in anything left in a V1 cache, resolving which jam each stem belongs to in batches
+    if ( m_options.m_migrateVersion1 && m_jamResolver && fs::exists( m_rootPathVersion1 ) )
+    {
+        std::vector< fs::path >         resolverOriginalFiles;
+        endlesss::types::StemCouchIDs   resolverInputs;
+        endlesss::types::JamCouchIDs    resolverOutputs;
+
+        const auto resolveBatch = [&]()
+        {
+            if ( resolverInputs.empty() )
+                return;
+
+            resolverOutputs.clear();
+            m_jamResolver( resolverInputs, resolverOutputs );
+
+            for ( std::size_t idx = 0; idx < resolverInputs.size(); idx++ )
+            {
+                if ( idx >= resolverOutputs.size() || resolverOutputs[idx].empty() )
+                {
+                    m_filesUnresolved++;
+                    continue;
+                }
+
+                const auto copyToPath = Stems::getCachePathForStemData( m_rootPathVersion2, resolverOutputs[idx], resolverInputs[idx] );
+                const auto copyToFile = copyToPath / resolverInputs[idx].value();
+
+                // already migrated on a previous run, will have been picked up by the V2 walk
+                if ( fs::exists( copyToFile ) )
+                    continue;
+
+                considerFile( copyToFile, resolverOriginalFiles[idx] );
+            }
+
+            resolverOriginalFiles.clear();
+            resolverInputs.clear();
+        };
+
+        try
+        {
+            std::error_code osError;
+            for ( auto it = fs::recursive_directory_iterator( m_rootPathVersion1, fs::directory_options::skip_permission_denied, osError );
+                  it != fs::recursive_directory_iterator();
+                  it.increment( osError ) )
+            {
+                if ( osError || m_cancelRequested )
+                    break;
+
+                if ( it->is_directory() )
+                    continue;
+
+                const std::string filename = it->path().stem().string();
+                if ( filename.size() > 10 && filename.starts_with( "stem" ) )
+                {
+                    resolverInputs.emplace_back( filename.substr( 5 ) );
+                    resolverOriginalFiles.emplace_back( it->path() );
+
+                    if ( resolverInputs.size() >= cResolverBatchSize )
+                        resolveBatch();
+                }
+            }
+            resolveBatch();
+        }
+        catch ( std::exception& cEx )
+        {
+            blog::error::cache( FMTX( "[maintenance] stopping V1 cache walk on exception : {}" ), cEx.what() );
+        }
+    }
+
+    blog::cache( FMTX( "[maintenance] scan found {} stems, {} unchanged, {} queued for validation" ),
+        m_filesFound.load(),
+        m_filesUnchanged.load(),
+        m_work.size() );
+
+    // open the journal for appending; anything we finish from here on survives an interruption
+    m_journal.open( m_manifestFile, std::ios::out | std::ios::app );
+
+    m_phase = Phase::Processing;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void StemMaintenance::State::processLane()
+{
+    OuroveonThreadScope ots( "StemMaint::Lane" );
+
+    for ( ;; )
+    {
+        if ( m_cancelRequested )
+            break;
+
+        const std::size_t workIndex = m_nextWork++;
+        if ( workIndex >= m_work.size() )
+            break;
+
+        const WorkItem& work = m_work[workIndex];
+
+        if ( !work.m_migrateFrom.empty() )
+        {
+            const absl::Status directoryBuildStatus = filesys::ensureDirectoryExists( work.m_file.parent_path() );
+            if ( !directoryBuildStatus.ok() )
+            {
+                blog::error::cache( FMTX( "[maintenance] unable to create [{}] : {}" ), work.m_file.parent_path().string(), directoryBuildStatus.ToString() );
+                m_filesProcessed++;
+                continue;
+            }
+
+            std::error_code copyError;
+            fs::copy_file( work.m_migrateFrom, work.m_file, fs::copy_options::skip_existing, copyError );
+            if ( copyError )
+            {
+                blog::error::cache( FMTX( "[maintenance] error while copying [{}] : {}" ), work.m_file.string(), copyError.message() );
+                m_filesProcessed++;
+                continue;
+            }
+            m_filesMigrated++;
+        }
+
+        const FileCheck check = checkStemFile( work.m_file, m_options.m_fullDecode );
+        m_bytesExamined += check.m_size;
+
+        ManifestEntry entry;
+        entry.m_size        = check.m_size;
+        entry.m_writeTime   = getWriteTime( work.m_file );
+        entry.m_checksum    = check.m_checksum;
+        entry.m_verdict     = check.m_verdict;
+        entry.m_fullDecode  = m_options.m_fullDecode;
+
+        // same size and timestamp as last time, but different contents
+        if ( const auto previous = m_previousManifest.find( work.m_relativePath ); previous != m_previousManifest.end() )
+        {
+            if ( previous->second.m_size      == entry.m_size &&
+                 previous->second.m_writeTime == entry.m_writeTime &&
+                 previous->second.m_checksum  != entry.m_checksum )
+            {
+                blog::error::cache( FMTX( "[maintenance] [{}] contents changed without modification time changing" ), work.m_relativePath );
+            }
+        }
+
+        if ( check.m_verdict == Verdict::Valid )
+        {
+            m_filesValid++;
+            record( work.m_relativePath, entry, false );
+        }
+        // a stem fetch may still be writing this; judge it next time instead
+        else if ( wasWrittenRecently( work.m_file ) )
+        {
+            m_filesRecent++;
+            blog::cache( FMTX( "[maintenance] [{}] failed validation ({}) but was only just written, leaving it for now" ), work.m_relativePath, getVerdictName( check.m_verdict ) );
+
+            record( work.m_relativePath, entry, true );
+        }
+        else
+        {
+            m_filesCorrupt++;
+            blog::error::cache( FMTX( "[maintenance] [{}] failed validation : {}" ), work.m_relativePath, getVerdictName( check.m_verdict ) );
+
+            bool quarantined = false;
+            if ( m_options.m_quarantine )
+            {
+                const fs::path quarantineFile = m_quarantineRoot / work.m_relativePath;
+
+                std::error_code moveError;
+                fs::create_directories( quarantineFile.parent_path(), moveError );
+                fs::rename( work.m_file, quarantineFile, moveError );
+                if ( moveError )
+                {
+                    blog::error::cache( FMTX( "[maintenance] unable to quarantine [{}] : {}" ), work.m_relativePath, moveError.message() );
+                }
+                else
+                {
+                    // any cached analysis belonged to the broken audio
+                    fs::path analysisFile = work.m_file;
+                    analysisFile += ".analysis";
+                    fs::remove( analysisFile, moveError );
+
+                    quarantined = true;
+                    m_filesQuarantined++;
+                }
+            }
+
+            // keep a record of files we left in place so they are re-examined (and reported) next time
+            if ( !quarantined )
+                record( work.m_relativePath, entry, true );
+        }
+
+        m_filesProcessed++;
+    }
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void StemMaintenance::State::finalise()
+{
+    m_phase = Phase::Finalising;
+
+    std::scoped_lock<std::mutex> journalLock( m_journalMutex );
+    flushJournal();
+    m_journal.close();
+
+    // an interrupted run leaves the appended journal in place to resume from
+    if ( m_cancelRequested )
+    {
+        blog::cache( FMTX( "[maintenance] cancelled after {} / {} files" ), m_filesProcessed.load(), m_work.size() );
+        m_phase = Phase::Cancelled;
+        return;
+    }
+
+    // rewrite a compacted manifest holding one entry per file that is still in the cache
+    fs::path writeFile = m_manifestFile;
+    writeFile += ".tmp";
+    {
+        std::ofstream manifestStream( writeFile, std::ios::out | std::ios::trunc );
+        for ( const auto& [relativePath, entry] : m_currentManifest )
+            manifestStream << formatManifestLine( relativePath, entry );
+    }
+    std::error_code fileError;
+    fs::rename( writeFile, m_manifestFile, fileError );
+    if ( fileError )
+        blog::error::cache( FMTX( "[maintenance] unable to compact manifest : {}" ), fileError.message() );
+
+    blog::cache( FMTX( "[maintenance] complete; {} found, {} unchanged, {} migrated, {} valid, {} corrupt, {} quarantined, {} recent, {} unresolved" ),
+        m_filesFound.load(),
+        m_filesUnchanged.load(),
+        m_filesMigrated.load(),
+        m_filesValid.load(),
+        m_filesCorrupt.load(),
+        m_filesQuarantined.load(),
+        m_filesRecent.load(),
+        m_filesUnresolved.load() );
+
+    m_phase = Phase::Complete;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+const char* StemMaintenance::getVerdictName( const Verdict verdict )
+{
+    switch ( verdict )
+    {
+        case Verdict::Valid:            return "Valid";
+        case Verdict::Empty:            return "Empty";
+        case Verdict::Truncated:        return "Truncated";
+        case Verdict::UnknownFormat:    return "Unknown Format";
+        case Verdict::BadHeader:        return "Bad Header";
+        case Verdict::DecodeFailed:     return "Decode Failed";
+    }
+    return "Unknown";
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+const char* StemMaintenance::getPhaseName( const Phase phase )
+{
+    switch ( phase )
+    {
+        case Phase::Idle:       return "Idle";
+        case Phase::Scanning:   return "Scanning";
+        case Phase::Processing: return "Validating";
+        case Phase::Finalising: return "Finalising";
+        case Phase::Complete:   return "Complete";
+        case Phase::Cancelled:  return "Cancelled";
+    }
+    return "Unknown";
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+StemMaintenance::StemMaintenance()
+    : m_state( std::make_unique<State>() )
+{
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+StemMaintenance::~StemMaintenance()
+{
+    cancel();
+    wait();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+bool StemMaintenance::start(
+    tf::Executor& taskExecutor,
+    const fs::path& cacheCommonRoot,
+    const Options& options,
+    const JamResolver& jamResolver )
+{
+    if ( isRunning() )
+        return false;
+
+    wait();
+
+    m_state->reset();
+    m_state->m_rootPathVersion1 = cacheCommonRoot / Stems::getCachePathRoot( Stems::CacheVersion::Version1 );
+    m_state->m_rootPathVersion2 = cacheCommonRoot / Stems::getCachePathRoot( Stems::CacheVersion::Version2 );
+    m_state->m_quarantineRoot   = cacheCommonRoot / cQuarantineDirectory;
+    m_state->m_manifestFile     = m_state->m_rootPathVersion2 / cManifestFilename;
+    m_state->m_options          = options;
+    m_state->m_jamResolver      = jamResolver;
+    m_state->m_phase            = Phase::Scanning;
+
+    // scan -> N validation lanes -> finalise
+    m_state->m_taskflow.clear();
+
+    State* state = m_state.get();
+
+    tf::Task taskScan     = m_state->m_taskflow.emplace( [state]() { state->scan(); } );
+    tf::Task taskFinalise = m_state->m_taskflow.emplace( [state]() { state->finalise(); } );
+
+    // leave one worker free so the rest of the app can keep using the executor
+    const std::size_t laneCount = std::max< std::size_t >( 1, taskExecutor.num_workers() - 1 );
+    for ( std::size_t lane = 0; lane < laneCount; lane++ )
+    {
+        tf::Task taskLane = m_state->m_taskflow.emplace( [state]() { state->processLane(); } );
+        taskLane.succeed( taskScan );
+        taskLane.precede( taskFinalise );
+    }
+
+    blog::cache( FMTX( "[maintenance] starting with {} lanes{}{}" ),
+        laneCount,
+        options.m_migrateVersion1 ? ", migrating V1" : "",
+        options.m_fullDecode ? ", full decode" : "" );
+
+    m_state->m_future = taskExecutor.run( m_state->m_taskflow );
+    return true;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void StemMaintenance::cancel()
+{
+    m_state->m_cancelRequested = true;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void StemMaintenance::wait()
+{
+    if ( m_state->m_future.has_value() )
+        m_state->m_future->wait();
+    m_state->m_future = std::nullopt;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+bool StemMaintenance::isRunning() const
+{
+    const Phase phase = m_state->m_phase;
+    return phase == Phase::Scanning ||
+           phase == Phase::Processing ||
+           phase == Phase::Finalising;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+StemMaintenance::Progress StemMaintenance::getProgress() const
+{
+    Progress progress;
+    progress.m_phase            = m_state->m_phase;
+    progress.m_filesFound       = m_state->m_filesFound;
+    progress.m_filesProcessed   = m_state->m_filesProcessed;
+    progress.m_filesUnchanged   = m_state->m_filesUnchanged;
+    progress.m_filesMigrated    = m_state->m_filesMigrated;
+    progress.m_filesUnresolved  = m_state->m_filesUnresolved;
+    progress.m_filesValid       = m_state->m_filesValid;
+    progress.m_filesCorrupt     = m_state->m_filesCorrupt;
+    progress.m_filesQuarantined = m_state->m_filesQuarantined;
+    progress.m_filesRecent      = m_state->m_filesRecent;
+    progress.m_bytesExamined    = m_state->m_bytesExamined;
+    return progress;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+StemMaintenance::FileCheck StemMaintenance::checkStemFile( const fs::path& stemFile, const bool fullDecode )
+{
+    FileCheck result;
+
+    std::error_code fileError;
+    result.m_size = (uint64_t)fs::file_size( stemFile, fileError );
+    if ( fileError || result.m_size == 0 )
+    {
+        result.m_verdict = Verdict::Empty;
+        return result;
+    }
+
+    xp::MappedFile mappedStem;
+    if ( !mappedStem.open( stemFile ) )
+    {
+        result.m_verdict = Verdict::Empty;
+        return result;
+    }
+
+    const uint8_t*    data = mappedStem.data();
+    const std::size_t size = mappedStem.size();
+
+    result.m_checksum = base::hashBytes64( data, size );
+
+    if ( size < 4 )
+    {
+        result.m_verdict = Verdict::Truncated;
+        return result;
+    }
+
+    // same sniffing as Stem::fetch()
+    const bool stemIsFLAC = ( std::memcmp( data, "fLaC", 4 ) == 0 );
+    const bool stemIsOGG  = ( std::memcmp( data, "OggS", 4 ) == 0 );
+
+    if ( stemIsFLAC )
+    {
+        uint64_t flacSampleCount = 0;
+        result.m_verdict = checkFlacHeader( data, size, flacSampleCount );
+
+        if ( result.m_verdict == Verdict::Valid && fullDecode )
+            result.m_verdict = decodeFlac( data, size, flacSampleCount );
+    }
+    else if ( stemIsOGG )
+    {
+        result.m_verdict = checkOggHeader( data, size );
+
+        if ( result.m_verdict == Verdict::Valid && fullDecode )
+            result.m_verdict = decodeOgg( data, size );
+    }
+    else
+    {
+        result.m_verdict = Verdict::UnknownFormat;
+    }
+
+    return result;
+}
+
+} // namespace cache
+} // namespace endlesss
@@ -0,0 +1,124 @@
+//   _______ _______ ______ _______ ___ ___ _______ _______ _______ 
+//  |       |   |   |   __ \       |   |   |    ___|       |    |  |
+//  |   -   |   |   |      <   -   |   |   |    ___|   -   |       |
+//  |_______|_______|___|__|_______|\_____/|_______|_______|__|____|
+//  \\ harry denholm \\ ishani            ishani.org/shelf/ouroveon/
+//
+//  
+//
+
+#pragma once
+
+#include "base/construction.h"
+#include "endlesss/core.types.h"
+
+namespace endlesss {
+namespace cache {
+
+// ---------------------------------------------------------------------------------------------------------------------
+// background maintenance of the on-disk stem cache; walks the V2 cache (and optionally migrates anything still sitting
+// in a V1 cache into it) and validates every stem file on the task executor - size, header sniffing and, optionally,
+// a full decode. each file's size, write time, checksum and verdict are journalled into a manifest in the cache root,
+// so an interrupted run picks up where it left off and a repeat run only re-examines files that have changed.
+// files that fail validation can be moved into a quarantine directory, where the stem cache will no longer find them
+// and will instead re-download a fresh copy on next use
+//
+struct StemMaintenance
+{
+    DECLARE_NO_COPY_NO_MOVE( StemMaintenance );
+
+    static constexpr auto cManifestFilename     = "_maintenance.manifest";
+    static constexpr auto cQuarantineDirectory  = "stem_quarantine";
+
+    // files written more recently than this may still be in the middle of being fetched; if one fails validation it
+    // is left alone and looked at again on the next run, rather than being pulled out from under its writer
+    static constexpr auto cRecentWriteGrace     = std::chrono::minutes( 2 );
+
+    // given a batch of V1 stem IDs, fill the output with the jam each belongs to (or empty if unknown);
+    // typically bound to Warehouse::batchFindJamIDForStem
+    using JamResolver = std::function< bool( const endlesss::types::StemCouchIDs& stems, endlesss::types::JamCouchIDs& result ) >;
+
+    struct Options
+    {
+        bool        m_migrateVersion1   = false;    // copy stems from a V1 cache into V2 before validating
+        bool        m_fullDecode        = false;    // decode every stem end-to-end rather than just checking headers
+        bool        m_quarantine        = true;     // move files that fail validation out of the cache
+        bool        m_revalidateAll     = false;    // ignore the manifest and re-examine every file
+    };
+
+    enum class Verdict : uint8_t
+    {
+        Valid,
+        Empty,              // zero-length file
+        Truncated,          // too short to hold a header, or the stream ends early
+        UnknownFormat,      // neither FLAC nor Ogg
+        BadHeader,          // recognised format but the header is unusable (eg. not stereo)
+        DecodeFailed,       // full decode hit an error
+    };
+    ouro_nodiscard static const char* getVerdictName( const Verdict verdict );
+
+    enum class Phase
+    {
+        Idle,
+        Scanning,
+        Processing,
+        Finalising,
+        Complete,
+        Cancelled
+    };
+    ouro_nodiscard static const char* getPhaseName( const Phase phase );
+
+    struct Progress
+    {
+        Phase       m_phase                 = Phase::Idle;
+        uint64_t    m_filesFound            = 0;
+        uint64_t    m_filesProcessed        = 0;
+        uint64_t    m_filesUnchanged        = 0;    // skipped as the manifest already had a valid entry for them
+        uint64_t    m_filesMigrated         = 0;
+        uint64_t    m_filesUnresolved       = 0;    // V1 stems we couldn't find a jam for, left where they are
+        uint64_t    m_filesValid            = 0;
+        uint64_t    m_filesCorrupt          = 0;
+        uint64_t    m_filesQuarantined      = 0;
+        uint64_t    m_filesRecent           = 0;    // failed validation but written inside the grace window, left in place
+        uint64_t    m_bytesExamined         = 0;
+    };
+
+    StemMaintenance();
+    ~StemMaintenance();
+
+    // kick off a run on the executor; `cacheCommonRoot` is the root containing stem / stem_v2 directories.
+    // returns false if a run is already active
+    bool start(
+        tf::Executor& taskExecutor,
+        const fs::path& cacheCommonRoot,
+        const Options& options,
+        const JamResolver& jamResolver );
+
+    // ask a running pass to stop at the next file boundary; the manifest is still flushed so the next run resumes
+    void cancel();
+
+    // block until any running pass finishes
+    void wait();
+
+    ouro_nodiscard bool isRunning() const;
+    ouro_nodiscard Progress getProgress() const;
+
+
+    // result of validating a single stem file
+    struct FileCheck
+    {
+        Verdict     m_verdict   = Verdict::Valid;
+        uint64_t    m_size      = 0;
+        uint64_t    m_checksum  = 0;
+    };
+    // validate one file in isolation; exposed so other tools can sniff a cached stem before trusting it
+    ouro_nodiscard static FileCheck checkStemFile( const fs::path& stemFile, const bool fullDecode );
+
+private:
+
+    struct State;
+    std::unique_ptr< State >    m_state;
+};
+
+} // namespace cache
+} // namespace endlesss
@@ -0,0 +1,1334 @@
+//   _______ _______ ______ _______ ___ ___ _______ _______ _______ 
+//  |       |   |   |   __ \       |   |   |    ___|       |    |  |
+//  |   -   |   |   |      <   -   |   |   |    ___|   -   |       |
+//  |_______|_______|___|__|_______|\_____/|_______|_______|__|____|
+//  \\ harry denholm \\ ishani            ishani.org/shelf/ouroveon/
+//
+//  
+//
+
+#include "pch.h"
+
+#include <charconv>
+#include <shared_mutex>
+
+#include "base/hashing.h"
+#include "filesys/fsutil.h"
+#include "spacetime/moment.h"
+
+#include "endlesss/cache.stems.h"
+#include "endlesss/cache.stems.pack.h"
+
+#include "xp/mapped.file.h"
+#include "xp/positional.file.h"
+
+namespace endlesss {
+namespace cache {
+
+namespace pack {
+
+// ---------------------------------------------------------------------------------------------------------------------
+// IMPORTANT : bump FormatVersion on any change to these layouts; existing packs will then be ignored, not misread
+//
+static constexpr uint32_t SegmentMagic      = 0x4B50534F;   // 'OSPK'
+static constexpr uint32_t RecordMagic       = 0x5250534F;   // 'OSPR'
+static constexpr uint32_t IndexMagic        = 0x4950534F;   // 'OSPI'
+static constexpr uint32_t FormatVersion     = 1;
+
+static constexpr std::size_t MaximumKeyLength = 1024;
+
+static constexpr std::string_view SegmentPrefix = "segment_";
+static constexpr std::string_view SegmentSuffix = ".pack";
+
+struct SegmentHeader
+{
+    uint32_t    m_magic             = SegmentMagic;
+    uint32_t    m_formatVersion     = FormatVersion;
+    uint32_t    m_segmentIndex      = 0;
+    uint32_t    m_reserved          = 0;
+};
+static_assert( sizeof( SegmentHeader ) == 16 );
+
+enum class RecordType : uint8_t
+{
+    Blob,           // key + content; payload bytes follow the key
+    Reference,      // key pointing at content already written in some earlier Blob record
+    Removal         // key no longer exists
+};
+
+// every record carries a sequence number; when the same key turns up more than once, the highest sequence wins no
+// matter which segment it was read from, so segments can be scanned in any order and compaction can run alongside writes
+struct RecordHeader
+{
+    uint32_t    m_magic             = RecordMagic;
+    RecordType  m_type              = RecordType::Blob;
+    uint8_t     m_reserved          = 0;
+    uint16_t    m_keyLength         = 0;
+    uint64_t    m_sequence          = 0;
+    uint64_t    m_payloadSize       = 0;    // size of the content this key resolves to, even if it isn't stored here
+    uint64_t    m_contentHash       = 0;
+    uint64_t    m_recordHash        = 0;    // over everything above plus the key, catches torn or garbage writes
+
+    ouro_nodiscard uint64_t computeHash( std::string_view key ) const
+    {
+        const uint64_t headerHash = base::hashBytes64( reinterpret_cast<const uint8_t*>( this ), offsetof( RecordHeader, m_recordHash ) );
+        return base::hashBytes64( reinterpret_cast<const uint8_t*>( key.data() ), key.size(), headerHash );
+    }
+
+    ouro_nodiscard uint64_t getRecordSize() const
+    {
+        return sizeof( RecordHeader ) + m_keyLength + ( m_type == RecordType::Blob ? m_payloadSize : 0 );
+    }
+};
+static_assert( sizeof( RecordHeader ) == 40 );
+
+struct IndexHeader
+{
+    uint32_t    m_magic             = IndexMagic;
+    uint32_t    m_formatVersion     = FormatVersion;
+    uint32_t    m_segmentCount      = 0;
+    uint32_t    m_blobCount         = 0;
+    uint64_t    m_keyCount          = 0;
+    uint64_t    m_nextSequence      = 0;
+    uint64_t    m_payloadHash       = 0;    // hashBytes64() of everything following this header
+    uint64_t    m_reserved          = 0;
+};
+static_assert( sizeof( IndexHeader ) == 48 );
+
+struct IndexSegment
+{
+    uint32_t    m_segmentIndex      = 0;
+    uint32_t    m_reserved          = 0;
+    uint64_t    m_coveredBytes      = 0;    // how much of the segment the index accounts for; anything after is scanned
+};
+static_assert( sizeof( IndexSegment ) == 16 );
+
+struct IndexBlob
+{
+    uint64_t    m_contentHash       = 0;
+    uint64_t    m_size              = 0;
+    uint64_t    m_payloadOffset     = 0;
+    uint32_t    m_segmentIndex      = 0;
+    uint32_t    m_reserved          = 0;
+};
+static_assert( sizeof( IndexBlob ) == 32 );
+
+struct IndexKey
+{
+    uint64_t    m_contentHash       = 0;
+    uint64_t    m_size              = 0;
+    uint64_t    m_sequence          = 0;
+    uint16_t    m_keyLength         = 0;    // key bytes follow this struct
+    uint8_t     m_removed           = 0;
+    uint8_t     m_reserved[5]       = {};
+};
+static_assert( sizeof( IndexKey ) == 32 );
+
+// ---------------------------------------------------------------------------------------------------------------------
+static fs::path getSegmentPath( const fs::path& packRoot, const uint32_t segmentIndex )
+{
+    return packRoot / fmt::format( FMTX( "{}{:06}{}" ), SegmentPrefix, segmentIndex, SegmentSuffix );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+static std::optional< uint32_t > parseSegmentFilename( const std::string& filename )
+{
+    if ( filename.size() <= SegmentPrefix.size() + SegmentSuffix.size() ||
+        !filename.starts_with( SegmentPrefix ) ||
+        !filename.ends_with( SegmentSuffix ) )
+        return std::nullopt;
+
+    const char* numberBegin = filename.data() + SegmentPrefix.size();
+    const char* numberEnd   = filename.data() + filename.size() - SegmentSuffix.size();
+
+    uint32_t segmentIndex = 0;
+    const auto parseResult = std::from_chars( numberBegin, numberEnd, segmentIndex );
+    if ( parseResult.ec != std::errc() || parseResult.ptr != numberEnd )
+        return std::nullopt;
+
+    return segmentIndex;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+static uint64_t roundUpToBlock( const uint64_t bytes )
+{
+    static constexpr uint64_t blockSize = 4096;
+    return ( bytes + blockSize - 1 ) & ~( blockSize - 1 );
+}
+
+} // namespace pack
+
+
+// ---------------------------------------------------------------------------------------------------------------------
+struct StemPack::State
+{
+    struct Segment
+    {
+        uint32_t                m_index     = 0;
+        fs::path                m_path;
+        xp::PositionalFile      m_reader;
+        uint64_t                m_size      = 0;    // bytes of valid records, ie. where the next append goes
+    };
+    using SegmentPtr = std::unique_ptr< Segment >;
+    using SegmentMap = std::map< uint32_t, SegmentPtr >;
+
+    struct SegmentWriter
+    {
+        std::ofstream           m_stream;
+        Segment*                m_segment   = nullptr;
+
+        void close()
+        {
+            if ( m_stream.is_open() )
+                m_stream.close();
+            m_segment = nullptr;
+        }
+    };
+
+    struct BlobLocation
+    {
+        uint32_t                m_segmentIndex  = 0;
+        uint64_t                m_payloadOffset = 0;
+        uint64_t                m_size          = 0;
+    };
+
+    struct KeyEntry
+    {
+        uint64_t                m_contentHash   = 0;
+        uint64_t                m_size          = 0;
+        uint64_t                m_sequence      = 0;
+        bool                    m_removed       = false;
+    };
+
+    using BlobMap   = absl::flat_hash_map< uint64_t, BlobLocation >;
+    using KeyMap    = absl::flat_hash_map< std::string, KeyEntry >;
+
+
+    ouro_nodiscard SegmentPtr createSegment( const uint32_t segmentIndex, SegmentWriter& writer ) const;
+    ouro_nodiscard bool appendRecord(
+        SegmentWriter& writer,
+        const pack::RecordType recordType,
+        std::string_view key,
+        const uint64_t sequence,
+        const uint64_t contentHash,
+        const uint64_t payloadSize,
+        const uint8_t* payload,
+        BlobLocation* blobLocation ) const;
+
+    // roll the main writer onto a fresh segment if there isn't one open or the current one is full
+    ouro_nodiscard bool ensureWriterFor( const uint64_t recordBytes );
+
+    ouro_nodiscard bool readBlob( const SegmentMap& segments, const BlobLocation& location, uint8_t* destination ) const;
+
+    void applyRecord( const pack::RecordHeader& header, std::string_view key, const BlobLocation* blobLocation );
+    ouro_nodiscard uint64_t scanSegment( Segment& segment, const uint64_t fromOffset, const uint64_t fileSize );
+
+    ouro_nodiscard bool loadIndex( absl::flat_hash_map< uint32_t, uint64_t >& coveredBytes );
+    void saveIndex() const;
+
+
+    fs::path                    m_packRoot;
+    bool                        m_open              = false;
+
+    mutable std::shared_mutex   m_lock;             // guards everything below; reads shared, writes exclusive
+    std::mutex                  m_compactLock;      // one compaction at a time
+    std::atomic_bool            m_compactCancel     = false;
+
+    SegmentMap                  m_segments;
+    SegmentWriter               m_writer;
+    uint32_t                    m_nextSegmentIndex  = 0;
+    uint64_t                    m_nextSequence      = 1;
+
+    BlobMap                     m_blobs;            // content hash -> where that content was written
+    KeyMap                      m_keys;             // key -> content, including removed keys so older records can't resurrect them
+
+    bool                        m_indexDirty        = false;
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+StemPack::State::SegmentPtr StemPack::State::createSegment( const uint32_t segmentIndex, SegmentWriter& writer ) const
+{
+    writer.close();
+
+    auto segment = std::make_unique< Segment >();
+    segment->m_index = segmentIndex;
+    segment->m_path  = pack::getSegmentPath( m_packRoot, segmentIndex );
+
+    writer.m_stream.open( segment->m_path, std::ios::out | std::ios::binary | std::ios::trunc );
+
+    const pack::SegmentHeader header{ .m_segmentIndex = segmentIndex };
+    writer.m_stream.write( reinterpret_cast<const char*>( &header ), sizeof( header ) );
+    writer.m_stream.flush();
+
+    if ( !writer.m_stream || !segment->m_reader.open( segment->m_path ) )
+    {
+        blog::error::cache( FMTX( "stem pack : unable to create segment [{}]" ), segment->m_path.string() );
+        writer.close();
+        return nullptr;
+    }
+
+    segment->m_size  = sizeof( header );
+    writer.m_segment = segment.get();
+
+    return segment;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+bool StemPack::State::appendRecord(
+    SegmentWriter& writer,
+    const pack::RecordType recordType,
+    std::string_view key,
+    const uint64_t sequence,
+    const uint64_t contentHash,
+    const uint64_t payloadSize,
+    const uint8_t* payload,
+    BlobLocation* blobLocation ) const
+{
+    ABSL_ASSERT( writer.m_segment != nullptr );
+    ABSL_ASSERT( key.size() <= pack::MaximumKeyLength );
+
+    pack::RecordHeader header;
+    header.m_type           = recordType;
+    header.m_keyLength      = static_cast<uint16_t>( key.size() );
+    header.m_sequence       = sequence;
+    header.m_payloadSize    = payloadSize;
+    header.m_contentHash    = contentHash;
+    header.m_recordHash     = header.computeHash( key );
+
+    writer.m_stream.write( reinterpret_cast<const char*>( &header ), sizeof( header ) );
+    writer.m_stream.write( key.data(), key.size() );
+    if ( recordType == pack::RecordType::Blob )
+        writer.m_stream.write( reinterpret_cast<const char*>( payload ), payloadSize );
+
+    // flush each record so readers (and a crash) only ever see whole records up to m_size
+    writer.m_stream.flush();
+
+    if ( !writer.m_stream )
+    {
+        // whatever made it to disk is a torn record; abandon this segment, the next append starts a fresh one
+        blog::error::cache( FMTX( "stem pack : write failed in [{}]" ), writer.m_segment->m_path.string() );
+        writer.close();
+        return false;
+    }
+
+    if ( blobLocation != nullptr )
+    {
+        blobLocation->m_segmentIndex  = writer.m_segment->m_index;
+        blobLocation->m_payloadOffset = writer.m_segment->m_size + sizeof( header ) + key.size();
+        blobLocation->m_size          = payloadSize;
+    }
+
+    writer.m_segment->m_size += header.getRecordSize();
+    return true;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+bool StemPack::State::ensureWriterFor( const uint64_t recordBytes )
+{
+    if ( m_writer.m_segment != nullptr )
+    {
+        const uint64_t currentSize = m_writer.m_segment->m_size;
+
+        // always allow at least one record per segment, however big it is
+        if ( currentSize == sizeof( pack::SegmentHeader ) || currentSize + recordBytes <= cSegmentTargetSize )
+            return true;
+    }
+
+    auto segment = createSegment( m_nextSegmentIndex, m_writer );
+    if ( segment == nullptr )
+        return false;
+
+    m_nextSegmentIndex++;
+    m_segments.emplace( segment->m_index, std::move( segment ) );
+    m_indexDirty = true;
+    return true;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+bool StemPack::State::readBlob( const SegmentMap& segments, const BlobLocation& location, uint8_t* destination ) const
+{
+    const auto segmentIt = segments.find( location.m_segmentIndex );
+    if ( segmentIt == segments.end() )
+        return false;
+
+    return segmentIt->second->m_reader.readAt( location.m_payloadOffset, destination, location.m_size );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void StemPack::State::applyRecord( const pack::RecordHeader& header, std::string_view key, const BlobLocation* blobLocation )
+{
+    // content stays addressable even if the key that introduced it has moved on, so it can still be deduplicated against
+    if ( blobLocation != nullptr )
+        m_blobs.try_emplace( header.m_contentHash, *blobLocation );
+
+    m_nextSequence = std::max( m_nextSequence, header.m_sequence + 1 );
+
+    auto [keyIt, inserted] = m_keys.try_emplace( std::string( key ) );
+    if ( !inserted && keyIt->second.m_sequence >= header.m_sequence )
+        return;
+
+    keyIt->second.m_contentHash = header.m_contentHash;
+    keyIt->second.m_size        = header.m_payloadSize;
+    keyIt->second.m_sequence    = header.m_sequence;
+    keyIt->second.m_removed     = ( header.m_type == pack::RecordType::Removal );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+// walk records from `fromOffset`, returning the end of the last whole, valid record found
+//
+uint64_t StemPack::State::scanSegment( Segment& segment, const uint64_t fromOffset, const uint64_t fileSize )
+{
+    uint64_t readOffset = fromOffset;
+    std::string key;
+
+    while ( readOffset + sizeof( pack::RecordHeader ) <= fileSize )
+    {
+        pack::RecordHeader header;
+        if ( !segment.m_reader.readAt( readOffset, &header, sizeof( header ) ) )
+            break;
+
+        if ( header.m_magic != pack::RecordMagic ||
+             header.m_keyLength == 0 ||
+             header.m_keyLength > pack::MaximumKeyLength ||
+             header.m_type > pack::RecordType::Removal )
+            break;
+
+        // check the record fits in the file before trusting the sizes in it
+        if ( readOffset + header.getRecordSize() > fileSize )
+            break;
+
+        key.resize( header.m_keyLength );
+        if ( !segment.m_reader.readAt( readOffset + sizeof( header ), key.data(), key.size() ) )
+            break;
+
+        if ( header.computeHash( key ) != header.m_recordHash )
+            break;
+
+        if ( header.m_type == pack::RecordType::Blob )
+        {
+            const BlobLocation blobLocation{
+                segment.m_index,
+                readOffset + sizeof( header ) + header.m_keyLength,
+                header.m_payloadSize };
+
+            applyRecord( header, key, &blobLocation );
+        }
+        else
+        {
+            applyRecord( header, key, nullptr );
+        }
+
+        readOffset += header.getRecordSize();
+    }
+
+    return readOffset;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+bool StemPack::State::loadIndex( absl::flat_hash_map< uint32_t, uint64_t >& coveredBytes )
+{
+    xp::MappedFile indexFile;
+    if ( !indexFile.open( m_packRoot / cIndexFilename ) )
+        return false;
+
+    const uint8_t* readPtr = indexFile.data();
+    const uint8_t* readEnd = indexFile.data() + indexFile.size();
+
+    if ( indexFile.size() < sizeof( pack::IndexHeader ) )
+        return false;
+
+    pack::IndexHeader header;
+    std::memcpy( &header, readPtr, sizeof( header ) );
+    readPtr += sizeof( header );
+
+    if ( header.m_magic != pack::IndexMagic || header.m_formatVersion != pack::FormatVersion )
+    {
+        blog::cache( FMTX( "stem pack : discarding index, format v{} vs v{}" ), header.m_formatVersion, pack::FormatVersion );
+        return false;
+    }
+
+    if ( base::hashBytes64( readPtr, (std::size_t)( readEnd - readPtr ) ) != header.m_payloadHash )
+    {
+        blog::error::cache( FMTX( "stem pack : discarding index, checksum mismatch" ) );
+        return false;
+    }
+
+    // bounds-checked copy out of the mapping
+    const auto readInto = [&]( void* destination, const std::size_t byteCount ) -> bool
+    {
+        if ( (std::size_t)( readEnd - readPtr ) < byteCount )
+            return false;
+        std::memcpy( destination, readPtr, byteCount );
+        readPtr += byteCount;
+        return true;
+    };
+
+    for ( uint32_t segmentIdx = 0; segmentIdx < header.m_segmentCount; segmentIdx++ )
+    {
+        pack::IndexSegment indexSegment;
+        if ( !readInto( &indexSegment, sizeof( indexSegment ) ) )
+            return false;
+
+        coveredBytes.emplace( indexSegment.m_segmentIndex, indexSegment.m_coveredBytes );
+    }
+
+    m_blobs.reserve( header.m_blobCount );
+    for ( uint32_t blobIdx = 0; blobIdx < header.m_blobCount; blobIdx++ )
+    {
+        pack::IndexBlob indexBlob;
+        if ( !readInto( &indexBlob, sizeof( indexBlob ) ) )
+            return false;
+
+        m_blobs.emplace( indexBlob.m_contentHash, BlobLocation{ indexBlob.m_segmentIndex, indexBlob.m_payloadOffset, indexBlob.m_size } );
+    }
+
+    m_keys.reserve( header.m_keyCount );
+    std::string key;
+    for ( uint64_t keyIdx = 0; keyIdx < header.m_keyCount; keyIdx++ )
+    {
+        pack::IndexKey indexKey;
+        if ( !readInto( &indexKey, sizeof( indexKey ) ) || indexKey.m_keyLength > pack::MaximumKeyLength )
+            return false;
+
+        key.resize( indexKey.m_keyLength );
+        if ( !readInto( key.data(), key.size() ) )
+            return false;
+
+        m_keys.emplace( key, KeyEntry{ indexKey.m_contentHash, indexKey.m_size, indexKey.m_sequence, indexKey.m_removed != 0 } );
+    }
+
+    m_nextSequence = header.m_nextSequence;
+    return readPtr == readEnd;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void StemPack::State::saveIndex() const
+{
+    std::vector< uint8_t > payload;
+    payload.reserve( ( m_segments.size() * sizeof( pack::IndexSegment ) ) +
+                     ( m_blobs.size() * sizeof( pack::IndexBlob ) ) +
+                     ( m_keys.size() * ( sizeof( pack::IndexKey ) + 48 ) ) );
+
+    const auto append = [&]( const void* source, const std::size_t byteCount )
+    {
+        const uint8_t* sourceBytes = static_cast<const uint8_t*>( source );
+        payload.insert( payload.end(), sourceBytes, sourceBytes + byteCount );
+    };
+
+    for ( const auto& [segmentIndex, segment] : m_segments )
+    {
+        const pack::IndexSegment indexSegment{ .m_segmentIndex = segmentIndex, .m_coveredBytes = segment->m_size };
+        append( &indexSegment, sizeof( indexSegment ) );
+    }
+    for ( const auto& [contentHash, location] : m_blobs )
+    {
+        const pack::IndexBlob indexBlob{
+            .m_contentHash      = contentHash,
+            .m_size             = location.m_size,
+            .m_payloadOffset    = location.m_payloadOffset,
+            .m_segmentIndex     = location.m_segmentIndex };
+        append( &indexBlob, sizeof( indexBlob ) );
+    }
+    for ( const auto& [key, entry] : m_keys )
+    {
+        const pack::IndexKey indexKey{
+            .m_contentHash  = entry.m_contentHash,
+            .m_size         = entry.m_size,
+            .m_sequence     = entry.m_sequence,
+            .m_keyLength    = static_cast<uint16_t>( key.size() ),
+            .m_removed      = static_cast<uint8_t>( entry.m_removed ? 1 : 0 ) };
+        append( &indexKey, sizeof( indexKey ) );
+        append( key.data(), key.size() );
+    }
+
+    pack::IndexHeader header;
+    header.m_segmentCount   = static_cast<uint32_t>( m_segments.size() );
+    header.m_blobCount      = static_cast<uint32_t>( m_blobs.size() );
+    header.m_keyCount       = m_keys.size();
+    header.m_nextSequence   = m_nextSequence;
+    header.m_payloadHash    = base::hashBytes64( payload.data(), payload.size() );
+
+    const fs::path indexFile = m_packRoot / cIndexFilename;
+    fs::path writeFile = indexFile;
+    writeFile += ".tmp";
+    {
+        std::basic_ofstream<char> ofs( writeFile, std::ios::out | std::ios::binary | std::ios::trunc );
+        ofs.write( reinterpret_cast<const char*>( &header ), sizeof( header ) );
+        ofs.write( reinterpret_cast<const char*>( payload.data() ), payload.size() );
+
+        if ( !ofs )
+        {
+            blog::error::cache( FMTX( "stem pack : unable to write index [{}]" ), writeFile.string() );
+            return;
+        }
+    }
+
+    std::error_code fileError;
+    fs::rename( writeFile, indexFile, fileError );
+    if ( fileError )
+        blog::error::cache( FMTX( "stem pack : unable to replace index [{}], {}" ), indexFile.string(), fileError.message() );
+}
+
+
+// ---------------------------------------------------------------------------------------------------------------------
+StemPack::StemPack()
+    : m_state( std::make_unique< State >() )
+{
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+StemPack::~StemPack()
+{
+    close();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+absl::Status StemPack::open( const fs::path& packRoot )
+{
+    close();
+
+    const auto packRootStatus = filesys::ensureDirectoryExists( packRoot );
+    if ( !packRootStatus.ok() )
+        return packRootStatus;
+
+    std::unique_lock< std::shared_mutex > stateLock( m_state->m_lock );
+
+    spacetime::Moment openTimer;
+
+    m_state->m_packRoot = packRoot;
+
+    // find all the segments on disk
+    std::error_code fileError;
+    for ( const auto& dirEntry : fs::directory_iterator( packRoot, fileError ) )
+    {
+        if ( !dirEntry.is_regular_file() )
+            continue;
+
+        const auto segmentIndex = pack::parseSegmentFilename( dirEntry.path().filename().string() );
+        if ( !segmentIndex.has_value() )
+            continue;
+
+        // never reuse an index, even for a segment we can't read
+        m_state->m_nextSegmentIndex = std::max( m_state->m_nextSegmentIndex, segmentIndex.value() + 1 );
+
+        auto segment = std::make_unique< State::Segment >();
+        segment->m_index = segmentIndex.value();
+        segment->m_path  = dirEntry.path();
+
+        pack::SegmentHeader segmentHeader;
+        if ( !segment->m_reader.open( segment->m_path ) ||
+             !segment->m_reader.readAt( 0, &segmentHeader, sizeof( segmentHeader ) ) ||
+             segmentHeader.m_magic != pack::SegmentMagic ||
+             segmentHeader.m_formatVersion != pack::FormatVersion ||
+             segmentHeader.m_segmentIndex != segment->m_index )
+        {
+            blog::error::cache( FMTX( "stem pack : ignoring unreadable segment [{}]" ), segment->m_path.string() );
+            continue;
+        }
+
+        m_state->m_segments.emplace( segment->m_index, std::move( segment ) );
+    }
+
+    // the index covers some prefix of each segment; it is only usable if every segment it mentions still holds at
+    // least that much data, otherwise rebuild from a full scan
+    absl::flat_hash_map< uint32_t, uint64_t > coveredBytes;
+    bool indexUsable = m_state->loadIndex( coveredBytes );
+    if ( indexUsable )
+    {
+        for ( const auto& [segmentIndex, covered] : coveredBytes )
+        {
+            const auto segmentIt = m_state->m_segments.find( segmentIndex );
+            if ( segmentIt == m_state->m_segments.end() ||
+                 fs::file_size( segmentIt->second->m_path, fileError ) < covered )
+            {
+                indexUsable = false;
+                break;
+            }
+        }
+    }
+    if ( !indexUsable )
+    {
+        coveredBytes.clear();
+        m_state->m_blobs.clear();
+        m_state->m_keys.clear();
+        m_state->m_nextSequence = 1;
+    }
+
+    // pick up anything the index doesn't know about
+    std::size_t segmentsScanned = 0;
+    for ( auto& [segmentIndex, segment] : m_state->m_segments )
+    {
+        const uint64_t fileSize = fs::file_size( segment->m_path, fileError );
+
+        const auto coveredIt = coveredBytes.find( segmentIndex );
+        const uint64_t scanFrom = ( coveredIt == coveredBytes.end() ) ? sizeof( pack::SegmentHeader ) : coveredIt->second;
+
+        if ( scanFrom < fileSize )
+        {
+            segment->m_size = m_state->scanSegment( *segment, scanFrom, fileSize );
+            segmentsScanned++;
+            m_state->m_indexDirty = true;
+
+            // most likely a record torn by a crash mid-write; trim it off so we don't trip over it every time we open
+            if ( segment->m_size < fileSize )
+            {
+                blog::error::cache( FMTX( "stem pack : [{}] has {} bytes of incomplete data after offset {}, discarding" ),
+                    segment->m_path.filename().string(),
+                    fileSize - segment->m_size,
+                    segment->m_size );
+
+                segment->m_reader.close();
+                fs::resize_file( segment->m_path, segment->m_size, fileError );
+                if ( !segment->m_reader.open( segment->m_path ) )
+                    blog::error::cache( FMTX( "stem pack : unable to reopen [{}]" ), segment->m_path.string() );
+            }
+        }
+        else
+        {
+            segment->m_size = scanFrom;
+        }
+    }
+
+    // drop any keys whose content never made it to disk
+    std::size_t danglingKeys = 0;
+    for ( auto& [key, entry] : m_state->m_keys )
+    {
+        if ( !entry.m_removed && !m_state->m_blobs.contains( entry.m_contentHash ) )
+        {
+            entry.m_removed = true;
+            danglingKeys++;
+        }
+    }
+    if ( danglingKeys > 0 )
+        blog::error::cache( FMTX( "stem pack : {} keys refer to missing content, dropped" ), danglingKeys );
+
+    // nothing is appended to existing segments, the first store() starts a fresh one; that way we never write
+    // after a tail that might be torn
+    m_state->m_open = true;
+
+    blog::cache( FMTX( "stem pack : opened [{}], {} segments, {} keys ({} index, {} segments scanned) in {}" ),
+        packRoot.string(),
+        m_state->m_segments.size(),
+        m_state->m_keys.size(),
+        indexUsable ? "using" : "rebuilt",
+        segmentsScanned,
+        openTimer.delta< std::chrono::milliseconds >() );
+
+    if ( m_state->m_indexDirty )
+    {
+        m_state->saveIndex();
+        m_state->m_indexDirty = false;
+    }
+
+    return absl::OkStatus();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void StemPack::close()
+{
+    // stop any compaction in progress rather than wait for it to finish
+    cancelCompaction();
+
+    std::scoped_lock< std::mutex > compactLock( m_state->m_compactLock );
+    std::unique_lock< std::shared_mutex > stateLock( m_state->m_lock );
+
+    m_state->m_compactCancel = false;
+
+    if ( !m_state->m_open )
+        return;
+
+    m_state->m_writer.close();
+
+    if ( m_state->m_indexDirty )
+        m_state->saveIndex();
+
+    m_state->m_segments.clear();
+    m_state->m_blobs.clear();
+    m_state->m_keys.clear();
+    m_state->m_nextSegmentIndex = 0;
+    m_state->m_nextSequence     = 1;
+    m_state->m_indexDirty       = false;
+    m_state->m_open             = false;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+bool StemPack::isOpen() const
+{
+    std::shared_lock< std::shared_mutex > stateLock( m_state->m_lock );
+    return m_state->m_open;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+std::optional< std::size_t > StemPack::getStoredSize( std::string_view key ) const
+{
+    std::shared_lock< std::shared_mutex > stateLock( m_state->m_lock );
+
+    const auto keyIt = m_state->m_keys.find( key );
+    if ( keyIt == m_state->m_keys.end() || keyIt->second.m_removed )
+        return std::nullopt;
+
+    return static_cast<std::size_t>( keyIt->second.m_size );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+bool StemPack::read( std::string_view key, uint8_t* destination, const std::size_t byteCount ) const
+{
+    uint64_t expectedHash = 0;
+    {
+        std::shared_lock< std::shared_mutex > stateLock( m_state->m_lock );
+
+        const auto keyIt = m_state->m_keys.find( key );
+        if ( keyIt == m_state->m_keys.end() || keyIt->second.m_removed || keyIt->second.m_size != byteCount )
+            return false;
+
+        const auto blobIt = m_state->m_blobs.find( keyIt->second.m_contentHash );
+        if ( blobIt == m_state->m_blobs.end() )
+            return false;
+
+        if ( !m_state->readBlob( m_state->m_segments, blobIt->second, destination ) )
+            return false;
+
+        expectedHash = keyIt->second.m_contentHash;
+    }
+
+    if ( base::hashBytes64( destination, byteCount ) != expectedHash )
+    {
+        blog::error::cache( FMTX( "stem pack : content hash mismatch reading [{}]" ), key );
+        return false;
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+bool StemPack::store( std::string_view key, const uint8_t* data, const std::size_t byteCount )
+{
+    if ( key.empty() || key.size() > pack::MaximumKeyLength )
+        return false;
+
+    const uint64_t contentHash = base::hashBytes64( data, byteCount );
+
+    std::unique_lock< std::shared_mutex > stateLock( m_state->m_lock );
+
+    if ( !m_state->m_open )
+        return false;
+
+    // already holding exactly this
+    const auto keyIt = m_state->m_keys.find( key );
+    if ( keyIt != m_state->m_keys.end() &&
+        !keyIt->second.m_removed &&
+         keyIt->second.m_contentHash == contentHash &&
+         keyIt->second.m_size == byteCount )
+        return true;
+
+    pack::RecordType recordType = pack::RecordType::Blob;
+
+    const auto blobIt = m_state->m_blobs.find( contentHash );
+    if ( blobIt != m_state->m_blobs.end() )
+    {
+        // confirm it really is the same data before pointing at it, rather than trusting the hash alone
+        bool contentMatches = ( blobIt->second.m_size == byteCount );
+        if ( contentMatches )
+        {
+            std::vector< uint8_t > existingContent( byteCount );
+            contentMatches = m_state->readBlob( m_state->m_segments, blobIt->second, existingContent.data() ) &&
+                             std::memcmp( existingContent.data(), data, byteCount ) == 0;
+        }
+
+        if ( !contentMatches )
+        {
+            blog::error::cache( FMTX( "stem pack : content hash collision storing [{}], not cached" ), key );
+            return false;
+        }
+
+        recordType = pack::RecordType::Reference;
+    }
+
+    const uint64_t recordBytes = sizeof( pack::RecordHeader ) + key.size() + ( recordType == pack::RecordType::Blob ? byteCount : 0 );
+    if ( !m_state->ensureWriterFor( recordBytes ) )
+        return false;
+
+    const uint64_t sequence = m_state->m_nextSequence++;
+
+    State::BlobLocation blobLocation;
+    if ( !m_state->appendRecord( m_state->m_writer, recordType, key, sequence, contentHash, byteCount, data, &blobLocation ) )
+        return false;
+
+    if ( recordType == pack::RecordType::Blob )
+        m_state->m_blobs.emplace( contentHash, blobLocation );
+
+    m_state->m_keys.insert_or_assign( std::string( key ), State::KeyEntry{ contentHash, byteCount, sequence, false } );
+    m_state->m_indexDirty = true;
+
+    return true;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+bool StemPack::remove( std::string_view key )
+{
+    std::unique_lock< std::shared_mutex > stateLock( m_state->m_lock );
+
+    if ( !m_state->m_open )
+        return false;
+
+    auto keyIt = m_state->m_keys.find( key );
+    if ( keyIt == m_state->m_keys.end() || keyIt->second.m_removed )
+        return true;
+
+    const uint64_t recordBytes = sizeof( pack::RecordHeader ) + key.size();
+    if ( !m_state->ensureWriterFor( recordBytes ) )
+        return false;
+
+    const uint64_t sequence = m_state->m_nextSequence++;
+    if ( !m_state->appendRecord( m_state->m_writer, pack::RecordType::Removal, key, sequence, 0, 0, nullptr, nullptr ) )
+        return false;
+
+    keyIt->second = State::KeyEntry{ 0, 0, sequence, true };
+    m_state->m_indexDirty = true;
+
+    return true;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+// copies live content out of the existing segments into new ones while reads and writes carry on against the old
+// set; new writes land in segments created after the snapshot, which compaction leaves alone. once the copy is
+// done everything is swapped over under the exclusive lock and the old segments are deleted
+//
+absl::Status StemPack::compact()
+{
+    std::scoped_lock< std::mutex > compactLock( m_state->m_compactLock );
+
+    // a cancel only applies to the compaction it was aimed at (or the next one, if none was running)
+    absl::Cleanup resetCancel = [this] { m_state->m_compactCancel = false; };
+
+    spacetime::Moment compactTimer;
+
+    struct LiveKey
+    {
+        std::string         m_key;
+        State::KeyEntry     m_entry;
+    };
+    // keys grouped by the content they point at, so each piece of content is copied once
+    absl::flat_hash_map< uint64_t, std::vector< LiveKey > > liveContent;
+    absl::flat_hash_set< uint32_t > oldSegments;
+    uint64_t bytesBefore = 0;
+    {
+        std::unique_lock< std::shared_mutex > stateLock( m_state->m_lock );
+
+        if ( !m_state->m_open )
+            return absl::FailedPreconditionError( "stem pack is not open" );
+
+        for ( const auto& [key, entry] : m_state->m_keys )
+        {
+            if ( !entry.m_removed )
+                liveContent[entry.m_contentHash].emplace_back( key, entry );
+        }
+        for ( const auto& [segmentIndex, segment] : m_state->m_segments )
+        {
+            oldSegments.emplace( segmentIndex );
+            bytesBefore += segment->m_size;
+        }
+
+        // stop appending to the current segment so nothing written from here on lands in the old set
+        m_state->m_writer.close();
+    }
+
+    State::SegmentMap newSegments;
+    State::SegmentWriter compactWriter;
+    State::BlobMap newBlobs;
+
+    // take a new segment index under the lock, as writers are allocating them too
+    const auto startCompactSegment = [&]() -> bool
+    {
+        uint32_t segmentIndex;
+        {
+            std::unique_lock< std::shared_mutex > stateLock( m_state->m_lock );
+            segmentIndex = m_state->m_nextSegmentIndex++;
+        }
+        auto segment = m_state->createSegment( segmentIndex, compactWriter );
+        if ( segment == nullptr )
+            return false;
+
+        newSegments.emplace( segmentIndex, std::move( segment ) );
+        return true;
+    };
+    const auto ensureCompactWriterFor = [&]( const uint64_t recordBytes ) -> bool
+    {
+        if ( compactWriter.m_segment != nullptr )
+        {
+            const uint64_t currentSize = compactWriter.m_segment->m_size;
+            if ( currentSize == sizeof( pack::SegmentHeader ) || currentSize + recordBytes <= cSegmentTargetSize )
+                return true;
+        }
+        return startCompactSegment();
+    };
+    // write one piece of content plus every key pointing at it; the first key carries the data, the others reference it
+    const auto copyContent = [&]( const uint64_t contentHash, const std::vector< LiveKey >& keys, const uint8_t* content ) -> bool
+    {
+        for ( std::size_t keyIdx = 0; keyIdx < keys.size(); keyIdx++ )
+        {
+            const LiveKey& liveKey = keys[keyIdx];
+            const bool writeContent = ( keyIdx == 0 );
+
+            const uint64_t recordBytes = sizeof( pack::RecordHeader ) + liveKey.m_key.size() + ( writeContent ? liveKey.m_entry.m_size : 0 );
+            if ( !ensureCompactWriterFor( recordBytes ) )
+                return false;
+
+            State::BlobLocation blobLocation;
+            if ( !m_state->appendRecord(
+                    compactWriter,
+                    writeContent ? pack::RecordType::Blob : pack::RecordType::Reference,
+                    liveKey.m_key,
+                    liveKey.m_entry.m_sequence,
+                    contentHash,
+                    liveKey.m_entry.m_size,
+                    content,
+                    writeContent ? &blobLocation : nullptr ) )
+                return false;
+
+            if ( writeContent )
+                newBlobs.emplace( contentHash, blobLocation );
+        }
+        return true;
+    };
+    const auto abandonCompaction = [&]( const absl::Status& reason ) -> absl::Status
+    {
+        compactWriter.close();
+        for ( const auto& [segmentIndex, segment] : newSegments )
+        {
+            segment->m_reader.close();
+
+            std::error_code fileError;
+            fs::remove( segment->m_path, fileError );
+        }
+        return reason;
+    };
+
+    // copy phase; only reads of the old segments need the lock
+    std::vector< uint8_t > contentBuffer;
+    for ( const auto& [contentHash, keys] : liveContent )
+    {
+        if ( m_state->m_compactCancel )
+            return abandonCompaction( absl::CancelledError( "stem pack compaction cancelled" ) );
+        {
+            std::shared_lock< std::shared_mutex > stateLock( m_state->m_lock );
+
+            const auto blobIt = m_state->m_blobs.find( contentHash );
+            if ( blobIt == m_state->m_blobs.end() )
+                continue;
+
+            contentBuffer.resize( blobIt->second.m_size );
+            if ( !m_state->readBlob( m_state->m_segments, blobIt->second, contentBuffer.data() ) )
+                return abandonCompaction( absl::InternalError( "unable to read existing content" ) );
+        }
+
+        if ( !copyContent( contentHash, keys, contentBuffer.data() ) )
+            return abandonCompaction( absl::InternalError( "unable to write new segment" ) );
+    }
+
+    // swap phase
+    std::unique_lock< std::shared_mutex > stateLock( m_state->m_lock );
+
+    // anything that was written (or deduplicated against old content) while we were copying, and still needs
+    // data out of the old set, gets copied across now
+    for ( const auto& [key, entry] : m_state->m_keys )
+    {
+        if ( entry.m_removed || newBlobs.contains( entry.m_contentHash ) )
+            continue;
+
+        const auto blobIt = m_state->m_blobs.find( entry.m_contentHash );
+        if ( blobIt == m_state->m_blobs.end() || !oldSegments.contains( blobIt->second.m_segmentIndex ) )
+            continue;
+
+        contentBuffer.resize( blobIt->second.m_size );
+        if ( !m_state->readBlob( m_state->m_segments, blobIt->second, contentBuffer.data() ) ||
+             !copyContent( entry.m_contentHash, { LiveKey{ key, entry } }, contentBuffer.data() ) )
+        {
+            stateLock.unlock();
+            return abandonCompaction( absl::InternalError( "unable to copy late writes" ) );
+        }
+    }
+    compactWriter.close();
+
+    // rebuild the content map from the new segments plus anything written since the snapshot
+    for ( auto blobIt = m_state->m_blobs.begin(); blobIt != m_state->m_blobs.end(); )
+    {
+        if ( oldSegments.contains( blobIt->second.m_segmentIndex ) )
+            m_state->m_blobs.erase( blobIt++ );
+        else
+            ++blobIt;
+    }
+    for ( const auto& [contentHash, location] : newBlobs )
+        m_state->m_blobs.insert_or_assign( contentHash, location );
+
+    // removed keys only need remembering while an older record for them might still be on disk, which is no
+    // longer the case for anything removed before the snapshot; later removals are still recorded in a newer segment
+    for ( auto keyIt = m_state->m_keys.begin(); keyIt != m_state->m_keys.end(); )
+    {
+        if ( keyIt->second.m_removed )
+            m_state->m_keys.erase( keyIt++ );
+        else
+            ++keyIt;
+    }
+
+    std::vector< fs::path > deadSegments;
+    for ( const uint32_t segmentIndex : oldSegments )
+    {
+        auto segmentIt = m_state->m_segments.find( segmentIndex );
+        if ( segmentIt == m_state->m_segments.end() )
+            continue;
+
+        segmentIt->second->m_reader.close();
+        deadSegments.emplace_back( segmentIt->second->m_path );
+        m_state->m_segments.erase( segmentIt );
+    }
+    for ( auto& [segmentIndex, segment] : newSegments )
+        m_state->m_segments.emplace( segmentIndex, std::move( segment ) );
+
+    // index first; if we die before the deletes below, the leftovers are scanned, lose on sequence number and get
+    // cleaned up by the next compaction
+    m_state->saveIndex();
+    m_state->m_indexDirty = false;
+
+    for ( const auto& deadSegment : deadSegments )
+    {
+        std::error_code fileError;
+        fs::remove( deadSegment, fileError );
+        if ( fileError )
+            blog::error::cache( FMTX( "stem pack : unable to remove old segment [{}], {}" ), deadSegment.string(), fileError.message() );
+    }
+
+    uint64_t bytesAfter = 0;
+    for ( const auto& [segmentIndex, segment] : m_state->m_segments )
+        bytesAfter += segment->m_size;
+
+    blog::cache( FMTX( "stem pack : compacted {} segments into {}, {} -> {} bytes, took {}" ),
+        deadSegments.size(),
+        newSegments.size(),
+        bytesBefore,
+        bytesAfter,
+        compactTimer.delta< std::chrono::milliseconds >() );
+
+    return absl::OkStatus();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void StemPack::cancelCompaction()
+{
+    m_state->m_compactCancel = true;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+StemPack::Statistics StemPack::getStatistics() const
+{
+    std::shared_lock< std::shared_mutex > stateLock( m_state->m_lock );
+
+    Statistics result;
+    result.m_segmentCount = m_state->m_segments.size();
+
+    for ( const auto& [segmentIndex, segment] : m_state->m_segments )
+        result.m_segmentBytes += segment->m_size;
+
+    absl::flat_hash_set< uint64_t > liveContent;
+    uint64_t keyBytes = 0;
+    for ( const auto& [key, entry] : m_state->m_keys )
+    {
+        if ( entry.m_removed )
+            continue;
+
+        result.m_keyCount++;
+        keyBytes += entry.m_size;
+
+        if ( liveContent.emplace( entry.m_contentHash ).second )
+            result.m_liveBytes += entry.m_size;
+    }
+    result.m_uniqueBlobCount = liveContent.size();
+    result.m_dedupedBytes    = keyBytes - result.m_liveBytes;
+
+    return result;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+StemPack::LayoutBenchmark StemPack::benchmarkAgainstLooseFiles( const fs::path& scratchPath, const std::size_t stemCount, const std::size_t stemBytes )
+{
+    LayoutBenchmark result;
+    result.m_stemCount = stemCount;
+
+    const fs::path benchmarkRoot = scratchPath / "ouro.stem.pack.benchmark";
+    const fs::path looseRoot     = benchmarkRoot / "loose";
+    const fs::path packRoot      = benchmarkRoot / "pack";
+
+    std::error_code fileError;
+    fs::remove_all( benchmarkRoot, fileError );
+
+    struct SyntheticStem
+    {
+        endlesss::types::JamCouchID     m_jam;
+        endlesss::types::StemCouchID    m_stem;
+        uint32_t                        m_contentSeed;
+        std::size_t                     m_contentBytes;
+    };
+    std::vector< SyntheticStem > stems;
+    stems.reserve( stemCount );
+
+    // fixed seed so runs are comparable; around 200 stems per jam, and 1 in 10 stems reuses earlier content, as
+    // happens when the same audio gets committed more than once
+    {
+        std::mt19937 rng( 0x57E3CAC4 );
+        std::uniform_int_distribution< std::size_t > sizeDist( stemBytes / 2, stemBytes + ( stemBytes / 2 ) );
+
+        const std::size_t jamCount = std::max< std::size_t >( 1, stemCount / 200 );
+
+        for ( std::size_t stemIdx = 0; stemIdx < stemCount; stemIdx++ )
+        {
+            SyntheticStem stem;
+            stem.m_jam  = endlesss::types::JamCouchID( fmt::format( FMTX( "band{:010x}" ), stemIdx % jamCount ) );
+            stem.m_stem = endlesss::types::StemCouchID( fmt::format( FMTX( "{:08x}{:08x}{:08x}{:08x}" ), rng(), rng(), rng(), rng() ) );
+
+            if ( stemIdx > 0 && ( rng() % 10 ) == 0 )
+            {
+                const auto& original = stems[rng() % stems.size()];
+                stem.m_contentSeed  = original.m_contentSeed;
+                stem.m_contentBytes = original.m_contentBytes;
+            }
+            else
+            {
+                stem.m_contentSeed  = static_cast<uint32_t>( stemIdx );
+                stem.m_contentBytes = sizeDist( rng );
+                result.m_uniqueStemCount++;
+            }
+            stems.emplace_back( std::move( stem ) );
+        }
+    }
+
+    const auto generateContent = []( const SyntheticStem& stem, std::vector< uint8_t >& content )
+    {
+        content.resize( stem.m_contentBytes );
+
+        std::mt19937 contentRng( stem.m_contentSeed );
+        for ( auto& byte : content )
+            byte = static_cast<uint8_t>( contentRng() );
+    };
+
+    // write both layouts
+    std::vector< uint8_t > content;
+    {
+        StemPack writePack;
+        if ( !writePack.open( packRoot ).ok() )
+            return result;
+
+        for ( const auto& stem : stems )
+        {
+            generateContent( stem, content );
+
+            const fs::path stemDirectory = Stems::getCachePathForStemData( looseRoot, stem.m_jam, stem.m_stem );
+            if ( !filesys::ensureDirectoryExists( stemDirectory ).ok() )
+                return result;
+            {
+                std::basic_ofstream<char> ofs( stemDirectory / stem.m_stem.value(), std::ios::out | std::ios::binary );
+                ofs.write( reinterpret_cast<const char*>( content.data() ), content.size() );
+            }
+
+            if ( !writePack.store( stem.m_stem.value(), content.data(), content.size() ) )
+                return result;
+        }
+    }
+
+    const auto tallyFiles = []( const fs::path& root, std::size_t& fileCount, uint64_t& allocatedBytes )
+    {
+        std::error_code walkError;
+        for ( const auto& dirEntry : fs::recursive_directory_iterator( root, walkError ) )
+        {
+            if ( dirEntry.is_regular_file() )
+            {
+                fileCount++;
+                allocatedBytes += pack::roundUpToBlock( dirEntry.file_size() );
+            }
+        }
+    };
+    tallyFiles( looseRoot, result.m_looseFileCount, result.m_looseAllocatedBytes );
+    tallyFiles( packRoot,  result.m_packFileCount,  result.m_packAllocatedBytes );
+
+    // note that we can't drop the OS file cache from here, so these are warm-cache numbers; the loose layout's
+    // directory walk only gets worse from a truly cold start, or over a network share
+    std::vector< std::size_t > sampleIndices;
+    {
+        std::mt19937 rng( 0x0DDBA11 );
+        for ( std::size_t sampleIdx = 0; sampleIdx < std::min< std::size_t >( 256, stemCount ); sampleIdx++ )
+            sampleIndices.emplace_back( rng() % stemCount );
+    }
+
+    // reads are kept and checked after timing, as regenerating the expected content is slower than reading it
+    bool allMatched = true;
+    std::vector< std::vector< uint8_t > > readBack( sampleIndices.size() );
+    const auto checkReadBack = [&]()
+    {
+        for ( std::size_t sampleIdx = 0; sampleIdx < sampleIndices.size(); sampleIdx++ )
+        {
+            generateContent( stems[sampleIndices[sampleIdx]], content );
+            allMatched &= ( readBack[sampleIdx] == content );
+        }
+    };
+    {
+        spacetime::Moment openTimer;
+
+        std::size_t stemsFound = 0;
+        std::error_code walkError;
+        for ( const auto& dirEntry : fs::recursive_directory_iterator( looseRoot, walkError ) )
+        {
+            if ( dirEntry.is_regular_file() )
+                stemsFound++;
+        }
+        result.m_looseOpenMs = (double)openTimer.delta< std::chrono::microseconds >().count() / 1000.0;
+
+        allMatched &= ( stemsFound == stemCount );
+
+        spacetime::Moment readTimer;
+        for ( std::size_t sampleIdx = 0; sampleIdx < sampleIndices.size(); sampleIdx++ )
+        {
+            const auto& stem = stems[sampleIndices[sampleIdx]];
+            const fs::path stemFile = Stems::getCachePathForStemData( looseRoot, stem.m_jam, stem.m_stem ) / stem.m_stem.value();
+
+            auto& readBuffer = readBack[sampleIdx];
+            readBuffer.resize( (std::size_t)fs::file_size( stemFile, fileError ) );
+
+            std::basic_ifstream<char> ifs( stemFile, std::ios::in | std::ios::binary );
+            ifs.read( reinterpret_cast<char*>( readBuffer.data() ), readBuffer.size() );
+        }
+        result.m_looseReadMs = (double)readTimer.delta< std::chrono::microseconds >().count() / 1000.0;
+
+        checkReadBack();
+    }
+    {
+        spacetime::Moment openTimer;
+
+        StemPack readPack;
+        const bool packOpened = readPack.open( packRoot ).ok();
+        result.m_packOpenMs = (double)openTimer.delta< std::chrono::microseconds >().count() / 1000.0;
+
+        allMatched &= packOpened && ( readPack.getStatistics().m_keyCount == stemCount );
+
+        spacetime::Moment readTimer;
+        for ( std::size_t sampleIdx = 0; sampleIdx < sampleIndices.size(); sampleIdx++ )
+        {
+            const auto& stem = stems[sampleIndices[sampleIdx]];
+
+            const auto storedSize = readPack.getStoredSize( stem.m_stem.value() );
+
+            auto& readBuffer = readBack[sampleIdx];
+            readBuffer.resize( storedSize.value_or( 0 ) );
+
+            allMatched &= storedSize.has_value() && readPack.read( stem.m_stem.value(), readBuffer.data(), readBuffer.size() );
+        }
+        result.m_packReadMs = (double)readTimer.delta< std::chrono::microseconds >().count() / 1000.0;
+
+        checkReadBack();
+    }
+    result.m_resultsMatch = allMatched;
+
+    fs::remove_all( benchmarkRoot, fileError );
+
+    return result;
+}
+
+} // namespace cache
+} // namespace endlesss
@@ -0,0 +1,114 @@
+//   _______ _______ ______ _______ ___ ___ _______ _______ _______ 
+//  |       |   |   |   __ \       |   |   |    ___|       |    |  |
+//  |   -   |   |   |      <   -   |   |   |    ___|   -   |       |
+//  |_______|_______|___|__|_______|\_____/|_______|_______|__|____|
+//  \\ harry denholm \\ ishani            ishani.org/shelf/ouroveon/
+//
+//  
+//
+
+#pragma once
+
+#include "base/construction.h"
+
+namespace endlesss {
+namespace cache {
+
+// ---------------------------------------------------------------------------------------------------------------------
+// optional backend for the stem cache that keeps stem audio (and analysis sidecars) in a handful of large append-only
+// segment files instead of one small file per stem; a big cache otherwise runs to millions of files, which is slow to
+// walk, slow to rsync and can exhaust inodes on shared volumes.
+//
+// each record in a segment carries its key (the stem couch ID, or a derived key for sidecar data), a content hash
+// and - if that content hasn't been seen before - the payload itself. identical content stored under several keys is
+// only written once. the newest record for a key wins, so overwrites and removals are just more appends; compact()
+// rewrites the live data into fresh segments to reclaim the space left behind.
+//
+// an index snapshot is written on close / compaction so opening a large pack is a single read; anything appended
+// after the snapshot (eg. following a crash) is recovered by scanning the segment tails the snapshot doesn't cover
+//
+struct StemPack
+{
+    DECLARE_NO_COPY_NO_MOVE( StemPack );
+
+    static constexpr auto       cPackDirectory      = "stem_pack";      // relative to the cache root
+    static constexpr auto       cIndexFilename      = "pack.index";
+    static constexpr uint64_t   cSegmentTargetSize  = 256 * 1024 * 1024;
+
+    struct Statistics
+    {
+        std::size_t     m_segmentCount      = 0;
+        std::size_t     m_keyCount          = 0;
+        std::size_t     m_uniqueBlobCount   = 0;
+        uint64_t        m_segmentBytes      = 0;    // total size of all segment files
+        uint64_t        m_liveBytes         = 0;    // payload bytes still reachable from a key
+        uint64_t        m_dedupedBytes      = 0;    // payload bytes we didn't write thanks to content hashing
+
+        ouro_nodiscard uint64_t getReclaimableBytes() const { return m_segmentBytes > m_liveBytes ? m_segmentBytes - m_liveBytes : 0; }
+    };
+
+    StemPack();
+    ~StemPack();
+
+    // open (or create) the pack rooted at `packRoot`
+    absl::Status open( const fs::path& packRoot );
+
+    // write the index snapshot and release all file handles
+    void close();
+
+    ouro_nodiscard bool isOpen() const;
+
+    // size of the payload stored under `key`, or nullopt if there isn't one
+    ouro_nodiscard std::optional< std::size_t > getStoredSize( std::string_view key ) const;
+
+    // read the payload for `key`; `byteCount` must match getStoredSize(). the content hash is checked on the way out,
+    // returns false if the key is missing or the data doesn't match what was written
+    ouro_nodiscard bool read( std::string_view key, uint8_t* destination, const std::size_t byteCount ) const;
+
+    // store (or replace) the payload for `key`
+    ouro_nodiscard bool store( std::string_view key, const uint8_t* data, const std::size_t byteCount );
+
+    // drop `key` from the pack; space is reclaimed on the next compact()
+    ouro_nodiscard bool remove( std::string_view key );
+
+    // rewrite every live payload into fresh segments and delete the old ones; reads and writes carry on while it runs
+    absl::Status compact();
+
+    // ask a running compact() to give up at the next piece of content; the pack is left as it was before it started
+    void cancelCompaction();
+
+    ouro_nodiscard Statistics getStatistics() const;
+
+
+    // results of storing the same synthetic stems as loose files in the stem_v2 layout and in a pack
+    struct LayoutBenchmark
+    {
+        std::size_t     m_stemCount             = 0;
+        std::size_t     m_uniqueStemCount       = 0;
+
+        std::size_t     m_looseFileCount        = 0;
+        uint64_t        m_looseAllocatedBytes   = 0;    // file sizes rounded up to whole 4k blocks
+        double          m_looseOpenMs           = 0;    // walk the directory tree to enumerate every stem
+        double          m_looseReadMs           = 0;    // read a random sample of stems
+
+        std::size_t     m_packFileCount         = 0;
+        uint64_t        m_packAllocatedBytes    = 0;
+        double          m_packOpenMs            = 0;    // open the pack, loading the index
+        double          m_packReadMs            = 0;
+
+        bool            m_resultsMatch          = false;
+
+        ouro_nodiscard bool passed() const { return m_resultsMatch && m_packOpenMs < m_looseOpenMs; }
+    };
+    // write `stemCount` synthetic stems of around `stemBytes` each (with a proportion of duplicate content) into
+    // `scratchPath` in both layouts, then time reopening and reading a sample back; scratch data is removed afterwards
+    static LayoutBenchmark benchmarkAgainstLooseFiles( const fs::path& scratchPath, const std::size_t stemCount, const std::size_t stemBytes );
+
+private:
+
+    struct State;
+    std::unique_ptr< State >    m_state;
+};
+
+} // namespace cache
+} // namespace endlesss
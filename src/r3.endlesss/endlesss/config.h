@@ -105,6 +105,9 @@ OURO_CONFIG( rAPI )
     int32_t                 networkRequestRetryLimitDefault = 2;        // for LAN broadband / stable connections
     int32_t                 networkRequestRetryLimitUnstable = 5;       // for 4G / less reliable connections
 
+    // upper bound on how many requests bulk operations (eg. the jam list rebuild) will have in flight at once
+    int32_t                 networkConcurrentRequestLimit = 8;
+
 
 
     // BEHAVIOURAL HACKS
@@ -145,6 +148,7 @@ OURO_CONFIG( rAPI )
                , CEREAL_OPTIONAL_NVP( networkTimeoutInSecondsUnstable )
                , CEREAL_OPTIONAL_NVP( networkRequestRetryLimitDefault )
                , CEREAL_OPTIONAL_NVP( networkRequestRetryLimitUnstable )
+               , CEREAL_OPTIONAL_NVP( networkConcurrentRequestLimit )
                , CEREAL_OPTIONAL_NVP( hackAllowStemSizeMismatch )
                , CEREAL_OPTIONAL_NVP( debugVerboseNetLog )
                , CEREAL_OPTIONAL_NVP( debugVerboseNetDataCapture )
@@ -16,6 +16,9 @@
 #include "endlesss/cache.stems.h"
 #include "endlesss/api.h"
 
+// r8brain
+#include "CDSPResampler.h"
+
 using namespace date;
 using namespace std::chrono;
 
@@ -147,8 +150,9 @@ void Riff::fetch( services::RiffFetchProvider& services )
 
                 endlesss::live::Stem* loopStemRaw = loopStemPtr.get();
 
-                // if this was a fresh stem, enqueue it for loading via task graph
-                if ( loopStemRaw->m_state == endlesss::live::Stem::State::Empty )
+                // if this was a fresh stem, enqueue it for loading via task graph; if someone else (another riff, the
+                // prefetcher) already has it, we wait for their work to land after our own loading is done
+                if ( loopStemRaw->claimFetch() )
                 {
                     stemLoadFlow.emplace( [&stemData, &services, loopStemRaw]()
                     {
@@ -173,6 +177,12 @@ void Riff::fetch( services::RiffFetchProvider& services )
         auto stemLoadFuture = services->getTaskExecutor().run( stemLoadFlow );
         stemLoadFuture.wait();
 
+        for ( endlesss::live::Stem* rawStem : m_stemPtrs )
+        {
+            if ( rawStem != nullptr )
+                rawStem->waitForFetch();
+        }
+
         // with data loaded, enqueue the post-process analysis tasks; shift ownership of the graph and return
         // a future that all stems can wait() on pre-destruction to ensure the underlying data isn't tossed before the tasks complete
         std::shared_future<void> stemSharedAnalysis( services->getTaskExecutor().run( std::move(stemAnalysisFlow) ) );
@@ -270,9 +280,163 @@ void Riff::fetch( services::RiffFetchProvider& services )
     m_syncState = SyncState::Failed;
 }
 
+namespace {
+
 // ---------------------------------------------------------------------------------------------------------------------
-void Riff::exportToDisk( const streamProcessorFactoryFn& diskWriterForStem, const int32_t sampleOffset )
+// everything needed to render one stem out to its writer, independently of any other
+struct StemExportJob
 {
+    const Stem*                         m_stem          = nullptr;
+    StemSlab::Ptr                       m_samples;          // float data if the stem still has it, otherwise read via StemReader
+    ssp::SampleStreamProcessorInstance  m_writer;
+    uint32_t                            m_sampleRate    = 0;
+    float                               m_timeStretch   = 1.0f;
+    float                               m_gain          = 1.0f;
+    int32_t                             m_sampleOffset  = 0;
+};
+
+// stream a stem out to disk in fixed-size chunks; the stem is read as a loop starting from the offset, time-scaled
+// through r8brain where needed, so nothing stem-sized is ever allocated here
+void renderStemForExport( StemExportJob& job )
+{
+    static constexpr int32_t SourceChunkFrames = 4096;
+    static constexpr int32_t OutputChunkFrames = 16384;
+
+    const int32_t sampleCount = job.m_stem->m_sampleCount;
+    if ( sampleCount <= 0 )
+        return;
+
+    const double  timeStretch       = static_cast<double>( job.m_timeStretch );
+    const int32_t outputSampleCount = static_cast<int32_t>( static_cast<double>( sampleCount ) / timeStretch );
+
+    // where in the loop the export begins, wrapped into range
+    int64_t readPosition = static_cast<int64_t>( static_cast<double>( job.m_sampleOffset ) * timeStretch ) % sampleCount;
+    if ( readPosition < 0 )
+        readPosition += sampleCount;
+
+    // untouched stems go straight from the shared samples to the writer; writers only read from what they are given.
+    // still fed in output-sized chunks, to keep each hand-off to the writer's buffering the same size as below
+    if ( job.m_samples != nullptr &&
+         job.m_timeStretch == 1.0f &&
+         job.m_gain == 1.0f &&
+         readPosition == 0 )
+    {
+        float* samplesLeft  = const_cast<float*>( job.m_samples->getChannel( 0 ).data() );
+        float* samplesRight = const_cast<float*>( job.m_samples->getChannel( 1 ).data() );
+
+        for ( int32_t chunkStart = 0; chunkStart < sampleCount; chunkStart += OutputChunkFrames )
+        {
+            const int32_t chunkFrames = std::min( OutputChunkFrames, sampleCount - chunkStart );
+            job.m_writer->appendSamples( samplesLeft + chunkStart, samplesRight + chunkStart, static_cast<uint32_t>( chunkFrames ) );
+        }
+        return;
+    }
+
+    // time-scaling is resampling the stem from (rate * stretch) down to the output rate
+    std::array< std::unique_ptr< r8b::CDSPResampler24 >, 2 > resamplers;
+    if ( job.m_timeStretch != 1.0f )
+    {
+        for ( auto& resampler : resamplers )
+        {
+            resampler = std::make_unique< r8b::CDSPResampler24 >(
+                static_cast<double>( job.m_sampleRate ) * timeStretch,
+                static_cast<double>( job.m_sampleRate ),
+                SourceChunkFrames );
+        }
+    }
+
+    std::array< double*, 2 > sourceChunk = { mem::alloc16<double>( SourceChunkFrames ), mem::alloc16<double>( SourceChunkFrames ) };
+    std::array< float*,  2 > outputChunk = { mem::alloc16<float>( OutputChunkFrames ),  mem::alloc16<float>( OutputChunkFrames ) };
+    absl::Cleanup releaseChunks = [&]
+    {
+        for ( std::size_t channel = 0; channel < 2; channel++ )
+        {
+            mem::free16( sourceChunk[channel] );
+            mem::free16( outputChunk[channel] );
+        }
+    };
+
+    std::span< const float > samplesLeft, samplesRight;
+    if ( job.m_samples != nullptr )
+    {
+        samplesLeft  = job.m_samples->getChannel( 0 );
+        samplesRight = job.m_samples->getChannel( 1 );
+    }
+    StemReader stemReader;
+
+    int32_t outputWritten   = 0;
+    int32_t outputChunkFill = 0;
+
+    const auto flushOutput = [&]()
+    {
+        if ( outputChunkFill > 0 )
+        {
+            job.m_writer->appendSamples( outputChunk[0], outputChunk[1], static_cast<uint32_t>( outputChunkFill ) );
+            outputWritten  += outputChunkFill;
+            outputChunkFill = 0;
+        }
+    };
+    const auto emitOutput = [&]( const double* left, const double* right, int32_t frames )
+    {
+        frames = std::min( frames, outputSampleCount - ( outputWritten + outputChunkFill ) );
+        for ( int32_t s = 0; s < frames; s++ )
+        {
+            outputChunk[0][outputChunkFill] = static_cast<float>( left[s]  ) * job.m_gain;
+            outputChunk[1][outputChunkFill] = static_cast<float>( right[s] ) * job.m_gain;
+
+            if ( ++outputChunkFill == OutputChunkFrames )
+                flushOutput();
+        }
+    };
+
+    while ( outputWritten + outputChunkFill < outputSampleCount )
+    {
+        // pull the next run of the source loop, wrapping around as often as needed
+        for ( int32_t s = 0; s < SourceChunkFrames; s++ )
+        {
+            float sampleLeft, sampleRight;
+            if ( !samplesLeft.empty() )
+            {
+                sampleLeft  = samplesLeft[readPosition];
+                sampleRight = samplesRight[readPosition];
+            }
+            else
+            {
+                stemReader.read( job.m_stem->getStorage(), readPosition, sampleLeft, sampleRight );
+            }
+            sourceChunk[0][s] = sampleLeft;
+            sourceChunk[1][s] = sampleRight;
+
+            if ( ++readPosition == sampleCount )
+                readPosition = 0;
+        }
+
+        if ( resamplers[0] != nullptr )
+        {
+            double* resampledLeft  = nullptr;
+            double* resampledRight = nullptr;
+            const int32_t resampled = resamplers[0]->process( sourceChunk[0], SourceChunkFrames, resampledLeft );
+                                      resamplers[1]->process( sourceChunk[1], SourceChunkFrames, resampledRight );
+
+            emitOutput( resampledLeft, resampledRight, resampled );
+        }
+        else
+        {
+            emitOutput( sourceChunk[0], sourceChunk[1], SourceChunkFrames );
+        }
+    }
+    flushOutput();
+}
+
+} // anonymous namespace
+
+// ---------------------------------------------------------------------------------------------------------------------
+void Riff::exportToDisk( const streamProcessorFactoryFn& diskWriterForStem, const int32_t sampleOffset, tf::Executor* taskExecutor )
+{
+    // writers are created up-front, one stem at a time, as the factory is free to share state between calls
+    std::vector< StemExportJob > exportJobs;
+    exportJobs.reserve( 8 );
+
     for ( auto stemI = 0; stemI < 8; stemI++ )
     {
         const float stemTimeStretch   = m_stemTimeScales[stemI];
@@ -284,33 +448,47 @@ void Riff::exportToDisk( const streamProcessorFactoryFn& diskWriterForStem, cons
              stemGain <= 0.0f )
             continue;
 
+        // export needs every sample, not just what was ready for playback
+        stemPtr->completeDecode();
+
         // diskWriter could be null for dry-run mode
         auto diskWriter = diskWriterForStem( stemI, *stemPtr );
         if ( diskWriter != nullptr )
         {
-            const int32_t sampleCount = stemPtr->m_sampleCount;
-            const int32_t sampleCountTimeScaled = (int32_t)( (double)sampleCount / (double)stemTimeStretch );
-
-            auto exportChannelLeft  = mem::alloc16To<float>( sampleCountTimeScaled, 0.0f );
-            auto exportChannelRight = mem::alloc16To<float>( sampleCountTimeScaled, 0.0f );
-
-            const int32_t sampleOffsetTimeScaled = (int32_t)( (double)sampleOffset * (double)stemTimeStretch );
+            StemExportJob& job = exportJobs.emplace_back();
+
+            // hang on to the float samples if the stem still has them; they stay valid for as long as the job holds
+            // this, even if the stem cache decides to drop them in the meantime
+            job.m_stem          = stemPtr;
+            job.m_samples       = stemPtr->getSampleSlab();
+            job.m_writer        = std::move( diskWriter );
+            job.m_sampleRate    = m_stemSampleRate;
+            job.m_timeStretch   = stemTimeStretch;
+            job.m_gain          = stemGain;
+            job.m_sampleOffset  = sampleOffset;
+        }
+    }
 
-            for ( int32_t sampleWrite = 0; sampleWrite < sampleCountTimeScaled; sampleWrite++ )
+    // each stem renders and writes independently, so fan them out if we have somewhere to do that
+    if ( taskExecutor != nullptr && exportJobs.size() > 1 )
+    {
+        tf::Taskflow exportFlow;
+        for ( auto& job : exportJobs )
+        {
+            exportFlow.emplace( [&job]()
             {
-                const int32_t readSampleTimeScaled           = (int32_t)( (double)sampleWrite * (double)stemTimeStretch );
-                const int32_t readSampleTimeScaledWithOffset = ( readSampleTimeScaled + sampleOffsetTimeScaled ) % sampleCount;
-
-                exportChannelLeft[sampleWrite]  = stemPtr->m_channel[0][readSampleTimeScaledWithOffset] * stemGain;
-                exportChannelRight[sampleWrite] = stemPtr->m_channel[1][readSampleTimeScaledWithOffset] * stemGain;
-            }
-
-            // output to disk, force flush immediately
-            diskWriter->appendSamples( exportChannelLeft, exportChannelRight, sampleCountTimeScaled );
-            diskWriter.reset();
-
-            mem::free16( exportChannelLeft );
-            mem::free16( exportChannelRight );
+                renderStemForExport( job );
+                job.m_writer.reset();   // output to disk, force flush immediately
+            });
+        }
+        taskExecutor->run( exportFlow ).wait();
+    }
+    else
+    {
+        for ( auto& job : exportJobs )
+        {
+            renderStemForExport( job );
+            job.m_writer.reset();
         }
     }
 }
@@ -60,8 +60,10 @@ struct Riff
 
     void fetch( services::RiffFetchProvider& services );
 
+    // write each stem out through a writer provided by the factory, which is called once per stem from this thread
+    // before any rendering starts; stems are then rendered in parallel across the executor if one is given
     using streamProcessorFactoryFn = std::function< ssp::SampleStreamProcessorInstance( const uint32_t stemIndex, const endlesss::live::Stem& stemData ) >;
-    void exportToDisk( const streamProcessorFactoryFn& diskWriterForStem, const int32_t sampleOffset );
+    void exportToDisk( const streamProcessorFactoryFn& diskWriterForStem, const int32_t sampleOffset, tf::Executor* taskExecutor = nullptr );
 
     struct RiffTimingDetails
     {
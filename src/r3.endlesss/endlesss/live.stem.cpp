@@ -10,9 +10,11 @@
 #include "pch.h"
 
 #include "app/module.frontend.h"
+#include "base/instrumentation.h"
 #include "base/text.h"
 #include "dsp/fft.util.h"
 #include "dsp/octave.h"
+#include "endlesss/cache.stems.pack.h"
 #include "endlesss/live.stem.h"
 #include "filesys/fsutil.h"
 #include "math/rng.h"
@@ -76,12 +78,16 @@ Stem::Processing::UPtr Stem::createStemProcessing( const uint32_t targetSampleRa
 }
 
 // ---------------------------------------------------------------------------------------------------------------------
-Stem::Stem( const types::Stem& stemData, const uint32_t targetSampleRate )
-    : m_data( stemData )
+Stem::Stem( const types::Stem& stemData, const uint32_t targetSampleRate, const StemStorage::Format::Enum storageFormat, const bool progressiveDecode, std::shared_ptr<cache::StemPack> stemPack )
+    : m_storageFormat( storageFormat )
+    , m_stemPack( std::move( stemPack ) )
+    , m_progressiveDecode( progressiveDecode )
+    , m_data( stemData )
     , m_state( State::Empty )
     , m_sampleRate( targetSampleRate )
     , m_sampleCount( 0 )
     , m_hasValidAnalysis( false )
+    , m_fetchStage( FetchStage::Unclaimed )
 {
     m_channel.fill( nullptr );
 
@@ -99,18 +105,37 @@ Stem::~Stem()
 
     blog::stem( FMTX( "[s:{}] released" ), m_data.couchID );
 
-    mem::free16( m_channel[0] );
-    mem::free16( m_channel[1] );
+    releaseChannels();
 
     m_sampleCount = 0;
     m_state       = State::Empty;
 }
 
+// ---------------------------------------------------------------------------------------------------------------------
+bool Stem::claimFetch()
+{
+    FetchStage expected = FetchStage::Unclaimed;
+    return m_fetchStage.compare_exchange_strong( expected, FetchStage::InFlight );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void Stem::waitForFetch() const
+{
+    m_fetchStage.wait( FetchStage::InFlight );
+}
+
 // ---------------------------------------------------------------------------------------------------------------------
 void Stem::fetch( const api::NetConfiguration& ncfg, const fs::path& cachePath )
 {
-    // ensure we have a space to write the stem back out to
-    const absl::Status cachePathAvailable = filesys::ensureDirectoryExists( cachePath );
+    // wake anyone blocked in waitForFetch() regardless of how we leave this function
+    absl::Cleanup fetchFinished = [this]
+    {
+        m_fetchStage = FetchStage::Finished;
+        m_fetchStage.notify_all();
+    };
+
+    // ensure we have a space to write the stem back out to; not needed if everything is going into the stem pack
+    const absl::Status cachePathAvailable = ( m_stemPack == nullptr ) ? filesys::ensureDirectoryExists( cachePath ) : absl::OkStatus();
     if ( !cachePathAvailable.ok() )
     {
         blog::error::stem( FMTX( "Unable to create sub-directory in stem cache [{}], {}" ),
@@ -133,11 +158,26 @@ void Stem::fetch( const api::NetConfiguration& ncfg, const fs::path& cachePath )
 
     // check to see if we already have it downloaded
     auto cacheFile = cachePath / m_data.couchID.value();
-    if ( fs::exists( cacheFile ) )
+
+    // analysis results live alongside the audio
+    m_analysisCacheFile = cachePath / fmt::format( FMTX( "{}.analysis" ), m_data.couchID.value() );
+
+    // look in the stem pack first, if we have one; otherwise (or if it's not in there yet) look for a loose file,
+    // which gets moved into the pack by writeToCache() once it has decoded successfully
+    std::optional< std::size_t > cachedSize;
+    if ( m_stemPack != nullptr )
+        cachedSize = m_stemPack->getStoredSize( m_data.couchID.value() );
+
+    const bool cachedInPack = cachedSize.has_value();
+
+    if ( !cachedInPack && fs::exists( cacheFile ) )
+        cachedSize = fs::file_size( cacheFile );
+
+    if ( cachedSize.has_value() )
     {
-        blog::cache( FMTX( "[s:{}..] found in cache" ), stemCouchSnip );
+        blog::cache( FMTX( "[s:{}..] found in {}" ), stemCouchSnip, cachedInPack ? "stem pack" : "cache" );
 
-        const auto fileSize = fs::file_size( cacheFile );
+        const auto fileSize = cachedSize.value();
 
         if ( fileSize != audioMemory.m_rawLength )
         {
@@ -163,10 +203,20 @@ void Stem::fetch( const api::NetConfiguration& ncfg, const fs::path& cachePath )
             }
         }
 
-        std::basic_ifstream<char> ifs( cacheFile, std::ios::in | std::ios::binary );
-        ifs.read( (char*)audioMemory.m_rawAudio, fileSize );
+        if ( cachedInPack )
+        {
+            if ( m_stemPack->read( m_data.couchID.value(), audioMemory.m_rawAudio, fileSize ) )
+                audioMemory.m_rawReceived = fileSize;
+            else
+                blog::error::cache( FMTX( "[s:{}..] unable to read from stem pack, will download again" ), stemCouchSnip );
+        }
+        else
+        {
+            std::basic_ifstream<char> ifs( cacheFile, std::ios::in | std::ios::binary );
+            ifs.read( (char*)audioMemory.m_rawAudio, fileSize );
 
-        audioMemory.m_rawReceived = fileSize;
+            audioMemory.m_rawReceived = fileSize;
+        }
     }
 
     math::RNG32 lRng;
@@ -223,6 +273,23 @@ void Stem::fetch( const api::NetConfiguration& ncfg, const fs::path& cachePath )
         return;
     }
 
+    // progressive decode hands back a playable stem early; the compact storage formats are encoded from the
+    // complete stem in one go, so they always take the full decode path below
+    if ( m_progressiveDecode && m_storageFormat == StemStorage::Format::Float32 )
+    {
+        const Compression compression = stemIsFLAC ? Compression::FLAC : Compression::OggVorbis;
+
+        if ( beginProgressiveDecode( audioMemory, compression, cacheFile, stemCouchSnip ) )
+        {
+            blog::stem( FMTX( "[s:{}..] playable after {}, {} / {} samples decoded" ),
+                stemCouchSnip,
+                stemTiming.stop(),
+                m_storage.getSamplesAvailable(),
+                m_sampleCount );
+        }
+        return;
+    }
+
     if ( stemIsOGG )
     {
         // decode the vorbis stream into interleaved shorts
@@ -256,10 +323,7 @@ void Stem::fetch( const api::NetConfiguration& ncfg, const fs::path& cachePath )
         m_compressionFormat = Compression::OggVorbis;
 
         // emit a successful capture back to the cache
-        {
-            std::basic_ofstream<char> ofs( cacheFile, std::ios::out | std::ios::binary );
-            ofs.write( (char*)audioMemory.m_rawAudio, audioMemory.m_rawReceived );
-        }
+        writeToCache( cacheFile, audioMemory.m_rawAudio, audioMemory.m_rawReceived );
 
         static constexpr double shortToDoubleNormalisedRcp = 1.0 / 32768.0;
 
@@ -275,9 +339,12 @@ void Stem::fetch( const api::NetConfiguration& ncfg, const fs::path& cachePath )
                 m_sampleRate,
                 m_sampleCount );
 
-            const auto outputSampleLength = resampler24.getMaxOutLen( 0 );
+            // oneshot() fills exactly the requested length, so use the same sizing as the streaming decoder
+            const auto outputSampleLength = static_cast<int32_t>( StemStreamDecoder::getResampledLength( m_sampleCount, static_cast<uint32_t>( oggSampleRate ), m_sampleRate ) );
             double* resampleOut = mem::alloc16<double>( outputSampleLength );
 
+            allocateChannels( outputSampleLength );
+
             // resample each channel to the chosen sample rate using r8brain
             for ( std::size_t channel = 0; channel < 2; channel++ )
             {
@@ -290,8 +357,7 @@ void Stem::fetch( const api::NetConfiguration& ncfg, const fs::path& cachePath )
                 // resample stem as one-shot, standalone task
                 resampler24.oneshot( resampleIn, m_sampleCount, resampleOut, outputSampleLength );
 
-                // allocate actual channel data storage and copy across, out of resampling buffer
-                m_channel[channel] = mem::alloc16<float>( outputSampleLength );
+                // copy across to the channel data storage, out of resampling buffer
                 for ( size_t s = 0; s < outputSampleLength; s++ )
                 {
                     m_channel[channel][s] = static_cast<float>(resampleOut[s]);
@@ -307,8 +373,7 @@ void Stem::fetch( const api::NetConfiguration& ncfg, const fs::path& cachePath )
         {
             // blog::stem( FMTX( "[s:{}..] stem already at {}" ), stemCouchSnip, m_sampleRate );
 
-            m_channel[0] = mem::alloc16<float>( m_sampleCount );
-            m_channel[1] = mem::alloc16<float>( m_sampleCount );
+            allocateChannels( m_sampleCount );
 
             for ( std::size_t s = 0, readIndex = 0; s < m_sampleCount; s++ )
             {
@@ -485,17 +550,19 @@ void Stem::fetch( const api::NetConfiguration& ncfg, const fs::path& cachePath )
                 m_sampleRate,
                 m_sampleCount );
 
-            const auto outputSampleLength = resampler24.getMaxOutLen( 0 );
+            // oneshot() fills exactly the requested length, so use the same sizing as the streaming decoder
+            const auto outputSampleLength = static_cast<int32_t>( StemStreamDecoder::getResampledLength( m_sampleCount, static_cast<uint32_t>( flacSampleRate ), m_sampleRate ) );
             double* resampleOut = mem::alloc16<double>( outputSampleLength );
 
+            allocateChannels( outputSampleLength );
+
             // resample each channel to the chosen sample rate using r8brain
             for ( std::size_t channel = 0; channel < 2; channel++ )
             {
                 // resample stem as one-shot, standalone task
                 resampler24.oneshot( flacStreamChannels[channel], m_sampleCount, resampleOut, outputSampleLength);
 
-                // allocate actual channel data storage and copy across, out of resampling buffer
-                m_channel[channel] = mem::alloc16<float>( outputSampleLength );
+                // copy across to the channel data storage, out of resampling buffer
                 for ( std::size_t s = 0; s < outputSampleLength; s++ )
                 {
                     m_channel[channel][s] = static_cast<float>(resampleOut[s]);
@@ -511,8 +578,7 @@ void Stem::fetch( const api::NetConfiguration& ncfg, const fs::path& cachePath )
         {
             // blog::stem( FMTX( "[s:{}..] stem already at {}" ), stemCouchSnip, m_sampleRate );
 
-            m_channel[0] = mem::alloc16<float>( m_sampleCount );
-            m_channel[1] = mem::alloc16<float>( m_sampleCount );
+            allocateChannels( m_sampleCount );
 
             for ( std::size_t channel = 0; channel < 2; channel++ )
             {
@@ -529,15 +595,15 @@ void Stem::fetch( const api::NetConfiguration& ncfg, const fs::path& cachePath )
         m_compressionFormat = Compression::FLAC;
 
         // if the decode worked, stash the original data in the cache
-        {
-            std::basic_ofstream<char> ofs( cacheFile, std::ios::out | std::ios::binary );
-            ofs.write( (char*)audioMemory.m_rawAudio, audioMemory.m_rawReceived );
-        }
+        writeToCache( cacheFile, audioMemory.m_rawAudio, audioMemory.m_rawReceived );
     }
 
     // immediate post-processing steps that modify samples
     applyLoopSewingBlend();
 
+    // produce the representation that playback will read from
+    m_storage.encode( m_storageFormat, m_channel[0], m_channel[1], m_sampleCount );
+
     m_state = State::Complete;
 
     // report on our hard work
@@ -545,11 +611,135 @@ void Stem::fetch( const api::NetConfiguration& ncfg, const fs::path& cachePath )
         auto stemTime = stemTiming.stop();
         const auto humanisedMemoryUsage = base::humaniseByteSize( "using approx mem : ", estimateMemoryUsageBytes() );
 
-        blog::stem( FMTX( "[s:{}..] finalizing took {}, {}" ),
+        blog::stem( FMTX( "[s:{}..] finalizing took {}, {} [{}]" ),
             stemCouchSnip,
             stemTime,
-            humanisedMemoryUsage );
+            humanisedMemoryUsage,
+            StemStorage::Format::toString( m_storage.getFormat() ) );
+    }
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+bool Stem::beginProgressiveDecode( RawAudioMemory& audioMemory, const Compression compression, const fs::path& cacheFile, const std::string& logTag )
+{
+    const std::size_t rawLength = audioMemory.m_rawReceived;
+
+    m_streamDecoder = StemStreamDecoder::create(
+        ( compression == Compression::FLAC ) ? StemStreamDecoder::Codec::FLAC : StemStreamDecoder::Codec::OggVorbis,
+        audioMemory.release(),
+        rawLength,
+        m_sampleRate,
+        logTag );
+
+    if ( m_streamDecoder == nullptr )
+    {
+        m_state = State::Failed_Decompression;
+        return false;
+    }
+
+    m_sampleCount = m_streamDecoder->getOutputSampleCount();
+
+    allocateChannels( m_sampleCount );
+
+    if ( !m_streamDecoder->decodeUntil( m_channel[0], m_channel[1], ProgressiveDecodeFirstChunk ) )
+    {
+        m_streamDecoder.reset();
+
+        releaseChannels();
+
+        m_state = State::Failed_Decompression;
+        return false;
+    }
+
+    m_compressionFormat = compression;
+    m_streamCacheFile   = cacheFile;
+
+    m_storage.bindFloat( m_channel[0], m_channel[1], m_sampleCount, getUnsewnSamplesAvailable() );
+
+    m_state = State::Complete;
+    return true;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+int32_t Stem::getUnsewnSamplesAvailable() const
+{
+    // the final stretch of samples is rewritten by applyLoopSewingBlend(), so hold it back from readers until that's done
+    return std::clamp( m_streamDecoder->getOutputWritten(), 0, std::max( 0, m_sampleCount - LoopSewingWindowSize ) );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void Stem::completeDecode()
+{
+    std::scoped_lock<std::mutex> decodeLock( m_streamDecodeLock );
+
+    if ( m_streamDecoder == nullptr )
+        return;
+
+    base::instr::ScopedEvent se( "stem-decode", base::instr::PresetColour::Orange );
+
+    const std::string stemCouchSnip = m_data.couchID.substr( 8 );
+
+    // publish progress as we go so that playback running ahead of us gets audio as soon as possible
+    bool decodeSucceeded = true;
+    while ( decodeSucceeded && m_streamDecoder->getOutputWritten() < m_sampleCount )
+    {
+        decodeSucceeded = m_streamDecoder->decodeUntil( m_channel[0], m_channel[1], m_streamDecoder->getOutputWritten() + ProgressiveDecodeFirstChunk );
+
+        m_storage.setSamplesAvailable( getUnsewnSamplesAvailable() );
+    }
+
+    if ( decodeSucceeded )
+    {
+        // only keep a copy in the cache once we know the whole stream decodes cleanly
+        writeToCache( m_streamCacheFile, m_streamDecoder->getRawAudio(), m_streamDecoder->getRawLength() );
+    }
+    else
+    {
+        // too late to fail the stem, playback may already be using it; silence whatever didn't decode
+        blog::error::stem( FMTX( "[s:{}..] stream decode failed at {} / {}, remainder silenced" ), stemCouchSnip, m_streamDecoder->getOutputWritten(), m_sampleCount );
+
+        std::fill( m_channel[0] + m_streamDecoder->getOutputWritten(), m_channel[0] + m_sampleCount, 0.0f );
+        std::fill( m_channel[1] + m_streamDecoder->getOutputWritten(), m_channel[1] + m_sampleCount, 0.0f );
     }
+
+    // the tail now exists, so the loop can be sewn before it becomes visible to readers
+    applyLoopSewingBlend();
+
+    m_storage.setSamplesAvailable( m_sampleCount );
+    m_streamDecoder.reset();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void Stem::writeToCache( const fs::path& cacheFile, const uint8_t* data, const std::size_t byteCount ) const
+{
+    if ( m_stemPack != nullptr )
+    {
+        // storing the same data again is a no-op, so this is cheap for stems that were loaded out of the pack
+        if ( m_stemPack->store( m_data.couchID.value(), data, byteCount ) )
+        {
+            // if this stem had been cached as a loose file, it now lives in the pack instead
+            std::error_code removeError;
+            fs::remove( cacheFile, removeError );
+            return;
+        }
+
+        // the pack is having trouble; better to have a loose file than nothing
+        if ( !filesys::ensureDirectoryExists( cacheFile.parent_path() ).ok() )
+            return;
+    }
+
+    // write to a temporary and then swap it in, so cache maintenance or another reader never sees a partial stem
+    fs::path writeFile = cacheFile;
+    writeFile += ".tmp";
+    {
+        std::basic_ofstream<char> ofs( writeFile, std::ios::out | std::ios::binary | std::ios::trunc );
+        ofs.write( reinterpret_cast<const char*>( data ), byteCount );
+        if ( !ofs )
+            return;
+    }
+
+    std::error_code renameError;
+    fs::rename( writeFile, cacheFile, renameError );
 }
 
 // ---------------------------------------------------------------------------------------------------------------------
@@ -682,7 +872,7 @@ bool Stem::attemptRemoteFetch( const api::NetConfiguration& ncfg, const uint32_t
 //
 void Stem::applyLoopSewingBlend()
 {
-    constexpr int32_t xfadeWindowSize = 128;
+    constexpr int32_t xfadeWindowSize = LoopSewingWindowSize;
     constexpr double xfadeWindowSizeRecp = 1.0 / (double)xfadeWindowSize;
 
     // 1..0 constant-power blend over the window size
@@ -725,7 +915,7 @@ void Stem::applyLoopSewingBlend()
 }
 
 // ---------------------------------------------------------------------------------------------------------------------
-void Stem::analyse( const Processing& processing, StemAnalysisData& result ) const
+void Stem::analyse( const Processing& processing, StemAnalysisData& result, StemAnalysisData::Accuracy* accuracy ) const
 {
     using namespace dsp;
     using namespace cycfi::q::literals;
@@ -737,6 +927,29 @@ void Stem::analyse( const Processing& processing, StemAnalysisData& result ) con
         return;
     }
 
+    // compact storage formats release the float channels once the initial analysis is done; anything re-running
+    // analysis after that point (eg. the tuning tools) works from a temporary decode instead. hold a reference to
+    // the samples while we work so they can't be released out from under us
+    const StemSlab::Ptr samples = getSampleSlab();
+    std::array< const float*, 2 > channelData = { nullptr, nullptr };
+    if ( samples != nullptr )
+        channelData = { samples->getChannel( 0 ).data(), samples->getChannel( 1 ).data() };
+
+    std::array< float*, 2 > decodedChannels = { nullptr, nullptr };
+    if ( channelData[0] == nullptr )
+    {
+        decodedChannels[0] = mem::alloc16<float>( m_sampleCount );
+        decodedChannels[1] = mem::alloc16<float>( m_sampleCount );
+        m_storage.decode( decodedChannels[0], decodedChannels[1] );
+
+        channelData = { decodedChannels[0], decodedChannels[1] };
+    }
+    absl::Cleanup releaseDecoded = [&decodedChannels]
+    {
+        mem::free16( decodedChannels[0] );
+        mem::free16( decodedChannels[1] );
+    };
+
     // default spectrum data for normalising freq data; we could load this from disk potentially
     const config::Spectrum audioSpectrumConfig;
 
@@ -758,8 +971,8 @@ void Stem::analyse( const Processing& processing, StemAnalysisData& result ) con
     for ( int64_t sI = 0, fftBandLimit = 0; sI <= m_sampleCount - fftWindowSize; sI += fftWindowSize, fftBandLimit++ )
     {
         // perform FFT on each stereo channel
-        pffft_transform_ordered( processing.m_pffftPlan, &(m_channel[0][sI]), reinterpret_cast<float*>(fftOutputL), nullptr, PFFFT_FORWARD );
-        pffft_transform_ordered( processing.m_pffftPlan, &(m_channel[1][sI]), reinterpret_cast<float*>(fftOutputR), nullptr, PFFFT_FORWARD );
+        pffft_transform_ordered( processing.m_pffftPlan, &(channelData[0][sI]), reinterpret_cast<float*>(fftOutputL), nullptr, PFFFT_FORWARD );
+        pffft_transform_ordered( processing.m_pffftPlan, &(channelData[1][sI]), reinterpret_cast<float*>(fftOutputR), nullptr, PFFFT_FORWARD );
 
         std::array< float, 3 > frequencyBuckets;
         frequencyBuckets.fill( 0 );
@@ -806,6 +1019,14 @@ void Stem::analyse( const Processing& processing, StemAnalysisData& result ) con
 
     #define PSA_ENCODE( _v ) static_cast<uint8_t>( _v * 255.0f );
 
+    // when asked for an accuracy report, also keep the full per-sample tracks to compare the envelopes against
+    std::array< std::vector< uint8_t >, 4 > perSampleTracks;
+    if ( accuracy != nullptr )
+    {
+        for ( auto& track : perSampleTracks )
+            track.resize( m_sampleCount );
+    }
+
     // run two loops of the signal followers, ensuring that we get a good representation of the looping signal;
     // this is also when we run peak-finding to get some beats extracted 
     for ( auto cycle = 0; cycle < 2; cycle++ )
@@ -826,34 +1047,100 @@ void Stem::analyse( const Processing& processing, StemAnalysisData& result ) con
             }
 
             // don't imagine max() here is terribly scientific
-            const float signalInput     = std::max( m_channel[0][sI], m_channel[1][sI] );
+            const float signalInput     = std::max( channelData[0][sI], channelData[1][sI] );
             const float signalFollow    = waveFollower( signalInput );
             const float signalFollowLF  = waveFollowerLF( fftOutLowBand[fftBandIndex] );
             const float signalFollowHF  = waveFollowerHF( fftOutHighBand[fftBandIndex] );
 
             float beatPeak = 0;
 
-            // clear out beats on first cycle through
-            if ( cycle == 0 )
-            {
-                result.m_beatBitfield[sI >> StemAnalysisData::BeatBitsShift] = 0;
-            }
-            // run the tracker on second pass
-            else
+            // first cycle just warms up the followers, run the tracker and record results on the second pass
+            if ( cycle == 1 )
             {
-                result.m_psaWave[sI]     = PSA_ENCODE( signalFollow   );
-                result.m_psaLowFreq[sI]  = PSA_ENCODE( signalFollowLF );
-                result.m_psaHighFreq[sI] = PSA_ENCODE( signalFollowHF );
-
                 if ( peakTracker( signalInput, signalFollow ) )
                 {
                     result.setBeatAtSample( sI );
                     beatPeak = 1.0f;
                 }
+
+                const uint8_t encodedWave = PSA_ENCODE( signalFollow   );
+                const uint8_t encodedBeat = PSA_ENCODE( beatFollower( beatPeak ) );
+                const uint8_t encodedLow  = PSA_ENCODE( signalFollowLF );
+                const uint8_t encodedHigh = PSA_ENCODE( signalFollowHF );
+
+                // envelopes take the value at the start of each block
+                if ( ( sI & ( StemAnalysisData::EnvelopeBlockSize - 1 ) ) == 0 )
+                {
+                    const std::size_t envelopeIndex = static_cast<std::size_t>( sI >> StemAnalysisData::EnvelopeShift );
+
+                    result.m_envWave[envelopeIndex]     = encodedWave;
+                    result.m_envBeat[envelopeIndex]     = encodedBeat;
+                    result.m_envLowFreq[envelopeIndex]  = encodedLow;
+                    result.m_envHighFreq[envelopeIndex] = encodedHigh;
+                }
+
+                if ( accuracy != nullptr )
+                {
+                    perSampleTracks[0][sI] = encodedWave;
+                    perSampleTracks[1][sI] = encodedBeat;
+                    perSampleTracks[2][sI] = encodedLow;
+                    perSampleTracks[3][sI] = encodedHigh;
+                }
+            }
+            else
+            {
+                beatFollower( beatPeak );
+            }
+        }
+    }
+
+    // trailing entry holds the last block's value so interpolating across the final block stays flat
+    {
+        const std::size_t finalEnvelope = result.m_envWave.size() - 1;
+
+        result.m_envWave[finalEnvelope]     = result.m_envWave[finalEnvelope - 1];
+        result.m_envBeat[finalEnvelope]     = result.m_envBeat[finalEnvelope - 1];
+        result.m_envLowFreq[finalEnvelope]  = result.m_envLowFreq[finalEnvelope - 1];
+        result.m_envHighFreq[finalEnvelope] = result.m_envHighFreq[finalEnvelope - 1];
+    }
+
+    if ( accuracy != nullptr )
+    {
+        *accuracy = {};
+
+        // rebuild the one-bit-per-sample beat field we used to store, to check the onset list answers queries identically
+        std::vector< uint64_t > referenceBeatBits( ( m_sampleCount >> StemAnalysisData::BeatWindowShift ) + 1, 0 );
+        for ( const auto onset : result.m_beatOnsets )
+            referenceBeatBits[onset >> StemAnalysisData::BeatWindowShift] |= 1ULL << ( onset & 63 );
+
+        std::array< double, 4 > errorSum = { 0, 0, 0, 0 };
+        for ( int64_t sI = 0; sI < m_sampleCount; sI++ )
+        {
+            const std::array< float, 4 > envelopeValues = {
+                result.getWaveF( sI ),
+                result.getBeatF( sI ),
+                result.getLowFreqF( sI ),
+                result.getHighFreqF( sI ) };
+
+            for ( std::size_t track = 0; track < 4; track++ )
+            {
+                const float error = std::abs( base::LUT::u8_to_float[ perSampleTracks[track][sI] ] - envelopeValues[track] );
+
+                errorSum[track] += error;
+                accuracy->m_maxError[track] = std::max( accuracy->m_maxError[track], error );
             }
 
-            result.m_psaBeat[sI] = PSA_ENCODE( beatFollower( beatPeak ) );
+            const bool referenceBeat = ( referenceBeatBits[sI >> StemAnalysisData::BeatWindowShift] >> ( sI & 63 ) ) != 0;
+            if ( referenceBeat != result.queryBeatAtSample( sI ) )
+                accuracy->m_beatQueryMismatches++;
         }
+
+        for ( std::size_t track = 0; track < 4; track++ )
+            accuracy->m_meanError[track] = static_cast<float>( errorSum[track] / static_cast<double>( m_sampleCount ) );
+
+        accuracy->m_perSampleBytes  = ( static_cast<std::size_t>( m_sampleCount ) * 4 * sizeof( uint8_t ) ) + ( referenceBeatBits.size() * sizeof( uint64_t ) );
+        accuracy->m_compactBytes    = result.estimateMemoryUsageBytes();
+        accuracy->m_beatOnsetCount  = static_cast<int64_t>( result.m_beatOnsets.size() );
     }
 
     mem::free16( fftOutHighBand );
@@ -863,8 +1150,236 @@ void Stem::analyse( const Processing& processing, StemAnalysisData& result ) con
 // ---------------------------------------------------------------------------------------------------------------------
 void Stem::analyse( const Processing& processing )
 {
-    analyse( processing, m_analysisData );
+    // analysis needs the whole stem
+    completeDecode();
+
+    if ( !loadAnalysisFromCache( processing ) )
+    {
+        analyse( processing, m_analysisData );
+
+        if ( !saveAnalysisToCache( processing ) )
+        {
+            blog::error::cache( FMTX( "[s:{}] unable to write analysis data to [{}]" ), m_data.couchID, m_analysisCacheFile.string() );
+        }
+    }
     m_hasValidAnalysis = true;
+
+    // with analysis done, playback reads exclusively through m_storage; if that is a compact format we can now drop
+    // the full-size float data that was kept around to run the analysis on
+    // (anyone still holding a reference from getSampleSlab() keeps the data alive until they are done with it)
+    if ( m_storage.getFormat() != StemStorage::Format::Float32 )
+    {
+        releaseChannels();
+    }
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+StemSlab::Ptr Stem::getSampleSlab() const
+{
+    if ( m_state != State::Complete )
+        return nullptr;
+
+    std::scoped_lock<std::mutex> samplesLock( m_samplesLock );
+    return m_samples;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void Stem::allocateChannels( const int32_t sampleCount )
+{
+    auto samples = StemSlab::create( sampleCount );
+    ABSL_ASSERT( samples != nullptr );
+
+    std::scoped_lock<std::mutex> samplesLock( m_samplesLock );
+
+    m_samples    = std::move( samples );
+    m_channel[0] = m_samples->getWritableChannel( 0 );
+    m_channel[1] = m_samples->getWritableChannel( 1 );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void Stem::releaseChannels()
+{
+    StemSlab::MutablePtr releasing;
+    {
+        std::scoped_lock<std::mutex> samplesLock( m_samplesLock );
+
+        m_channel.fill( nullptr );
+        std::swap( releasing, m_samples );
+    }
+    // last reference (if it is) gets freed outside the lock
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+// on-disk header for persisted analysis data; everything that analyse() depends on is recorded so we only ever
+// load data that would match a fresh analysis pass. followed by the four envelope tracks and then the beat onsets
+//
+struct AnalysisCacheHeader
+{
+    static constexpr uint32_t Magic = 0x4441534F;   // 'OSAD'
+
+    uint32_t    m_magic             = Magic;
+    uint32_t    m_analysisVersion   = 0;
+    uint32_t    m_sampleRate        = 0;
+    int32_t     m_sampleCount       = 0;
+    int32_t     m_fftWindowSize     = 0;
+    uint32_t    m_beatOnsetCount    = 0;
+    float       m_tuning[4]         = { 0, 0, 0, 0 };
+
+    void setup( const Stem::Processing& processing, const uint32_t sampleRate, const int32_t sampleCount, const std::size_t beatOnsetCount )
+    {
+        m_analysisVersion   = Stem::Processing::AnalysisVersion;
+        m_sampleRate        = sampleRate;
+        m_sampleCount       = sampleCount;
+        m_fftWindowSize     = processing.m_fftWindowSize;
+        m_beatOnsetCount    = static_cast<uint32_t>( beatOnsetCount );
+        m_tuning[0]         = processing.m_tuning.m_beatFollowDuration;
+        m_tuning[1]         = processing.m_tuning.m_waveFollowDuration;
+        m_tuning[2]         = processing.m_tuning.m_trackerSensitivity;
+        m_tuning[3]         = processing.m_tuning.m_trackerHysteresis;
+    }
+
+    ouro_nodiscard bool matches( const AnalysisCacheHeader& other ) const
+    {
+        return std::memcmp( this, &other, sizeof( AnalysisCacheHeader ) ) == 0;
+    }
+
+    ouro_nodiscard std::size_t expectedFileSize() const
+    {
+        return sizeof( AnalysisCacheHeader ) +
+               ( StemAnalysisData::getEnvelopeCount( m_sampleCount ) * 4 * sizeof( uint8_t ) ) +
+               ( static_cast<std::size_t>( m_beatOnsetCount ) * sizeof( int32_t ) );
+    }
+};
+static_assert( sizeof( AnalysisCacheHeader ) == 40 );
+
+// ---------------------------------------------------------------------------------------------------------------------
+bool Stem::loadAnalysisFromCache( const Processing& processing )
+{
+    if ( m_analysisCacheFile.empty() || m_state != State::Complete )
+        return false;
+
+    // analysis sits in the stem pack under the same name the loose file would have
+    const std::string analysisPackKey = m_analysisCacheFile.filename().string();
+
+    std::size_t fileSize = 0;
+    std::unique_ptr< std::istream > analysisStream;
+
+    const auto packedSize = ( m_stemPack != nullptr ) ? m_stemPack->getStoredSize( analysisPackKey ) : std::nullopt;
+    if ( packedSize.has_value() )
+    {
+        std::string analysisBytes( packedSize.value(), '\0' );
+        if ( !m_stemPack->read( analysisPackKey, reinterpret_cast<uint8_t*>( analysisBytes.data() ), analysisBytes.size() ) )
+            return false;
+
+        fileSize = analysisBytes.size();
+        analysisStream = std::make_unique< std::istringstream >( std::move( analysisBytes ), std::ios::in | std::ios::binary );
+    }
+    else
+    {
+        std::error_code fileError;
+        fileSize = fs::file_size( m_analysisCacheFile, fileError );
+        if ( fileError )
+            return false;
+
+        analysisStream = std::make_unique< std::ifstream >( m_analysisCacheFile, std::ios::in | std::ios::binary );
+    }
+    std::istream& ifs = *analysisStream;
+
+    AnalysisCacheHeader storedHeader;
+    ifs.read( reinterpret_cast<char*>( &storedHeader ), sizeof( AnalysisCacheHeader ) );
+
+    // what we expect to find, given the current stem and processing setup; the onset count is the only
+    // thing that depends on the analysis itself, so take that from the file
+    AnalysisCacheHeader expectedHeader;
+    expectedHeader.setup( processing, m_sampleRate, m_sampleCount, storedHeader.m_beatOnsetCount );
+
+    if ( !ifs || !expectedHeader.matches( storedHeader ) )
+    {
+        blog::cache( FMTX( "[s:{}] discarding stale analysis data (v{} vs v{})" ), m_data.couchID, storedHeader.m_analysisVersion, Processing::AnalysisVersion );
+        return false;
+    }
+
+    if ( fileSize != expectedHeader.expectedFileSize() )
+    {
+        blog::cache( FMTX( "[s:{}] discarding analysis data, size mismatch" ), m_data.couchID );
+        return false;
+    }
+
+    m_analysisData.resize( m_sampleCount );
+    m_analysisData.m_beatOnsets.resize( storedHeader.m_beatOnsetCount );
+
+    const auto envelopeCount = static_cast<std::streamsize>( m_analysisData.m_envWave.size() );
+
+    ifs.read( reinterpret_cast<char*>( m_analysisData.m_envWave.data() ),     envelopeCount );
+    ifs.read( reinterpret_cast<char*>( m_analysisData.m_envBeat.data() ),     envelopeCount );
+    ifs.read( reinterpret_cast<char*>( m_analysisData.m_envLowFreq.data() ),  envelopeCount );
+    ifs.read( reinterpret_cast<char*>( m_analysisData.m_envHighFreq.data() ), envelopeCount );
+    ifs.read( reinterpret_cast<char*>( m_analysisData.m_beatOnsets.data() ),  m_analysisData.m_beatOnsets.size() * sizeof( int32_t ) );
+
+    if ( !ifs )
+    {
+        blog::error::cache( FMTX( "[s:{}] failed reading analysis data from [{}]" ), m_data.couchID, m_analysisCacheFile.string() );
+        return false;
+    }
+
+    blog::cache( FMTX( "[s:{}] loaded analysis from cache" ), m_data.couchID );
+    return true;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+bool Stem::saveAnalysisToCache( const Processing& processing ) const
+{
+    // nothing to persist if the stem didn't load or was too small to analyse
+    if ( m_analysisCacheFile.empty() || m_state != State::Complete || m_analysisData.m_envWave.empty() )
+        return true;
+
+    AnalysisCacheHeader header;
+    header.setup( processing, m_sampleRate, m_sampleCount, m_analysisData.m_beatOnsets.size() );
+
+    const auto writeAnalysis = [&]( std::ostream& ofs )
+    {
+        const auto envelopeCount = static_cast<std::streamsize>( m_analysisData.m_envWave.size() );
+
+        ofs.write( reinterpret_cast<const char*>( &header ), sizeof( AnalysisCacheHeader ) );
+        ofs.write( reinterpret_cast<const char*>( m_analysisData.m_envWave.data() ),     envelopeCount );
+        ofs.write( reinterpret_cast<const char*>( m_analysisData.m_envBeat.data() ),     envelopeCount );
+        ofs.write( reinterpret_cast<const char*>( m_analysisData.m_envLowFreq.data() ),  envelopeCount );
+        ofs.write( reinterpret_cast<const char*>( m_analysisData.m_envHighFreq.data() ), envelopeCount );
+        ofs.write( reinterpret_cast<const char*>( m_analysisData.m_beatOnsets.data() ),  m_analysisData.m_beatOnsets.size() * sizeof( int32_t ) );
+
+        return !ofs.fail();
+    };
+
+    std::error_code fileError;
+
+    // pack records are all-or-nothing, so no temporary needed
+    if ( m_stemPack != nullptr )
+    {
+        std::ostringstream analysisStream( std::ios::out | std::ios::binary );
+        if ( !writeAnalysis( analysisStream ) )
+            return false;
+
+        const std::string analysisBytes = std::move( analysisStream ).str();
+        if ( !m_stemPack->store( m_analysisCacheFile.filename().string(), reinterpret_cast<const uint8_t*>( analysisBytes.data() ), analysisBytes.size() ) )
+            return false;
+
+        // drop any loose copy from before the pack was switched on
+        fs::remove( m_analysisCacheFile, fileError );
+        return true;
+    }
+
+    // write to a temporary and then swap it in so that a concurrent reader or a crash never sees a partial file
+    fs::path writeFile = m_analysisCacheFile;
+    writeFile += ".tmp";
+    {
+        std::basic_ofstream<char> ofs( writeFile, std::ios::out | std::ios::binary | std::ios::trunc );
+        if ( !writeAnalysis( ofs ) )
+            return false;
+    }
+
+    fs::rename( writeFile, m_analysisCacheFile, fileError );
+
+    return !fileError;
 }
 
 // ---------------------------------------------------------------------------------------------------------------------
@@ -884,6 +1399,18 @@ Stem::RawAudioMemory::~RawAudioMemory()
     m_rawReceived   = 0;
 }
 
+// ---------------------------------------------------------------------------------------------------------------------
+uint8_t* Stem::RawAudioMemory::release()
+{
+    uint8_t* rawAudio = m_rawAudio;
+
+    m_rawAudio      = nullptr;
+    m_rawLength     = 0;
+    m_rawReceived   = 0;
+
+    return rawAudio;
+}
+
 // ---------------------------------------------------------------------------------------------------------------------
 void Stem::RawAudioMemory::allocate( size_t newSize )
 {
@@ -12,13 +12,20 @@
 #include "endlesss/api.h"
 #include "core.types.h"
 #include "base/float.util.h"
+#include "base/mathematics.h"
 #include "dsp/octave.h"
+#include "endlesss/live.stem.slab.h"
+#include "endlesss/live.stem.storage.h"
+#include "endlesss/live.stem.stream.h"
 
 struct PFFFT_Setup;
 
 namespace config { namespace endlesss { struct rAPI; } }
 
 namespace endlesss {
+
+namespace cache { struct StemPack; }
+
 namespace live {
 
 // ---------------------------------------------------------------------------------------------------------------------
@@ -32,71 +39,163 @@ struct StemAnalysisData
     StemAnalysisData() = default;
 
 
-    static constexpr std::size_t    BeatBitsShift = 6;      // shift left/right by 64
+    // analysis tracks are kept as one value per envelope block rather than one per sample; consumers only ever
+    // read them at UI / visualisation rates, so a 64-sample (~1.3ms @ 48khz) step is still far finer than needed.
+    // lookups linearly interpolate between neighbouring blocks
+    static constexpr std::size_t    EnvelopeShift       = 6;
+    static constexpr int64_t        EnvelopeBlockSize   = 1LL << EnvelopeShift;
+    static constexpr float          EnvelopeBlockRecp   = 1.0f / static_cast<float>( EnvelopeBlockSize );
+
+    // beat queries report an onset anywhere from the given sample up to the end of its 64-sample window, so that
+    // callers stepping through samples at a stretched rate don't skip over them
+    static constexpr std::size_t    BeatWindowShift     = 6;
+
+    // one entry per block touched by the stem, plus one trailing entry so interpolation can always read [block + 1]
+    ouro_nodiscard static constexpr std::size_t getEnvelopeCount( const int32_t sampleCount )
+    {
+        return static_cast<std::size_t>( ( sampleCount + EnvelopeBlockSize - 1 ) >> EnvelopeShift ) + 1;
+    }
 
     ouro_nodiscard inline std::size_t estimateMemoryUsageBytes() const
     {
         std::size_t result = 0;
-        result += m_psaWave.size()      * sizeof( uint8_t );
-        result += m_psaBeat.size()      * sizeof( uint8_t );
-        result += m_psaLowFreq.size()   * sizeof( uint8_t );
-        result += m_psaHighFreq.size()  * sizeof( uint8_t );
-        result += m_beatBitfield.size() * sizeof( uint64_t );
+        result += m_envWave.size()      * sizeof( uint8_t );
+        result += m_envBeat.size()      * sizeof( uint8_t );
+        result += m_envLowFreq.size()   * sizeof( uint8_t );
+        result += m_envHighFreq.size()  * sizeof( uint8_t );
+        result += m_beatOnsets.size()   * sizeof( int32_t );
 
         return result;
     }
 
     void resize( int32_t sampleCount )
     {
-        m_psaWave.resize( sampleCount );
-        m_psaBeat.resize( sampleCount );
-        m_psaLowFreq.resize( sampleCount );
-        m_psaHighFreq.resize( sampleCount );
-        
-        m_beatBitfield.resize( (sampleCount >> BeatBitsShift) + 1 );
-    }
-
+        const std::size_t envelopeCount = getEnvelopeCount( sampleCount );
 
-    ouro_nodiscard inline uint8_t getWaveU8( const int64_t sampleIndex ) const { return m_psaWave[sampleIndex]; }
-    ouro_nodiscard inline float   getWaveF(  const int64_t sampleIndex ) const { return base::LUT::u8_to_float[ getWaveU8(sampleIndex) ]; }
+        m_envWave.assign( envelopeCount, 0 );
+        m_envBeat.assign( envelopeCount, 0 );
+        m_envLowFreq.assign( envelopeCount, 0 );
+        m_envHighFreq.assign( envelopeCount, 0 );
 
-    ouro_nodiscard inline uint8_t getBeatU8( const int64_t sampleIndex ) const { return m_psaBeat[sampleIndex]; }
-    ouro_nodiscard inline float   getBeatF(  const int64_t sampleIndex ) const { return base::LUT::u8_to_float[ getBeatU8(sampleIndex) ]; }
+        m_beatOnsets.clear();
+    }
 
-    ouro_nodiscard inline uint8_t getLowFreqU8( const int64_t sampleIndex ) const { return m_psaLowFreq[sampleIndex]; }
-    ouro_nodiscard inline float   getLowFreqF(  const int64_t sampleIndex ) const { return base::LUT::u8_to_float[ getLowFreqU8(sampleIndex) ]; }
 
-    ouro_nodiscard inline uint8_t getHighFreqU8( const int64_t sampleIndex ) const { return m_psaHighFreq[sampleIndex]; }
-    ouro_nodiscard inline float   getHighFreqF(  const int64_t sampleIndex ) const { return base::LUT::u8_to_float[ getHighFreqU8(sampleIndex) ]; }
+    ouro_nodiscard inline float getWaveF(     const int64_t sampleIndex ) const { return sampleEnvelope( m_envWave, sampleIndex ); }
+    ouro_nodiscard inline float getBeatF(     const int64_t sampleIndex ) const { return sampleEnvelope( m_envBeat, sampleIndex ); }
+    ouro_nodiscard inline float getLowFreqF(  const int64_t sampleIndex ) const { return sampleEnvelope( m_envLowFreq, sampleIndex ); }
+    ouro_nodiscard inline float getHighFreqF( const int64_t sampleIndex ) const { return sampleEnvelope( m_envHighFreq, sampleIndex ); }
 
 
-    // all the per-sample 0..1 analysis data is stored quantised as mostly we're using it for visualisation
-    // or debugging / alignment, full precision generally isn't required. `psa` being per-sample average, just for a name for it
+    // all the 0..1 analysis data is stored quantised as mostly we're using it for visualisation
+    // or debugging / alignment, full precision generally isn't required. each value is the signal at the start of its block
     //
-    std::vector< uint8_t >          m_psaWave;         // rms-follower of original waveform
-    std::vector< uint8_t >          m_psaBeat;         // peak-follower on detected beats, giving smooth decay off each
-    std::vector< uint8_t >          m_psaLowFreq;      // smoothed extraction of lower-band frequencies
-    std::vector< uint8_t >          m_psaHighFreq;     // smoothed extraction of higher-band frequencies
+    std::vector< uint8_t >          m_envWave;          // rms-follower of original waveform
+    std::vector< uint8_t >          m_envBeat;          // peak-follower on detected beats, giving smooth decay off each
+    std::vector< uint8_t >          m_envLowFreq;       // smoothed extraction of lower-band frequencies
+    std::vector< uint8_t >          m_envHighFreq;      // smoothed extraction of higher-band frequencies
 
 
+    // onsets must be added in ascending sample order, as they are during analysis
     inline void setBeatAtSample( const int64_t sampleIndex )
     {
-        const uint64_t bitBlock = sampleIndex >> BeatBitsShift;
-        const uint64_t bitBit = sampleIndex - (bitBlock << BeatBitsShift);
-
-        m_beatBitfield[bitBlock] |= 1ULL << bitBit;
+        ABSL_ASSERT( m_beatOnsets.empty() || m_beatOnsets.back() < sampleIndex );
+        m_beatOnsets.emplace_back( static_cast<int32_t>( sampleIndex ) );
     }
 
     ouro_nodiscard inline bool queryBeatAtSample( const int64_t sampleIndex ) const
     {
-        const uint64_t bitBlock = sampleIndex >> BeatBitsShift;
-        const uint64_t bitBit = sampleIndex - (bitBlock << BeatBitsShift);
+        const int64_t windowEnd = ( ( sampleIndex >> BeatWindowShift ) + 1 ) << BeatWindowShift;
 
-        return (m_beatBitfield[bitBlock] >> bitBit) != 0;
+        const auto onsetIt = std::lower_bound( m_beatOnsets.begin(), m_beatOnsets.end(), sampleIndex );
+        return onsetIt != m_beatOnsets.end() && *onsetIt < windowEnd;
     }
 
-    // one bit per sample bitfield, talk to it via functions above
-    std::vector< uint64_t >         m_beatBitfield;
+    // count the onsets that queryBeatAtSample() would report across a run of `rangeLength` samples from `rangeStart`
+    // in a stem `loopLength` samples long; the run may start beyond or wrap past the end of the stem. if `onsetsOut`
+    // is given, up to `onsetsOutMax` of the hits are written to it in playback order. costs a pair of binary searches
+    // per wrap rather than one per sample
+    ouro_nodiscard inline std::size_t queryBeatsInRange(
+        const int64_t       rangeStart,
+        int64_t             rangeLength,
+        const int64_t       loopLength,
+        int32_t*            onsetsOut       = nullptr,
+        const std::size_t   onsetsOutMax    = 0 ) const
+    {
+        if ( m_beatOnsets.empty() || rangeLength <= 0 || loopLength <= 0 )
+            return 0;
+
+        std::size_t hitCount = 0;
+
+        int64_t segmentStart = rangeStart % loopLength;
+        while ( rangeLength > 0 )
+        {
+            const int64_t segmentLength = std::min( rangeLength, loopLength - segmentStart );
+            const int64_t segmentLast   = segmentStart + segmentLength - 1;
+            const int64_t windowEnd     = ( ( segmentLast >> BeatWindowShift ) + 1 ) << BeatWindowShift;
+
+            const auto firstIt = std::lower_bound( m_beatOnsets.begin(), m_beatOnsets.end(), segmentStart );
+            const auto lastIt  = std::lower_bound( firstIt, m_beatOnsets.end(), windowEnd );
+
+            for ( auto onsetIt = firstIt; onsetIt != lastIt; ++onsetIt, ++hitCount )
+            {
+                if ( onsetsOut != nullptr && hitCount < onsetsOutMax )
+                    onsetsOut[hitCount] = *onsetIt;
+            }
+
+            rangeLength -= segmentLength;
+            segmentStart = 0;
+        }
+        return hitCount;
+    }
+
+    // as above, for the samples visited when playing `playbackLength` samples from riff-relative `playbackStart` with
+    // the stem read at `timeStretch`; the stretched index is floor( sample * timeStretch ), matching the mixers
+    ouro_nodiscard inline bool queryBeatInPlayback(
+        const int64_t       playbackStart,
+        const int64_t       playbackLength,
+        const float         timeStretch,
+        const int64_t       loopLength ) const
+    {
+        if ( playbackLength <= 0 )
+            return false;
+
+        if ( timeStretch == 1.0f )
+            return queryBeatsInRange( playbackStart, playbackLength, loopLength ) > 0;
+
+        // treat the stretched reads as one contiguous run; this reports everything a per-sample walk would, plus any
+        // onsets that a stretched walk steps over at the edge of a beat window
+        const int64_t stretchedFirst = static_cast<int64_t>( (double)playbackStart * timeStretch );
+        const int64_t stretchedLast  = static_cast<int64_t>( (double)( playbackStart + playbackLength - 1 ) * timeStretch );
+
+        return queryBeatsInRange( stretchedFirst, ( stretchedLast - stretchedFirst ) + 1, loopLength ) > 0;
+    }
+
+    // sorted sample indices of every detected beat; there are usually only a handful per stem
+    std::vector< int32_t >          m_beatOnsets;
+
+
+    // comparison of the envelope representation against the full per-sample data the analysis pass produces
+    // internally, filled in on request by Stem::analyse() for use by the debug tools
+    struct Accuracy
+    {
+        std::array< float, 4 >      m_meanError             = { 0, 0, 0, 0 };   // wave, beat, low, high; in 0..1 units
+        std::array< float, 4 >      m_maxError              = { 0, 0, 0, 0 };
+        std::size_t                 m_perSampleBytes        = 0;                // cost of storing everything per-sample
+        std::size_t                 m_compactBytes          = 0;
+        int64_t                     m_beatOnsetCount        = 0;
+        int64_t                     m_beatQueryMismatches   = 0;                // samples where queryBeatAtSample disagrees with a full bitfield
+    };
+
+private:
+
+    ouro_nodiscard static inline float sampleEnvelope( const std::vector< uint8_t >& envelope, const int64_t sampleIndex )
+    {
+        const std::size_t blockIndex = static_cast<std::size_t>( sampleIndex >> EnvelopeShift );
+        const float       blockT     = static_cast<float>( sampleIndex & ( EnvelopeBlockSize - 1 ) ) * EnvelopeBlockRecp;
+
+        return base::lerp( base::LUT::u8_to_float[ envelope[blockIndex] ], base::LUT::u8_to_float[ envelope[blockIndex + 1] ], blockT );
+    }
 };
 
 // ---------------------------------------------------------------------------------------------------------------------
@@ -131,6 +230,10 @@ struct Stem
         using UPtr = std::unique_ptr<Processing>;
         using FFTOctaves = dsp::FFTOctaveBuckets< 3 >;      // bucketing used during frequency collection
 
+        // stamped into persisted analysis data; bump this whenever a change to analyse() would produce different
+        // results from the same audio, so that stale sidecar files in the stem cache get ignored and rebuilt
+        static constexpr uint32_t AnalysisVersion = 2;
+
         ~Processing();
 
         PFFFT_Setup*    m_pffftPlan;                        // pffft setup, valid to share between simultaneous workers
@@ -155,19 +258,40 @@ struct Stem
 
     static Processing::UPtr createStemProcessing( const uint32_t targetSampleRate );
 
+    // when decoding progressively, how many samples (at the target rate) fetch() decodes before it returns
+    static constexpr int32_t ProgressiveDecodeFirstChunk = 16384;
+
 
-    Stem( const types::Stem& stemData, const uint32_t targetSampleRate );
+    Stem(
+        const types::Stem&              stemData,
+        const uint32_t                  targetSampleRate,
+        const StemStorage::Format::Enum storageFormat       = StemStorage::Format::Float32,
+        const bool                      progressiveDecode   = false,    // see completeDecode()
+        std::shared_ptr<cache::StemPack> stemPack           = nullptr );  // if set, cached data goes here instead of loose files
     ~Stem();
 
 
+    // stems are shared between riffs and can be requested from more than one thread at a time (eg. the playback
+    // pipeline and the prefetcher); the first caller to claim the stem is responsible for calling fetch(), anyone
+    // else that needs the audio data should waitForFetch() before touching it
+    ouro_nodiscard bool claimFetch();
+    void waitForFetch() const;
+
     // instigate a fetch of the stem data from either the cache or the network
     // note this is a blocking call and is designed to be called from a background thread in most cases
     void fetch( const api::NetConfiguration& ncfg, const fs::path& cachePath );
 
+    // with progressive decoding enabled (and Float32 storage), fetch() returns as soon as the first chunk of audio
+    // is ready - the stem is Complete and playable, with StemStorage::getSamplesAvailable() tracking how much of it
+    // can be read. this finishes the job, applying the loop sewing once the tail exists; safe to call from multiple
+    // threads, anyone arriving second blocks until the first is done. no-op if there's nothing left to decode
+    void completeDecode();
+
     // run analysis pass, producing things like onsets / peak-following / etc into the given result;
     // this result is passed as an argument so that we can also run this in debug tools to tune the processing
-    void analyse( const Processing& processing, StemAnalysisData& result ) const;
-    void analyse( const Processing& processing );   // convenience function that calls the above on current instance, also then toggling m_hasValidAnalysis
+    void analyse( const Processing& processing, StemAnalysisData& result, StemAnalysisData::Accuracy* accuracy = nullptr ) const;
+    void analyse( const Processing& processing );   // convenience function that calls the above on current instance, also then toggling m_hasValidAnalysis;
+                                                    // loads the result from the stem cache if a valid one was saved previously, writes it there if not
 
 
     // stem needs a copy of the analysis task future to ensure that in the unlikely case
@@ -199,8 +323,11 @@ struct Stem
         if ( m_state != State::Complete )
             return result;
 
-        // buffer data
-        result += ( static_cast<std::size_t>(m_sampleCount) * 2 ) * sizeof( float );
+        // buffer data; float channels may be released once a compact storage format has been encoded and analysed
+        if ( m_channel[0] != nullptr )
+            result += ( static_cast<std::size_t>(m_sampleCount) * 2 ) * sizeof( float );
+
+        result += m_storage.estimateMemoryUsageBytes();
 
         // add analysis chunk if it is ready
         if ( isAnalysisComplete() )
@@ -215,6 +342,15 @@ struct Stem
         return m_hasValidAnalysis;
     }
 
+    // playback should read audio through this (via a StemReader) rather than m_channel, which is only guaranteed
+    // to be valid during loading and analysis
+    ouro_nodiscard constexpr const StemStorage& getStorage() const { return m_storage; }
+
+    // shared read-only reference to the full float data, or nullptr if this stem has none (not loaded, or a compact
+    // storage format has already dropped it after analysis). holding the reference keeps the samples alive even if
+    // the stem lets go of them. with progressive decoding, only fully valid after completeDecode()
+    ouro_nodiscard StemSlab::Ptr getSampleSlab() const;
+
     ouro_nodiscard constexpr const StemAnalysisData& getAnalysisData() const { return m_analysisData; }
     ouro_nodiscard constexpr StemAnalysisData& getAnalysisData() { return m_analysisData; }
 
@@ -227,6 +363,9 @@ private:
 
         void allocate( size_t newSize );
 
+        // hand the buffer over to someone else, who becomes responsible for mem::free16'ing it
+        ouro_nodiscard uint8_t* release();
+
         size_t      m_rawLength;
         size_t      m_rawReceived;
         uint8_t*    m_rawAudio;
@@ -238,17 +377,60 @@ private:
     // returns false if something broke; sets the m_state appropriately in that case
     ouro_nodiscard bool attemptRemoteFetch( const api::NetConfiguration& ncfg, const uint32_t attemptUID, RawAudioMemory& audioMemory );
 
+    // set up m_streamDecoder and decode enough of the stem to start playback; returns false and sets m_state on failure
+    ouro_nodiscard bool beginProgressiveDecode( RawAudioMemory& audioMemory, const Compression compression, const fs::path& cacheFile, const std::string& logTag );
+
+    // how much of a progressively decoded stem can be handed to readers before the loop has been sewn
+    ouro_nodiscard int32_t getUnsewnSamplesAvailable() const;
+
     // blend a small window of samples at each end of the stem to reduce clicks on looping
     // (as best we can tell Endlesss also does something like this)
+    static constexpr int32_t LoopSewingWindowSize = 128;
     void applyLoopSewingBlend();
 
+    // create / drop m_samples, keeping m_channel pointing into it
+    void allocateChannels( const int32_t sampleCount );
+    void releaseChannels();
+
+    // write verified compressed audio back to the cache; into the stem pack if we have one, otherwise as a loose file
+    void writeToCache( const fs::path& cacheFile, const uint8_t* data, const std::size_t byteCount ) const;
+
+    // analysis data is persisted next to the cached stem audio; these return false if there was nothing
+    // valid to load (or if writing failed), in which case the caller can just carry on as normal
+    ouro_nodiscard bool loadAnalysisFromCache( const Processing& processing );
+    ouro_nodiscard bool saveAnalysisToCache( const Processing& processing ) const;
+
+
 
+    enum class FetchStage : uint8_t
+    {
+        Unclaimed,
+        InFlight,
+        Finished
+    };
 
     std::shared_future<void>        m_analysisFuture;
     std::atomic_bool                m_hasValidAnalysis; // set in async analysis if analysis data is to be trusted
+    std::atomic< FetchStage >       m_fetchStage;       // see claimFetch() / waitForFetch()
 
     Compression                     m_compressionFormat = Compression::Unknown;
 
+    const StemStorage::Format::Enum m_storageFormat;    // requested in-memory format, encoded into m_storage on fetch
+    StemStorage                     m_storage;
+
+    fs::path                        m_analysisCacheFile;    // set during fetch(), where analysis data is persisted to
+
+    const std::shared_ptr< cache::StemPack >
+                                    m_stemPack;             // null when the stem cache is using loose files
+
+    const bool                      m_progressiveDecode;
+    std::mutex                      m_streamDecodeLock;
+    StemStreamDecoder::UPtr         m_streamDecoder;        // live between a progressive fetch() and completeDecode()
+    fs::path                        m_streamCacheFile;      // where to write the compressed data once it is known to be good
+
+    mutable std::mutex              m_samplesLock;          // guards swapping m_samples, not the data in it
+    StemSlab::MutablePtr            m_samples;
+
     // #TODO move into accessors
 public:
     const types::Stem               m_data;
@@ -257,7 +439,7 @@ public:
 
     uint32_t                        m_sampleRate;
     int32_t                         m_sampleCount;
-    std::array<float*, 2>           m_channel;
+    std::array<float*, 2>           m_channel;          // writable views into m_samples, for use while loading
 
 private:
     StemAnalysisData                m_analysisData;
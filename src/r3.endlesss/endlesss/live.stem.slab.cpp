@@ -0,0 +1,121 @@
+//   _______ _______ ______ _______ ___ ___ _______ _______ _______ 
+//  |       |   |   |   __ \       |   |   |    ___|       |    |  |
+//  |   -   |   |   |      <   -   |   |   |    ___|   -   |       |
+//  |_______|_______|___|__|_______|\_____/|_______|_______|__|____|
+//  \\ harry denholm \\ ishani            ishani.org/shelf/ouroveon/
+//
+//  refcounted, cache-line aligned blocks of decoded stem audio, shared
+//  read-only between the stem cache and anything reading the samples
+//
+
+#include "pch.h"
+
+#include "endlesss/live.stem.slab.h"
+
+namespace endlesss {
+namespace live {
+
+namespace {
+
+std::atomic_size_t      gSlabLiveCount          = 0;
+std::atomic_size_t      gSlabLiveSampleBytes    = 0;
+std::atomic_size_t      gSlabLiveReservedBytes  = 0;
+std::atomic_size_t      gSlabHighWaterCount     = 0;
+std::atomic_size_t      gSlabHighWaterReserved  = 0;
+std::atomic_uint64_t    gSlabTotalCreated       = 0;
+std::atomic_uint64_t    gSlabTotalReleased      = 0;
+
+inline void updateHighWater( std::atomic_size_t& highWater, const std::size_t value )
+{
+    std::size_t current = highWater.load( std::memory_order_relaxed );
+    while ( value > current && !highWater.compare_exchange_weak( current, value, std::memory_order_relaxed ) ) {}
+}
+
+} // anonymous namespace
+
+// ---------------------------------------------------------------------------------------------------------------------
+StemSlab::MutablePtr StemSlab::create( const int32_t sampleCount )
+{
+    ABSL_ASSERT( sampleCount >= 0 );
+
+    // round each channel up to a whole number of cache lines so the right channel starts aligned too
+    const std::size_t channelBytes  = static_cast<std::size_t>( std::max( sampleCount, 1 ) ) * sizeof( float );
+    const std::size_t channelStride = ( channelBytes + Alignment - 1 ) & ~( Alignment - 1 );
+
+    void* memory = rpaligned_alloc( Alignment, channelStride * 2 );
+    if ( memory == nullptr )
+        return nullptr;
+
+    const std::size_t reservedBytes = rpmalloc_usable_size( memory );
+
+    return MutablePtr( new StemSlab( memory, reservedBytes, channelStride, sampleCount ) );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+StemSlab::StemSlab( void* memory, const std::size_t reservedBytes, const std::size_t channelStride, const int32_t sampleCount )
+    : m_memory( memory )
+    , m_reservedBytes( reservedBytes )
+    , m_sampleCount( sampleCount )
+{
+    uint8_t* base = static_cast<uint8_t*>( m_memory );
+    m_channels[0] = reinterpret_cast<float*>( base );
+    m_channels[1] = reinterpret_cast<float*>( base + channelStride );
+
+    StemSlabArena::onCreated( static_cast<std::size_t>( m_sampleCount ) * 2 * sizeof( float ), m_reservedBytes );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+StemSlab::~StemSlab()
+{
+    StemSlabArena::onReleased( static_cast<std::size_t>( m_sampleCount ) * 2 * sizeof( float ), m_reservedBytes );
+
+    rpfree( m_memory );
+    m_memory = nullptr;
+    m_channels.fill( nullptr );
+}
+
+
+// ---------------------------------------------------------------------------------------------------------------------
+StemSlabArena::Statistics StemSlabArena::getStatistics()
+{
+    Statistics stats;
+    stats.m_liveSlabs               = gSlabLiveCount.load( std::memory_order_relaxed );
+    stats.m_liveSampleBytes         = gSlabLiveSampleBytes.load( std::memory_order_relaxed );
+    stats.m_liveReservedBytes       = gSlabLiveReservedBytes.load( std::memory_order_relaxed );
+    stats.m_highWaterSlabs          = gSlabHighWaterCount.load( std::memory_order_relaxed );
+    stats.m_highWaterReservedBytes  = gSlabHighWaterReserved.load( std::memory_order_relaxed );
+    stats.m_totalCreated            = gSlabTotalCreated.load( std::memory_order_relaxed );
+    stats.m_totalReleased           = gSlabTotalReleased.load( std::memory_order_relaxed );
+    return stats;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void StemSlabArena::resetHighWater()
+{
+    gSlabHighWaterCount.store( gSlabLiveCount.load( std::memory_order_relaxed ), std::memory_order_relaxed );
+    gSlabHighWaterReserved.store( gSlabLiveReservedBytes.load( std::memory_order_relaxed ), std::memory_order_relaxed );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void StemSlabArena::onCreated( const std::size_t sampleBytes, const std::size_t reservedBytes )
+{
+    const std::size_t liveCount     = gSlabLiveCount.fetch_add( 1, std::memory_order_relaxed ) + 1;
+    const std::size_t liveReserved  = gSlabLiveReservedBytes.fetch_add( reservedBytes, std::memory_order_relaxed ) + reservedBytes;
+    gSlabLiveSampleBytes.fetch_add( sampleBytes, std::memory_order_relaxed );
+    gSlabTotalCreated.fetch_add( 1, std::memory_order_relaxed );
+
+    updateHighWater( gSlabHighWaterCount, liveCount );
+    updateHighWater( gSlabHighWaterReserved, liveReserved );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void StemSlabArena::onReleased( const std::size_t sampleBytes, const std::size_t reservedBytes )
+{
+    gSlabLiveCount.fetch_sub( 1, std::memory_order_relaxed );
+    gSlabLiveReservedBytes.fetch_sub( reservedBytes, std::memory_order_relaxed );
+    gSlabLiveSampleBytes.fetch_sub( sampleBytes, std::memory_order_relaxed );
+    gSlabTotalReleased.fetch_add( 1, std::memory_order_relaxed );
+}
+
+} // namespace live
+} // namespace endlesss
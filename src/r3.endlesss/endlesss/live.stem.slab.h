@@ -0,0 +1,106 @@
+//   _______ _______ ______ _______ ___ ___ _______ _______ _______ 
+//  |       |   |   |   __ \       |   |   |    ___|       |    |  |
+//  |   -   |   |   |      <   -   |   |   |    ___|   -   |       |
+//  |_______|_______|___|__|_______|\_____/|_______|_______|__|____|
+//  \\ harry denholm \\ ishani            ishani.org/shelf/ouroveon/
+//
+//  refcounted, cache-line aligned blocks of decoded stem audio, shared
+//  read-only between the stem cache and anything reading the samples
+//
+
+#pragma once
+
+#include <span>
+
+#include "base/construction.h"
+
+namespace endlesss {
+namespace live {
+
+// ---------------------------------------------------------------------------------------------------------------------
+// both channels of a stem's float data in a single allocation, each channel starting on a cache line. the stem that
+// creates a slab is the only writer, and only while it is loading; once published through StemSlab::Ptr the data is
+// treated as immutable, so consumers (export, waveform previews, tooling) can hold a reference and read spans directly
+// without copying - and without caring if the stem itself drops its reference in the meantime
+//
+struct StemSlab
+{
+    DECLARE_NO_COPY_NO_MOVE( StemSlab );
+
+    static constexpr std::size_t    Alignment = 64;
+
+    using Ptr        = std::shared_ptr< const StemSlab >;
+    using MutablePtr = std::shared_ptr< StemSlab >;
+
+    // contents are uninitialised; returns nullptr if the allocation failed
+    ouro_nodiscard static MutablePtr create( const int32_t sampleCount );
+
+    ~StemSlab();
+
+    ouro_nodiscard constexpr int32_t getSampleCount() const { return m_sampleCount; }
+
+    ouro_nodiscard inline std::span< const float > getChannel( const std::size_t channel ) const
+    {
+        ABSL_ASSERT( channel < 2 );
+        return { m_channels[channel], static_cast<std::size_t>( m_sampleCount ) };
+    }
+
+    // for the owning stem to fill in during decode, before anyone else can see the slab
+    ouro_nodiscard inline float* getWritableChannel( const std::size_t channel )
+    {
+        ABSL_ASSERT( channel < 2 );
+        return m_channels[channel];
+    }
+
+    // bytes actually reserved from the allocator for this slab, including alignment padding
+    ouro_nodiscard constexpr std::size_t getReservedBytes() const { return m_reservedBytes; }
+
+private:
+
+    StemSlab( void* memory, const std::size_t reservedBytes, const std::size_t channelStride, const int32_t sampleCount );
+
+    void*                       m_memory        = nullptr;
+    std::size_t                 m_reservedBytes = 0;
+    int32_t                     m_sampleCount   = 0;
+    std::array< float*, 2 >     m_channels      = { nullptr, nullptr };
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+// global accounting for all live slabs; slabs are carved from rpmalloc with cache-line alignment, this tracks how much
+// of that is actually sample data versus padding and allocator size-class rounding
+//
+struct StemSlabArena
+{
+    struct Statistics
+    {
+        std::size_t     m_liveSlabs             = 0;
+        std::size_t     m_liveSampleBytes       = 0;    // float data the slabs were asked for
+        std::size_t     m_liveReservedBytes     = 0;    // what the allocator actually handed out for them
+        std::size_t     m_highWaterSlabs        = 0;
+        std::size_t     m_highWaterReservedBytes= 0;
+        uint64_t        m_totalCreated          = 0;
+        uint64_t        m_totalReleased         = 0;
+
+        // fraction of reserved memory not holding samples
+        ouro_nodiscard inline float getFragmentation() const
+        {
+            if ( m_liveReservedBytes == 0 )
+                return 0.0f;
+            return 1.0f - ( static_cast<float>( m_liveSampleBytes ) / static_cast<float>( m_liveReservedBytes ) );
+        }
+    };
+
+    ouro_nodiscard static Statistics getStatistics();
+
+    // drop high-water marks back to current usage
+    static void resetHighWater();
+
+private:
+    friend StemSlab;
+
+    static void onCreated( const std::size_t sampleBytes, const std::size_t reservedBytes );
+    static void onReleased( const std::size_t sampleBytes, const std::size_t reservedBytes );
+};
+
+} // namespace live
+} // namespace endlesss
@@ -0,0 +1,320 @@
+//   _______ _______ ______ _______ ___ ___ _______ _______ _______ 
+//  |       |   |   |   __ \       |   |   |    ___|       |    |  |
+//  |   -   |   |   |      <   -   |   |   |    ___|   -   |       |
+//  |_______|_______|___|__|_______|\_____/|_______|_______|__|____|
+//  \\ harry denholm \\ ishani            ishani.org/shelf/ouroveon/
+//
+//  
+//
+
+#include "pch.h"
+
+#include "endlesss/live.stem.storage.h"
+
+namespace endlesss {
+namespace live {
+
+namespace adpcm {
+
+// standard IMA ADPCM tables
+static constexpr std::array< int32_t, 89 > cStepTable =
+{
+        7,     8,     9,    10,    11,    12,    13,    14,    16,    17,
+       19,    21,    23,    25,    28,    31,    34,    37,    41,    45,
+       50,    55,    60,    66,    73,    80,    88,    97,   107,   118,
+      130,   143,   157,   173,   190,   209,   230,   253,   279,   307,
+      337,   371,   408,   449,   494,   544,   598,   658,   724,   796,
+      876,   963,  1060,  1166,  1282,  1411,  1552,  1707,  1878,  2066,
+     2272,  2499,  2749,  3024,  3327,  3660,  4026,  4428,  4871,  5358,
+     5894,  6484,  7132,  7845,  8630,  9493, 10442, 11487, 12635, 13899,
+    15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+};
+
+static constexpr std::array< int32_t, 16 > cIndexTable =
+{
+    -1, -1, -1, -1, 2, 4, 6, 8,
+    -1, -1, -1, -1, 2, 4, 6, 8
+};
+
+struct State
+{
+    int32_t     m_predictor = 0;
+    int32_t     m_stepIndex = 0;
+
+    // apply a 4-bit code to the state, returning the new predicted sample
+    inline int32_t decode( const uint8_t code )
+    {
+        const int32_t step = cStepTable[m_stepIndex];
+
+        int32_t delta = step >> 3;
+        if ( code & 4 ) delta += step;
+        if ( code & 2 ) delta += step >> 1;
+        if ( code & 1 ) delta += step >> 2;
+
+        m_predictor += ( code & 8 ) ? -delta : delta;
+        m_predictor  = std::clamp( m_predictor, -32768, 32767 );
+
+        m_stepIndex  = std::clamp( m_stepIndex + cIndexTable[code], 0, 88 );
+
+        return m_predictor;
+    }
+
+    // choose the best code for the target sample; runs decode() so that the encoder tracks exactly what the decoder will see
+    inline uint8_t encode( const int32_t sample )
+    {
+        const int32_t step = cStepTable[m_stepIndex];
+
+        int32_t diff = sample - m_predictor;
+        uint8_t code = 0;
+        if ( diff < 0 )
+        {
+            code = 8;
+            diff = -diff;
+        }
+        if ( diff >= step )        { code |= 4; diff -= step; }
+        if ( diff >= step >> 1 )   { code |= 2; diff -= step >> 1; }
+        if ( diff >= step >> 2 )   { code |= 1; }
+
+        decode( code );
+        return code;
+    }
+};
+
+inline int16_t floatToInt16( const float sample )
+{
+    return static_cast<int16_t>( std::clamp( sample * 32767.0f, -32768.0f, 32767.0f ) );
+}
+
+// write one channel's worth of a block; the first sample goes in the header verbatim, the rest as packed nibbles
+inline void encodeChannelBlock( State& state, const float* input, const int32_t frames, uint8_t* output )
+{
+    const int16_t firstSample = floatToInt16( input[0] );
+
+    state.m_predictor = firstSample;
+
+    output[0] = static_cast<uint8_t>( firstSample & 0xFF );
+    output[1] = static_cast<uint8_t>( ( firstSample >> 8 ) & 0xFF );
+    output[2] = static_cast<uint8_t>( state.m_stepIndex );
+    output[3] = 0;
+
+    uint8_t* nibbles = output + StemStorage::BlockHeaderBytes;
+    std::memset( nibbles, 0, StemStorage::BlockFrames / 2 );
+
+    for ( int32_t frame = 1; frame < frames; frame++ )
+    {
+        const uint8_t code = state.encode( floatToInt16( input[frame] ) );
+        const int32_t nibbleIndex = frame - 1;
+
+        nibbles[nibbleIndex >> 1] |= ( nibbleIndex & 1 ) ? ( code << 4 ) : code;
+    }
+}
+
+inline void decodeChannelBlock( const uint8_t* input, const int32_t frames, float* output )
+{
+    constexpr float int16ToFloat = 1.0f / 32767.0f;
+
+    State state;
+    state.m_predictor = static_cast<int16_t>( input[0] | ( input[1] << 8 ) );
+    state.m_stepIndex = std::min<int32_t>( input[2], 88 );
+
+    output[0] = static_cast<float>( state.m_predictor ) * int16ToFloat;
+
+    const uint8_t* nibbles = input + StemStorage::BlockHeaderBytes;
+    for ( int32_t frame = 1; frame < frames; frame++ )
+    {
+        const int32_t nibbleIndex = frame - 1;
+        const uint8_t packed = nibbles[nibbleIndex >> 1];
+        const uint8_t code = ( nibbleIndex & 1 ) ? ( packed >> 4 ) : ( packed & 0x0F );
+
+        output[frame] = static_cast<float>( state.decode( code ) ) * int16ToFloat;
+    }
+}
+
+} // namespace adpcm
+
+// ---------------------------------------------------------------------------------------------------------------------
+static std::atomic_uint32_t gStemStorageSerial = 0;
+
+// ---------------------------------------------------------------------------------------------------------------------
+StemStorage::~StemStorage()
+{
+    release();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void StemStorage::release()
+{
+    mem::free16( m_pcm );
+    mem::free16( m_blocks );
+
+    m_pcm           = nullptr;
+    m_blocks        = nullptr;
+    m_blockCount    = 0;
+    m_float         = { nullptr, nullptr };
+    m_sampleCount   = 0;
+    m_format        = Format::Float32;
+
+    m_samplesAvailable.store( 0, std::memory_order_release );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void StemStorage::bindFloat( const float* left, const float* right, const int32_t sampleCount, const int32_t samplesAvailable )
+{
+    release();
+
+    m_format        = Format::Float32;
+    m_sampleCount   = sampleCount;
+    m_float         = { left, right };
+    m_serial        = ++gStemStorageSerial;
+
+    m_samplesAvailable.store( std::min( samplesAvailable, sampleCount ), std::memory_order_release );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void StemStorage::setSamplesAvailable( const int32_t samplesAvailable )
+{
+    ABSL_ASSERT( m_format == Format::Float32 );
+    ABSL_ASSERT( samplesAvailable >= m_samplesAvailable.load( std::memory_order_relaxed ) );
+
+    m_samplesAvailable.store( std::min( samplesAvailable, m_sampleCount ), std::memory_order_release );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void StemStorage::encode( const Format::Enum format, const float* left, const float* right, const int32_t sampleCount )
+{
+    if ( format == Format::Float32 )
+    {
+        bindFloat( left, right, sampleCount );
+        return;
+    }
+
+    release();
+
+    m_format        = format;
+    m_sampleCount   = sampleCount;
+    m_serial        = ++gStemStorageSerial;
+
+    switch ( format )
+    {
+        case Format::Int16:
+        {
+            m_pcm = mem::alloc16<int16_t>( static_cast<std::size_t>( sampleCount ) * 2 );
+            for ( int32_t sI = 0; sI < sampleCount; sI++ )
+            {
+                m_pcm[ ( sI * 2 ) + 0 ] = adpcm::floatToInt16( left[sI] );
+                m_pcm[ ( sI * 2 ) + 1 ] = adpcm::floatToInt16( right[sI] );
+            }
+        }
+        break;
+
+        case Format::ADPCM:
+        {
+            m_blockCount = ( sampleCount + BlockFrameMask ) >> BlockFrameShift;
+            m_blocks     = mem::alloc16<uint8_t>( static_cast<std::size_t>( m_blockCount ) * BlockBytes );
+
+            // encoder step index carries across blocks, it's only the decoder that starts afresh from each header
+            adpcm::State stateLeft, stateRight;
+            for ( int32_t blockI = 0; blockI < m_blockCount; blockI++ )
+            {
+                const int32_t blockStart  = blockI << BlockFrameShift;
+                const int32_t blockFrames = std::min( BlockFrames, sampleCount - blockStart );
+
+                uint8_t* blockData = m_blocks + ( static_cast<std::size_t>( blockI ) * BlockBytes );
+
+                adpcm::encodeChannelBlock( stateLeft,  left  + blockStart, blockFrames, blockData );
+                adpcm::encodeChannelBlock( stateRight, right + blockStart, blockFrames, blockData + BlockChannelBytes );
+            }
+        }
+        break;
+
+        default:
+            ABSL_ASSERT( false );
+            break;
+    }
+
+    m_samplesAvailable.store( sampleCount, std::memory_order_release );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void StemStorage::decode( float* left, float* right ) const
+{
+    switch ( m_format )
+    {
+        case Format::Float32:
+        {
+            std::memcpy( left,  m_float[0], sizeof( float ) * m_sampleCount );
+            std::memcpy( right, m_float[1], sizeof( float ) * m_sampleCount );
+        }
+        break;
+
+        case Format::Int16:
+        {
+            for ( int32_t sI = 0; sI < m_sampleCount; sI++ )
+                readInt16( sI, left[sI], right[sI] );
+        }
+        break;
+
+        case Format::ADPCM:
+        {
+            for ( int32_t blockI = 0; blockI < m_blockCount; blockI++ )
+            {
+                const int32_t blockStart  = blockI << BlockFrameShift;
+                const int32_t blockFrames = std::min( BlockFrames, m_sampleCount - blockStart );
+
+                const uint8_t* blockData = m_blocks + ( static_cast<std::size_t>( blockI ) * BlockBytes );
+
+                adpcm::decodeChannelBlock( blockData,                     blockFrames, left  + blockStart );
+                adpcm::decodeChannelBlock( blockData + BlockChannelBytes, blockFrames, right + blockStart );
+            }
+        }
+        break;
+
+        default:
+            ABSL_ASSERT( false );
+            break;
+    }
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void StemStorage::decodeBlock( const int32_t blockIndex, float* left, float* right ) const
+{
+    ABSL_ASSERT( m_format == Format::ADPCM );
+    ABSL_ASSERT( blockIndex >= 0 && blockIndex < m_blockCount );
+
+    const int32_t blockStart  = blockIndex << BlockFrameShift;
+    const int32_t blockFrames = std::min( BlockFrames, m_sampleCount - blockStart );
+
+    const uint8_t* blockData = m_blocks + ( static_cast<std::size_t>( blockIndex ) * BlockBytes );
+
+    adpcm::decodeChannelBlock( blockData,                     blockFrames, left );
+    adpcm::decodeChannelBlock( blockData + BlockChannelBytes, blockFrames, right );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+std::size_t StemStorage::estimateMemoryUsageBytes() const
+{
+    switch ( m_format )
+    {
+        case Format::Int16: return static_cast<std::size_t>( m_sampleCount ) * 2 * sizeof( int16_t );
+        case Format::ADPCM: return static_cast<std::size_t>( m_blockCount ) * BlockBytes;
+        default:
+            return 0;
+    }
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+StemReader::StemReader()
+{
+    m_scratch[0] = mem::alloc16<float>( StemStorage::BlockFrames );
+    m_scratch[1] = mem::alloc16<float>( StemStorage::BlockFrames );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+StemReader::~StemReader()
+{
+    mem::free16( m_scratch[0] );
+    mem::free16( m_scratch[1] );
+}
+
+} // namespace live
+} // namespace endlesss
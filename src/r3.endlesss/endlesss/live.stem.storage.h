@@ -0,0 +1,160 @@
+//   _______ _______ ______ _______ ___ ___ _______ _______ _______ 
+//  |       |   |   |   __ \       |   |   |    ___|       |    |  |
+//  |   -   |   |   |      <   -   |   |   |    ___|   -   |       |
+//  |_______|_______|___|__|_______|\_____/|_______|_______|__|____|
+//  \\ harry denholm \\ ishani            ishani.org/shelf/ouroveon/
+//
+//  
+//
+
+#pragma once
+
+#include "base/construction.h"
+#include "config/performance.h"
+
+namespace endlesss {
+namespace live {
+
+// ---------------------------------------------------------------------------------------------------------------------
+// decoded stem audio, held in one of the StemStorageFormat representations
+//
+//  Float32 - a non-owning view of the stem's own float channels, exactly as before
+//  Int16   - interleaved 16-bit PCM, half the size of the floats and trivial to read back
+//  ADPCM   - 4-bit IMA ADPCM in fixed-size blocks, roughly 1/8th the size of the floats; each block carries its own
+//            predictor state so any block can be decoded in isolation - the "seek table" is just blockIndex * blockBytes
+//
+struct StemStorage
+{
+    DECLARE_NO_COPY_NO_MOVE( StemStorage );
+
+    using Format = config::StemStorageFormat;
+
+    static constexpr int32_t        BlockFrameShift     = 10;
+    static constexpr int32_t        BlockFrames         = 1 << BlockFrameShift;     // sample frames per ADPCM block
+    static constexpr int32_t        BlockFrameMask      = BlockFrames - 1;
+    static constexpr std::size_t    BlockHeaderBytes    = 4;                        // int16 predictor, uint8 step index, padding
+    static constexpr std::size_t    BlockChannelBytes   = BlockHeaderBytes + ( BlockFrames / 2 );
+    static constexpr std::size_t    BlockBytes          = BlockChannelBytes * 2;    // left then right
+
+    StemStorage() = default;
+    ~StemStorage();
+
+    // point at float data owned elsewhere; if that data is still being filled in (see StemStreamDecoder) then
+    // samplesAvailable marks how far it is safe to read, and can be advanced with setSamplesAvailable()
+    void bindFloat( const float* left, const float* right, const int32_t sampleCount, const int32_t samplesAvailable = std::numeric_limits<int32_t>::max() );
+    void setSamplesAvailable( const int32_t samplesAvailable );
+
+    // build a compressed representation of the given float data; Float32 is equivalent to bindFloat()
+    void encode( const Format::Enum format, const float* left, const float* right, const int32_t sampleCount );
+
+    // decode the whole lot back out to floats, used by analysis and tooling rather than during playback
+    void decode( float* left, float* right ) const;
+
+    // decode a single ADPCM block; outputs must have room for BlockFrames samples
+    void decodeBlock( const int32_t blockIndex, float* left, float* right ) const;
+
+
+    ouro_nodiscard constexpr Format::Enum getFormat() const { return m_format; }
+    ouro_nodiscard constexpr int32_t getSampleCount() const { return m_sampleCount; }
+    ouro_nodiscard constexpr uint32_t getSerial() const { return m_serial; }
+
+    // writer publishes with release after filling the samples in, so anything below this is safe to read; never blocks
+    ouro_nodiscard inline int32_t getSamplesAvailable() const { return m_samplesAvailable.load( std::memory_order_acquire ); }
+
+    // bytes owned by this instance; Float32 views report 0 as the memory belongs to the stem
+    ouro_nodiscard std::size_t estimateMemoryUsageBytes() const;
+
+    inline void readFloat( const int64_t sampleIndex, float& left, float& right ) const
+    {
+        left  = m_float[0][sampleIndex];
+        right = m_float[1][sampleIndex];
+    }
+
+    inline void readInt16( const int64_t sampleIndex, float& left, float& right ) const
+    {
+        constexpr float int16ToFloat = 1.0f / 32767.0f;
+
+        left  = static_cast<float>( m_pcm[ ( sampleIndex * 2 ) + 0 ] ) * int16ToFloat;
+        right = static_cast<float>( m_pcm[ ( sampleIndex * 2 ) + 1 ] ) * int16ToFloat;
+    }
+
+private:
+
+    void release();
+
+    Format::Enum                m_format        = Format::Float32;
+    int32_t                     m_sampleCount   = 0;
+    uint32_t                    m_serial        = 0;        // unique per encode, lets readers spot a change of source
+    std::atomic_int32_t         m_samplesAvailable = 0;     // read watermark, equal to m_sampleCount once fully decoded
+
+    std::array<const float*, 2> m_float         = { nullptr, nullptr };
+    int16_t*                    m_pcm           = nullptr;
+    uint8_t*                    m_blocks        = nullptr;
+    int32_t                     m_blockCount    = 0;
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+// per-voice playback cursor over a StemStorage; ADPCM blocks are decoded on demand into a small scratch buffer that
+// is allocated up-front, so reading is allocation free and suitable for use in the mixer
+//
+struct StemReader
+{
+    DECLARE_NO_COPY_NO_MOVE( StemReader );
+
+    StemReader();
+    ~StemReader();
+
+    // forget any decoded block; call if the storage may have been released and reallocated
+    inline void reset()
+    {
+        m_serial     = 0;
+        m_blockIndex = -1;
+    }
+
+    inline void read( const StemStorage& storage, const int64_t sampleIndex, float& left, float& right )
+    {
+        // stems decoded progressively play silence over the part that hasn't arrived yet rather than wait for it
+        if ( sampleIndex >= storage.getSamplesAvailable() )
+        {
+            left  = 0;
+            right = 0;
+            return;
+        }
+
+        switch ( storage.getFormat() )
+        {
+            default:
+            case StemStorage::Format::Float32:  storage.readFloat( sampleIndex, left, right ); break;
+            case StemStorage::Format::Int16:    storage.readInt16( sampleIndex, left, right ); break;
+            case StemStorage::Format::ADPCM:
+            {
+                const int32_t blockIndex = static_cast<int32_t>( sampleIndex >> StemStorage::BlockFrameShift );
+                if ( blockIndex != m_blockIndex || storage.getSerial() != m_serial )
+                {
+                    storage.decodeBlock( blockIndex, m_scratch[0], m_scratch[1] );
+
+                    m_serial     = storage.getSerial();
+                    m_blockIndex = blockIndex;
+                    m_blockDecodes++;
+                }
+                const int64_t blockOffset = sampleIndex & StemStorage::BlockFrameMask;
+                left  = m_scratch[0][blockOffset];
+                right = m_scratch[1][blockOffset];
+            }
+            break;
+        }
+    }
+
+    // running total of ADPCM blocks decoded, for profiling
+    ouro_nodiscard constexpr uint64_t getBlockDecodeCount() const { return m_blockDecodes; }
+
+private:
+
+    uint32_t                    m_serial        = 0;
+    int32_t                     m_blockIndex    = -1;
+    uint64_t                    m_blockDecodes  = 0;
+    std::array<float*, 2>       m_scratch;
+};
+
+} // namespace live
+} // namespace endlesss
@@ -0,0 +1,333 @@
+//   _______ _______ ______ _______ ___ ___ _______ _______ _______ 
+//  |       |   |   |   __ \       |   |   |    ___|       |    |  |
+//  |   -   |   |   |      <   -   |   |   |    ___|   -   |       |
+//  |_______|_______|___|__|_______|\_____/|_______|_______|__|____|
+//  \\ harry denholm \\ ishani            ishani.org/shelf/ouroveon/
+//
+//  
+//
+
+#include "pch.h"
+
+#include "base/utils.h"
+
+#include "endlesss/live.stem.stream.h"
+
+// vorbis decode
+#define STB_VORBIS_HEADER_ONLY
+#include "stb_vorbis.c"
+
+// foxen flac
+#include <foxen/flac.h>
+
+// r8brain
+#include "CDSPResampler.h"
+
+namespace endlesss {
+namespace live {
+
+// size of the intermediate buffer fx_flac writes interleaved samples into
+static constexpr uint32_t cFlacFrameBufferSize = 1024 * 4;
+
+// ---------------------------------------------------------------------------------------------------------------------
+StemStreamDecoder::UPtr StemStreamDecoder::create(
+    const Codec         codec,
+    uint8_t*            rawAudio,
+    const std::size_t   rawLength,
+    const uint32_t      targetSampleRate,
+    const std::string&  logTag )
+{
+    UPtr decoder( new StemStreamDecoder( codec, rawAudio, rawLength, logTag ) );
+
+    const bool opened = ( codec == Codec::OggVorbis ) ? decoder->openVorbis() : decoder->openFLAC();
+    if ( !opened )
+        return nullptr;
+
+    const int64_t outputSampleCount = getResampledLength( decoder->m_sourceSampleCount, decoder->m_sourceSampleRate, targetSampleRate );
+
+    // stream the data through r8brain if the source is at a different rate to the mixer
+    if ( decoder->m_sourceSampleRate != targetSampleRate )
+    {
+        blog::stem( FMTX( "[s:{}..] streaming resample from {}" ), logTag, decoder->m_sourceSampleRate );
+
+        for ( auto& resampler : decoder->m_resamplers )
+        {
+            resampler = std::make_unique< r8b::CDSPResampler24 >(
+                static_cast<double>( decoder->m_sourceSampleRate ),
+                static_cast<double>( targetSampleRate ),
+                SourceChunkFrames );
+        }
+    }
+
+    if ( outputSampleCount <= 0 || outputSampleCount >= std::numeric_limits<int32_t>::max() )
+    {
+        blog::error::stem( FMTX( "[s:{}..] stream reports unusable length ({} samples)" ), logTag, decoder->m_sourceSampleCount );
+        return nullptr;
+    }
+    decoder->m_outputSampleCount = static_cast<int32_t>( outputSampleCount );
+
+    decoder->m_source[0] = mem::alloc16<double>( SourceChunkFrames );
+    decoder->m_source[1] = mem::alloc16<double>( SourceChunkFrames );
+
+    return decoder;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+int64_t StemStreamDecoder::getResampledLength( const int64_t sourceSampleCount, const uint32_t sourceSampleRate, const uint32_t targetSampleRate )
+{
+    if ( sourceSampleRate == targetSampleRate || sourceSampleRate == 0 )
+        return sourceSampleCount;
+
+    // exact integer ceil( count * target / source ), avoiding double rounding on long stems
+    return ( ( sourceSampleCount * targetSampleRate ) + sourceSampleRate - 1 ) / sourceSampleRate;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+StemStreamDecoder::StemStreamDecoder( const Codec codec, uint8_t* rawAudio, const std::size_t rawLength, const std::string& logTag )
+    : m_codec( codec )
+    , m_logTag( logTag )
+    , m_rawAudio( rawAudio )
+    , m_rawLength( rawLength )
+{
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+StemStreamDecoder::~StemStreamDecoder()
+{
+    if ( m_vorbis != nullptr )
+        stb_vorbis_close( m_vorbis );
+
+    mem::free16( m_vorbisInterleaved );
+    mem::free16( m_flacFrameBuffer );
+    mem::free16( m_flacWorkingMemory );
+    mem::free16( m_source[0] );
+    mem::free16( m_source[1] );
+    mem::free16( m_rawAudio );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+bool StemStreamDecoder::openVorbis()
+{
+    int32_t vorbisError = 0;
+    m_vorbis = stb_vorbis_open_memory( m_rawAudio, static_cast<int32_t>( m_rawLength ), &vorbisError, nullptr );
+    if ( m_vorbis == nullptr )
+    {
+        blog::error::stem( FMTX( "[s:{}..] vorbis stream failed to open ({})" ), m_logTag, vorbisError );
+        return false;
+    }
+
+    const stb_vorbis_info vorbisInfo = stb_vorbis_get_info( m_vorbis );
+    if ( vorbisInfo.channels != 2 )
+    {
+        blog::error::stem( FMTX( "[s:{}..] invalid vorbis stream, only stereo supported; {} channels found" ), m_logTag, vorbisInfo.channels );
+        return false;
+    }
+
+    m_sourceSampleRate  = vorbisInfo.sample_rate;
+    m_sourceSampleCount = stb_vorbis_stream_length_in_samples( m_vorbis );
+
+    m_vorbisInterleaved = mem::alloc16<int16_t>( SourceChunkFrames * 2 );
+    return true;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+bool StemStreamDecoder::openFLAC()
+{
+    const uint32_t flacWorkingMemorySize = fx_flac_size( FLAC_MAX_BLOCK_SIZE, FLAC_MAX_CHANNEL_COUNT );
+
+    m_flacWorkingMemory = mem::alloc16<uint8_t>( flacWorkingMemorySize );
+    m_flac              = fx_flac_init( m_flacWorkingMemory, FLAC_MAX_BLOCK_SIZE, FLAC_MAX_CHANNEL_COUNT );
+    m_flacFrameBuffer   = mem::alloc16<int32_t>( cFlacFrameBufferSize );
+
+    // run the decoder up to the end of the STREAMINFO block, which always comes first
+    for (;;)
+    {
+        if ( m_rawConsumed >= m_rawLength )
+        {
+            blog::error::stem( FMTX( "[s:{}..] flac decode error - stream ended before metadata" ), m_logTag );
+            return false;
+        }
+
+        uint32_t rawAudioInBytes     = static_cast<uint32_t>( m_rawLength - m_rawConsumed );
+        uint32_t flacAudioOutSamples = 0;
+
+        const fx_flac_state_t flacState = fx_flac_process( m_flac, m_rawAudio + m_rawConsumed, &rawAudioInBytes, m_flacFrameBuffer, &flacAudioOutSamples );
+        m_rawConsumed += rawAudioInBytes;
+
+        if ( flacState == FLAC_ERR )
+        {
+            blog::error::stem( FMTX( "[s:{}..] flac decode error - unknown error from fx_flac_process" ), m_logTag );
+            return false;
+        }
+        if ( flacState >= FLAC_SEARCH_FRAME )
+        {
+            blog::error::stem( FMTX( "[s:{}..] flac decode error - no metadata decoded before frames encountered" ), m_logTag );
+            return false;
+        }
+        if ( flacState == FLAC_END_OF_METADATA )
+            break;
+    }
+
+    const int64_t flacChannelCount = fx_flac_get_streaminfo( m_flac, FLAC_KEY_N_CHANNELS );
+    const int64_t flacSampleSize   = fx_flac_get_streaminfo( m_flac, FLAC_KEY_SAMPLE_SIZE );
+
+    if ( flacChannelCount != 2 )
+    {
+        blog::error::stem( FMTX( "[s:{}..] flac decode error - expecting 2 channels, got {}" ), m_logTag, flacChannelCount );
+        return false;
+    }
+
+    m_sourceSampleRate  = static_cast<uint32_t>( fx_flac_get_streaminfo( m_flac, FLAC_KEY_SAMPLE_RATE ) );
+    m_sourceSampleCount = fx_flac_get_streaminfo( m_flac, FLAC_KEY_N_SAMPLES );
+
+    blog::stem( FMTX( "[s:{}..] start streaming flac decode : {} samples, {}-bit @ {}" ),
+        m_logTag,
+        m_sourceSampleCount,
+        flacSampleSize,
+        m_sourceSampleRate );
+
+    // samples arrive shifted to fill an int32; work out how to bring them back down to -1..+1 doubles
+    const int32_t sampleMaxPositiveValue = ( (int32_t)1 << ( flacSampleSize - 1 ) ) - 1;
+    const int32_t sampleMaxNegativeValue = sampleMaxPositiveValue + 1;
+
+    m_flacConversionRecp = 1.0 / static_cast<double>( sampleMaxNegativeValue );
+    m_flacBitShift       = static_cast<uint32_t>( 32 - flacSampleSize );
+
+    return true;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+int32_t StemStreamDecoder::decodeSourceChunk()
+{
+    return ( m_codec == Codec::OggVorbis ) ? decodeSourceChunkVorbis() : decodeSourceChunkFLAC();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+int32_t StemStreamDecoder::decodeSourceChunkVorbis()
+{
+    static constexpr double shortToDoubleNormalisedRcp = 1.0 / 32768.0;
+
+    const int32_t framesDecoded = stb_vorbis_get_samples_short_interleaved( m_vorbis, 2, m_vorbisInterleaved, SourceChunkFrames * 2 );
+
+    for ( int32_t s = 0, readIndex = 0; s < framesDecoded; s++ )
+    {
+        m_source[0][s] = (double)m_vorbisInterleaved[readIndex++] * shortToDoubleNormalisedRcp;
+        m_source[1][s] = (double)m_vorbisInterleaved[readIndex++] * shortToDoubleNormalisedRcp;
+    }
+    return framesDecoded;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+int32_t StemStreamDecoder::decodeSourceChunkFLAC()
+{
+    int32_t framesDecoded = 0;
+
+    while ( framesDecoded < SourceChunkFrames )
+    {
+        const bool inputExhausted = ( m_rawConsumed >= m_rawLength );
+
+        // never ask for more than will fit into the remaining source chunk
+        uint32_t rawAudioInBytes     = static_cast<uint32_t>( m_rawLength - m_rawConsumed );
+        uint32_t flacAudioOutSamples = std::min( cFlacFrameBufferSize, static_cast<uint32_t>( SourceChunkFrames - framesDecoded ) * 2 );
+
+        const fx_flac_state_t flacState = fx_flac_process( m_flac, m_rawAudio + m_rawConsumed, &rawAudioInBytes, m_flacFrameBuffer, &flacAudioOutSamples );
+        if ( flacState == FLAC_ERR )
+        {
+            blog::error::stem( FMTX( "[s:{}..] flac decode error - unknown error from fx_flac_process" ), m_logTag );
+            return -1;
+        }
+
+        ABSL_ASSERT( rawAudioInBytes <= m_rawLength - m_rawConsumed );
+        m_rawConsumed += rawAudioInBytes;
+
+        ABSL_ASSERT( ( flacAudioOutSamples % 2 ) == 0 );
+        for ( uint32_t sample = 0; sample < flacAudioOutSamples; sample += 2, framesDecoded++ )
+        {
+            m_source[0][framesDecoded] = static_cast<double>( m_flacFrameBuffer[sample + 0] >> m_flacBitShift ) * m_flacConversionRecp;
+            m_source[1][framesDecoded] = static_cast<double>( m_flacFrameBuffer[sample + 1] >> m_flacBitShift ) * m_flacConversionRecp;
+        }
+
+        // as output is capped to what fits in the chunk, the decoder may still be holding samples after all the input
+        // has been consumed; keep draining until it has nothing left to give
+        if ( inputExhausted && flacAudioOutSamples == 0 )
+            break;
+    }
+    return framesDecoded;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void StemStreamDecoder::emit( float* left, float* right, const int32_t frames )
+{
+    const int32_t outputRemaining = m_outputSampleCount - m_outputWritten;
+    std::array< float*, 2 > output = { left + m_outputWritten, right + m_outputWritten };
+
+    int32_t outputProduced = 0;
+    if ( m_resamplers[0] != nullptr )
+    {
+        for ( std::size_t channel = 0; channel < 2; channel++ )
+        {
+            double* resampleOut = nullptr;
+            const int32_t resampled = m_resamplers[channel]->process( m_source[channel], frames, resampleOut );
+
+            outputProduced = std::min( resampled, outputRemaining );
+            for ( int32_t s = 0; s < outputProduced; s++ )
+                output[channel][s] = static_cast<float>( resampleOut[s] );
+        }
+    }
+    else
+    {
+        outputProduced = std::min( frames, outputRemaining );
+        for ( std::size_t channel = 0; channel < 2; channel++ )
+        {
+            for ( int32_t s = 0; s < outputProduced; s++ )
+                output[channel][s] = static_cast<float>( m_source[channel][s] );
+        }
+    }
+    m_outputWritten += outputProduced;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+bool StemStreamDecoder::decodeUntil( float* left, float* right, const int32_t outputTarget )
+{
+    const int32_t finalTarget = std::min( outputTarget, m_outputSampleCount );
+
+    while ( m_outputWritten < finalTarget )
+    {
+        int32_t framesDecoded = 0;
+        if ( !m_sourceFinished )
+        {
+            framesDecoded = decodeSourceChunk();
+            if ( framesDecoded < 0 )
+                return false;
+
+            m_sourceFinished = ( framesDecoded == 0 );
+        }
+
+        if ( m_sourceFinished )
+        {
+            // flush the tail out of the resamplers by feeding silence, as a one-shot resample would
+            if ( m_resamplers[0] != nullptr )
+            {
+                std::fill_n( m_source[0], SourceChunkFrames, 0.0 );
+                std::fill_n( m_source[1], SourceChunkFrames, 0.0 );
+                framesDecoded = SourceChunkFrames;
+            }
+            // otherwise the stream came up short of what the header promised; pad out the remainder
+            else
+            {
+                blog::stem( FMTX( "[s:{}..] stream ended {} samples early, padding" ), m_logTag, m_outputSampleCount - m_outputWritten );
+
+                std::fill( left  + m_outputWritten, left  + m_outputSampleCount, 0.0f );
+                std::fill( right + m_outputWritten, right + m_outputSampleCount, 0.0f );
+                m_outputWritten = m_outputSampleCount;
+                break;
+            }
+        }
+
+        emit( left, right, framesDecoded );
+    }
+    return true;
+}
+
+} // namespace live
+} // namespace endlesss
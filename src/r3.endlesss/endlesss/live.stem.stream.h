@@ -0,0 +1,122 @@
+//   _______ _______ ______ _______ ___ ___ _______ _______ _______ 
+//  |       |   |   |   __ \       |   |   |    ___|       |    |  |
+//  |   -   |   |   |      <   -   |   |   |    ___|   -   |       |
+//  |_______|_______|___|__|_______|\_____/|_______|_______|__|____|
+//  \\ harry denholm \\ ishani            ishani.org/shelf/ouroveon/
+//
+//  
+//
+
+#pragma once
+
+#include "base/construction.h"
+
+struct stb_vorbis;
+struct fx_flac;
+namespace r8b { class CDSPResampler24; }
+
+namespace endlesss {
+namespace live {
+
+// ---------------------------------------------------------------------------------------------------------------------
+// incremental decoder for compressed stem audio; rather than unpacking the whole stem in one go, this produces output
+// at the target sample rate a chunk at a time, letting a stem become playable as soon as the start of it is ready
+//
+// the decoder owns the compressed data it is given and keeps it until it is destroyed, so that it can be written
+// out to the stem cache once decoding has finished
+//
+struct StemStreamDecoder
+{
+    DECLARE_NO_COPY_NO_MOVE( StemStreamDecoder );
+
+    using UPtr = std::unique_ptr< StemStreamDecoder >;
+
+    enum class Codec
+    {
+        OggVorbis,
+        FLAC
+    };
+
+    // source frames decoded per step, also the granularity of resampling work
+    static constexpr int32_t        SourceChunkFrames = 4096;
+
+    // returns null if the stream headers can't be parsed or describe something we can't play; rawAudio must
+    // have been allocated with mem::alloc16 and is freed by the decoder
+    ouro_nodiscard static UPtr create(
+        const Codec             codec,
+        uint8_t*                rawAudio,
+        const std::size_t       rawLength,
+        const uint32_t          targetSampleRate,
+        const std::string&      logTag );
+
+    ~StemStreamDecoder();
+
+    // length of a stem of `sourceSampleCount` frames once resampled to `targetSampleRate`; both the streaming and
+    // the one-shot decode paths size their output with this so a stem is the same length whichever way it was loaded
+    ouro_nodiscard static int64_t getResampledLength(
+        const int64_t           sourceSampleCount,
+        const uint32_t          sourceSampleRate,
+        const uint32_t          targetSampleRate );
+
+    // decode until at least `outputTarget` samples of the final stem have been written to the given buffers, which
+    // must have room for getOutputSampleCount() samples; returns false if the stream turned out to be corrupt
+    ouro_nodiscard bool decodeUntil( float* left, float* right, const int32_t outputTarget );
+
+    ouro_nodiscard constexpr int32_t getOutputSampleCount() const { return m_outputSampleCount; }
+    ouro_nodiscard constexpr int32_t getOutputWritten() const { return m_outputWritten; }
+    ouro_nodiscard constexpr uint32_t getSourceSampleRate() const { return m_sourceSampleRate; }
+
+    ouro_nodiscard constexpr const uint8_t* getRawAudio() const { return m_rawAudio; }
+    ouro_nodiscard constexpr std::size_t getRawLength() const { return m_rawLength; }
+
+private:
+
+    StemStreamDecoder( const Codec codec, uint8_t* rawAudio, const std::size_t rawLength, const std::string& logTag );
+
+    ouro_nodiscard bool openVorbis();
+    ouro_nodiscard bool openFLAC();
+
+    // fill m_source with up to SourceChunkFrames of decoded audio; returns the frame count, 0 at the end of
+    // the stream or -1 on error
+    ouro_nodiscard int32_t decodeSourceChunk();
+    ouro_nodiscard int32_t decodeSourceChunkVorbis();
+    ouro_nodiscard int32_t decodeSourceChunkFLAC();
+
+    // push `frames` of m_source through to the output buffers, resampling if required
+    void emit( float* left, float* right, const int32_t frames );
+
+
+    Codec                           m_codec;
+    std::string                     m_logTag;
+
+    uint8_t*                        m_rawAudio          = nullptr;
+    std::size_t                     m_rawLength         = 0;
+    std::size_t                     m_rawConsumed       = 0;
+
+    uint32_t                        m_sourceSampleRate  = 0;
+    int64_t                         m_sourceSampleCount = 0;
+    bool                            m_sourceFinished    = false;
+
+    int32_t                         m_outputSampleCount = 0;
+    int32_t                         m_outputWritten     = 0;
+
+    std::array< double*, 2 >        m_source            = { nullptr, nullptr };
+
+    // vorbis
+    stb_vorbis*                     m_vorbis            = nullptr;
+    int16_t*                        m_vorbisInterleaved = nullptr;
+
+    // flac
+    fx_flac*                        m_flac              = nullptr;
+    uint8_t*                        m_flacWorkingMemory = nullptr;
+    int32_t*                        m_flacFrameBuffer   = nullptr;
+    double                          m_flacConversionRecp = 1.0;
+    uint32_t                        m_flacBitShift      = 0;
+
+    // one streaming resampler per channel, only present if the source rate doesn't match the target
+    std::array< std::unique_ptr< r8b::CDSPResampler24 >, 2 >
+                                    m_resamplers;
+};
+
+} // namespace live
+} // namespace endlesss
@@ -17,6 +17,13 @@ namespace toolkit {
 // data block used to share the current state of ouroveon mixers live with other apps; designed to be readible from other
 // languages such as C#, uses 4-byte alignment
 //
+// when published through shared memory (see toolkit.exchange.ipc.h) the block is guarded by a seqlock on
+// m_dataWriteCounter rather than a mutex, so the publisher never waits on a slow reader. to take a consistent copy:
+//
+//  1. read m_dataWriteCounter; if it is odd a write is in progress, try again
+//  2. copy the whole block out
+//  3. read m_dataWriteCounter again; if it differs from (1), the copy may be torn - discard it and try again
+//
 struct Exchange
 {
     // fill in the riff-level Exchange details from a live pointer (or mark us as "not live" if the pointer is null)
@@ -32,11 +39,10 @@ struct Exchange
     #define _GLOBAL_NAME "Ouroveon_EXCH"
 
     // standard global names to use for local IPC exchange of this data
-    // this is what you need if you're writing tools to hook into
+    // this is what you need if you're writing tools to hook into; on Linux / macOS use the POSIX name with shm_open()
     static constexpr auto GlobalMapppingNameA   = _GLOBAL_NAME;
     static constexpr auto GlobalMapppingNameW   = _PPCAT( L, _GLOBAL_NAME );
-    static constexpr auto GlobalMutexNameA      =  "Global\\Mutex_" _GLOBAL_NAME;
-    static constexpr auto GlobalMutexNameW      = L"Global\\Mutex_" _PPCAT( L, _GLOBAL_NAME );
+    static constexpr auto GlobalMapppingNamePosix = "/" _GLOBAL_NAME;
 
     #undef _GLOBAL_NAME
     #undef _PPCAT
@@ -48,7 +54,7 @@ struct Exchange
     static constexpr size_t MaxJammerName           = 32;   // 16 characters max, afaik (32b, for alignment)
 
     static constexpr size_t ScopeBucketCount        = 8;    // frequency buckets storage
-    static constexpr uint32_t ExchangeDataVersion   = 2;    // basic magic version number to help hosts to
+    static constexpr uint32_t ExchangeDataVersion   = 3;    // basic magic version number to help hosts to
                                                             // identify incoming packets' format
 
 
@@ -64,6 +70,7 @@ struct Exchange
     inline void clear()
     {
         memset( this, 0, sizeof( Exchange ) );
+        m_exchangeDataVersion = ExchangeDataVersion;
     }
 
     ouro_nodiscard constexpr bool hasNoData() const       { return ( m_dataflags == DataFlags_Empty ); }
@@ -74,8 +81,9 @@ struct Exchange
     uint32_t    m_exchangeDataVersion = ExchangeDataVersion;
 
     uint32_t    m_dataflags;                    //      DataFlags_## declaring what of the following should be valid
-    uint32_t    m_dataWriteCounter;             //      incremented from 0 each time block is updated so external apps
-                                                //          can have some reference as to when data has changed or not
+    uint32_t    m_dataWriteCounter;             //      seqlock sequence; odd while the block is being written, advances by 2
+                                                //          for each completed update so external apps can also use it
+                                                //          to tell when data has changed or not
 
     char        m_jamName[MaxJamName];          // [R  ] which jam we jammin in
     uint64_t    m_riffHash;                     // [R  ] u64 hash derived from original riff couch ID as some kind of UID
@@ -0,0 +1,201 @@
+//   _______ _______ ______ _______ ___ ___ _______ _______ _______ 
+//  |       |   |   |   __ \       |   |   |    ___|       |    |  |
+//  |   -   |   |   |      <   -   |   |   |    ___|   -   |       |
+//  |_______|_______|___|__|_______|\_____/|_______|_______|__|____|
+//  \\ harry denholm \\ ishani            ishani.org/shelf/ouroveon/
+//
+//  
+//
+
+#include "pch.h"
+
+#include "endlesss/toolkit.exchange.ipc.h"
+
+namespace endlesss {
+namespace toolkit {
+
+namespace {
+
+// the sequence counter is shared with other processes, so all access to it goes through atomic_ref
+static_assert( std::atomic_ref<uint32_t>::is_always_lock_free );
+static_assert( std::is_standard_layout_v<Exchange> );
+
+constexpr std::size_t cSequenceOffset = offsetof( Exchange, m_dataWriteCounter );
+constexpr std::size_t cPayloadOffset  = cSequenceOffset + sizeof( uint32_t );
+
+inline std::atomic_ref<uint32_t> sequenceOf( const Exchange* block )
+{
+    // readers map the block read-only; atomic_ref wants a mutable reference but we only ever load through it
+    return std::atomic_ref<uint32_t>( const_cast<uint32_t&>( block->m_dataWriteCounter ) );
+}
+
+} // anonymous namespace
+
+// ---------------------------------------------------------------------------------------------------------------------
+bool ExchangeIPC::init( const Access requestedAccess )
+{
+#if OURO_PLATFORM_WIN
+    return init( Exchange::GlobalMapppingNameA, requestedAccess );
+#else
+    return init( Exchange::GlobalMapppingNamePosix, requestedAccess );
+#endif
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+bool ExchangeIPC::init( const char* mapName, const Access requestedAccess )
+{
+    m_block    = static_cast<Exchange*>( m_sharedMemory.open( mapName, requestedAccess, sizeof( Exchange ) ) );
+    m_sequence = 0;
+
+    // stamp a valid, empty block so readers attaching before the first publish see something sensible
+    if ( canWrite() )
+    {
+        Exchange empty;
+        empty.clear();
+        writeType( empty );
+    }
+
+    return ( m_block != nullptr );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+bool ExchangeIPC::writeType( const Exchange& data )
+{
+    if ( !canWrite() )
+        return false;
+
+    auto sequence = sequenceOf( m_block );
+
+    // odd sequence marks the block as being written; the release fence stops any of the payload stores below
+    // becoming visible before that does
+    sequence.store( m_sequence + 1, std::memory_order_relaxed );
+    std::atomic_thread_fence( std::memory_order_release );
+
+    // copy around the sequence counter, never through it
+    const uint8_t* source = reinterpret_cast<const uint8_t*>( &data );
+    uint8_t* target       = reinterpret_cast<uint8_t*>( m_block );
+    memcpy( target, source, cSequenceOffset );
+    memcpy( target + cPayloadOffset, source + cPayloadOffset, sizeof( Exchange ) - cPayloadOffset );
+
+    m_sequence += 2;
+    sequence.store( m_sequence, std::memory_order_release );
+
+    return true;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+bool ExchangeIPC::readType( Exchange& result, const uint32_t maxAttempts, uint32_t* retriesOut ) const
+{
+    if ( !canRead() )
+        return false;
+
+    auto sequence = sequenceOf( m_block );
+
+    for ( uint32_t attempt = 0; attempt < maxAttempts; attempt++ )
+    {
+        if ( retriesOut != nullptr )
+            *retriesOut = attempt;
+
+        const uint32_t sequenceBegin = sequence.load( std::memory_order_acquire );
+        if ( sequenceBegin & 1 )
+        {
+            std::this_thread::yield();
+            continue;
+        }
+
+        memcpy( &result, m_block, sizeof( Exchange ) );
+
+        // keep the payload loads above from drifting past the re-check of the sequence
+        std::atomic_thread_fence( std::memory_order_acquire );
+        if ( sequence.load( std::memory_order_relaxed ) == sequenceBegin )
+        {
+            result.m_dataWriteCounter = sequenceBegin;
+            return true;
+        }
+    }
+
+    if ( retriesOut != nullptr )
+        *retriesOut = maxAttempts;
+
+    return false;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+ExchangeIPC::Verification ExchangeIPC::verifyTearFreeReads( const std::chrono::milliseconds duration )
+{
+    Verification result;
+
+    // use a private name so anything attached to the real block isn't fed garbage
+    const std::string verifyName = fmt::format( FMTX( "{}_verify" ), Exchange::GlobalMapppingNameA );
+
+    ExchangeIPC writer;
+    if ( !writer.init( verifyName.c_str(), Access::Write ) )
+        return result;
+
+    ExchangeIPC reader;
+    if ( !reader.init( verifyName.c_str(), Access::Read ) )
+        return result;
+
+    std::atomic_bool writerRunning = true;
+    std::atomic_uint64_t writeCount = 0;
+
+    // each write fills every payload byte with the low byte of a rolling value that is also stored whole in
+    // m_dataflags, so any copy stitched together from two writes shows up as a mismatched byte
+    std::thread writerThread( [&]()
+    {
+        Exchange pattern;
+        uint32_t value = 0;
+        while ( writerRunning.load( std::memory_order_relaxed ) )
+        {
+            value++;
+            memset( &pattern, (int)( value & 0xff ), sizeof( Exchange ) );
+            pattern.m_exchangeDataVersion = Exchange::ExchangeDataVersion;
+            pattern.m_dataflags           = value;
+
+            writer.writeType( pattern );
+            writeCount.fetch_add( 1, std::memory_order_relaxed );
+        }
+    });
+
+    const auto timeStart = std::chrono::steady_clock::now();
+
+    Exchange copy;
+    while ( std::chrono::steady_clock::now() - timeStart < duration )
+    {
+        uint32_t retries = 0;
+        if ( !reader.readType( copy, DefaultReadAttempts, &retries ) )
+        {
+            result.m_failedReads++;
+            result.m_retries += retries;
+            continue;
+        }
+        result.m_retries += retries;
+
+        // the block as initialised by init() holds the empty pattern, skip until the writer has produced something
+        if ( copy.m_dataflags == 0 )
+            continue;
+
+        result.m_reads++;
+
+        const uint8_t expected = (uint8_t)( copy.m_dataflags & 0xff );
+        const uint8_t* bytes   = reinterpret_cast<const uint8_t*>( &copy );
+
+        for ( std::size_t byteI = cPayloadOffset; byteI < sizeof( Exchange ); byteI++ )
+        {
+            if ( bytes[byteI] != expected )
+            {
+                result.m_tornReads++;
+                break;
+            }
+        }
+    }
+
+    writerRunning = false;
+    writerThread.join();
+
+    result.m_writes = writeCount.load();
+    return result;
+}
+
+} // namespace toolkit
+} // namespace endlesss
@@ -0,0 +1,67 @@
+//   _______ _______ ______ _______ ___ ___ _______ _______ _______ 
+//  |       |   |   |   __ \       |   |   |    ___|       |    |  |
+//  |   -   |   |   |      <   -   |   |   |    ___|   -   |       |
+//  |_______|_______|___|__|_______|\_____/|_______|_______|__|____|
+//  \\ harry denholm \\ ishani            ishani.org/shelf/ouroveon/
+//
+//  
+//
+
+#pragma once
+
+#include "endlesss/toolkit.exchange.h"
+#include "xp/shared.memory.h"
+
+namespace endlesss {
+namespace toolkit {
+
+// ---------------------------------------------------------------------------------------------------------------------
+// publishes (or attaches to) an Exchange block in named shared memory, guarded by a seqlock on m_dataWriteCounter
+// as described in toolkit.exchange.h; there is a single writer and any number of readers, none of which block each other
+//
+struct ExchangeIPC
+{
+    using Access = xp::SharedMemory::Access;
+
+    static constexpr uint32_t DefaultReadAttempts = 64;
+
+    // results from verifyTearFreeReads()
+    struct Verification
+    {
+        uint64_t    m_writes        = 0;
+        uint64_t    m_reads         = 0;    // successful, consistent copies taken
+        uint64_t    m_retries       = 0;    // attempts discarded because a write was in progress or landed mid-copy
+        uint64_t    m_failedReads   = 0;    // reads that ran out of attempts
+        uint64_t    m_tornReads     = 0;    // copies that were accepted but held data from more than one write; must be 0
+
+        ouro_nodiscard constexpr bool passed() const { return m_tornReads == 0 && m_reads > 0; }
+    };
+
+    // open the standard platform name for the Exchange block
+    bool init( const Access requestedAccess );
+    // .. or a custom name, eg. for testing
+    bool init( const char* mapName, const Access requestedAccess );
+
+    ouro_nodiscard bool canWrite() const { return m_block != nullptr && m_sharedMemory.getAccess() == Access::Write; }
+    ouro_nodiscard bool canRead() const  { return m_block != nullptr && m_sharedMemory.getAccess() == Access::Read;  }
+
+    // publish a new copy of the data; wait-free, the m_dataWriteCounter in `data` is ignored and managed internally
+    bool writeType( const Exchange& data );
+
+    // take a consistent copy of the current data, returning false if no tear-free copy could be taken
+    // within `maxAttempts` (eg. if the publisher has died mid-write); optionally reports number of attempts discarded
+    bool readType( Exchange& result, const uint32_t maxAttempts = DefaultReadAttempts, uint32_t* retriesOut = nullptr ) const;
+
+    // stress-test the seqlock protocol; runs a writer thread hammering a private block while this thread reads it
+    // back as fast as it can, checking that every accepted copy came from exactly one write
+    static Verification verifyTearFreeReads( const std::chrono::milliseconds duration );
+
+private:
+
+    xp::SharedMemory    m_sharedMemory;
+    Exchange*           m_block         = nullptr;
+    uint32_t            m_sequence      = 0;        // writer-side copy of the current, even, sequence value
+};
+
+} // namespace toolkit
+} // namespace endlesss
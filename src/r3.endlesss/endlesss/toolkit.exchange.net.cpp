@@ -0,0 +1,767 @@
+//   _______ _______ ______ _______ ___ ___ _______ _______ _______ 
+//  |       |   |   |   __ \       |   |   |    ___|       |    |  |
+//  |   -   |   |   |      <   -   |   |   |    ___|   -   |       |
+//  |_______|_______|___|__|_______|\_____/|_______|_______|__|____|
+//  \\ harry denholm \\ ishani            ishani.org/shelf/ouroveon/
+//
+//  
+//
+
+#include "pch.h"
+
+#include "endlesss/toolkit.exchange.net.h"
+
+#include <asio/io_context.hpp>
+#include <asio/ip/udp.hpp>
+#include <asio/ip/multicast.hpp>
+
+namespace endlesss {
+namespace toolkit {
+
+namespace {
+
+static_assert( std::endian::native == std::endian::little, "ExchangePacket encoding assumes a little-endian host" );
+
+// ---------------------------------------------------------------------------------------------------------------------
+struct PacketWriter
+{
+    uint8_t*    m_cursor;
+
+    template< typename _T >
+    inline void put( const _T& value )
+    {
+        static_assert( std::is_trivially_copyable_v<_T> );
+        memcpy( m_cursor, &value, sizeof( _T ) );
+        m_cursor += sizeof( _T );
+    }
+
+    inline void putBytes( const void* source, const std::size_t bytes )
+    {
+        memcpy( m_cursor, source, bytes );
+        m_cursor += bytes;
+    }
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+struct PacketReader
+{
+    const uint8_t*  m_cursor;
+    const uint8_t*  m_end;
+    bool            m_overrun = false;
+
+    template< typename _T >
+    inline _T get()
+    {
+        static_assert( std::is_trivially_copyable_v<_T> );
+        _T value{};
+        getBytes( &value, sizeof( _T ) );
+        return value;
+    }
+
+    inline void getBytes( void* target, const std::size_t bytes )
+    {
+        if ( m_overrun || (std::size_t)( m_end - m_cursor ) < bytes )
+        {
+            m_overrun = true;
+            return;
+        }
+        memcpy( target, m_cursor, bytes );
+        m_cursor += bytes;
+    }
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+inline std::array< char*, 8 > jammerNamesOf( Exchange& data )
+{
+    return { data.m_jammerName1, data.m_jammerName2, data.m_jammerName3, data.m_jammerName4,
+             data.m_jammerName5, data.m_jammerName6, data.m_jammerName7, data.m_jammerName8 };
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void writeRiffSection( const Exchange& data, PacketWriter& writer )
+{
+    writer.putBytes( data.m_jamName, Exchange::MaxJamName );
+    writer.put( data.m_riffHash );
+    writer.put( data.m_riffTimestamp );
+    writer.put( data.m_riffRoot );
+    writer.put( data.m_riffScale );
+    writer.put( data.m_riffBPM );
+    writer.put( data.m_riffBeatSegmentCount );
+    writer.put( data.m_jammerNameValidBits );
+
+    for ( const char* jammerName : jammerNamesOf( const_cast<Exchange&>( data ) ) )
+        writer.putBytes( jammerName, Exchange::MaxJammerName );
+}
+
+void readRiffSection( Exchange& data, PacketReader& reader )
+{
+    reader.getBytes( data.m_jamName, Exchange::MaxJamName );
+    data.m_jamName[Exchange::MaxJamName - 1] = '\0';
+
+    data.m_riffHash             = reader.get<uint64_t>();
+    data.m_riffTimestamp        = reader.get<uint64_t>();
+    data.m_riffRoot             = reader.get<uint32_t>();
+    data.m_riffScale            = reader.get<uint32_t>();
+    data.m_riffBPM              = reader.get<float>();
+    data.m_riffBeatSegmentCount = reader.get<uint32_t>();
+    data.m_jammerNameValidBits  = reader.get<uint32_t>();
+
+    for ( char* jammerName : jammerNamesOf( data ) )
+    {
+        reader.getBytes( jammerName, Exchange::MaxJammerName );
+        jammerName[Exchange::MaxJammerName - 1] = '\0';
+    }
+}
+
+// the fields carried by the riff section, used to fill in deltas from the last keyframe
+void copyRiffFields( const Exchange& source, Exchange& target )
+{
+    memcpy( target.m_jamName, source.m_jamName, Exchange::MaxJamName );
+    target.m_riffHash             = source.m_riffHash;
+    target.m_riffTimestamp        = source.m_riffTimestamp;
+    target.m_riffRoot             = source.m_riffRoot;
+    target.m_riffScale            = source.m_riffScale;
+    target.m_riffBPM              = source.m_riffBPM;
+    target.m_riffBeatSegmentCount = source.m_riffBeatSegmentCount;
+    target.m_jammerNameValidBits  = source.m_jammerNameValidBits;
+
+    const auto sourceNames = jammerNamesOf( const_cast<Exchange&>( source ) );
+    const auto targetNames = jammerNamesOf( target );
+    for ( std::size_t jI = 0; jI < sourceNames.size(); jI++ )
+        memcpy( targetNames[jI], sourceNames[jI], Exchange::MaxJammerName );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void writePlaybackSection( const Exchange& data, PacketWriter& writer )
+{
+    writer.put( data.m_riffBeatSegmentActive );
+    writer.put( data.m_stemBeat );
+    writer.put( data.m_stemWave );
+    writer.put( data.m_stemWaveLF );
+    writer.put( data.m_stemWaveHF );
+    writer.put( data.m_stemGain );
+    writer.put( data.m_stemColour );
+
+    uint8_t analysedBits = 0;
+    for ( std::size_t sI = 0; sI < 8; sI++ )
+    {
+        if ( data.m_stemAnalysed[sI] != 0 )
+            analysedBits |= (uint8_t)( 1 << sI );
+    }
+    writer.put( analysedBits );
+
+    writer.put( data.m_consensusBeat );
+    writer.put( data.m_riffPlaybackProgress );
+    writer.put( data.m_riffTransition );
+}
+
+void readPlaybackSection( Exchange& data, PacketReader& reader )
+{
+    data.m_riffBeatSegmentActive = reader.get<uint32_t>();
+    reader.getBytes( data.m_stemBeat,   sizeof( data.m_stemBeat ) );
+    reader.getBytes( data.m_stemWave,   sizeof( data.m_stemWave ) );
+    reader.getBytes( data.m_stemWaveLF, sizeof( data.m_stemWaveLF ) );
+    reader.getBytes( data.m_stemWaveHF, sizeof( data.m_stemWaveHF ) );
+    reader.getBytes( data.m_stemGain,   sizeof( data.m_stemGain ) );
+    reader.getBytes( data.m_stemColour, sizeof( data.m_stemColour ) );
+
+    const uint8_t analysedBits = reader.get<uint8_t>();
+    for ( std::size_t sI = 0; sI < 8; sI++ )
+        data.m_stemAnalysed[sI] = ( analysedBits >> sI ) & 1;
+
+    data.m_consensusBeat        = reader.get<float>();
+    data.m_riffPlaybackProgress = reader.get<float>();
+    data.m_riffTransition       = reader.get<float>();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void writeScopeSection( const Exchange& data, PacketWriter& writer )
+{
+    writer.put( data.m_scope );
+}
+
+void readScopeSection( Exchange& data, PacketReader& reader )
+{
+    reader.getBytes( data.m_scope, sizeof( data.m_scope ) );
+}
+
+} // anonymous namespace
+
+
+// ---------------------------------------------------------------------------------------------------------------------
+std::size_t ExchangePacket::encode( const Exchange& data, const Header& header, uint8_t* buffer )
+{
+    uint32_t sectionMask = 0;
+    if ( header.isKeyframe() && data.hasRiffData() )
+        sectionMask |= Section_Riff;
+    if ( data.hasPlaybackData() )
+        sectionMask |= Section_Playback;
+    if ( data.hasScopeData() )
+        sectionMask |= Section_Scope;
+
+    PacketWriter writer{ buffer };
+
+    writer.put( Magic );
+    writer.put( ProtocolVersion );
+    writer.put( header.m_flags );
+    writer.put( header.m_sequence );
+    writer.put( header.m_keyframeSequence );
+    writer.put( header.m_sourceID );
+    writer.put( data.m_dataflags );
+    writer.put( sectionMask );
+
+    if ( sectionMask & Section_Riff )
+        writeRiffSection( data, writer );
+    if ( sectionMask & Section_Playback )
+        writePlaybackSection( data, writer );
+    if ( sectionMask & Section_Scope )
+        writeScopeSection( data, writer );
+
+    const std::size_t bytesWritten = writer.m_cursor - buffer;
+    ABSL_ASSERT( bytesWritten <= MaxPacketSize );
+
+    return bytesWritten;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+absl::Status ExchangePacket::decode( const uint8_t* buffer, const std::size_t bufferSize, Header& header, Exchange& result )
+{
+    PacketReader reader{ buffer, buffer + bufferSize };
+
+    if ( reader.get<uint32_t>() != Magic )
+        return absl::InvalidArgumentError( "not an exchange packet" );
+
+    header.m_protocolVersion    = reader.get<uint16_t>();
+    if ( header.m_protocolVersion != ProtocolVersion )
+        return absl::UnimplementedError( fmt::format( FMTX( "unsupported exchange packet version {}" ), header.m_protocolVersion ) );
+
+    header.m_flags              = reader.get<uint16_t>();
+    header.m_sequence           = reader.get<uint32_t>();
+    header.m_keyframeSequence   = reader.get<uint32_t>();
+    header.m_sourceID           = reader.get<uint32_t>();
+    header.m_dataflags          = reader.get<uint32_t>();
+    header.m_sectionMask        = reader.get<uint32_t>();
+
+    result.m_dataflags = header.m_dataflags;
+
+    if ( header.m_sectionMask & Section_Riff )
+        readRiffSection( result, reader );
+    if ( header.m_sectionMask & Section_Playback )
+        readPlaybackSection( result, reader );
+    if ( header.m_sectionMask & Section_Scope )
+        readScopeSection( result, reader );
+
+    if ( reader.m_overrun )
+        return absl::DataLossError( "exchange packet truncated" );
+
+    return absl::OkStatus();
+}
+
+
+// ---------------------------------------------------------------------------------------------------------------------
+struct ExchangeBroadcaster::State
+{
+    using Clock = std::chrono::steady_clock;
+
+    State( const Options& options )
+        : m_options( options )
+        , m_sendInterval( std::chrono::duration_cast<Clock::duration>( std::chrono::duration<double>( 1.0 / std::max( options.m_sendRateHz, 1 ) ) ) )
+    {
+        // distinguish this run from any previous one, so receivers notice a restart rather than seeing the sequence go backwards
+        std::random_device randomDevice;
+        m_sourceID = randomDevice() | 1;
+    }
+
+    absl::Status open()
+    {
+        asio::error_code ec;
+
+        const auto targetAddress = asio::ip::make_address( m_options.m_address, ec );
+        if ( ec )
+            return absl::InvalidArgumentError( fmt::format( FMTX( "invalid broadcast address [{}] : {}" ), m_options.m_address, ec.message() ) );
+
+        m_target = asio::ip::udp::endpoint( targetAddress, m_options.m_port );
+
+        m_socket.open( m_target.protocol(), ec );
+        if ( ec )
+            return absl::UnavailableError( fmt::format( FMTX( "unable to open broadcast socket : {}" ), ec.message() ) );
+
+        if ( targetAddress.is_multicast() )
+        {
+            m_socket.set_option( asio::ip::multicast::hops( m_options.m_multicastTTL ), ec );
+            // allow receivers on this machine to hear us too
+            m_socket.set_option( asio::ip::multicast::enable_loopback( true ), ec );
+        }
+
+        // the caller is likely the main thread; never stall it on a full send buffer, just drop the packet
+        m_socket.non_blocking( true, ec );
+
+        return absl::OkStatus();
+    }
+
+    bool send( const Exchange& data )
+    {
+        // compare the riff section against the last keyframe to decide if we need a new one
+        std::array< uint8_t, ExchangePacket::MaxPacketSize > riffSection;
+        PacketWriter riffWriter{ riffSection.data() };
+        if ( data.hasRiffData() )
+            writeRiffSection( data, riffWriter );
+        const std::size_t riffSectionSize = riffWriter.m_cursor - riffSection.data();
+
+        const bool riffChanged = ( riffSectionSize != m_keyframeRiffSectionSize ) ||
+                                 ( memcmp( riffSection.data(), m_keyframeRiffSection.data(), riffSectionSize ) != 0 );
+
+        m_sequence++;
+
+        const bool isKeyframe = ( m_stats.m_keyframesSent == 0 ) ||
+                                riffChanged ||
+                                ( m_packetsSinceKeyframe >= (uint32_t)m_options.m_keyframeInterval );
+        if ( isKeyframe )
+        {
+            m_keyframeSequence          = m_sequence;
+            m_keyframeRiffSection       = riffSection;
+            m_keyframeRiffSectionSize   = riffSectionSize;
+            m_packetsSinceKeyframe      = 0;
+        }
+        m_packetsSinceKeyframe++;
+
+        ExchangePacket::Header header;
+        header.m_flags              = isKeyframe ? ExchangePacket::Flags_Keyframe : 0;
+        header.m_sequence           = m_sequence;
+        header.m_keyframeSequence   = m_keyframeSequence;
+        header.m_sourceID           = m_sourceID;
+
+        const std::size_t packetSize = ExchangePacket::encode( data, header, m_packet.data() );
+
+        asio::error_code ec;
+        m_socket.send_to( asio::buffer( m_packet.data(), packetSize ), m_target, 0, ec );
+
+        m_stats.m_lastSequence = m_sequence;
+        if ( ec )
+        {
+            // a dropped keyframe means receivers may ignore deltas until the next one; force it to be soon
+            if ( isKeyframe )
+                m_keyframeRiffSectionSize = std::numeric_limits<std::size_t>::max();
+
+            m_stats.m_sendFailures++;
+            return false;
+        }
+
+        m_stats.m_packetsSent++;
+        m_stats.m_bytesSent += packetSize;
+        if ( isKeyframe )
+            m_stats.m_keyframesSent++;
+
+        return true;
+    }
+
+    bool publish( const Exchange& data )
+    {
+        const auto timeNow = Clock::now();
+        if ( timeNow < m_nextSendTime )
+            return false;
+
+        // step forward on a fixed cadence, but don't try and catch up if we've been stalled
+        m_nextSendTime += m_sendInterval;
+        if ( m_nextSendTime < timeNow )
+            m_nextSendTime = timeNow + m_sendInterval;
+
+        return send( data );
+    }
+
+
+    Options                                                 m_options;
+    Clock::duration                                         m_sendInterval;
+    Clock::time_point                                       m_nextSendTime;
+
+    asio::io_context                                        m_ioContext;
+    asio::ip::udp::socket                                   m_socket{ m_ioContext };
+    asio::ip::udp::endpoint                                 m_target;
+
+    uint32_t                                                m_sourceID              = 0;
+    uint32_t                                                m_sequence              = 0;
+    uint32_t                                                m_keyframeSequence      = 0;
+    uint32_t                                                m_packetsSinceKeyframe  = 0;
+
+    std::array< uint8_t, ExchangePacket::MaxPacketSize >    m_keyframeRiffSection;
+    std::size_t                                             m_keyframeRiffSectionSize = 0;
+
+    std::array< uint8_t, ExchangePacket::MaxPacketSize >    m_packet;
+
+    Statistics                                              m_stats;
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+ExchangeBroadcaster::ExchangeBroadcaster() = default;
+ExchangeBroadcaster::~ExchangeBroadcaster()
+{
+    stop();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+absl::Status ExchangeBroadcaster::start( const Options& options )
+{
+    stop();
+
+    auto newState = std::make_unique<State>( options );
+    const auto openStatus = newState->open();
+    if ( !openStatus.ok() )
+        return openStatus;
+
+    m_state = std::move( newState );
+    return absl::OkStatus();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void ExchangeBroadcaster::stop()
+{
+    m_state.reset();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+bool ExchangeBroadcaster::isRunning() const
+{
+    return m_state != nullptr;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+bool ExchangeBroadcaster::publish( const Exchange& data )
+{
+    if ( m_state == nullptr )
+        return false;
+
+    return m_state->publish( data );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+bool ExchangeBroadcaster::publishImmediate( const Exchange& data )
+{
+    if ( m_state == nullptr )
+        return false;
+
+    return m_state->send( data );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+ExchangeBroadcaster::Statistics ExchangeBroadcaster::getStatistics() const
+{
+    if ( m_state == nullptr )
+        return {};
+
+    return m_state->m_stats;
+}
+
+
+// ---------------------------------------------------------------------------------------------------------------------
+struct ExchangeReceiver::State
+{
+    State( const Options& options )
+        : m_options( options )
+    {
+    }
+
+    absl::Status open()
+    {
+        asio::error_code ec;
+
+        const auto listenAddress = asio::ip::make_address( m_options.m_listenAddress, ec );
+        if ( ec )
+            return absl::InvalidArgumentError( fmt::format( FMTX( "invalid listen address [{}] : {}" ), m_options.m_listenAddress, ec.message() ) );
+
+        const asio::ip::udp::endpoint listenEndpoint( listenAddress, m_options.m_port );
+
+        m_socket.open( listenEndpoint.protocol(), ec );
+        if ( ec )
+            return absl::UnavailableError( fmt::format( FMTX( "unable to open receive socket : {}" ), ec.message() ) );
+
+        // let several receivers on one machine share a multicast port
+        m_socket.set_option( asio::ip::udp::socket::reuse_address( true ), ec );
+        m_socket.set_option( asio::socket_base::receive_buffer_size( 256 * 1024 ), ec );
+
+        m_socket.bind( listenEndpoint, ec );
+        if ( ec )
+            return absl::UnavailableError( fmt::format( FMTX( "unable to bind receive socket to [{}:{}] : {}" ), m_options.m_listenAddress, m_options.m_port, ec.message() ) );
+
+        if ( !m_options.m_multicastGroup.empty() )
+        {
+            const auto groupAddress = asio::ip::make_address( m_options.m_multicastGroup, ec );
+            if ( ec || !groupAddress.is_multicast() )
+                return absl::InvalidArgumentError( fmt::format( FMTX( "invalid multicast group [{}]" ), m_options.m_multicastGroup ) );
+
+            m_socket.set_option( asio::ip::multicast::join_group( groupAddress ), ec );
+            if ( ec )
+                return absl::UnavailableError( fmt::format( FMTX( "unable to join multicast group [{}] : {}" ), m_options.m_multicastGroup, ec.message() ) );
+        }
+
+        m_socket.non_blocking( true, ec );
+
+        return absl::OkStatus();
+    }
+
+    bool poll( Exchange& result )
+    {
+        bool updated = false;
+
+        for ( ;; )
+        {
+            asio::error_code ec;
+            asio::ip::udp::endpoint senderEndpoint;
+
+            const std::size_t bytesReceived = m_socket.receive_from( asio::buffer( m_packet.data(), m_packet.size() ), senderEndpoint, 0, ec );
+            if ( ec )
+                break;  // would_block, or the socket has gone away; either way nothing more to read
+
+            m_stats.m_packetsReceived++;
+
+            ExchangePacket::Header header;
+            Exchange decoded;
+            decoded.clear();
+
+            if ( !ExchangePacket::decode( m_packet.data(), bytesReceived, header, decoded ).ok() )
+            {
+                m_stats.m_packetsInvalid++;
+                continue;
+            }
+
+            if ( !m_hasSource || header.m_sourceID != m_sourceID )
+            {
+                if ( m_hasSource )
+                    m_stats.m_sourceChanges++;
+
+                m_hasSource     = true;
+                m_sourceID      = header.m_sourceID;
+                m_hasKeyframe   = false;
+            }
+            else
+            {
+                // signed distance copes with the sequence wrapping
+                const int32_t sequenceDelta = (int32_t)( header.m_sequence - m_lastSequence );
+                if ( sequenceDelta <= 0 )
+                {
+                    m_stats.m_packetsStale++;
+                    continue;
+                }
+                m_stats.m_packetsLost += (uint64_t)( sequenceDelta - 1 );
+            }
+            m_lastSequence = header.m_sequence;
+
+            if ( header.isKeyframe() )
+            {
+                m_hasKeyframe       = true;
+                m_keyframeSequence  = header.m_sequence;
+                m_keyframe          = decoded;
+            }
+            else
+            {
+                if ( !m_hasKeyframe || header.m_keyframeSequence != m_keyframeSequence )
+                {
+                    m_stats.m_packetsUnanchored++;
+                    continue;
+                }
+                if ( decoded.hasRiffData() )
+                    copyRiffFields( m_keyframe, decoded );
+            }
+
+            decoded.m_dataWriteCounter = header.m_sequence;
+
+            result = decoded;
+            updated = true;
+
+            m_stats.m_packetsApplied++;
+            m_stats.m_lastSequence = header.m_sequence;
+        }
+
+        return updated;
+    }
+
+
+    Options                                                 m_options;
+
+    asio::io_context                                        m_ioContext;
+    asio::ip::udp::socket                                   m_socket{ m_ioContext };
+
+    bool                                                    m_hasSource         = false;
+    uint32_t                                                m_sourceID          = 0;
+    uint32_t                                                m_lastSequence      = 0;
+
+    bool                                                    m_hasKeyframe       = false;
+    uint32_t                                                m_keyframeSequence  = 0;
+    Exchange                                                m_keyframe;
+
+    std::array< uint8_t, ExchangePacket::MaxPacketSize >    m_packet;
+
+    Statistics                                              m_stats;
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+ExchangeReceiver::ExchangeReceiver() = default;
+ExchangeReceiver::~ExchangeReceiver()
+{
+    stop();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+absl::Status ExchangeReceiver::start( const Options& options )
+{
+    stop();
+
+    auto newState = std::make_unique<State>( options );
+    const auto openStatus = newState->open();
+    if ( !openStatus.ok() )
+        return openStatus;
+
+    m_state = std::move( newState );
+    return absl::OkStatus();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void ExchangeReceiver::stop()
+{
+    m_state.reset();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+bool ExchangeReceiver::isRunning() const
+{
+    return m_state != nullptr;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+uint16_t ExchangeReceiver::getBoundPort() const
+{
+    if ( m_state == nullptr )
+        return 0;
+
+    asio::error_code ec;
+    const auto localEndpoint = m_state->m_socket.local_endpoint( ec );
+    return ec ? 0 : localEndpoint.port();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+bool ExchangeReceiver::poll( Exchange& result )
+{
+    if ( m_state == nullptr )
+        return false;
+
+    return m_state->poll( result );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+ExchangeReceiver::Statistics ExchangeReceiver::getStatistics() const
+{
+    if ( m_state == nullptr )
+        return {};
+
+    return m_state->m_stats;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+ExchangeReceiver::Verification ExchangeReceiver::verifyLoopback( const std::chrono::milliseconds duration )
+{
+    Verification result;
+
+    ExchangeReceiver receiver;
+    {
+        Options receiverOptions;
+        receiverOptions.m_listenAddress = "127.0.0.1";
+        if ( const auto status = receiver.start( receiverOptions ); !status.ok() )
+        {
+            blog::error::core( FMTX( "exchange loopback verification failed to start receiver : {}" ), status.ToString() );
+            return result;
+        }
+    }
+
+    ExchangeBroadcaster broadcaster;
+    {
+        ExchangeBroadcaster::Options broadcasterOptions;
+        broadcasterOptions.m_address            = "127.0.0.1";
+        broadcasterOptions.m_port               = receiver.getBoundPort();
+        broadcasterOptions.m_keyframeInterval   = 16;
+        if ( const auto status = broadcaster.start( broadcasterOptions ); !status.ok() )
+        {
+            blog::error::core( FMTX( "exchange loopback verification failed to start broadcaster : {}" ), status.ToString() );
+            return result;
+        }
+    }
+
+    // keep recent sent blocks around, keyed by sequence, to compare against whatever the receiver decodes
+    static constexpr std::size_t SentHistory = 256;
+    std::vector< Exchange > sentHistory( SentHistory );
+
+    const auto timeStart = std::chrono::steady_clock::now();
+
+    std::array< uint8_t, ExchangePacket::MaxPacketSize > expectedPacket;
+    std::array< uint8_t, ExchangePacket::MaxPacketSize > receivedPacket;
+
+    Exchange received;
+    for ( uint32_t frame = 0; std::chrono::steady_clock::now() - timeStart < duration; frame++ )
+    {
+        Exchange sending;
+        sending.clear();
+        sending.m_dataflags = Exchange::DataFlags_Riff | Exchange::DataFlags_Playback | Exchange::DataFlags_Scope;
+
+        // change riff every so often to exercise the keyframe / delta logic
+        const uint32_t riffIndex = frame / 40;
+        snprintf( sending.m_jamName, Exchange::MaxJamName, "loopback jam %u", riffIndex );
+        sending.m_riffHash              = 0x9E3779B97F4A7C15ull * ( riffIndex + 1 );
+        sending.m_riffTimestamp         = riffIndex;
+        sending.m_riffBPM               = 90.0f + (float)( riffIndex % 60 );
+        sending.m_riffBeatSegmentCount  = 4;
+        sending.setJammerName( riffIndex % 8, "loopback" );
+
+        sending.m_riffBeatSegmentActive = frame % 4;
+        for ( std::size_t sI = 0; sI < 8; sI++ )
+        {
+            const float signal = (float)( ( frame + sI ) % 100 ) / 100.0f;
+            sending.m_stemBeat[sI]      = signal;
+            sending.m_stemWave[sI]      = signal * 0.5f;
+            sending.m_stemWaveLF[sI]    = signal * 0.25f;
+            sending.m_stemWaveHF[sI]    = 1.0f - signal;
+            sending.m_stemGain[sI]      = 1.0f;
+            sending.m_stemColour[sI]    = 0xFF000000 | ( frame * 2654435761u );
+            sending.m_stemAnalysed[sI]  = ( frame >> sI ) & 1;
+            sending.m_scope[sI]         = signal * 4.0f;
+        }
+        sending.m_consensusBeat         = (float)( frame % 7 ) / 7.0f;
+        sending.m_riffPlaybackProgress  = (float)( frame % 40 ) / 40.0f;
+        sending.m_riffTransition        = 0.0f;
+
+        if ( broadcaster.publishImmediate( sending ) )
+        {
+            result.m_sent++;
+
+            const uint32_t sequence = broadcaster.getStatistics().m_lastSequence;
+            sending.m_dataWriteCounter = sequence;
+            sentHistory[sequence % SentHistory] = sending;
+        }
+
+        if ( receiver.poll( received ) )
+        {
+            result.m_received++;
+
+            // compare by re-encoding both as keyframes; a memcmp of the blocks themselves would trip over padding
+            const Exchange& expected = sentHistory[received.m_dataWriteCounter % SentHistory];
+
+            ExchangePacket::Header compareHeader;
+            compareHeader.m_flags = ExchangePacket::Flags_Keyframe;
+
+            const std::size_t expectedSize = ExchangePacket::encode( expected, compareHeader, expectedPacket.data() );
+            const std::size_t receivedSize = ExchangePacket::encode( received, compareHeader, receivedPacket.data() );
+
+            if ( expected.m_dataWriteCounter != received.m_dataWriteCounter ||
+                 expectedSize != receivedSize ||
+                 memcmp( expectedPacket.data(), receivedPacket.data(), expectedSize ) != 0 )
+            {
+                result.m_mismatched++;
+            }
+        }
+
+        std::this_thread::sleep_for( std::chrono::microseconds( 100 ) );
+    }
+
+    result.m_receiverStats = receiver.getStatistics();
+    return result;
+}
+
+} // namespace toolkit
+} // namespace endlesss
@@ -0,0 +1,181 @@
+//   _______ _______ ______ _______ ___ ___ _______ _______ _______ 
+//  |       |   |   |   __ \       |   |   |    ___|       |    |  |
+//  |   -   |   |   |      <   -   |   |   |    ___|   -   |       |
+//  |_______|_______|___|__|_______|\_____/|_______|_______|__|____|
+//  \\ harry denholm \\ ishani            ishani.org/shelf/ouroveon/
+//
+//  
+//
+
+#pragma once
+
+#include "base/construction.h"
+#include "endlesss/toolkit.exchange.h"
+
+namespace endlesss {
+namespace toolkit {
+
+// ---------------------------------------------------------------------------------------------------------------------
+// compact binary encoding of an Exchange block for sending over UDP to other machines. all values are little-endian
+// and tightly packed, independent of the in-memory layout of Exchange
+//
+//  header      u32 magic 'OXCH', u16 protocol version, u16 packet flags,
+//              u32 sequence, u32 keyframe sequence, u32 source id, u32 Exchange::m_dataflags, u32 section mask
+//  riff        jam name [32], u64 riff hash, u64 timestamp, u32 root, u32 scale, f32 bpm, u32 bar segment count,
+//              u32 jammer valid bits, 8x jammer name [32]
+//  playback    u32 active bar segment, f32 beat[8], f32 wave[8], f32 wave LF[8], f32 wave HF[8], f32 gain[8],
+//              u32 colour[8], u8 analysed bits, f32 consensus beat, f32 riff progress, f32 riff transition
+//  scope       f32 scope[8]
+//
+// sections appear in that order, only if set in the section mask. the riff section only changes when the riff does,
+// so it is only sent in keyframes; every other packet is a delta that leans on the riff section of the keyframe
+// named by its keyframe sequence. keyframes are sent whenever the riff changes, and periodically for late joiners
+//
+struct ExchangePacket
+{
+    static constexpr uint32_t       Magic               = 0x4843584F;   // 'OXCH'
+    static constexpr uint16_t       ProtocolVersion     = 1;
+    static constexpr std::size_t    MaxPacketSize       = 1024;
+
+    enum : uint16_t
+    {
+        Flags_Keyframe      = 1 << 0
+    };
+
+    enum : uint32_t
+    {
+        Section_Riff        = 1 << 0,
+        Section_Playback    = 1 << 1,
+        Section_Scope       = 1 << 2
+    };
+
+    struct Header
+    {
+        uint16_t    m_protocolVersion   = 0;
+        uint16_t    m_flags             = 0;
+        uint32_t    m_sequence          = 0;
+        uint32_t    m_keyframeSequence  = 0;
+        uint32_t    m_sourceID          = 0;
+        uint32_t    m_dataflags         = 0;
+        uint32_t    m_sectionMask       = 0;
+
+        ouro_nodiscard constexpr bool isKeyframe() const { return ( m_flags & Flags_Keyframe ) != 0; }
+    };
+
+    // write `data` out into `buffer` (at least MaxPacketSize bytes), returning the number of bytes used
+    static std::size_t encode( const Exchange& data, const Header& header, uint8_t* buffer );
+
+    // parse the header and whatever sections are present into `result`; sections not in the packet are left untouched
+    static absl::Status decode( const uint8_t* buffer, const std::size_t bufferSize, Header& header, Exchange& result );
+};
+
+
+// ---------------------------------------------------------------------------------------------------------------------
+// sends Exchange updates as ExchangePacket datagrams to a multicast group or a single unicast host. sending is
+// non-blocking and rate-limited; call publish() as often as new data is available
+//
+struct ExchangeBroadcaster
+{
+    DECLARE_NO_COPY_NO_MOVE( ExchangeBroadcaster );
+
+    struct Options
+    {
+        std::string     m_address;
+        uint16_t        m_port              = 0;
+        int32_t         m_multicastTTL      = 1;
+        int32_t         m_sendRateHz        = 60;
+        int32_t         m_keyframeInterval  = 30;
+    };
+
+    struct Statistics
+    {
+        uint64_t        m_packetsSent       = 0;
+        uint64_t        m_keyframesSent     = 0;
+        uint64_t        m_bytesSent         = 0;
+        uint64_t        m_sendFailures      = 0;    // includes packets dropped because the socket would have blocked
+        uint32_t        m_lastSequence      = 0;
+    };
+
+    ExchangeBroadcaster();
+    ~ExchangeBroadcaster();
+
+    ouro_nodiscard absl::Status start( const Options& options );
+    void stop();
+    ouro_nodiscard bool isRunning() const;
+
+    // sends `data` if the configured rate allows, returns true if a packet went out
+    bool publish( const Exchange& data );
+    // .. or send it right now, ignoring the rate limit
+    bool publishImmediate( const Exchange& data );
+
+    ouro_nodiscard Statistics getStatistics() const;
+
+private:
+    struct State;
+    std::unique_ptr< State >    m_state;
+};
+
+
+// ---------------------------------------------------------------------------------------------------------------------
+// listens for ExchangePacket datagrams and rebuilds the sender's Exchange block from them; non-blocking, call poll()
+// regularly to drain whatever has arrived
+//
+struct ExchangeReceiver
+{
+    DECLARE_NO_COPY_NO_MOVE( ExchangeReceiver );
+
+    struct Options
+    {
+        std::string     m_listenAddress     = "0.0.0.0";
+        std::string     m_multicastGroup;               // empty to only receive unicast
+        uint16_t        m_port              = 0;        // 0 picks any free port, see getBoundPort()
+    };
+
+    struct Statistics
+    {
+        uint64_t        m_packetsReceived   = 0;
+        uint64_t        m_packetsApplied    = 0;
+        uint64_t        m_packetsLost       = 0;    // gaps in the sequence
+        uint64_t        m_packetsStale      = 0;    // duplicates or arrived after a newer packet
+        uint64_t        m_packetsInvalid    = 0;    // failed to decode, wrong magic or protocol version
+        uint64_t        m_packetsUnanchored = 0;    // deltas dropped as we don't have the keyframe they refer to
+        uint64_t        m_sourceChanges     = 0;    // sender restarted, or another sender started on the same port
+        uint32_t        m_lastSequence      = 0;
+    };
+
+    // results from verifyLoopback()
+    struct Verification
+    {
+        uint64_t        m_sent              = 0;
+        uint64_t        m_received          = 0;
+        uint64_t        m_mismatched        = 0;    // decoded blocks that differed from what was sent; must be 0
+        Statistics      m_receiverStats;
+
+        ouro_nodiscard constexpr bool passed() const { return m_mismatched == 0 && m_received > 0; }
+    };
+
+    ExchangeReceiver();
+    ~ExchangeReceiver();
+
+    ouro_nodiscard absl::Status start( const Options& options );
+    void stop();
+    ouro_nodiscard bool isRunning() const;
+    ouro_nodiscard uint16_t getBoundPort() const;
+
+    // process everything waiting on the socket; returns true if `result` now holds newer data. m_dataWriteCounter
+    // is set to the sequence number of the packet that produced it
+    bool poll( Exchange& result );
+
+    ouro_nodiscard Statistics getStatistics() const;
+
+    // round-trip a stream of changing Exchange blocks through a broadcaster and receiver over the loopback interface,
+    // checking every one that arrives decodes to exactly what was sent
+    static Verification verifyLoopback( const std::chrono::milliseconds duration );
+
+private:
+    struct State;
+    std::unique_ptr< State >    m_state;
+};
+
+} // namespace toolkit
+} // namespace endlesss
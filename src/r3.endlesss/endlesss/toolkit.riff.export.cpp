@@ -43,7 +43,8 @@ std::vector<fs::path> exportRiff(
     const RiffExportMode            exportMode,
     const RiffExportDestination&    destination,
     const RiffExportAdjustments&    adjustments,
-    const endlesss::live::RiffPtr&  riffPtr )
+    const endlesss::live::RiffPtr&  riffPtr,
+    tf::Executor*                   taskExecutor )
 {
     TokenReplacements tokenReplacements;
 
@@ -148,6 +149,8 @@ std::vector<fs::path> exportRiff(
         }
     }
 
+    static constexpr float cWriterBufferSeconds = 4.0f;
+
     const uint32_t exportSampleRate = currentRiff->m_stemSampleRate;
     currentRiff->exportToDisk( [&]( const uint32_t stemIndex, const endlesss::live::Stem& stemData ) -> ssp::SampleStreamProcessorInstance
         {
@@ -206,10 +209,13 @@ std::vector<fs::path> exportRiff(
                     return nullptr;
                 }
 
+                // stems are streamed into the writers in chunks, so they only need to buffer a little before
+                // committing to disk; keeps memory use flat with several stems in flight at once. exports run on worker
+                // threads far faster than realtime, so let them wait on the encoder rather than drop pages
                 switch ( destination.m_spec.format )
                 {
-                    case AudioFormat::FLAC: return ssp::FLACWriter::Create( stemPath, exportSampleRate, 60.0f );
-                    case AudioFormat::WAV:  return ssp::WAVWriter::Create( stemPath, exportSampleRate, 60 );
+                    case AudioFormat::FLAC: return ssp::FLACWriter::Create( stemPath, exportSampleRate, cWriterBufferSeconds, ssp::SampleFeed::Offline );
+                    case AudioFormat::WAV:  return ssp::WAVWriter::Create( stemPath, exportSampleRate, (uint32_t)cWriterBufferSeconds );
                     default:
                         ABSL_ASSERT( false );
                         break;
@@ -218,7 +224,8 @@ std::vector<fs::path> exportRiff(
 
             return nullptr;
         }, 
-        adjustments.m_exportSampleOffset );
+        adjustments.m_exportSampleOffset,
+        taskExecutor );
 
     return outputFiles;
 }
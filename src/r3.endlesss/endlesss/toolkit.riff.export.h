@@ -120,7 +120,8 @@ std::vector<fs::path> exportRiff(
     const RiffExportMode            exportMode,         // the plan
     const RiffExportDestination&    destination,        // where & how it's going
     const RiffExportAdjustments&    adjustments,        // anything else to do to it
-    const endlesss::live::RiffPtr&  riffPtr );          // the what
+    const endlesss::live::RiffPtr&  riffPtr,            // the what
+    tf::Executor*                   taskExecutor );     // optional; stems are rendered in parallel across it if provided
 
 } // namespace xp
 } // namespace toolkit
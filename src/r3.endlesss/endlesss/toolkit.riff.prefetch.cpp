@@ -0,0 +1,285 @@
+//   _______ _______ ______ _______ ___ ___ _______ _______ _______ 
+//  |       |   |   |   __ \       |   |   |    ___|       |    |  |
+//  |   -   |   |   |      <   -   |   |   |    ___|   -   |       |
+//  |_______|_______|___|__|_______|\_____/|_______|_______|__|____|
+//  \\ harry denholm \\ ishani            ishani.org/shelf/ouroveon/
+//
+//  
+//
+
+#include "pch.h"
+
+#include "base/instrumentation.h"
+#include "base/text.h"
+
+#include "endlesss/toolkit.riff.prefetch.h"
+#include "endlesss/cache.stems.h"
+#include "endlesss/api.h"
+
+namespace endlesss {
+namespace toolkit {
+
+// ---------------------------------------------------------------------------------------------------------------------
+RiffPrefetch::RiffPrefetch(
+    endlesss::services::RiffFetchProvider& riffFetchProvider,
+    const RiffDataResolver& riffDataResolver,
+    const std::size_t memoryBudgetBytes )
+    : m_riffFetchProvider( riffFetchProvider )
+    , m_resolver( riffDataResolver )
+    , m_memoryBudgetBytes( memoryBudgetBytes )
+{
+    m_prefetchThreadRun = true;
+    m_prefetchThread = std::make_unique<std::thread>( &RiffPrefetch::prefetchThread, this );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+RiffPrefetch::~RiffPrefetch()
+{
+    cancel();
+
+    m_prefetchThreadRun = false;
+    m_prefetchSema.signal();
+    m_prefetchThread->join();
+    m_prefetchThread.reset();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void RiffPrefetch::schedule( const std::vector< types::RiffIdentity >& riffs )
+{
+    {
+        std::scoped_lock<std::mutex> planLock( m_planLock );
+
+        m_generation++;
+
+        m_plan.clear();
+        m_plan.insert( m_plan.end(), riffs.begin(), riffs.end() );
+
+        // keep hold of anything we already warmed that is still part of the new plan, let the rest go
+        std::vector< WarmedRiff > keptWarm;
+        for ( auto& warmed : m_warmed )
+        {
+            const bool stillWanted = std::any_of( riffs.begin(), riffs.end(), [&]( const types::RiffIdentity& riff )
+                {
+                    return riff.getRiffID() == warmed.m_riffCouchID;
+                });
+
+            if ( stillWanted )
+                keptWarm.emplace_back( std::move( warmed ) );
+        }
+        m_warmed = std::move( keptWarm );
+    }
+    m_prefetchSema.signal();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+bool RiffPrefetch::append( const types::RiffIdentity& riff, const std::size_t planLimit )
+{
+    {
+        std::scoped_lock<std::mutex> planLock( m_planLock );
+        if ( m_plan.size() >= planLimit )
+            return false;
+
+        m_plan.emplace_back( riff );
+    }
+    m_prefetchSema.signal();
+    return true;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void RiffPrefetch::release( const types::RiffCouchID& riffCouchID )
+{
+    std::scoped_lock<std::mutex> planLock( m_planLock );
+
+    std::erase_if( m_warmed, [&]( const WarmedRiff& warmed )
+        {
+            return warmed.m_riffCouchID == riffCouchID;
+        });
+
+    // no point warming something that is already loaded
+    std::erase_if( m_plan, [&]( const types::RiffIdentity& planned )
+        {
+            return planned.getRiffID() == riffCouchID;
+        });
+
+    // the prefetch thread may be partway through this riff; flag it so the result is dropped rather than being
+    // added to m_warmed after the fact, where nothing would ever come along to release it
+    if ( m_warming == riffCouchID )
+        m_warmingReleased = true;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void RiffPrefetch::cancel()
+{
+    std::scoped_lock<std::mutex> planLock( m_planLock );
+
+    m_generation++;
+
+    m_plan.clear();
+    m_warmed.clear();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+std::vector< types::RiffIdentity > RiffPrefetch::collectFollowingRiffs(
+    const Warehouse::JamSlice& jamSlice,
+    const types::JamCouchID& jamCouchID,
+    const types::RiffCouchID& currentRiff,
+    const std::size_t count )
+{
+    std::vector< types::RiffIdentity > result;
+
+    const auto currentIt = std::find( jamSlice.m_ids.begin(), jamSlice.m_ids.end(), currentRiff );
+    if ( currentIt == jamSlice.m_ids.end() )
+        return result;
+
+    result.reserve( count );
+    for ( auto riffIt = std::next( currentIt ); riffIt != jamSlice.m_ids.end() && result.size() < count; ++riffIt )
+    {
+        result.emplace_back( jamCouchID, *riffIt );
+    }
+    return result;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+RiffPrefetch::Statistics RiffPrefetch::getStatistics() const
+{
+    std::scoped_lock<std::mutex> planLock( m_planLock );
+    return m_statistics;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+std::size_t RiffPrefetch::getPendingCount() const
+{
+    std::scoped_lock<std::mutex> planLock( m_planLock );
+    return m_plan.size();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+bool RiffPrefetch::warmRiff( const types::RiffIdentity& riff, const uint32_t generation )
+{
+    const auto isStale = [&]() { return m_generation != generation || !m_prefetchThreadRun; };
+
+    types::RiffComplete riffComplete;
+    if ( !m_resolver( riff, riffComplete ) )
+    {
+        blog::error::api( FMTX( "riff prefetch resolver failed to fetch [{}]" ), riff.getRiffID() );
+        return true;
+    }
+
+    auto& stemCache = m_riffFetchProvider->getStemCache();
+
+    WarmedRiff warmed;
+    warmed.m_riffCouchID = riff.getRiffID();
+
+    uint32_t stemsFetched  = 0;
+    uint32_t stemsResident = 0;
+
+    for ( size_t stemI = 0; stemI < 8; stemI++ )
+    {
+        if ( !riffComplete.riff.stemsOn[stemI] )
+            continue;
+
+        if ( isStale() )
+        {
+            std::scoped_lock<std::mutex> planLock( m_planLock );
+            m_statistics.m_cancellations++;
+            return false;
+        }
+
+        // don't let prefetching be the thing that tips the cache into pruning live data
+        if ( stemCache.estimateMemoryUsageBytes() >= m_memoryBudgetBytes )
+        {
+            blog::stem( FMTX( "[prefetch] stem cache at memory budget ({}), pausing" ), base::humaniseByteSize( "", m_memoryBudgetBytes ) );
+
+            std::scoped_lock<std::mutex> planLock( m_planLock );
+            m_statistics.m_budgetStops++;
+
+            // put it back to be picked up again once the plan next changes, unless it was superseded or loaded meanwhile
+            if ( m_generation == generation && !m_warmingReleased )
+                m_plan.emplace_front( riff );
+
+            return false;
+        }
+
+        const auto& stemData = riffComplete.stems[stemI];
+
+        endlesss::live::StemPtr stemPtr = stemCache.request( stemData );
+        if ( stemPtr->claimFetch() )
+        {
+            base::instr::ScopedEvent se( "stem-prefetch", base::instr::PresetColour::Cyan );
+
+            stemPtr->fetch( m_riffFetchProvider->getNetConfiguration(), stemCache.getCachePathForStem( stemData ) );
+            stemPtr->analyse( stemCache.getStemProcessing() );
+            stemsFetched++;
+        }
+        else
+        {
+            stemsResident++;
+        }
+        warmed.m_stems.emplace_back( std::move( stemPtr ) );
+    }
+
+    blog::stem( FMTX( "[prefetch] riff [{}] warm, {} stems fetched, {} already resident" ), warmed.m_riffCouchID, stemsFetched, stemsResident );
+
+    std::scoped_lock<std::mutex> planLock( m_planLock );
+
+    m_statistics.m_riffsWarmed++;
+    m_statistics.m_stemsFetched  += stemsFetched;
+    m_statistics.m_stemsResident += stemsResident;
+
+    // only hold onto the stems if the plan they were part of is still current and the riff wasn't loaded for real
+    // while we were busy with it
+    if ( m_generation == generation && !m_warmingReleased )
+        m_warmed.emplace_back( std::move( warmed ) );
+
+    return true;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void RiffPrefetch::prefetchThread()
+{
+    OuroveonThreadScope ots( OURO_THREAD_PREFIX "Riff-Prefetch" );
+
+    for (;;)
+    {
+        if ( !m_prefetchThreadRun )
+            break;
+
+        if ( !m_prefetchSema.wait( 100000 ) )
+            continue;
+
+        for (;;)
+        {
+            types::RiffIdentity nextRiff;
+            uint32_t generation;
+            {
+                std::scoped_lock<std::mutex> planLock( m_planLock );
+                if ( m_plan.empty() )
+                    break;
+
+                nextRiff = m_plan.front();
+                m_plan.pop_front();
+
+                generation = m_generation;
+
+                m_warming         = nextRiff.getRiffID();
+                m_warmingReleased = false;
+            }
+
+            // stop on cancellation or budget exhaustion; on the latter the riff goes back on the plan and it, along
+            // with the rest, will be retried next time the plan is changed
+            const bool warmed = warmRiff( nextRiff, generation );
+
+            {
+                std::scoped_lock<std::mutex> planLock( m_planLock );
+                m_warming = {};
+                m_warmingReleased = false;
+            }
+
+            if ( !warmed )
+                break;
+        }
+    }
+}
+
+} // namespace toolkit
+} // namespace endlesss
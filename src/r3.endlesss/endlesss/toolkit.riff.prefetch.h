@@ -0,0 +1,120 @@
+//   _______ _______ ______ _______ ___ ___ _______ _______ _______ 
+//  |       |   |   |   __ \       |   |   |    ___|       |    |  |
+//  |   -   |   |   |      <   -   |   |   |    ___|   -   |       |
+//  |_______|_______|___|__|_______|\_____/|_______|_______|__|____|
+//  \\ harry denholm \\ ishani            ishani.org/shelf/ouroveon/
+//
+//  
+//
+
+#pragma once
+
+#include "base/construction.h"
+
+#include "endlesss/core.types.h"
+#include "endlesss/core.services.h"
+#include "endlesss/live.stem.h"
+#include "endlesss/toolkit.riff.pipeline.h"
+#include "endlesss/toolkit.warehouse.h"
+
+namespace endlesss {
+namespace toolkit {
+
+// ---------------------------------------------------------------------------------------------------------------------
+// background stem warmer; given a list of riffs we're likely to want soon (the next few riffs along a jam timeline,
+// the riffs queued up behind the current one in Beam) this works through them one stem at a time, pulling them
+// into the stem cache so that by the time the Pipeline gets asked for them all the heavy lifting is done
+//
+// it deliberately runs on its own single thread rather than the shared task executor so that it never competes
+// with the riffs that are actually being requested for playback. work stops once the stem cache grows past the
+// given memory budget, so prefetching never pushes the cache into a prune
+//
+struct RiffPrefetch
+{
+    DECLARE_NO_COPY_NO_MOVE( RiffPrefetch );
+
+    using RiffDataResolver = Pipeline::RiffDataResolver;
+
+    RiffPrefetch(
+        endlesss::services::RiffFetchProvider&  riffFetchProvider,          // api required for riff fetching / caching
+        const RiffDataResolver&                 riffDataResolver,           // resolver function, as given to the Pipeline
+        const std::size_t                       memoryBudgetBytes );        // stop warming once stem cache is using this much
+
+    ~RiffPrefetch();
+
+
+    // replace the current prefetch plan with a new one, in order of priority; any work in progress for the previous
+    // plan is abandoned at the next stem boundary and stems kept alive on its behalf are released
+    void schedule( const std::vector< types::RiffIdentity >& riffs );
+
+    // add a riff to the back of the current plan, unless there are already `planLimit` riffs waiting in it;
+    // returns false if the riff was turned away
+    bool append( const types::RiffIdentity& riff, const std::size_t planLimit = std::numeric_limits<std::size_t>::max() );
+
+    // a prefetched riff has been loaded for real, so the live riff now owns its stems; release our hold on them.
+    // also drops the riff from the plan if it hasn't been reached yet, and stops a warm already underway on it
+    // from holding onto its stems once it finishes
+    void release( const types::RiffCouchID& riffCouchID );
+
+    // drop everything
+    void cancel();
+
+
+    // walk a jam slice to find the `count` riffs that follow `currentRiff` in timeline order; returns an empty
+    // list if the current riff isn't part of the slice
+    static std::vector< types::RiffIdentity > collectFollowingRiffs(
+        const Warehouse::JamSlice&      jamSlice,
+        const types::JamCouchID&        jamCouchID,
+        const types::RiffCouchID&       currentRiff,
+        const std::size_t               count );
+
+
+    struct Statistics
+    {
+        uint32_t    m_riffsWarmed       = 0;    // riffs that had all their stems brought into the cache
+        uint32_t    m_stemsFetched      = 0;    // stems we loaded ourselves
+        uint32_t    m_stemsResident     = 0;    // stems already present or being loaded by someone else
+        uint32_t    m_cancellations     = 0;    // riffs abandoned mid-warm due to a schedule change
+        uint32_t    m_budgetStops       = 0;    // times we stopped as the stem cache hit the memory budget
+    };
+
+    ouro_nodiscard Statistics getStatistics() const;
+    ouro_nodiscard std::size_t getPendingCount() const;
+
+private:
+
+    using StemPtrs = std::vector< endlesss::live::StemPtr >;
+
+    struct WarmedRiff
+    {
+        types::RiffCouchID      m_riffCouchID;
+        StemPtrs                m_stems;
+    };
+
+    // returns false if the work was abandoned, either through cancellation or the budget being hit; on the latter
+    // the riff is put back at the front of the plan to try again later
+    bool warmRiff( const types::RiffIdentity& riff, const uint32_t generation );
+
+    void prefetchThread();
+
+
+    services::RiffFetchProvider             m_riffFetchProvider;
+    RiffDataResolver                        m_resolver;
+    std::size_t                             m_memoryBudgetBytes;
+
+    mutable std::mutex                      m_planLock;
+    std::deque< types::RiffIdentity >       m_plan;             // riffs still to warm, front first
+    std::vector< WarmedRiff >               m_warmed;           // stems we're holding to stop them being pruned
+    types::RiffCouchID                      m_warming;          // riff the prefetch thread is currently working on, if any
+    bool                                    m_warmingReleased = false;  // release() was called for m_warming while it was underway
+    Statistics                              m_statistics;
+
+    std::atomic_uint32_t                    m_generation = 0;   // bumped on every schedule change; workers compare to bail early
+
+    std::unique_ptr< std::thread >          m_prefetchThread;
+    std::atomic_bool                        m_prefetchThreadRun = false;
+    mcc::LightweightSemaphore               m_prefetchSema;
+};
+
+} // namespace toolkit
+} // namespace endlesss
@@ -31,6 +31,48 @@ namespace toolkit {
 
 std::string Warehouse::m_databaseFile;
 
+// scratch databases used by Warehouse::benchmarkSearch / benchmarkIngest
+static std::string gSearchBenchmarkDatabaseFile;
+using SearchBenchmarkDB = sqlite::Database<gSearchBenchmarkDatabaseFile>;
+static std::string gIngestBenchmarkDatabaseFile;
+using IngestBenchmarkDB = sqlite::Database<gIngestBenchmarkDatabaseFile>;
+
+// point `databaseFile` (one of the above) at a fresh file in `scratchPath` and run `benchmarkFn` against it on a private
+// thread; the database connection is thread-local, so it is closed when the thread exits and the scratch files can
+// then be deleted. returns a description of any SQLite error that was thrown, or an empty string
+static std::string runBenchmarkOnScratchDatabase( std::string& databaseFile, const fs::path& scratchFile, const std::function<void()>& benchmarkFn )
+{
+    databaseFile = scratchFile.string();
+
+    const auto removeScratchFiles = [&databaseFile]()
+    {
+        std::error_code fileError;
+        fs::remove( databaseFile, fileError );
+        fs::remove( databaseFile + "-journal", fileError );
+        fs::remove( databaseFile + "-wal", fileError );
+        fs::remove( databaseFile + "-shm", fileError );
+    };
+    removeScratchFiles();
+
+    std::string benchmarkError;
+    std::thread benchmarkThread( [&benchmarkFn, &benchmarkError]()
+    {
+        try
+        {
+            benchmarkFn();
+        }
+        catch ( const sqlite::error& sqlError )
+        {
+            benchmarkError = fmt::format( FMTX( "SQLite error {} ({})" ), sqlError.err_code, sqlite3_errstr( sqlError.err_code ) );
+        }
+    });
+    benchmarkThread.join();
+
+    removeScratchFiles();
+
+    return benchmarkError;
+}
+
 
 using StemSet   = absl::flat_hash_set< endlesss::types::StemCouchID >;
 
@@ -184,40 +226,43 @@ struct JamExportTask final : Warehouse::ITask
 };
 
 // ---------------------------------------------------------------------------------------------------------------------
-struct GetRiffDataTask final : Warehouse::INetworkTask
+struct ContentsAuditTask final : Warehouse::ITask
 {
-    static constexpr char Tag[] = "RIFFDATA";
+    static constexpr char Tag[] = "AUDIT";
 
-    GetRiffDataTask( const api::NetConfiguration& ncfg, const types::JamCouchID& jamCID, const std::vector< types::RiffCouchID >& riffCIDs )
-        : Warehouse::INetworkTask( ncfg )
-        , m_jamCID( jamCID )
-        , m_riffCIDs( riffCIDs )
+    ContentsAuditTask( base::EventBusClient& eventBus, const bool repairMismatches )
+        : Warehouse::ITask()
+        , m_eventBusClient( eventBus )
+        , m_repairMismatches( repairMismatches )
     {}
 
-    types::JamCouchID                 m_jamCID;
-    std::vector< types::RiffCouchID > m_riffCIDs;
+    // always trigger a contents update in case we rebuilt the statistics
+    bool forceContentReport() const override { return true; }
+
+    base::EventBusClient    m_eventBusClient;
+    bool                    m_repairMismatches;
 
     const char* getTag() override { return Tag; }
-    std::string Describe() override { return fmt::format( "[{}] pulling {} riff details", Tag, m_riffCIDs.size() ); }
+    std::string Describe() override { return fmt::format( "[{}] checking contents statistics", Tag ); }
     bool Work( TaskQueue& currentTasks ) override;
 };
 
 // ---------------------------------------------------------------------------------------------------------------------
-struct GetStemData final : Warehouse::INetworkTask
+struct SearchTask final : Warehouse::ITask
 {
-    static constexpr char Tag[] = "STEMDATA";
+    static constexpr char Tag[] = "SEARCH";
 
-    GetStemData( const api::NetConfiguration& ncfg, const types::JamCouchID& jamCID, const std::vector< types::StemCouchID >& stemCIDs )
-        : Warehouse::INetworkTask( ncfg )
-        , m_jamCID( jamCID )
-        , m_stemCIDs( stemCIDs )
+    SearchTask( const Warehouse::SearchQuery& query, const Warehouse::SearchCallback& callbackOnCompletion )
+        : ITask()
+        , m_query( query )
+        , m_reportCallback( callbackOnCompletion )
     {}
 
-    types::JamCouchID                 m_jamCID;
-    std::vector< types::StemCouchID > m_stemCIDs;
+    Warehouse::SearchQuery          m_query;
+    Warehouse::SearchCallback       m_reportCallback;
 
     const char* getTag() override { return Tag; }
-    std::string Describe() override { return fmt::format( "[{}] pulling {} stem details", Tag, m_stemCIDs.size() ); }
+    std::string Describe() override { return fmt::format( "[{}] searching riffs", Tag ); }
     bool Work( TaskQueue& currentTasks ) override;
 };
 
@@ -976,16 +1021,692 @@ namespace ledger {
 
 } // namespace ledger
 
+// ---------------------------------------------------------------------------------------------------------------------
+// full-text index over riffs; each row shares its rowid with the Riffs row it describes and holds the searchable text
+// gathered from Riffs, Jams and Tags. triggers on those tables keep it in sync, so nothing that writes to them needs
+// to know the index exists
+//
+// functions are templated on the database so the benchmark can run the same schema in a scratch file
+namespace search {
+
+    static constexpr char checkTableExists[] = R"(
+        select count(*) from sqlite_master where type = 'table' and name = 'RiffSearch';)";
+
+    static constexpr char createTable[] = R"(
+        CREATE VIRTUAL TABLE IF NOT EXISTS "RiffSearch" USING fts5(
+            UserName,
+            JamName,
+            TagNote,
+            tokenize = 'unicode61 remove_diacritics 2',
+            prefix = '2 3'
+        );)";
+
+    // fill the index from whatever is already in the database; only run when the index is first created
+    static constexpr char populateFromExisting[] = R"(
+        INSERT INTO RiffSearch( rowid, UserName, JamName, TagNote )
+            SELECT Riffs.rowid, Riffs.UserName, Jams.PublicName, Tags.Note FROM Riffs
+            LEFT JOIN Jams ON Jams.JamCID  = Riffs.OwnerJamCID
+            LEFT JOIN Tags ON Tags.RiffCID = Riffs.RiffCID;)";
+
+    static constexpr char createTrigger_0[] = R"(
+        CREATE TRIGGER IF NOT EXISTS "RiffSearch_RiffInsert" AFTER INSERT ON "Riffs" BEGIN
+            INSERT INTO RiffSearch( rowid, UserName, JamName, TagNote ) VALUES( new.rowid, new.UserName,
+                ( SELECT PublicName FROM Jams WHERE JamCID  = new.OwnerJamCID ),
+                ( SELECT Note       FROM Tags WHERE RiffCID = new.RiffCID ) );
+        END;)";
+    static constexpr char createTrigger_1[] = R"(
+        CREATE TRIGGER IF NOT EXISTS "RiffSearch_RiffUpdate" AFTER UPDATE OF UserName, OwnerJamCID ON "Riffs"
+            WHEN old.UserName IS NOT new.UserName OR old.OwnerJamCID IS NOT new.OwnerJamCID BEGIN
+            UPDATE RiffSearch SET
+                UserName = new.UserName,
+                JamName  = ( SELECT PublicName FROM Jams WHERE JamCID = new.OwnerJamCID )
+                WHERE rowid = new.rowid;
+        END;)";
+    static constexpr char createTrigger_2[] = R"(
+        CREATE TRIGGER IF NOT EXISTS "RiffSearch_RiffDelete" AFTER DELETE ON "Riffs" BEGIN
+            DELETE FROM RiffSearch WHERE rowid = old.rowid;
+        END;)";
+    static constexpr char createTrigger_3[] = R"(
+        CREATE TRIGGER IF NOT EXISTS "RiffSearch_TagInsert" AFTER INSERT ON "Tags" BEGIN
+            UPDATE RiffSearch SET TagNote = new.Note WHERE rowid = ( SELECT rowid FROM Riffs WHERE RiffCID = new.RiffCID );
+        END;)";
+    static constexpr char createTrigger_4[] = R"(
+        CREATE TRIGGER IF NOT EXISTS "RiffSearch_TagUpdate" AFTER UPDATE OF Note ON "Tags"
+            WHEN old.Note IS NOT new.Note BEGIN
+            UPDATE RiffSearch SET TagNote = new.Note WHERE rowid = ( SELECT rowid FROM Riffs WHERE RiffCID = new.RiffCID );
+        END;)";
+    static constexpr char createTrigger_5[] = R"(
+        CREATE TRIGGER IF NOT EXISTS "RiffSearch_TagDelete" AFTER DELETE ON "Tags" BEGIN
+            UPDATE RiffSearch SET TagNote = NULL WHERE rowid = ( SELECT rowid FROM Riffs WHERE RiffCID = old.RiffCID );
+        END;)";
+    static constexpr char createTrigger_6[] = R"(
+        CREATE TRIGGER IF NOT EXISTS "RiffSearch_JamInsert" AFTER INSERT ON "Jams" BEGIN
+            UPDATE RiffSearch SET JamName = new.PublicName WHERE rowid IN ( SELECT rowid FROM Riffs WHERE OwnerJamCID = new.JamCID );
+        END;)";
+    static constexpr char createTrigger_7[] = R"(
+        CREATE TRIGGER IF NOT EXISTS "RiffSearch_JamUpdate" AFTER UPDATE OF PublicName ON "Jams"
+            WHEN old.PublicName IS NOT new.PublicName BEGIN
+            UPDATE RiffSearch SET JamName = new.PublicName WHERE rowid IN ( SELECT rowid FROM Riffs WHERE OwnerJamCID = new.JamCID );
+        END;)";
+
+    // -----------------------------------------------------------------------------------------------------------------
+    template< typename _DB >
+    static void runInit()
+    {
+        int32_t tableExists = 0;
+        {
+            auto query = _DB::template query<checkTableExists>();
+            query( tableExists );
+        }
+
+        _DB::template query<createTable>();
+
+        _DB::template query<createTrigger_0>();
+        _DB::template query<createTrigger_1>();
+        _DB::template query<createTrigger_2>();
+        _DB::template query<createTrigger_3>();
+        _DB::template query<createTrigger_4>();
+        _DB::template query<createTrigger_5>();
+        _DB::template query<createTrigger_6>();
+        _DB::template query<createTrigger_7>();
+
+        if ( tableExists == 0 )
+        {
+            spacetime::ScopedTimer indexTiming( "warehouse [building search index]" );
+            _DB::template query<populateFromExisting>();
+        }
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------
+    // turn free text into an FTS5 expression; every word becomes a quoted prefix term, so punctuation in the input
+    // is never read as query syntax, and all terms must match. words with nothing the tokenizer would keep are dropped
+    static std::string buildMatchExpression( const Warehouse::SearchQuery& query )
+    {
+        std::string terms;
+
+        std::size_t wordStart = 0;
+        while ( wordStart < query.m_text.size() )
+        {
+            std::size_t wordEnd = query.m_text.find_first_of( " \t\r\n", wordStart );
+            if ( wordEnd == std::string::npos )
+                wordEnd = query.m_text.size();
+
+            const std::string_view word( query.m_text.data() + wordStart, wordEnd - wordStart );
+            wordStart = wordEnd + 1;
+
+            // bytes >= 0x80 are assumed to be part of a UTF8 letter
+            if ( std::none_of( word.begin(), word.end(), []( const char c ) { return std::isalnum( (uint8_t)c ) || ( (uint8_t)c >= 0x80 ); } ) )
+                continue;
+
+            if ( !terms.empty() )
+                terms += ' ';
+
+            terms += '"';
+            for ( const char c : word )
+            {
+                if ( c == '"' )
+                    terms += "\"\"";
+                else
+                    terms += c;
+            }
+            terms += "\"*";
+        }
+
+        if ( terms.empty() )
+            return terms;
+
+        switch ( query.m_textScope )
+        {
+            case Warehouse::SearchQuery::TextScope::UserName:   return fmt::format( FMTX( "{{UserName}} : ( {} )" ), terms );
+            case Warehouse::SearchQuery::TextScope::JamName:    return fmt::format( FMTX( "{{JamName}} : ( {} )" ), terms );
+            case Warehouse::SearchQuery::TextScope::TagNote:    return fmt::format( FMTX( "{{TagNote}} : ( {} )" ), terms );
+            default:
+                break;
+        }
+        return terms;
+    }
+
+    // parameters are shared by every search query;
+    //  ?1 match expression, ?2 jam ID, ?3 ?4 time window, ?5 ?6 BPM range, ?7 root, ?8 scale, ?9 page size, ?10 page offset
+    #define SEARCH_PREDICATES   " and Riffs.CreationTime between ?3 and ?4 and Riffs.BPMrnd between ?5 and ?6 and ( ?7 < 0 or Riffs.Root = ?7 ) and ( ?8 < 0 or Riffs.Scale = ?8 )"
+    #define SEARCH_PAGING       " order by Riffs.CreationTime desc limit ?9 offset ?10;"
+
+    #define SEARCH_FROM_TEXT    " from RiffSearch join Riffs on Riffs.rowid = RiffSearch.rowid where RiffSearch match ?1 and ( ?2 = '' or Riffs.OwnerJamCID = ?2 )"
+    #define SEARCH_FROM_JAM     " from Riffs where Riffs.OwnerJamCID = ?2"
+    #define SEARCH_FROM_ALL     " from Riffs where Riffs.CreationTime is not null"
+
+    static constexpr char _sqlSearchText[]  = { "select Riffs.RiffCID, Riffs.OwnerJamCID" SEARCH_FROM_TEXT SEARCH_PREDICATES SEARCH_PAGING };
+    static constexpr char _sqlCountText[]   = { "select count(*)"                         SEARCH_FROM_TEXT SEARCH_PREDICATES };
+    static constexpr char _sqlSearchJam[]   = { "select Riffs.RiffCID, Riffs.OwnerJamCID" SEARCH_FROM_JAM  SEARCH_PREDICATES SEARCH_PAGING };
+    static constexpr char _sqlCountJam[]    = { "select count(*)"                         SEARCH_FROM_JAM  SEARCH_PREDICATES };
+    static constexpr char _sqlSearchAll[]   = { "select Riffs.RiffCID, Riffs.OwnerJamCID" SEARCH_FROM_ALL  SEARCH_PREDICATES SEARCH_PAGING };
+    static constexpr char _sqlCountAll[]    = { "select count(*)"                         SEARCH_FROM_ALL  SEARCH_PREDICATES };
+
+    #undef SEARCH_FROM_ALL
+    #undef SEARCH_FROM_JAM
+    #undef SEARCH_FROM_TEXT
+    #undef SEARCH_PAGING
+    #undef SEARCH_PREDICATES
+
+    // -----------------------------------------------------------------------------------------------------------------
+    template< typename _DB, const auto& _sqlSearch, const auto& _sqlCount >
+    static void executeWith( const Warehouse::SearchQuery& query, const std::string& matchExpression, Warehouse::SearchResult& result )
+    {
+        const std::string jamCID = query.m_jamCID.value();
+        const int32_t pageSize   = std::max( query.m_pageSize, 0 );
+        const int32_t pageOffset = std::max( query.m_pageOffset, 0 );
+
+        {
+            auto searchQuery = _DB::template query<_sqlSearch>(
+                matchExpression,
+                jamCID,
+                query.m_timeBegin,
+                query.m_timeEnd,
+                query.m_bpmMinimum,
+                query.m_bpmMaximum,
+                query.m_root,
+                query.m_scale,
+                pageSize,
+                pageOffset );
+
+            result.m_riffIDs.reserve( pageSize );
+            result.m_jamIDs.reserve( pageSize );
+
+            std::string_view riffCID, ownerJamCID;
+            while ( searchQuery( riffCID, ownerJamCID ) )
+            {
+                result.m_riffIDs.emplace_back( riffCID );
+                result.m_jamIDs.emplace_back( ownerJamCID );
+            }
+        }
+
+        if ( query.m_countTotal )
+        {
+            auto countQuery = _DB::template query<_sqlCount>(
+                matchExpression,
+                jamCID,
+                query.m_timeBegin,
+                query.m_timeEnd,
+                query.m_bpmMinimum,
+                query.m_bpmMaximum,
+                query.m_root,
+                query.m_scale );
+
+            countQuery( result.m_totalMatches );
+        }
+        else
+        {
+            result.m_totalMatches = -1;
+        }
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------
+    template< typename _DB >
+    static void execute( const Warehouse::SearchQuery& query, Warehouse::SearchResult& result )
+    {
+        const std::string matchExpression = buildMatchExpression( query );
+
+        if ( !matchExpression.empty() )
+            executeWith< _DB, _sqlSearchText, _sqlCountText >( query, matchExpression, result );
+        else if ( !query.m_jamCID.empty() )
+            executeWith< _DB, _sqlSearchJam, _sqlCountJam >( query, matchExpression, result );
+        else
+            executeWith< _DB, _sqlSearchAll, _sqlCountAll >( query, matchExpression, result );
+    }
+
+} // namespace search
+
+// ---------------------------------------------------------------------------------------------------------------------
+// running per-jam counts of filled / empty riffs and stems, kept up to date by triggers on Riffs and Stems so the
+// contents report can be read straight out of one row per jam rather than re-counting both tables every time
+namespace statistics {
+
+    static constexpr char checkTableExists[] = R"(
+        select count(*) from sqlite_master where type = 'table' and name = 'JamStatistics';)";
+
+    static constexpr char createTable[] = R"(
+        CREATE TABLE IF NOT EXISTS "JamStatistics" (
+            "JamCID"        TEXT NOT NULL UNIQUE,
+            "FilledRiffs"   INTEGER NOT NULL DEFAULT 0,
+            "EmptyRiffs"    INTEGER NOT NULL DEFAULT 0,
+            "FilledStems"   INTEGER NOT NULL DEFAULT 0,
+            "EmptyStems"    INTEGER NOT NULL DEFAULT 0,
+            PRIMARY KEY("JamCID")
+        );)";
+
+    static constexpr char createTrigger_0[] = R"(
+        CREATE TRIGGER IF NOT EXISTS "JamStatistics_RiffInsert" AFTER INSERT ON "Riffs" BEGIN
+            INSERT INTO JamStatistics( JamCID, FilledRiffs, EmptyRiffs ) VALUES( new.OwnerJamCID, new.CreationTime IS NOT NULL, new.CreationTime IS NULL )
+            ON CONFLICT(JamCID) DO UPDATE SET FilledRiffs = FilledRiffs + excluded.FilledRiffs, EmptyRiffs = EmptyRiffs + excluded.EmptyRiffs;
+        END;)";
+    static constexpr char createTrigger_1[] = R"(
+        CREATE TRIGGER IF NOT EXISTS "JamStatistics_RiffDelete" AFTER DELETE ON "Riffs" BEGIN
+            UPDATE JamStatistics SET FilledRiffs = FilledRiffs - ( old.CreationTime IS NOT NULL ), EmptyRiffs = EmptyRiffs - ( old.CreationTime IS NULL )
+            WHERE JamCID = old.OwnerJamCID;
+        END;)";
+    static constexpr char createTrigger_2[] = R"(
+        CREATE TRIGGER IF NOT EXISTS "JamStatistics_RiffUpdate" AFTER UPDATE OF CreationTime, OwnerJamCID ON "Riffs"
+            WHEN ( old.CreationTime IS NULL ) IS NOT ( new.CreationTime IS NULL ) OR old.OwnerJamCID IS NOT new.OwnerJamCID BEGIN
+            UPDATE JamStatistics SET FilledRiffs = FilledRiffs - ( old.CreationTime IS NOT NULL ), EmptyRiffs = EmptyRiffs - ( old.CreationTime IS NULL )
+            WHERE JamCID = old.OwnerJamCID;
+            INSERT INTO JamStatistics( JamCID, FilledRiffs, EmptyRiffs ) VALUES( new.OwnerJamCID, new.CreationTime IS NOT NULL, new.CreationTime IS NULL )
+            ON CONFLICT(JamCID) DO UPDATE SET FilledRiffs = FilledRiffs + excluded.FilledRiffs, EmptyRiffs = EmptyRiffs + excluded.EmptyRiffs;
+        END;)";
+    static constexpr char createTrigger_3[] = R"(
+        CREATE TRIGGER IF NOT EXISTS "JamStatistics_StemInsert" AFTER INSERT ON "Stems" BEGIN
+            INSERT INTO JamStatistics( JamCID, FilledStems, EmptyStems ) VALUES( new.OwnerJamCID, new.CreationTime IS NOT NULL, new.CreationTime IS NULL )
+            ON CONFLICT(JamCID) DO UPDATE SET FilledStems = FilledStems + excluded.FilledStems, EmptyStems = EmptyStems + excluded.EmptyStems;
+        END;)";
+    static constexpr char createTrigger_4[] = R"(
+        CREATE TRIGGER IF NOT EXISTS "JamStatistics_StemDelete" AFTER DELETE ON "Stems" BEGIN
+            UPDATE JamStatistics SET FilledStems = FilledStems - ( old.CreationTime IS NOT NULL ), EmptyStems = EmptyStems - ( old.CreationTime IS NULL )
+            WHERE JamCID = old.OwnerJamCID;
+        END;)";
+    static constexpr char createTrigger_5[] = R"(
+        CREATE TRIGGER IF NOT EXISTS "JamStatistics_StemUpdate" AFTER UPDATE OF CreationTime, OwnerJamCID ON "Stems"
+            WHEN ( old.CreationTime IS NULL ) IS NOT ( new.CreationTime IS NULL ) OR old.OwnerJamCID IS NOT new.OwnerJamCID BEGIN
+            UPDATE JamStatistics SET FilledStems = FilledStems - ( old.CreationTime IS NOT NULL ), EmptyStems = EmptyStems - ( old.CreationTime IS NULL )
+            WHERE JamCID = old.OwnerJamCID;
+            INSERT INTO JamStatistics( JamCID, FilledStems, EmptyStems ) VALUES( new.OwnerJamCID, new.CreationTime IS NOT NULL, new.CreationTime IS NULL )
+            ON CONFLICT(JamCID) DO UPDATE SET FilledStems = FilledStems + excluded.FilledStems, EmptyStems = EmptyStems + excluded.EmptyStems;
+        END;)";
+
+    // full recount, as the contents report used to do on every run
+    static constexpr char _sqlCountRiffsFromScratch[] = R"(
+        SELECT OwnerJamCID,
+            count(case when CreationTime is not null then 1 end),
+            count(case when CreationTime is null then 1 end)
+            FROM Riffs GROUP BY OwnerJamCID;)";
+    static constexpr char _sqlCountStemsFromScratch[] = R"(
+        SELECT OwnerJamCID,
+            count(case when CreationTime is not null then 1 end),
+            count(case when CreationTime is null then 1 end)
+            FROM Stems GROUP BY OwnerJamCID;)";
+
+    static constexpr char _sqlRebuild_0[] = R"(
+        DELETE FROM JamStatistics;)";
+    static constexpr char _sqlRebuild_1[] = R"(
+        INSERT INTO JamStatistics( JamCID, FilledRiffs, EmptyRiffs )
+            SELECT OwnerJamCID,
+                count(case when CreationTime is not null then 1 end),
+                count(case when CreationTime is null then 1 end)
+            FROM Riffs GROUP BY OwnerJamCID;)";
+    static constexpr char _sqlRebuild_2[] = R"(
+        INSERT INTO JamStatistics( JamCID, FilledStems, EmptyStems )
+            SELECT OwnerJamCID,
+                count(case when CreationTime is not null then 1 end),
+                count(case when CreationTime is null then 1 end)
+            FROM Stems WHERE true GROUP BY OwnerJamCID
+        ON CONFLICT(JamCID) DO UPDATE SET FilledStems = excluded.FilledStems, EmptyStems = excluded.EmptyStems;)";
+
+    // -----------------------------------------------------------------------------------------------------------------
+    static void rebuild()
+    {
+        spacetime::ScopedTimer rebuildTiming( "warehouse [rebuilding statistics]" );
+
+        Warehouse::SqlDB::TransactionGuard txn;
+        Warehouse::SqlDB::query<_sqlRebuild_0>();
+        Warehouse::SqlDB::query<_sqlRebuild_1>();
+        Warehouse::SqlDB::query<_sqlRebuild_2>();
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------
+    static void runInit()
+    {
+        int32_t tableExists = 0;
+        {
+            auto query = Warehouse::SqlDB::query<checkTableExists>();
+            query( tableExists );
+        }
+
+        Warehouse::SqlDB::query<createTable>();
+
+        Warehouse::SqlDB::query<createTrigger_0>();
+        Warehouse::SqlDB::query<createTrigger_1>();
+        Warehouse::SqlDB::query<createTrigger_2>();
+        Warehouse::SqlDB::query<createTrigger_3>();
+        Warehouse::SqlDB::query<createTrigger_4>();
+        Warehouse::SqlDB::query<createTrigger_5>();
+
+        if ( tableExists == 0 )
+            rebuild();
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------
+    // filled riffs, empty riffs, filled stems, empty stems
+    using Counts      = std::array< int64_t, 4 >;
+    using CountsByJam = absl::flat_hash_map< std::string, Counts >;
+
+    static void fetchMaintained( CountsByJam& result )
+    {
+        static constexpr char _sqlFetchAll[] = R"(
+            select JamCID, FilledRiffs, EmptyRiffs, FilledStems, EmptyStems from JamStatistics;)";
+
+        auto query = Warehouse::SqlDB::query<_sqlFetchAll>();
+
+        std::string_view jamCID;
+        Counts counts;
+        while ( query( jamCID, counts[0], counts[1], counts[2], counts[3] ) )
+        {
+            result.emplace( jamCID, counts );
+        }
+    }
+
+    static void fetchFromScratch( CountsByJam& result )
+    {
+        std::string_view jamCID;
+        int64_t filled, empty;
+        {
+            auto query = Warehouse::SqlDB::query<_sqlCountRiffsFromScratch>();
+            while ( query( jamCID, filled, empty ) )
+            {
+                auto& counts = result[std::string( jamCID )];
+                counts[0] = filled;
+                counts[1] = empty;
+            }
+        }
+        {
+            auto query = Warehouse::SqlDB::query<_sqlCountStemsFromScratch>();
+            while ( query( jamCID, filled, empty ) )
+            {
+                auto& counts = result[std::string( jamCID )];
+                counts[2] = filled;
+                counts[3] = empty;
+            }
+        }
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------
+    static void remove( const types::JamCouchID& jamCID )
+    {
+        static constexpr char _sqlDeleteJam[] = R"(
+            delete from JamStatistics where JamCID = ?1;)";
+
+        Warehouse::SqlDB::query<_sqlDeleteJam>( jamCID.value() );
+    }
+
+} // namespace statistics
+
+// ---------------------------------------------------------------------------------------------------------------------
+// bulk ingest of riff records; incoming rows are staged into a per-connection TEMP table and then merged into Riffs and
+// Stems with a handful of set-based statements, rather than a round-trip per riff plus one per stem. merges run in key
+// order so the unique indices are walked in sequence instead of being hit at random for every row
+//
+// callers are expected to hold a transaction across staging and merging. templated on the database so the ingest
+// benchmark can run it against a scratch file
+namespace ingest {
+
+    static constexpr char createStaging[] = R"(
+        CREATE TEMP TABLE IF NOT EXISTS "RiffStage" (
+            "RiffCID"       TEXT NOT NULL,
+            "OwnerJamCID"   TEXT NOT NULL,
+            "CreationTime"  INTEGER,
+            "Root"          INTEGER,
+            "Scale"         INTEGER,
+            "BPS"           REAL,
+            "BPMrnd"        REAL,
+            "BarLength"     INTEGER,
+            "AppVersion"    INTEGER,
+            "Magnitude"     REAL,
+            "UserName"      TEXT,
+            "StemCID_1"     TEXT,
+            "StemCID_2"     TEXT,
+            "StemCID_3"     TEXT,
+            "StemCID_4"     TEXT,
+            "StemCID_5"     TEXT,
+            "StemCID_6"     TEXT,
+            "StemCID_7"     TEXT,
+            "StemCID_8"     TEXT,
+            "GainsJSON"     TEXT,
+            PRIMARY KEY("RiffCID")
+        );)";
+    static constexpr char clearStaging[] = R"(
+        DELETE FROM temp.RiffStage;)";
+
+    static constexpr char stageSkeleton[] = R"(
+        INSERT OR IGNORE INTO temp.RiffStage( RiffCID, OwnerJamCID ) VALUES( ?1, ?2 );)";
+    static constexpr char stageRiff[] = R"(
+        INSERT OR REPLACE INTO temp.RiffStage(
+            RiffCID, OwnerJamCID, CreationTime, Root, Scale, BPS, BPMrnd, BarLength, AppVersion, Magnitude, UserName,
+            StemCID_1, StemCID_2, StemCID_3, StemCID_4, StemCID_5, StemCID_6, StemCID_7, StemCID_8, GainsJSON )
+            VALUES( ?1, ?2, ?3, ?4, ?5, ?6, ?7, ?8, ?9, ?10, ?11, ?12, ?13, ?14, ?15, ?16, ?17, ?18, ?19, ?20 );)";
+
+    // newly discovered riffs are added as empty records, anything we already know about is left alone
+    static constexpr char mergeSkeletons[] = R"(
+        INSERT OR IGNORE INTO Riffs( RiffCID, OwnerJamCID )
+            SELECT RiffCID, OwnerJamCID FROM temp.RiffStage ORDER BY RiffCID;)";
+
+    // every stem referenced by a staged riff gets an empty record to be filled in later, if it doesn't have one already.
+    // only riffs that still have a record count; the backfill fetches concurrently, so a batch can arrive after its jam
+    // was purged and that must not bring its stems back
+    static constexpr char mergeStemSkeletons[] = R"(
+        INSERT OR IGNORE INTO Stems( StemCID, OwnerJamCID )
+            WITH LiveStage AS ( SELECT * FROM temp.RiffStage WHERE RiffCID IN (SELECT RiffCID FROM Riffs) )
+            SELECT StemCID, OwnerJamCID FROM (
+                SELECT StemCID_1 AS StemCID, OwnerJamCID FROM LiveStage UNION ALL
+                SELECT StemCID_2, OwnerJamCID FROM LiveStage UNION ALL
+                SELECT StemCID_3, OwnerJamCID FROM LiveStage UNION ALL
+                SELECT StemCID_4, OwnerJamCID FROM LiveStage UNION ALL
+                SELECT StemCID_5, OwnerJamCID FROM LiveStage UNION ALL
+                SELECT StemCID_6, OwnerJamCID FROM LiveStage UNION ALL
+                SELECT StemCID_7, OwnerJamCID FROM LiveStage UNION ALL
+                SELECT StemCID_8, OwnerJamCID FROM LiveStage )
+            WHERE StemCID <> '' ORDER BY StemCID;)";
+
+    // fill in existing riff records from the staged details. this only ever updates - riffs are created by
+    // mergeSkeletons, and any staged riff without a record (eg. its jam was purged mid-backfill) is skipped
+    static constexpr char mergeRiffs[] = R"(
+        INSERT INTO Riffs(
+            RiffCID, OwnerJamCID, CreationTime, Root, Scale, BPS, BPMrnd, BarLength, AppVersion, Magnitude, UserName,
+            StemCID_1, StemCID_2, StemCID_3, StemCID_4, StemCID_5, StemCID_6, StemCID_7, StemCID_8, GainsJSON )
+            SELECT
+            RiffCID, OwnerJamCID, CreationTime, Root, Scale, BPS, BPMrnd, BarLength, AppVersion, Magnitude, UserName,
+            StemCID_1, StemCID_2, StemCID_3, StemCID_4, StemCID_5, StemCID_6, StemCID_7, StemCID_8, GainsJSON
+            FROM temp.RiffStage WHERE RiffCID IN (SELECT RiffCID FROM Riffs) ORDER BY RiffCID
+        ON CONFLICT(RiffCID) DO UPDATE SET
+            CreationTime    = excluded.CreationTime,
+            Root            = excluded.Root,
+            Scale           = excluded.Scale,
+            BPS             = excluded.BPS,
+            BPMrnd          = excluded.BPMrnd,
+            BarLength       = excluded.BarLength,
+            AppVersion      = excluded.AppVersion,
+            Magnitude       = excluded.Magnitude,
+            UserName        = excluded.UserName,
+            StemCID_1       = excluded.StemCID_1,
+            StemCID_2       = excluded.StemCID_2,
+            StemCID_3       = excluded.StemCID_3,
+            StemCID_4       = excluded.StemCID_4,
+            StemCID_5       = excluded.StemCID_5,
+            StemCID_6       = excluded.StemCID_6,
+            StemCID_7       = excluded.StemCID_7,
+            StemCID_8       = excluded.StemCID_8,
+            GainsJSON       = excluded.GainsJSON;)";
+
+    // -----------------------------------------------------------------------------------------------------------------
+    // the staging table lives in the connection's temp schema, so it has to be created on each thread that ingests
+    template< typename _DB >
+    static void beginStaging()
+    {
+        _DB::template query<createStaging>();
+        _DB::template query<clearStaging>();
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------
+    template< typename _DB >
+    static void stageRiffSkeleton( const types::RiffCouchID& riffCID, const types::JamCouchID& jamCID )
+    {
+        _DB::template query<stageSkeleton>( riffCID.value(), jamCID.value() );
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------
+    template< typename _DB >
+    static void stageRiffDetails( const types::Riff& riffData )
+    {
+        const auto gainsJson = fmt::format( R"([ {} ])", fmt::join( riffData.gains, ", " ) );
+
+        _DB::template query<stageRiff>(
+            riffData.couchID.value(),
+            riffData.jamCouchID.value(),
+            riffData.creationTimeUnix,
+            riffData.root,
+            riffData.scale,
+            riffData.BPS,
+            riffData.BPMrnd,
+            riffData.barLength,
+            riffData.appVersion,
+            riffData.magnitude,
+            riffData.user,
+            riffData.stems[0].value(),
+            riffData.stems[1].value(),
+            riffData.stems[2].value(),
+            riffData.stems[3].value(),
+            riffData.stems[4].value(),
+            riffData.stems[5].value(),
+            riffData.stems[6].value(),
+            riffData.stems[7].value(),
+            gainsJson
+            );
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------
+    template< typename _DB >
+    static void mergeStagedSkeletons()
+    {
+        _DB::template query<mergeSkeletons>();
+        _DB::template query<clearStaging>();
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------
+    template< typename _DB >
+    static void mergeStagedRiffs()
+    {
+        _DB::template query<mergeStemSkeletons>();
+        _DB::template query<mergeRiffs>();
+        _DB::template query<clearStaging>();
+    }
+
+} // namespace ingest
+
 } // namespace sql
 
+// ---------------------------------------------------------------------------------------------------------------------
+// network backfill of unpopulated riff and stem records, run as a pipeline rather than one blocking batch at a time
+//
+//  plan  : the worker thread finds batches of empty rows, skipping any already in flight, and launches fetches
+//  fetch : up to [m_concurrencyLimit] batches are downloaded and parsed concurrently on a dedicated executor
+//  write : finished batches queue up and the worker thread commits them, many to a single transaction
+//
+// the plan and write stages only ever run on the warehouse worker thread, so the bookkeeping here is unguarded;
+// the completed-batch queue is the only thing the fetchers touch
+//
+struct Warehouse::Backfill
+{
+    static constexpr int32_t    cBatchSize                  = 40;   // rows per network request
+    static constexpr int32_t    cMaxBatchesPerTransaction   = 32;
+    static constexpr int32_t    cFailuresBeforePause        = 3;    // consecutive failed batches before we halt and tell the user
+
+    struct LedgerNote
+    {
+        types::StemCouchID              m_stemCID;
+        sql::ledger::StemLedgerType     m_type;
+        std::string                     m_note;
+    };
+
+    struct Batch
+    {
+        types::JamCouchID                   m_jamCID;
+        std::vector< types::StemCouchID >   m_stemCIDs;         // a batch is either stems ..
+        std::vector< types::RiffCouchID >   m_riffCIDs;         // .. or riffs
+
+        bool                                m_fetched = false;
+        api::StemDetails                    m_stemDetails;
+        api::RiffDetails                    m_riffDetails;
+        StemSet                             m_invalidStems;     // stems referenced by fetched riffs that failed validation
+        std::vector< LedgerNote >           m_ledgerNotes;      // .. and why, to be written alongside the riffs
+
+        ouro_nodiscard bool isStems() const { return !m_stemCIDs.empty(); }
+        ouro_nodiscard std::size_t rowCount() const { return isStems() ? m_stemCIDs.size() : m_riffCIDs.size(); }
+    };
+    using BatchPtr   = std::shared_ptr<Batch>;     // shared, as the fetch closure must be copyable
+    using BatchQueue = mcc::ConcurrentQueue<BatchPtr>;
+
+    Backfill( const int32_t concurrencyLimit )
+        : m_concurrencyLimit( std::clamp( concurrencyLimit, 1, 16 ) )
+        , m_fetchExecutor( (std::size_t)m_concurrencyLimit )
+    {
+        m_report.m_concurrencyLimit = m_concurrencyLimit;
+    }
+
+    ~Backfill()
+    {
+        // in-flight fetches push back into our queue; let them all land before anything is torn down
+        m_fetchExecutor.wait_for_all();
+    }
+
+    ouro_nodiscard bool hasCapacity() const { return m_batchesInFlight < m_concurrencyLimit; }
+    ouro_nodiscard bool isActive() const    { return m_batchesInFlight > 0; }
+
+    // plan; returns true if a new batch was launched
+    bool planStems( const api::NetConfiguration::Shared& netConfig );
+    bool planRiffs( const api::NetConfiguration::Shared& netConfig, base::EventBusClient& eventBus );
+
+    // write; commits whatever has been fetched, returning the set of jams that changed. failures are counted
+    // and `outShouldHalt` is set if we've hit too many in a row
+    void commitCompleted( absl::flat_hash_set< types::JamCouchID >& changedJams, bool& outShouldHalt );
+
+    // refresh the remaining-work counts and produce a one-line status for the work-update callback
+    std::string updateReport();
+
+    ouro_nodiscard BackfillReport getReport() const
+    {
+        std::scoped_lock<std::mutex> reportLock( m_reportMutex );
+        return m_report;
+    }
+
+private:
+
+    void launch( const api::NetConfiguration::Shared& netConfig, const BatchPtr& batch );
+
+    // fetch; runs on the executor, must not touch the database
+    static void fetchStems( const api::NetConfiguration& ncfg, Batch& batch );
+    static void fetchRiffs( const api::NetConfiguration& ncfg, Batch& batch );
+
+    // write; inside a transaction opened by commitCompleted()
+    static void commitStems( const Batch& batch );
+    static void commitRiffs( const Batch& batch );
+
+    const int32_t                               m_concurrencyLimit;
+
+    // worker-thread bookkeeping
+    absl::flat_hash_set< types::StemCouchID >   m_stemsInFlight;
+    absl::flat_hash_set< types::RiffCouchID >   m_riffsInFlight;
+    int32_t                                     m_batchesInFlight       = 0;    // launched and not yet committed
+    int32_t                                     m_consecutiveFailures   = 0;
+
+    // stats for the current run; a run begins when the pipeline goes from idle to busy
+    spacetime::Moment                           m_runStarted;
+    uint64_t                                    m_runRowsWritten        = 0;
+    uint64_t                                    m_runBatchesAttempted   = 0;
+    uint64_t                                    m_runBatchesFailed      = 0;
+
+    mutable std::mutex                          m_reportMutex;
+    BackfillReport                              m_report;
+
+    BatchQueue                                  m_completed;
+
+    tf::Executor                                m_fetchExecutor;        // keep last, see destructor
+};
+
 
 // ---------------------------------------------------------------------------------------------------------------------
-Warehouse::Warehouse( const app::StoragePaths& storagePaths, api::NetConfiguration::Shared& networkConfig, base::EventBusClient eventBus )
+Warehouse::Warehouse( const app::StoragePaths& storagePaths, api::NetConfiguration::Shared& networkConfig, base::EventBusClient eventBus, const int32_t backfillConcurrency )
     : m_networkConfiguration( networkConfig )
     , m_eventBusClient( eventBus )
     , m_workerThreadPaused( false )
 {
     m_taskSchedule = std::make_unique<TaskSchedule>();
+    m_backfill     = std::make_unique<Backfill>( backfillConcurrency );
 
     m_databaseFile = ( storagePaths.cacheCommon / "warehouse.db3" ).string();
     SqlDB::post_connection_hook = []( sqlite3* db_handle )
@@ -1000,6 +1721,8 @@ Warehouse::Warehouse( const app::StoragePaths& storagePaths, api::NetConfigurati
     sql::tags::runInit();
     sql::stems::runInit();
     sql::ledger::runInit();
+    sql::search::runInit<SqlDB>();
+    sql::statistics::runInit();
 
     m_workerThreadAlive = true;
     m_workerThread      = std::make_unique<std::thread>( &Warehouse::threadWorker, this );
@@ -1026,6 +1749,15 @@ Warehouse::~Warehouse()
 
     m_workerThread->join();
     m_workerThread.reset();
+
+    // waits for any fetches still in flight
+    m_backfill.reset();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+Warehouse::BackfillReport Warehouse::getBackfillReport() const
+{
+    return m_backfill->getReport();
 }
 
 // ---------------------------------------------------------------------------------------------------------------------
@@ -1387,9 +2119,348 @@ void Warehouse::batchRemoveAllTags( const endlesss::types::JamCouchID& jamCID )
     m_cbTagBatching( false );
 }
 
-
 // ---------------------------------------------------------------------------------------------------------------------
-void Warehouse::workerTogglePause()
+void Warehouse::requestContentsAudit( const bool repairMismatches )
+{
+    m_taskSchedule->m_taskQueue.enqueue( std::make_unique<ContentsAuditTask>( m_eventBusClient, repairMismatches ) );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void Warehouse::addSearchRequest( const SearchQuery& query, const SearchCallback& callbackOnCompletion )
+{
+    if ( query.m_pageSize <= 0 )
+    {
+        blog::error::database( "search request with no page size" );
+        return;
+    }
+
+    m_taskSchedule->m_taskQueue.enqueue( std::make_unique<SearchTask>( query, callbackOnCompletion ) );
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+Warehouse::SearchBenchmark Warehouse::benchmarkSearch( const fs::path& scratchPath, const std::size_t riffCount )
+{
+    SearchBenchmark result;
+    result.m_riffCount = riffCount;
+
+    result.m_error = runBenchmarkOnScratchDatabase( gSearchBenchmarkDatabaseFile, scratchPath / "ouro.warehouse.search.benchmark.db3", [&result, riffCount]()
+    {
+        using BenchDB = SearchBenchmarkDB;
+
+        BenchDB::query<sql::jams::createTable>();
+        BenchDB::query<sql::riffs::createTable>();
+        BenchDB::query<sql::riffs::createIndex_2>();
+        BenchDB::query<sql::riffs::createIndex_6>();
+        BenchDB::query<sql::tags::createTable>();
+        sql::search::runInit<BenchDB>();
+
+        // fixed seed so runs are comparable; around 5000 riffs per jam from a pool of jammers, ingested the way
+        // the warehouse does it - an empty record first, then filled in when the riff data arrives
+        static constexpr std::array< const char*, 16 > cWords = {
+            "ambient", "techno", "bossa", "drone", "lofi", "dub", "jungle", "garage",
+            "modular", "tape", "choir", "glitch", "sunday", "night", "session", "basement" };
+
+        std::mt19937 rng( 0x5EA4C411 );
+
+        const std::size_t jamCount  = std::max< std::size_t >( 1, riffCount / 5000 );
+        const std::size_t userCount = std::max< std::size_t >( 1, riffCount / 500 );
+
+        const auto makeJamCID  = []( const std::size_t index ) { return fmt::format( FMTX( "band{:08x}" ), index ); };
+        const auto makeRiffCID = []( const std::size_t index ) { return fmt::format( FMTX( "{:032x}" ), index * 0x9E3779B1ull ); };
+
+        static constexpr char _sqlInsertJam[] = R"(
+            INSERT INTO jams( JamCID, PublicName ) VALUES( ?1, ?2 )
+            ON CONFLICT(JamCID) DO UPDATE SET PublicName = ?2; )";
+        static constexpr char _sqlInsertRiff[] = R"(
+            INSERT OR IGNORE INTO riffs( riffCID, OwnerJamCID ) VALUES( ?1, ?2 ); )";
+        static constexpr char _sqlFillRiff[] = R"(
+            UPDATE riffs SET CreationTime=?2, Root=?3, Scale=?4, BPS=?5, BPMrnd=?6, UserName=?7 WHERE riffCID=?1; )";
+        static constexpr char _sqlUpsertTag[] = R"(
+            INSERT INTO Tags( OwnerJamCID, riffCID, Ordering, Timestamp, Favour, Note ) VALUES( ?1, ?2, ?3, ?4, ?5, ?6 )
+            ON CONFLICT(riffCID) DO UPDATE SET Ordering = ?3, Timestamp = ?4, Favour = ?5, Note = ?6; )";
+
+        {
+            spacetime::Moment ingestTimer;
+
+            {
+                BenchDB::TransactionGuard txn;
+                for ( std::size_t jamI = 0; jamI < jamCount; jamI++ )
+                {
+                    const std::string jamName = fmt::format( FMTX( "{} {} {}" ), cWords[rng() % cWords.size()], cWords[rng() % cWords.size()], jamI );
+                    BenchDB::query<_sqlInsertJam>( makeJamCID( jamI ), jamName );
+                }
+            }
+
+            static constexpr std::size_t cRiffsPerTransaction = 10000;
+            for ( std::size_t riffBase = 0; riffBase < riffCount; riffBase += cRiffsPerTransaction )
+            {
+                BenchDB::TransactionGuard txn;
+
+                const std::size_t riffEnd = std::min( riffCount, riffBase + cRiffsPerTransaction );
+                for ( std::size_t riffI = riffBase; riffI < riffEnd; riffI++ )
+                {
+                    const std::string riffCID  = makeRiffCID( riffI );
+                    const std::string userName = fmt::format( FMTX( "{}_{}" ), cWords[( riffI * 7 ) % cWords.size()], ( rng() % userCount ) );
+                    const float       bpm      = (float)( 60 + ( rng() % 120 ) );
+
+                    BenchDB::query<_sqlInsertRiff>( riffCID, makeJamCID( riffI % jamCount ) );
+                    BenchDB::query<_sqlFillRiff>(
+                        riffCID,
+                        (int64_t)( 1500000000 + ( riffI * 30 ) ),
+                        (int32_t)( rng() % 12 ),
+                        (int32_t)( rng() % 18 ),
+                        bpm / 60.0f,
+                        bpm,
+                        userName );
+                }
+            }
+
+            result.m_ingestMs = (double)ingestTimer.delta< std::chrono::microseconds >().count() / 1000.0;
+        }
+
+        {
+            static constexpr std::size_t cTagUpdates = 1000;
+
+            spacetime::Moment tagTimer;
+            for ( std::size_t tagI = 0; tagI < cTagUpdates; tagI++ )
+            {
+                const std::size_t riffI = rng() % riffCount;
+                const std::string note  = fmt::format( FMTX( "{} {} bit" ), cWords[rng() % cWords.size()], cWords[rng() % cWords.size()] );
+
+                BenchDB::query<_sqlUpsertTag>( makeJamCID( riffI % jamCount ), makeRiffCID( riffI ), (int32_t)tagI, (int64_t)tagI, 0, note );
+            }
+            result.m_tagUpdateMs = (double)tagTimer.delta< std::chrono::microseconds >().count() / 1000.0 / (double)cTagUpdates;
+        }
+
+        static constexpr std::size_t cQueries = 50;
+        {
+            spacetime::Moment textTimer;
+            for ( std::size_t queryI = 0; queryI < cQueries; queryI++ )
+            {
+                SearchQuery query;
+                query.m_text        = cWords[queryI % cWords.size()];
+                query.m_textScope   = (SearchQuery::TextScope)( queryI % 4 );
+                query.m_bpmMinimum  = 90.0f;
+                query.m_bpmMaximum  = 130.0f;
+                query.m_pageSize    = 100;
+
+                SearchResult searchResult;
+                sql::search::execute<BenchDB>( query, searchResult );
+                result.m_lastTextMatches = searchResult.m_totalMatches;
+                result.m_textHits       += searchResult.m_riffIDs.size();
+            }
+            result.m_textQueryMs = (double)textTimer.delta< std::chrono::microseconds >().count() / 1000.0 / (double)cQueries;
+        }
+        {
+            spacetime::Moment rangeTimer;
+            for ( std::size_t queryI = 0; queryI < cQueries; queryI++ )
+            {
+                SearchQuery query;
+                if ( ( queryI & 1 ) == 0 )
+                    query.m_jamCID  = types::JamCouchID{ makeJamCID( queryI % jamCount ) };
+                query.m_root        = (int32_t)( queryI % 12 );
+                query.m_timeBegin   = 1500000000 + ( (int64_t)queryI * (int64_t)riffCount / (int64_t)cQueries ) * 30;
+                query.m_pageSize    = 100;
+
+                SearchResult searchResult;
+                sql::search::execute<BenchDB>( query, searchResult );
+                result.m_rangeHits += searchResult.m_riffIDs.size();
+            }
+            result.m_rangeQueryMs = (double)rangeTimer.delta< std::chrono::microseconds >().count() / 1000.0 / (double)cQueries;
+        }
+    });
+
+    return result;
+}
+
+
+// ---------------------------------------------------------------------------------------------------------------------
+Warehouse::IngestBenchmark Warehouse::benchmarkIngest( const fs::path& scratchPath, const std::size_t riffCount )
+{
+    IngestBenchmark result;
+    result.m_riffCount = riffCount;
+
+    // synthetic jam contents; fixed seed so runs are comparable, around 5000 riffs per jam with 5 of 8 stems in use
+    std::vector< types::Riff > riffs( riffCount );
+    {
+        std::mt19937 rng( 0x1A6E5700 );
+
+        const std::size_t jamCount = std::max< std::size_t >( 1, riffCount / 5000 );
+        for ( std::size_t riffI = 0; riffI < riffCount; riffI++ )
+        {
+            auto& riff = riffs[riffI];
+
+            riff.couchID          = types::RiffCouchID{ fmt::format( FMTX( "{:032x}" ), riffI * 0x9E3779B1ull ) };
+            riff.jamCouchID       = types::JamCouchID{ fmt::format( FMTX( "band{:08x}" ), riffI % jamCount ) };
+            riff.user             = fmt::format( FMTX( "user_{}" ), rng() % 200 );
+            riff.creationTimeUnix = 1500000000 + ( riffI * 30 );
+            riff.root             = rng() % 12;
+            riff.scale            = rng() % 18;
+            riff.BPMrnd           = (float)( 60 + ( rng() % 120 ) );
+            riff.BPS              = riff.BPMrnd / 60.0f;
+            riff.barLength        = 4;
+            riff.appVersion       = 3;
+            riff.magnitude        = 0.5f;
+
+            for ( std::size_t stemI = 0; stemI < 8; stemI++ )
+            {
+                riff.stemsOn[stemI] = ( ( rng() % 8 ) < 5 );
+                riff.stems[stemI]   = riff.stemsOn[stemI] ? types::StemCouchID{ fmt::format( FMTX( "{:016x}{:016x}" ), rng(), ( riffI << 3 ) | stemI ) } : types::StemCouchID{ "" };
+                riff.gains[stemI]   = 1.0f;
+            }
+        }
+    }
+
+    // backfill commits riff data in transactions of this size, so time it the same way
+    static constexpr std::size_t cRiffsPerTransaction = Backfill::cBatchSize * Backfill::cMaxBatchesPerTransaction;
+
+    const auto rowsPerSecond = []( const std::size_t rows, spacetime::Moment& timer )
+    {
+        const auto elapsedUs = std::max< int64_t >( 1, timer.delta< std::chrono::microseconds >().count() );
+        return (double)rows * 1000000.0 / (double)elapsedUs;
+    };
+
+    static constexpr char _sqlCountFilledRiffs[] = R"(
+        select count(*) from riffs where CreationTime is not null; )";
+
+    // each pass gets a fresh scratch file with the full schema, indices and triggers
+    const auto runPass = [&]( const bool bulk, double& skeletonsPerSec, double& riffsPerSec )
+    {
+        return runBenchmarkOnScratchDatabase( gIngestBenchmarkDatabaseFile, scratchPath / "ouro.warehouse.ingest.benchmark.db3", [&]()
+        {
+            using BenchDB = IngestBenchmarkDB;
+
+            BenchDB::query<sql::jams::createTable>();
+            BenchDB::query<sql::riffs::createTable>();
+            BenchDB::query<sql::riffs::createIndex_0>();
+            BenchDB::query<sql::riffs::createIndex_1>();
+            BenchDB::query<sql::riffs::createIndex_2>();
+            BenchDB::query<sql::riffs::createIndex_3>();
+            BenchDB::query<sql::riffs::createIndex_4>();
+            BenchDB::query<sql::riffs::createIndex_5>();
+            BenchDB::query<sql::riffs::createIndex_6>();
+            BenchDB::query<sql::tags::createTable>();
+            BenchDB::query<sql::stems::createTable>();
+            BenchDB::query<sql::stems::createIndex_0>();
+            BenchDB::query<sql::stems::createIndex_1>();
+            BenchDB::query<sql::stems::createIndex_2>();
+            BenchDB::query<sql::stems::createIndex_3>();
+            BenchDB::query<sql::stems::createIndex_4>();
+            BenchDB::query<sql::stems::createIndex_5>();
+            BenchDB::query<sql::stems::createIndex_6>();
+            BenchDB::query<sql::stems::createIndex_7>();
+            BenchDB::query<sql::statistics::createTable>();
+            BenchDB::query<sql::statistics::createTrigger_0>();
+            BenchDB::query<sql::statistics::createTrigger_1>();
+            BenchDB::query<sql::statistics::createTrigger_2>();
+            BenchDB::query<sql::statistics::createTrigger_3>();
+            BenchDB::query<sql::statistics::createTrigger_4>();
+            BenchDB::query<sql::statistics::createTrigger_5>();
+            sql::search::runInit<BenchDB>();
+
+            // the statements the warehouse used before the staged ingest
+            static constexpr char _sqlInsertRiffSkeleton[] = R"(
+                INSERT OR IGNORE INTO riffs( riffCID, OwnerJamCID ) VALUES( ?1, ?2 ); )";
+            static constexpr char _sqlInsertStemSkeleton[] = R"(
+                INSERT OR IGNORE INTO stems( stemCID, OwnerJamCID ) VALUES( ?1, ?2 ); )";
+            static constexpr char _sqlUpdateRiff[] = R"(
+                UPDATE riffs SET CreationTime=?2, Root=?3, Scale=?4, BPS=?5, BPMrnd=?6, BarLength=?7, AppVersion=?8, Magnitude=?9, UserName=?10,
+                    StemCID_1=?11, StemCID_2=?12, StemCID_3=?13, StemCID_4=?14, StemCID_5=?15, StemCID_6=?16, StemCID_7=?17, StemCID_8=?18, GainsJSON=?19
+                    WHERE riffCID=?1 )";
+
+            {
+                spacetime::Moment skeletonTimer;
+                {
+                    BenchDB::TransactionGuard txn;
+                    if ( bulk )
+                    {
+                        sql::ingest::beginStaging<BenchDB>();
+                        for ( const auto& riff : riffs )
+                            sql::ingest::stageRiffSkeleton<BenchDB>( riff.couchID, riff.jamCouchID );
+                        sql::ingest::mergeStagedSkeletons<BenchDB>();
+                    }
+                    else
+                    {
+                        for ( const auto& riff : riffs )
+                            BenchDB::query<_sqlInsertRiffSkeleton>( riff.couchID.value(), riff.jamCouchID.value() );
+                    }
+                }
+                skeletonsPerSec = rowsPerSecond( riffs.size(), skeletonTimer );
+            }
+            {
+                spacetime::Moment riffTimer;
+                for ( std::size_t riffBase = 0; riffBase < riffs.size(); riffBase += cRiffsPerTransaction )
+                {
+                    const std::size_t riffEnd = std::min( riffs.size(), riffBase + cRiffsPerTransaction );
+
+                    BenchDB::TransactionGuard txn;
+                    if ( bulk )
+                    {
+                        sql::ingest::beginStaging<BenchDB>();
+                        for ( std::size_t riffI = riffBase; riffI < riffEnd; riffI++ )
+                            sql::ingest::stageRiffDetails<BenchDB>( riffs[riffI] );
+                        sql::ingest::mergeStagedRiffs<BenchDB>();
+                    }
+                    else
+                    {
+                        for ( std::size_t riffI = riffBase; riffI < riffEnd; riffI++ )
+                        {
+                            const auto& riff = riffs[riffI];
+                            for ( const auto& stemCID : riff.stems )
+                            {
+                                if ( !stemCID.empty() )
+                                    BenchDB::query<_sqlInsertStemSkeleton>( stemCID.value(), riff.jamCouchID.value() );
+                            }
+
+                            const auto gainsJson = fmt::format( R"([ {} ])", fmt::join( riff.gains, ", " ) );
+                            BenchDB::query<_sqlUpdateRiff>(
+                                riff.couchID.value(),
+                                riff.creationTimeUnix,
+                                riff.root,
+                                riff.scale,
+                                riff.BPS,
+                                riff.BPMrnd,
+                                riff.barLength,
+                                riff.appVersion,
+                                riff.magnitude,
+                                riff.user,
+                                riff.stems[0].value(),
+                                riff.stems[1].value(),
+                                riff.stems[2].value(),
+                                riff.stems[3].value(),
+                                riff.stems[4].value(),
+                                riff.stems[5].value(),
+                                riff.stems[6].value(),
+                                riff.stems[7].value(),
+                                gainsJson );
+                        }
+                    }
+                }
+                riffsPerSec = rowsPerSecond( riffs.size(), riffTimer );
+            }
+
+            // check the staged merge actually landed everything, a quick run means nothing if it didn't
+            if ( bulk )
+            {
+                int64_t filledRiffs = 0;
+                {
+                    auto query = BenchDB::query<_sqlCountFilledRiffs>();
+                    query( filledRiffs );
+                }
+                result.m_bulkRiffsMerged = (std::size_t)filledRiffs;
+            }
+        });
+    };
+
+    result.m_error = runPass( false, result.m_rowSkeletonsPerSec, result.m_rowRiffsPerSec );
+    if ( result.m_error.empty() )
+        result.m_error = runPass( true, result.m_bulkSkeletonsPerSec, result.m_bulkRiffsPerSec );
+
+    return result;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void Warehouse::workerTogglePause()
 {
     m_workerThreadPaused = !m_workerThreadPaused;
 
@@ -1441,6 +2512,8 @@ void Warehouse::threadWorker()
 
     bool scrapingIsRunning = false;
 
+    absl::flat_hash_set< types::JamCouchID > backfillChangedJams;
+
     while ( m_workerThreadAlive )
     {
         // #HDD refactor how this thread works;
@@ -1448,7 +2521,12 @@ void Warehouse::threadWorker()
         //      by virtue of what tasks are running rather than a generic top-level wait
         //      (as this also interferes with local requests like generating jam-slices)
         //
-        std::this_thread::sleep_for( std::chrono::milliseconds( rng.genInt32(250, 700) ) );
+        // while the backfill has batches in flight we only nap briefly, so results get written and new fetches
+        // launched as soon as possible rather than the pipeline draining between cycles
+        if ( m_backfill->isActive() && !m_workerThreadPaused )
+            std::this_thread::sleep_for( std::chrono::milliseconds( 20 ) );
+        else
+            std::this_thread::sleep_for( std::chrono::milliseconds( rng.genInt32(250, 700) ) );
 
         checkLockAndInstallNewCallbacks();
 
@@ -1458,6 +2536,33 @@ void Warehouse::threadWorker()
             continue;
         }
 
+        // backfill write stage; commit anything the fetchers have finished with
+        {
+            bool backfillShouldHalt = false;
+
+            backfillChangedJams.clear();
+            m_backfill->commitCompleted( backfillChangedJams, backfillShouldHalt );
+
+            for ( const auto& jamCID : backfillChangedJams )
+                incrementChangeIndexForJam( jamCID );
+            if ( !backfillChangedJams.empty() )
+                tryEnqueueReport( false );
+
+            if ( backfillShouldHalt )
+            {
+                if ( m_cbWorkUpdate )
+                    m_cbWorkUpdate( false, "Paused due to repeated network errors" );
+
+                m_eventBusClient.Send<::events::AddToastNotification>(
+                    ::events::AddToastNotification::Type::Error,
+                    "Warehouse Update Halted",
+                    fmt::format( FMTX( "{} backfill batches failed in a row" ), Backfill::cFailuresBeforePause ) );
+
+                m_workerThreadPaused = true;
+                continue;
+            }
+        }
+
         // something to do?
         Task nextTask;
         if ( m_taskSchedule->m_taskQueue.try_dequeue( nextTask ) )
@@ -1492,82 +2597,32 @@ void Warehouse::threadWorker()
         // go looking for holes to fill
         else
         {
-            const bool hasEndlesssNetwork = hasFullEndlesssNetworkAccess();
-
-            // fill in empty stems
-            if ( hasEndlesssNetwork )
+            // backfill plan stage; top up the fetchers to capacity, stems first as before, then riffs
+            if ( hasFullEndlesssNetworkAccess() )
             {
-                base::instr::ScopedEvent se( "FILL", "Stems", base::instr::PresetColour::Orange );
-
-                types::JamCouchID owningJamCID;
-                types::StemCouchID emptyStemCID;
-                if ( sql::stems::findUnpopulated( owningJamCID, emptyStemCID ) )
+                while ( m_backfill->hasCapacity() )
                 {
-                    if ( m_cbWorkUpdate )
-                        m_cbWorkUpdate( true, "Finding unpopulated stems..." );
-
-                    // how about some stems?
-                    std::vector<types::StemCouchID> emptyStems;
-                    if ( sql::stems::findUnpopulatedBatch( owningJamCID, 40, emptyStems ) )
-                    {
-                        incrementChangeIndexForJam( owningJamCID );
-
-                        // stem me up
-                        m_taskSchedule->m_taskQueue.enqueue( std::make_unique<GetStemData>( *m_networkConfiguration, owningJamCID, emptyStems ) );
-                        tryEnqueueReport( false );
-
-                        scrapingIsRunning = true;
-                        continue;
-                    }
-                    else
-                    {
-                        blog::error::database( FMTX( "stems::findUnpopulatedBatch() failed" ) );
-                    }
+                    if ( !m_backfill->planStems( m_networkConfiguration ) &&
+                         !m_backfill->planRiffs( m_networkConfiguration, m_eventBusClient ) )
+                        break;
                 }
             }
-            // scour for empty riffs
-            if ( hasEndlesssNetwork )
-            {
-                base::instr::ScopedEvent se( "FILL", "Riffs", base::instr::PresetColour::Red );
 
-                types::JamCouchID owningJamCID;
-                types::RiffCouchID emptyRiffCID;
-                if ( sql::riffs::findUnpopulated( owningJamCID, emptyRiffCID ) )
-                {
-                    if ( m_cbWorkUpdate )
-                        m_cbWorkUpdate( true, "Finding unpopulated riffs..." );
-
-                    // can we find some juicy new riffs?
-                    std::vector<types::RiffCouchID> emptyRiffs;
-                    if ( sql::riffs::findUnpopulatedBatch( owningJamCID, 40, emptyRiffs ) )
-                    {
-                        incrementChangeIndexForJam( owningJamCID );
-
-                        // off to riff town
-                        m_taskSchedule->m_taskQueue.enqueue( std::make_unique<GetRiffDataTask>( *m_networkConfiguration, owningJamCID, emptyRiffs ) );
-                        tryEnqueueReport( false );
-
-                        scrapingIsRunning = true;
-                        continue;
-                    }
-                    else
-                    {
-                        const std::string errorReport = fmt::format( FMTX( "we found one empty riff ({}, in jam {}) but failed during batch?" ), emptyRiffCID, owningJamCID );
-                        blog::error::database( FMTX("Riff Sync Error : {}"), errorReport );
+            if ( m_backfill->isActive() )
+            {
+                const std::string backfillStatus = m_backfill->updateReport();
+                if ( m_cbWorkUpdate )
+                    m_cbWorkUpdate( true, backfillStatus );
 
-                        m_eventBusClient.Send<::events::AddToastNotification>(
-                            ::events::AddToastNotification::Type::Error,
-                            "Warehouse Riff Sync Error",
-                            errorReport );
-                    }
-                }
+                scrapingIsRunning = true;
+                continue;
             }
 
-
             // if we were running scraping tasks and we just finished, kick off a final report generation
             if ( scrapingIsRunning )
             {
                 scrapingIsRunning = false;
+                m_backfill->updateReport();
                 tryEnqueueReport( true );
             }
 
@@ -1642,20 +2697,18 @@ bool JamSnapshotTask::Work( TaskQueue& currentTasks )
     const auto countBeforeTx = sql::riffs::countRiffsInJam( m_jamCID );
 
     // the snapshot is only for getting the root couch IDs for all riffs in a jam; further details
-    // are then plucked one-by-one as we fill the warehouse. newly discovered riffs will INSERT, previously
-    // touched ones are ignored
-    static constexpr char insertOrIgnoreNewRiffSkeleton[] = R"(
-        INSERT OR IGNORE INTO riffs( riffCID, OwnerJamCID ) VALUES( ?1, ?2 );
-    )";
-
+    // are then plucked in batches as we fill the warehouse. newly discovered riffs are added, previously
+    // touched ones are ignored; staged first so a big jam lands in the Riffs table in one sorted merge
     {
         // bundle into single transaction
         Warehouse::SqlDB::TransactionGuard txn;
+
+        sql::ingest::beginStaging<Warehouse::SqlDB>();
         for ( const auto& jamData : jamSnapshot.rows )
         {
-            const auto& riffCID = jamData.id;
-            Warehouse::SqlDB::query<insertOrIgnoreNewRiffSkeleton>( riffCID.value(), m_jamCID.value() );
+            sql::ingest::stageRiffSkeleton<Warehouse::SqlDB>( jamData.id, m_jamCID );
         }
+        sql::ingest::mergeStagedSkeletons<Warehouse::SqlDB>();
     }
 
     const auto countAfterTx = sql::riffs::countRiffsInJam( m_jamCID );
@@ -1688,6 +2741,7 @@ bool JamPurgeTask::Work( TaskQueue& currentTasks )
         Warehouse::SqlDB::query<deleteJam>( m_jamCID.value() );
         Warehouse::SqlDB::query<deleteRiffs>( m_jamCID.value() );
         Warehouse::SqlDB::query<deleteStems>( m_jamCID.value() );
+        sql::statistics::remove( m_jamCID );
     }
 
     blog::database( "[{}] wiped [{}] from Db", Tag, m_jamCID.value() );
@@ -1840,26 +2894,148 @@ bool JamExportTask::Work( TaskQueue& currentTasks )
 }
 
 // ---------------------------------------------------------------------------------------------------------------------
-bool GetRiffDataTask::Work( TaskQueue& currentTasks )
+bool Warehouse::Backfill::planStems( const api::NetConfiguration::Shared& netConfig )
 {
-    blog::database( "[{}] collecting riff data ..", Tag );
+    base::instr::ScopedEvent se( "FILL", "Stems", base::instr::PresetColour::Orange );
 
-    // grab all the riff data
-    endlesss::api::RiffDetails riffDetails;
-    if ( !riffDetails.fetchBatch( m_netConfig, m_jamCID, m_riffCIDs ) )
+    types::JamCouchID owningJamCID;
+    types::StemCouchID emptyStemCID;
+    if ( !sql::stems::findUnpopulated( owningJamCID, emptyStemCID ) )
+        return false;
+
+    // ask for enough rows that we still get a full batch once anything already in flight is skipped over
+    std::vector<types::StemCouchID> emptyStems;
+    if ( !sql::stems::findUnpopulatedBatch( owningJamCID, cBatchSize + (int32_t)m_stemsInFlight.size(), emptyStems ) )
+    {
+        blog::error::database( FMTX( "stems::findUnpopulatedBatch() failed" ) );
+        return false;
+    }
+
+    auto batch = std::make_shared<Batch>();
+    batch->m_jamCID = owningJamCID;
+    for ( const auto& stemCID : emptyStems )
+    {
+        if ( m_stemsInFlight.contains( stemCID ) )
+            continue;
+
+        batch->m_stemCIDs.emplace_back( stemCID );
+        if ( batch->m_stemCIDs.size() >= cBatchSize )
+            break;
+    }
+
+    // everything outstanding in this jam is already on its way
+    if ( batch->m_stemCIDs.empty() )
+        return false;
+
+    for ( const auto& stemCID : batch->m_stemCIDs )
+        m_stemsInFlight.emplace( stemCID );
+
+    launch( netConfig, batch );
+    return true;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+bool Warehouse::Backfill::planRiffs( const api::NetConfiguration::Shared& netConfig, base::EventBusClient& eventBus )
+{
+    base::instr::ScopedEvent se( "FILL", "Riffs", base::instr::PresetColour::Red );
+
+    types::JamCouchID owningJamCID;
+    types::RiffCouchID emptyRiffCID;
+    if ( !sql::riffs::findUnpopulated( owningJamCID, emptyRiffCID ) )
+        return false;
+
+    std::vector<types::RiffCouchID> emptyRiffs;
+    if ( !sql::riffs::findUnpopulatedBatch( owningJamCID, cBatchSize + (int32_t)m_riffsInFlight.size(), emptyRiffs ) )
+    {
+        const std::string errorReport = fmt::format( FMTX( "we found one empty riff ({}, in jam {}) but failed during batch?" ), emptyRiffCID, owningJamCID );
+        blog::error::database( FMTX("Riff Sync Error : {}"), errorReport );
+
+        eventBus.Send<::events::AddToastNotification>(
+            ::events::AddToastNotification::Type::Error,
+            "Warehouse Riff Sync Error",
+            errorReport );
+
+        return false;
+    }
+
+    auto batch = std::make_shared<Batch>();
+    batch->m_jamCID = owningJamCID;
+    for ( const auto& riffCID : emptyRiffs )
     {
-        blog::error::database( "[{}] Failed to fetch riff details from jam [{}]", Tag, m_jamCID );
+        if ( m_riffsInFlight.contains( riffCID ) )
+            continue;
+
+        batch->m_riffCIDs.emplace_back( riffCID );
+        if ( batch->m_riffCIDs.size() >= cBatchSize )
+            break;
+    }
+
+    if ( batch->m_riffCIDs.empty() )
         return false;
+
+    for ( const auto& riffCID : batch->m_riffCIDs )
+        m_riffsInFlight.emplace( riffCID );
+
+    launch( netConfig, batch );
+    return true;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void Warehouse::Backfill::launch( const api::NetConfiguration::Shared& netConfig, const BatchPtr& batch )
+{
+    if ( m_batchesInFlight == 0 )
+    {
+        m_runStarted.setToNow();
+        m_runRowsWritten        = 0;
+        m_runBatchesAttempted   = 0;
+        m_runBatchesFailed      = 0;
+    }
+    m_batchesInFlight++;
+
+    m_fetchExecutor.silent_async( [this, netConfig, batch]()
+    {
+        if ( batch->isStems() )
+            fetchStems( *netConfig, *batch );
+        else
+            fetchRiffs( *netConfig, *batch );
+
+        m_completed.enqueue( batch );
+    });
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void Warehouse::Backfill::fetchStems( const api::NetConfiguration& ncfg, Batch& batch )
+{
+    blog::database( "[BACKFILL] collecting {} stem details ..", batch.m_stemCIDs.size() );
+
+    if ( !batch.m_stemDetails.fetchBatch( ncfg, batch.m_jamCID, batch.m_stemCIDs ) )
+    {
+        blog::error::database( "[BACKFILL] Failed to fetch stem details from jam [{}]", batch.m_jamCID );
+        return;
+    }
+    batch.m_fetched = true;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void Warehouse::Backfill::fetchRiffs( const api::NetConfiguration& ncfg, Batch& batch )
+{
+    blog::database( "[BACKFILL] collecting {} riff details ..", batch.m_riffCIDs.size() );
+
+    // grab all the riff data
+    if ( !batch.m_riffDetails.fetchBatch( ncfg, batch.m_jamCID, batch.m_riffCIDs ) )
+    {
+        blog::error::database( "[BACKFILL] Failed to fetch riff details from jam [{}]", batch.m_jamCID );
+        return;
     }
 
     // produce unique list of stem couch IDs from this batch of riffs; we can then mass-fetch the data to ensure its valid
     std::vector< endlesss::types::StemCouchID > stemsToValidate;
     StemSet uniqueStemCIDs;
-    uniqueStemCIDs.reserve( riffDetails.rows.size() * 8 );
-    stemsToValidate.reserve( riffDetails.rows.size() * 8 );
-    for ( const auto& netRiffData : riffDetails.rows )
+    uniqueStemCIDs.reserve( batch.m_riffDetails.rows.size() * 8 );
+    stemsToValidate.reserve( batch.m_riffDetails.rows.size() * 8 );
+    for ( const auto& netRiffData : batch.m_riffDetails.rows )
     {
-        types::Riff riffData{ m_jamCID, netRiffData.doc };
+        types::Riff riffData{ batch.m_jamCID, netRiffData.doc };
         for ( auto stemI = 0; stemI < 8; stemI++ )
         {
             const auto& stemCID = riffData.stems[stemI];
@@ -1873,31 +3049,32 @@ bool GetRiffDataTask::Work( TaskQueue& currentTasks )
             }
         }
     }
-    blog::database( "[{}] validating {} stems ..", Tag, stemsToValidate.size() );
+    blog::database( "[BACKFILL] validating {} stems ..", stemsToValidate.size() );
 
     // collect the type data for all the stems; there is a strange situation where some stem IDs turn out to
     // be .. chat messages? so we need to remove those early on
     endlesss::api::StemTypeCheck stemValidation;
-    if ( !stemValidation.fetchBatch( m_netConfig, m_jamCID, stemsToValidate ) )
+    if ( !stemValidation.fetchBatch( ncfg, batch.m_jamCID, stemsToValidate ) )
     {
-        blog::error::database( "[{}] Failed to validate stem details [{}]", Tag );
-        return false;
+        blog::error::database( "[BACKFILL] Failed to validate stem details from jam [{}]", batch.m_jamCID );
+        return;
     }
-    // re-use the hash set, add in any stems that are found to be problematic
-    uniqueStemCIDs.clear();
+
+    // gather any stems that are found to be problematic; the ledger notes are written out with the riffs
+    const auto rejectStem = [&batch]( const types::StemCouchID& stemCID, const sql::ledger::StemLedgerType type, std::string&& note )
+    {
+        batch.m_invalidStems.emplace( stemCID );
+        batch.m_ledgerNotes.emplace_back( LedgerNote{ stemCID, type, std::move( note ) } );
+    };
+
     for ( const auto& stemCheck : stemValidation.rows )
     {
         // missing key entirely, presumably moderated away
         if ( !stemCheck.error.empty() )
         {
-            uniqueStemCIDs.emplace( stemCheck.key );
-            blog::database( "[{}] Found stem with a retreival error ({}), ignoring ID [{}]", Tag, stemCheck.error, stemCheck.key );
-
-            sql::ledger::storeStemNote(
-                stemCheck.key,
-                sql::ledger::StemLedgerType::REMOVED_ID,
-                fmt::format( "[{}]", stemCheck.error ) );
+            blog::database( "[BACKFILL] Found stem with a retreival error ({}), ignoring ID [{}]", stemCheck.error, stemCheck.key );
 
+            rejectStem( stemCheck.key, sql::ledger::StemLedgerType::REMOVED_ID, fmt::format( "[{}]", stemCheck.error ) );
             continue;
         }
 
@@ -1911,154 +3088,47 @@ bool GetRiffDataTask::Work( TaskQueue& currentTasks )
         // stem is lacking app versioning (and isn't just old)
         if ( ignoreForMissingAppData )
         {
-            uniqueStemCIDs.emplace( stemCheck.key );
-            blog::database( "[{}] Found stem without app version ({}), ignoring ID [{}]", Tag, stemCheck.doc._attachments.oggAudio.digest, stemCheck.key );
-
-            sql::ledger::storeStemNote(
-                stemCheck.key,
-                sql::ledger::StemLedgerType::REMOVED_ID,
-                fmt::format( "[{}]", stemCheck.error ) );
+            blog::database( "[BACKFILL] Found stem without app version ({}), ignoring ID [{}]", stemCheck.doc._attachments.oggAudio.digest, stemCheck.key );
 
+            rejectStem( stemCheck.key, sql::ledger::StemLedgerType::REMOVED_ID, fmt::format( "[{}]", stemCheck.error ) );
             continue;
         }
         // stem was destroyed?
         if ( stemCheck.value.deleted )
         {
-            uniqueStemCIDs.emplace( stemCheck.key );
-            blog::database( "[{}] Found stem that was deleted ({}), ignoring ID [{}]", Tag, stemCheck.error, stemCheck.key );
-
-            sql::ledger::storeStemNote(
-                stemCheck.key,
-                sql::ledger::StemLedgerType::REMOVED_ID,
-                fmt::format( "[{}]", stemCheck.error ) );
+            blog::database( "[BACKFILL] Found stem that was deleted ({}), ignoring ID [{}]", stemCheck.error, stemCheck.key );
 
+            rejectStem( stemCheck.key, sql::ledger::StemLedgerType::REMOVED_ID, fmt::format( "[{}]", stemCheck.error ) );
             continue;
         }
 
         // this isn't a stem? 
         if ( stemCheck.doc.type != "Loop" )
         {
-            uniqueStemCIDs.emplace( stemCheck.doc._id );
-            blog::database( "[{}] Found stem that isn't a stem ({}), ignoring ID [{}]", Tag, stemCheck.doc.type, stemCheck.doc._id );
+            blog::database( "[BACKFILL] Found stem that isn't a stem ({}), ignoring ID [{}]", stemCheck.doc.type, stemCheck.doc._id );
 
-            sql::ledger::storeStemNote(
-                stemCheck.doc._id,
-                sql::ledger::StemLedgerType::DAMAGED_REFERENCE,
+            rejectStem( types::StemCouchID{ stemCheck.doc._id }, sql::ledger::StemLedgerType::DAMAGED_REFERENCE,
                 fmt::format( "[Ver:{}] Wrong type [{}]", stemCheck.doc.app_version, stemCheck.doc.type ) );
-
             continue;
         }
         // this stem was damaged and has no audio data
         if ( stemCheck.doc.cdn_attachments.oggAudio.endpoint.empty() &&
              stemCheck.doc.cdn_attachments.flacAudio.endpoint.empty() )
         {
-            uniqueStemCIDs.emplace( stemCheck.doc._id );
-            blog::database( "[{}] Found stem that is damaged, ignoring ID [{}]", Tag, stemCheck.doc._id );
+            blog::database( "[BACKFILL] Found stem that is damaged, ignoring ID [{}]", stemCheck.doc._id );
 
-            sql::ledger::storeStemNote(
-                stemCheck.doc._id,
-                sql::ledger::StemLedgerType::MISSING_OGG,   // previously this only happened with OGG sources.. potentially we could have missing FLAC here too
+            rejectStem( types::StemCouchID{ stemCheck.doc._id }, sql::ledger::StemLedgerType::MISSING_OGG,   // previously this only happened with OGG sources.. potentially we could have missing FLAC here too
                 fmt::format( "[Ver:{}]", stemCheck.doc.app_version ) );
-
             continue;
         }
     }
 
-
-    static constexpr char updateRiffDetails[] = R"(
-        UPDATE riffs SET CreationTime=?2,
-                         Root=?3,
-                         Scale=?4,
-                         BPS=?5,
-                         BPMrnd=?6,
-                         BarLength=?7,
-                         AppVersion=?8,
-                         Magnitude=?9,
-                         UserName=?10,
-                         StemCID_1=?11,
-                         StemCID_2=?12,
-                         StemCID_3=?13,
-                         StemCID_4=?14,
-                         StemCID_5=?15,
-                         StemCID_6=?16,
-                         StemCID_7=?17,
-                         StemCID_8=?18,
-                         GainsJSON=?19
-                         WHERE riffCID=?1
-    )";
-    static constexpr char insertOrIgnoreNewStemSkeleton[] = R"(
-        INSERT OR IGNORE INTO stems( stemCID, OwnerJamCID ) VALUES( ?1, ?2 );
-    )";
-
-    blog::database( "[{}] inserting {} rows of riff detail", Tag, riffDetails.rows.size() );
-
-    Warehouse::SqlDB::TransactionGuard txn;
-    for ( const auto& netRiffData : riffDetails.rows )
-    {
-        types::Riff riffData{ m_jamCID, netRiffData.doc };
-
-        for ( auto stemI = 0; stemI < 8; stemI++ )
-        {
-            const auto& stemCID = riffData.stems[stemI];
-            if ( stemCID.empty() )
-                continue;
-
-            // check if this stem is meant to be ignored from the validation phase earlier
-            auto stemIter = uniqueStemCIDs.find( stemCID );
-            if ( stemIter != uniqueStemCIDs.end() )
-            {
-                blog::database( "[{}] Removing stem {} from [{}] as it was marked as invalid", Tag, stemI, riffData.couchID );
-
-                riffData.stemsOn[stemI] = false;
-                riffData.stems[stemI] = endlesss::types::StemCouchID{ "" };
-            }
-            else
-            {
-                // as we walk the stems, poke the couch ID into the stems table if it doesn't already exist
-                // so that any new ones will be found and filled in later
-                Warehouse::SqlDB::query<insertOrIgnoreNewStemSkeleton>( stemCID.value(), m_jamCID.value() );
-            }
-        }
-
-        auto gainsJson = fmt::format( R"([ {} ])", fmt::join( riffData.gains, ", " ) );
-
-        Warehouse::SqlDB::query<updateRiffDetails>(
-            riffData.couchID.value(),
-            riffData.creationTimeUnix,
-            riffData.root,
-            riffData.scale,
-            riffData.BPS,
-            riffData.BPMrnd,
-            riffData.barLength,
-            riffData.appVersion,
-            riffData.magnitude,
-            riffData.user,
-            riffData.stems[0].value(),
-            riffData.stems[1].value(),
-            riffData.stems[2].value(),
-            riffData.stems[3].value(),
-            riffData.stems[4].value(),
-            riffData.stems[5].value(),
-            riffData.stems[6].value(),
-            riffData.stems[7].value(),
-            gainsJson
-            );
-    }
-    return true;
+    batch.m_fetched = true;
 }
 
 // ---------------------------------------------------------------------------------------------------------------------
-bool GetStemData::Work( TaskQueue& currentTasks )
+void Warehouse::Backfill::commitStems( const Batch& batch )
 {
-    blog::database( "[{}] collecting stem data ..", Tag );
-
-    endlesss::api::StemDetails stemDetails;
-    if ( !stemDetails.fetchBatch( m_netConfig, m_jamCID, m_stemCIDs ) )
-    {
-        blog::error::database( "[{}] Failed to fetch stem details from jam [{}]", Tag, m_jamCID );
-        return false;
-    }
-
     static constexpr char updateStemDetails[] = R"(
         UPDATE stems SET CreationTime=?2,
                          FileEndpoint=?3,
@@ -2079,10 +3149,7 @@ bool GetStemData::Work( TaskQueue& currentTasks )
                          WHERE stemCID=?1
     )";
 
-    blog::database( "[{}] inserting {} rows of stem detail", Tag, stemDetails.rows.size() );
-
-    Warehouse::SqlDB::TransactionGuard txn;
-    for ( const auto& stemData : stemDetails.rows )
+    for ( const auto& stemData : batch.m_stemDetails.rows )
     {
         const auto unixTime = (uint32_t)(stemData.doc.created / 1000); // from unix nano
 
@@ -2118,7 +3185,157 @@ bool GetStemData::Work( TaskQueue& currentTasks )
             stemData.doc.primaryColour
             );
     }
-    return true;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void Warehouse::Backfill::commitRiffs( const Batch& batch )
+{
+    for ( const auto& ledgerNote : batch.m_ledgerNotes )
+    {
+        sql::ledger::storeStemNote( ledgerNote.m_stemCID, ledgerNote.m_type, ledgerNote.m_note );
+    }
+
+    for ( const auto& netRiffData : batch.m_riffDetails.rows )
+    {
+        types::Riff riffData{ batch.m_jamCID, netRiffData.doc };
+
+        for ( auto stemI = 0; stemI < 8; stemI++ )
+        {
+            const auto& stemCID = riffData.stems[stemI];
+            if ( stemCID.empty() )
+                continue;
+
+            // check if this stem is meant to be ignored from the validation phase earlier
+            if ( batch.m_invalidStems.contains( stemCID ) )
+            {
+                blog::database( "[BACKFILL] Removing stem {} from [{}] as it was marked as invalid", stemI, riffData.couchID );
+
+                riffData.stemsOn[stemI] = false;
+                riffData.stems[stemI] = endlesss::types::StemCouchID{ "" };
+            }
+        }
+
+        // staged rather than written; the riff rows and any new stem records they reference are merged together
+        // once every batch in this commit has been staged, see commitCompleted()
+        sql::ingest::stageRiffDetails<Warehouse::SqlDB>( riffData );
+    }
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void Warehouse::Backfill::commitCompleted( absl::flat_hash_set< types::JamCouchID >& changedJams, bool& outShouldHalt )
+{
+    std::vector< BatchPtr > completed;
+    completed.reserve( cMaxBatchesPerTransaction );
+    {
+        BatchPtr batch;
+        while ( (int32_t)completed.size() < cMaxBatchesPerTransaction && m_completed.try_dequeue( batch ) )
+            completed.emplace_back( std::move( batch ) );
+    }
+    if ( completed.empty() )
+        return;
+
+    base::instr::ScopedEvent se( "FILL", "Commit", base::instr::PresetColour::Indigo );
+
+    std::size_t rowsWritten = 0;
+    {
+        Warehouse::SqlDB::TransactionGuard txn;
+        sql::ingest::beginStaging<Warehouse::SqlDB>();
+
+        for ( const auto& batch : completed )
+        {
+            if ( !batch->m_fetched )
+                continue;
+
+            if ( batch->isStems() )
+            {
+                commitStems( *batch );
+                rowsWritten += batch->m_stemDetails.rows.size();
+            }
+            else
+            {
+                commitRiffs( *batch );
+                rowsWritten += batch->m_riffDetails.rows.size();
+            }
+        }
+
+        sql::ingest::mergeStagedRiffs<Warehouse::SqlDB>();
+    }
+    blog::database( "[BACKFILL] committed {} batches, {} rows", completed.size(), rowsWritten );
+
+    // only now that the rows are written (or abandoned) can they be picked up by the planner again
+    uint64_t stemsWritten = 0;
+    uint64_t riffsWritten = 0;
+    uint64_t batchesFailed = 0;
+    for ( const auto& batch : completed )
+    {
+        for ( const auto& stemCID : batch->m_stemCIDs )
+            m_stemsInFlight.erase( stemCID );
+        for ( const auto& riffCID : batch->m_riffCIDs )
+            m_riffsInFlight.erase( riffCID );
+
+        m_batchesInFlight--;
+        m_runBatchesAttempted++;
+
+        if ( batch->m_fetched )
+        {
+            m_consecutiveFailures = 0;
+            changedJams.emplace( batch->m_jamCID );
+
+            if ( batch->isStems() )
+                stemsWritten += batch->m_stemDetails.rows.size();
+            else
+                riffsWritten += batch->m_riffDetails.rows.size();
+        }
+        else
+        {
+            m_consecutiveFailures++;
+            m_runBatchesFailed++;
+            batchesFailed++;
+        }
+    }
+    m_runRowsWritten += rowsWritten;
+
+    outShouldHalt = ( m_consecutiveFailures >= cFailuresBeforePause );
+    if ( outShouldHalt )
+        m_consecutiveFailures = 0;
+
+    std::scoped_lock<std::mutex> reportLock( m_reportMutex );
+    m_report.m_batchesCompleted += completed.size() - batchesFailed;
+    m_report.m_batchesFailed    += batchesFailed;
+    m_report.m_stemsWritten     += stemsWritten;
+    m_report.m_riffsWritten     += riffsWritten;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+std::string Warehouse::Backfill::updateReport()
+{
+    static constexpr char _sqlSumUnpopulated[] = R"(
+        select coalesce( sum( EmptyRiffs ), 0 ), coalesce( sum( EmptyStems ), 0 ) from JamStatistics;)";
+
+    int64_t riffsRemaining = 0;
+    int64_t stemsRemaining = 0;
+    {
+        auto query = Warehouse::SqlDB::query<_sqlSumUnpopulated>();
+        query( riffsRemaining, stemsRemaining );
+    }
+
+    const double runSeconds = (double)m_runStarted.delta< std::chrono::milliseconds >().count() / 1000.0;
+
+    std::scoped_lock<std::mutex> reportLock( m_reportMutex );
+
+    m_report.m_batchesInFlight      = m_batchesInFlight;
+    m_report.m_batchesAwaitingWrite = (int32_t)m_completed.size_approx();
+    m_report.m_riffsRemaining       = riffsRemaining;
+    m_report.m_stemsRemaining       = stemsRemaining;
+    m_report.m_rowsPerSecond        = ( runSeconds > 0 ) ? (double)m_runRowsWritten / runSeconds : 0;
+    m_report.m_errorRate            = ( m_runBatchesAttempted > 0 ) ? (double)m_runBatchesFailed / (double)m_runBatchesAttempted : 0;
+
+    return fmt::format( FMTX( "Backfill : {} batches in flight, {:.0f} rows/s, {:.1f}% errors, {} riffs & {} stems remaining" ),
+        m_report.m_batchesInFlight,
+        m_report.m_rowsPerSecond,
+        m_report.m_errorRate * 100.0,
+        riffsRemaining,
+        stemsRemaining );
 }
 
 // ---------------------------------------------------------------------------------------------------------------------
@@ -2228,6 +3445,21 @@ bool JamSliceTask::Work( TaskQueue& currentTasks )
 }
 
 
+// ---------------------------------------------------------------------------------------------------------------------
+bool SearchTask::Work( TaskQueue& currentTasks )
+{
+    spacetime::ScopedTimer searchTiming( "SearchTask::Work" );
+
+    auto searchResult = std::make_unique<Warehouse::SearchResult>();
+
+    sql::search::execute<Warehouse::SqlDB>( m_query, *searchResult );
+
+    if ( m_reportCallback )
+        m_reportCallback( m_query, std::move( searchResult ) );
+
+    return true;
+}
+
 // ---------------------------------------------------------------------------------------------------------------------
 bool ContentsReportTask::Work( TaskQueue& currentTasks )
 {
@@ -2235,98 +3467,109 @@ bool ContentsReportTask::Work( TaskQueue& currentTasks )
 
     Warehouse::ContentsReport reportResult;
 
-    absl::flat_hash_set< std::string > uniqueJamIDs;
-    uniqueJamIDs.reserve( 64 );
+    // counts are maintained by triggers as riffs and stems come and go (see sql::statistics), so this is one row per jam.
+    // when brand new jams arrive they only have riff records, no stem data; we still want the name of the jam in
+    // the report early so users don't wonder why it isn't there, so emit them as 0,0,0,0 and flag them as awaiting sync
+    static constexpr char gatherStatistics[] = R"(
+        select JamCID, FilledRiffs, EmptyRiffs, FilledStems, EmptyStems from JamStatistics where FilledRiffs + EmptyRiffs > 0
+        )";
+
+    auto query = Warehouse::SqlDB::query<gatherStatistics>();
+
+    std::string_view jamCID;
+    int64_t totalPopulatedRiffs;
+    int64_t totalUnpopulatedRiffs;
+    int64_t totalPopulatedStems;
+    int64_t totalUnpopulatedStems;
 
-    // when brand new jams arrive, they don't have any stem data initially so [gatherPopulations] returns nothing
-    // as the JOIN fails; however, to ensure we get the name of the jam into the contents report early so users don't
-    // wonder why it isn't there (before enough data is synced to magic up some empty stem entries), we first grab 
-    // a plain distinct set of jam IDs from the riff table and delete from it anything that [gatherPopulations] pulls in,
-    // leaving us with a hash set of jam IDs that have no synced data yet - which we can then emit as 0,0,0,0 in the report
+    while ( query( jamCID,
+                   totalPopulatedRiffs,
+                   totalUnpopulatedRiffs,
+                   totalPopulatedStems,
+                   totalUnpopulatedStems ) )
     {
-        static constexpr char gatherUniqueJams[] = R"(
-        select distinct OwnerJamCID from Riffs
-        )";
+        const bool awaitingInitialSync = ( totalPopulatedStems + totalUnpopulatedStems ) == 0;
 
-        auto query = Warehouse::SqlDB::query<gatherUniqueJams>();
+        reportResult.m_jamCouchIDs.emplace_back( jamCID );
 
-        std::string_view jamCID;
-        while ( query( jamCID ) )
-        {
-            uniqueJamIDs.emplace( jamCID );
-        }
-    }
-    {
-        // gather unified set of empty/not-empty counts from steams and riffs in a single blast
-        static constexpr char gatherPopulations[] = R"(
-        SELECT a.OwnerJamCID, a.FilledRiffs, a.EmptyRiffs, b.FilledStems, b.EmptyStems
-            FROM 
-            (
-                SELECT Riffs.OwnerJamCID,
-                    count(case when Riffs.CreationTime is null then 1 end) as EmptyRiffs,
-                    count(case when Riffs.CreationTime is not null then 1 end) as FilledRiffs
-                FROM Riffs
-                GROUP BY Riffs.OwnerJamCID
-            ) as a
-            JOIN
-            (
-                SELECT Stems.OwnerJamCID,
-                    count(case when Stems.CreationTime is null then 1 end) as EmptyStems,
-                    count(case when Stems.CreationTime is not null then 1 end) as FilledStems
-                FROM Stems
-                GROUP BY Stems.OwnerJamCID
-            ) as b
-            ON a.OwnerJamCID = b.OwnerJamCID
-        )";
+        reportResult.m_populatedRiffs.emplace_back( awaitingInitialSync ? 0 : totalPopulatedRiffs );
+        reportResult.m_unpopulatedRiffs.emplace_back( awaitingInitialSync ? 0 : totalUnpopulatedRiffs );
 
-        auto query = Warehouse::SqlDB::query<gatherPopulations>();
-    
-        std::string_view jamCID;
-        int64_t totalPopulatedRiffs;
-        int64_t totalUnpopulatedRiffs;
-        int64_t totalPopulatedStems;
-        int64_t totalUnpopulatedStems;
+        reportResult.m_populatedStems.emplace_back( totalPopulatedStems );
+        reportResult.m_unpopulatedStems.emplace_back( totalUnpopulatedStems );
 
-        while ( query( jamCID,
-                       totalPopulatedRiffs,
-                       totalUnpopulatedRiffs,
-                       totalPopulatedStems,
-                       totalUnpopulatedStems ) )
-        {
-            uniqueJamIDs.erase( jamCID );   // this jam has sync data, remove it from the unique list as we'll be emitting data for it normally
+        reportResult.m_awaitingInitialSync.emplace_back( awaitingInitialSync );
+    }
 
-            reportResult.m_jamCouchIDs.emplace_back( jamCID );
+    if ( m_reportCallback )
+        m_reportCallback( reportResult );
 
-            reportResult.m_populatedRiffs.emplace_back( totalPopulatedRiffs );
-            reportResult.m_unpopulatedRiffs.emplace_back( totalUnpopulatedRiffs );
+    return true;
+}
 
-            reportResult.m_populatedStems.emplace_back( totalPopulatedStems );
-            reportResult.m_unpopulatedStems.emplace_back( totalUnpopulatedStems );
+// ---------------------------------------------------------------------------------------------------------------------
+bool ContentsAuditTask::Work( TaskQueue& currentTasks )
+{
+    spacetime::ScopedTimer auditTiming( "ContentsAuditTask::Work" );
 
-            reportResult.m_awaitingInitialSync.emplace_back( false );
-        }
+    sql::statistics::CountsByJam maintainedCounts;
+    sql::statistics::CountsByJam recountedCounts;
+    {
+        // read both inside one transaction so nothing can land between them
+        Warehouse::SqlDB::TransactionGuard txn;
+        sql::statistics::fetchMaintained( maintainedCounts );
+        sql::statistics::fetchFromScratch( recountedCounts );
     }
 
-    // all remaining unique jam IDs haven't even had a single round of data sync yet but we want to show
-    // the user we're going to consider them soon
-    if ( !uniqueJamIDs.empty() )
+    static constexpr sql::statistics::Counts cNoCounts{ 0, 0, 0, 0 };
+    const auto findCounts = []( const sql::statistics::CountsByJam& countsByJam, const std::string& jamCID ) -> const sql::statistics::Counts&
     {
-        for ( const auto& unSyncJam : uniqueJamIDs )
+        const auto it = countsByJam.find( jamCID );
+        return ( it == countsByJam.end() ) ? cNoCounts : it->second;
+    };
+
+    std::size_t mismatchedJams = 0;
+    const auto compareJam = [&]( const std::string& jamCID )
+    {
+        const auto& maintained = findCounts( maintainedCounts, jamCID );
+        const auto& recounted  = findCounts( recountedCounts, jamCID );
+        if ( maintained != recounted )
         {
-            reportResult.m_jamCouchIDs.emplace_back( unSyncJam );
+            blog::error::database( FMTX( "[{}] statistics mismatch for [{}] : stored riffs {}/{} stems {}/{}, recounted riffs {}/{} stems {}/{}" ),
+                Tag, jamCID,
+                maintained[0], maintained[1], maintained[2], maintained[3],
+                recounted[0],  recounted[1],  recounted[2],  recounted[3] );
+            mismatchedJams++;
+        }
+    };
 
-            reportResult.m_populatedRiffs.emplace_back( 0 );
-            reportResult.m_unpopulatedRiffs.emplace_back( 0 );
+    for ( const auto& entry : recountedCounts )
+        compareJam( entry.first );
+    for ( const auto& entry : maintainedCounts )
+    {
+        if ( !recountedCounts.contains( entry.first ) )
+            compareJam( entry.first );
+    }
 
-            reportResult.m_populatedStems.emplace_back( 0 );
-            reportResult.m_unpopulatedStems.emplace_back( 0 );
+    if ( mismatchedJams == 0 )
+    {
+        blog::database( FMTX( "[{}] statistics match for all {} jams" ), Tag, recountedCounts.size() );
 
-            reportResult.m_awaitingInitialSync.emplace_back( true );
-        }
+        m_eventBusClient.Send<::events::AddToastNotification>(
+            ::events::AddToastNotification::Type::Info,
+            "Warehouse Statistics",
+            fmt::format( FMTX( "All {} jams consistent" ), recountedCounts.size() ) );
     }
+    else
+    {
+        if ( m_repairMismatches )
+            sql::statistics::rebuild();
 
-    if ( m_reportCallback )
-        m_reportCallback( reportResult );
+        m_eventBusClient.Send<::events::AddToastNotification>(
+            ::events::AddToastNotification::Type::Error,
+            "Warehouse Statistics",
+            fmt::format( FMTX( "{} of {} jams mismatched{}" ), mismatchedJams, recountedCounts.size(), m_repairMismatches ? ", rebuilt" : "" ) );
+    }
 
     return true;
 }
@@ -81,6 +81,72 @@ struct Warehouse
     using JamSlicePtr = std::unique_ptr<JamSlice>;
     using JamSliceCallback = std::function<void( const types::JamCouchID& jamCouchID, JamSlicePtr&& resultSlice )>;
 
+    // search across every riff in the warehouse; free text is matched against the full-text index (jammer name,
+    // jam name, tag note) and combined with range predicates on the riff metadata. results are paged, newest first
+    struct SearchQuery
+    {
+        enum class TextScope : uint8_t
+        {
+            Everything,
+            UserName,
+            JamName,
+            TagNote
+        };
+
+        std::string                 m_text;                             // whitespace-separated words, each prefix-matched; empty to skip text matching
+        TextScope                   m_textScope     = TextScope::Everything;
+
+        types::JamCouchID           m_jamCID;                           // restrict to a single jam, or empty for all jams
+
+        float                       m_bpmMinimum    = 0.0f;             // inclusive BPM range
+        float                       m_bpmMaximum    = 1000.0f;
+        int32_t                     m_root          = -1;               // specific root / scale index, or -1 for any
+        int32_t                     m_scale         = -1;
+        int64_t                     m_timeBegin     = 0;                // inclusive unix-time window
+        int64_t                     m_timeEnd       = std::numeric_limits<int64_t>::max();
+
+        int32_t                     m_pageOffset    = 0;
+        int32_t                     m_pageSize      = 256;
+        bool                        m_countTotal    = true;             // also count every match; skip when fetching later pages
+    };
+
+    struct SearchResult
+    {
+        std::vector< types::RiffCouchID >   m_riffIDs;      // this page of results
+        std::vector< types::JamCouchID >    m_jamIDs;       // .. and the jam each one belongs to
+        int64_t                             m_totalMatches = 0;  // -1 if SearchQuery::m_countTotal was not set
+    };
+    using SearchResultPtr = std::unique_ptr<SearchResult>;
+    using SearchCallback = std::function<void( const SearchQuery& query, SearchResultPtr&& result )>;
+
+    struct SearchBenchmark
+    {
+        std::size_t     m_riffCount         = 0;
+        double          m_ingestMs          = 0;        // bulk insert including keeping the index in sync
+        double          m_textQueryMs       = 0;        // mean per query, text + range predicates
+        double          m_rangeQueryMs      = 0;        // mean per query, range predicates only
+        double          m_tagUpdateMs       = 0;        // mean per tag upsert
+        int64_t         m_lastTextMatches   = 0;
+        std::size_t     m_textHits          = 0;        // rows returned across all text queries
+        std::size_t     m_rangeHits         = 0;        // .. and all range queries
+        std::string     m_error;                        // set if SQLite threw during the run
+
+        ouro_nodiscard bool passed() const { return m_error.empty() && m_textHits > 0 && m_rangeHits > 0; }
+    };
+
+    struct IngestBenchmark
+    {
+        std::size_t     m_riffCount             = 0;
+        double          m_rowSkeletonsPerSec    = 0;    // riff placeholders from a jam snapshot, one statement per row
+        double          m_rowRiffsPerSec        = 0;    // riff details + stem placeholders, one statement per row
+        double          m_bulkSkeletonsPerSec   = 0;    // .. as above, staged and merged
+        double          m_bulkRiffsPerSec       = 0;
+        std::size_t     m_bulkRiffsMerged       = 0;    // filled riffs in the database after the staged pass
+        std::string     m_error;                        // set if SQLite threw during either pass
+
+        ouro_nodiscard bool passed() const { return m_error.empty() && m_riffCount > 0 && m_bulkRiffsMerged == m_riffCount; }
+    };
+
 
     struct ITask;
     struct INetworkTask;
@@ -91,8 +157,26 @@ struct Warehouse
     using TagUpdateCallback     = std::function<void( const endlesss::types::RiffTag& tagData )>;
     using TagRemovedCallback    = std::function<void( const endlesss::types::RiffCouchID& tagRiffID )>;
 
+    // state of the background network backfill that fills in unpopulated riff and stem records
+    struct BackfillReport
+    {
+        int32_t     m_concurrencyLimit      = 0;
+        int32_t     m_batchesInFlight       = 0;    // fetching, or fetched and waiting to be written
+        int32_t     m_batchesAwaitingWrite  = 0;
+        uint64_t    m_batchesCompleted      = 0;
+        uint64_t    m_batchesFailed         = 0;
+        uint64_t    m_riffsWritten          = 0;
+        uint64_t    m_stemsWritten          = 0;
+        int64_t     m_riffsRemaining        = 0;    // across the whole warehouse
+        int64_t     m_stemsRemaining        = 0;
+        double      m_rowsPerSecond         = 0;    // since the current run of backfilling began
+        double      m_errorRate             = 0;    // failed / attempted batches, current run
+    };
+
 
-    Warehouse( const app::StoragePaths& storagePaths, api::NetConfiguration::Shared& networkConfig, base::EventBusClient eventBus );
+    // backfillConcurrency is the number of network batch fetches that may be in flight at once when filling in
+    // unpopulated riffs and stems
+    Warehouse( const app::StoragePaths& storagePaths, api::NetConfiguration::Shared& networkConfig, base::EventBusClient eventBus, const int32_t backfillConcurrency );
     ~Warehouse();
 
     static std::string  m_databaseFile;
@@ -139,6 +223,10 @@ struct Warehouse
     // erase all unfilled riffs, effectively cutting short any in-progress sync
     void requestJamSyncAbort( const types::JamCouchID& jamCouchID );
 
+    // recount every jam from scratch and compare against the running statistics that feed the contents report;
+    // mismatches are logged and, if requested, the statistics are rebuilt from the recount
+    void requestContentsAudit( const bool repairMismatches );
+
 
     // -----------------------------------------------------------------------------------------------------------------
     // Jam Export
@@ -200,6 +288,21 @@ struct Warehouse
     void batchRemoveAllTags( const endlesss::types::JamCouchID& jamCID );
 
 
+    // -----------------------------------------------------------------------------------------------------------------
+    // Search
+
+    // run a search on the worker thread, callback is fired from there with a page of matching riff IDs
+    void addSearchRequest( const SearchQuery& query, const SearchCallback& callbackOnCompletion );
+
+    // build a scratch database in `scratchPath` with `riffCount` synthetic riffs and time the search index against it;
+    // blocks until complete, the scratch database is deleted afterwards
+    static SearchBenchmark benchmarkSearch( const fs::path& scratchPath, const std::size_t riffCount );
+
+    // ingest `riffCount` synthetic riffs into a scratch database in `scratchPath`, once with the old row-by-row
+    // statements and once through the staged bulk path, and report throughput in rows per second for both
+    static IngestBenchmark benchmarkIngest( const fs::path& scratchPath, const std::size_t riffCount );
+
+
     // -----------------------------------------------------------------------------------------------------------------
 
     ouro_nodiscard ChangeIndex getChangeIndexForJam( const endlesss::types::JamCouchID& jamID ) const;
@@ -208,6 +311,9 @@ struct Warehouse
     void workerTogglePause();
     ouro_nodiscard bool workerIsPaused() const { return m_workerThreadPaused; }
 
+    // snapshot of backfill progress, throughput and error rate
+    ouro_nodiscard BackfillReport getBackfillReport() const;
+
     // passing in the NetConfiguration for API access to Endlesss is optional; users should not enqueue tasks
     // that require it if it isn't present (and tasks will check and bail in error)
     ouro_nodiscard bool hasFullEndlesssNetworkAccess() const { return m_networkConfiguration->hasAccess( api::NetConfiguration::Access::Authenticated ); }
@@ -218,6 +324,7 @@ protected:
 
     friend ITask;
     struct TaskSchedule;
+    struct Backfill;
 
     void threadWorker();
 
@@ -232,6 +339,7 @@ protected:
     base::EventBusClient                    m_eventBusClient;
 
     std::unique_ptr<TaskSchedule>           m_taskSchedule;
+    std::unique_ptr<Backfill>               m_backfill;
 
     ChangeIndexMap                          m_changeIndexMap;
 
@@ -25,7 +25,6 @@
 #include "app/module.frontend.fonts.h"
 
 #include "mix/common.h"
-#include "mix/stem.amalgam.h"
 
 #include "endlesss/all.h"
 
@@ -631,6 +630,8 @@ int OuroApp::EntrypointGUI()
                             {
                                 if ( ImGui::IconButton( ICON_FA_ARROWS_ROTATE ) )
                                 {
+                                    // rebuild populates a fresh graph each time, don't re-run the previous one
+                                    taskFlow.clear();
                                     m_jamLibrary.asyncCacheRebuild(
                                         *m_networkConfiguration,
                                         endlesssAuth.sync_options,
@@ -829,6 +830,39 @@ int OuroApp::EntrypointGUI()
                                 "If possible, some riffs are kept alive in memory to speed-up transitions / avoid re-loading from disk.\nThis value controls how many we aim to limit that to.\nIncrease if you got RAM to burn."
                             );
                             ImGui::InputInt( "##riff_live_inst", &m_configPerf.liveRiffInstancePoolSize, 8, 16);
+
+                            NicerIntEditPreamble(
+                                "Riff Prefetch Count",
+                                "When playing riffs from a jam, this many of the following riffs are loaded ahead of time in the background\nso that moving on to them is instant. Prefetching stops before the stem cache reaches its memory target.\nSet to 0 to disable; requires a restart to take effect."
+                            );
+                            if ( ImGui::InputInt( "##riff_prefetch", &m_configPerf.riffPrefetchCount, 1, 4 ) )
+                            {
+                                m_configPerf.clampLimits();
+                            }
+
+                            NicerIntEditPreamble(
+                                "Stem Memory Format",
+                                "How loaded stems are held in memory.\nFloat32 is full quality, Int16 halves the memory use, ADPCM uses around 1/8th at some cost in fidelity.\nThe compact formats let far more of a jam stay loaded for instant playback.\nRequires a restart to take effect."
+                            );
+                            {
+                                auto storageFormat = m_configPerf.getStemStorageFormat();
+                                if ( config::StemStorageFormat::ImGuiCombo( "##stem_storage", storageFormat ) )
+                                {
+                                    m_configPerf.stemStorageFormat = config::StemStorageFormat::toString( storageFormat );
+                                }
+                            }
+
+                            NicerIntEditPreamble(
+                                "Progressive Stem Decode",
+                                "Start playing a stem as soon as its first moments are decoded, filling in the rest in the background.\nCuts the wait when loading riffs that aren't cached in memory yet. Only applies to the Float32 memory format.\nRequires a restart to take effect."
+                            );
+                            ImGui::Checkbox( "##stem_progressive", &m_configPerf.stemProgressiveDecode );
+
+                            NicerIntEditPreamble(
+                                "Pack Stem Cache",
+                                "Store cached stems in a handful of large pack files instead of one file per stem.\nIdentical stems are only stored once, and large caches become much quicker to back up or sync.\nExisting cached stems are moved across as they get used.\nRequires a restart to take effect."
+                            );
+                            ImGui::Checkbox( "##stem_pack", &m_configPerf.stemCachePackFiles );
                         }
                         ImGui::PopItemWidth();
 
@@ -973,7 +1007,7 @@ int OuroApp::EntrypointGUI()
         return 0;
 
     // boot stem cache now we have paths & audio configured
-    const auto stemCacheStatus = m_stemCache.initialise( m_storagePaths->cacheCommon, m_mdAudio->getSampleRate() );
+    const auto stemCacheStatus = m_stemCache.initialise( m_storagePaths->cacheCommon, m_mdAudio->getSampleRate(), m_configPerf.getStemStorageFormat(), m_configPerf.stemProgressiveDecode, m_configPerf.stemCachePackFiles );
     if ( !stemCacheStatus.ok() )
     {
         blog::error::cfg( "Unable to initialise stem cache; {}", stemCacheStatus.ToString() );
@@ -982,6 +1016,10 @@ int OuroApp::EntrypointGUI()
     m_stemCacheLastPruneCheck.setToFuture( c_stemCachePruneCheckDuration );
     m_stemCachePruneTask.emplace( [this]() { m_stemCache.lockAndPrune( false ); } );
 
+    // stem requests carry on as normal while this runs, so there's no reason to hold up boot waiting for it
+    m_stemCachePackTask.emplace( [this]() { m_stemCache.compactPackIfWorthwhile(); } );
+    m_stemCachePackFuture = m_taskExecutor.run( m_stemCachePackTask );
+
 
     // unplug status bar bits
     unregisterStatusBarBlock( sbbTimeStatusLeftID );
@@ -999,7 +1037,6 @@ int OuroApp::EntrypointGUI()
     // events
     {
         APP_EVENT_REGISTER( ExportRiff );
-        APP_EVENT_REGISTER( StemDataAmalgamGenerated );
         APP_EVENT_REGISTER_SPECIFIC( MixerRiffChange, 16 * 4096 );
 
         {
@@ -1019,6 +1056,14 @@ int OuroApp::EntrypointGUI()
     // wrap up any dangling async work before teardown
     ensureStemCacheChecksComplete();
 
+    // a compaction still running at exit is abandoned, leaving the pack as it was
+    if ( m_stemCachePackFuture.has_value() )
+    {
+        m_stemCache.cancelPackCompaction();
+        m_stemCachePackFuture->wait();
+    }
+    m_stemCachePackFuture = std::nullopt;
+
     return appResult;
 }
 
@@ -1096,7 +1141,8 @@ void OuroApp::event_ExportRiff( const events::ExportRiff* eventData )
         endlesss::toolkit::xp::RiffExportMode::Stems,
         destination,
         eventData->m_adjustments,
-        eventData->m_riff );
+        eventData->m_riff,
+        &m_taskExecutor );
 
     blog::core( FMTX( "Exported" ) );
     for ( const auto& exported : exportedFiles )
@@ -73,6 +73,10 @@ protected:
     tf::Taskflow                            m_stemCachePruneTask;
     std::optional< tf::Future<void> >       m_stemCachePruneFuture = std::nullopt;
 
+    // one-off background compaction of the stem pack, if it is in use and needs it
+    tf::Taskflow                            m_stemCachePackTask;
+    std::optional< tf::Future<void> >       m_stemCachePackFuture = std::nullopt;
+
 
     // -------------
 
@@ -12,6 +12,7 @@
 
 #include "discord/discord.bot.h"
 #include "discord/config.h"
+#include "discord/discord.voice.pacer.h"
 
 #include "spacetime/chronicle.h"
 
@@ -37,8 +38,18 @@ using VoiceChannelNameMap = std::unordered_map< dpp::snowflake, std::string >;
 // ---------------------------------------------------------------------------------------------------------------------
 struct Bot::State
 {
-    // lf queue exchanging completed blocks of packets from sample processor (audio thread) and our dispatch (main thread)
-    using OpusPacketQueue = mcc::ReaderWriterQueue<ssp::OpusPacketDataInstance>;
+    // pacer output routed into the live dpp voice client, if we have one
+    struct LiveVoiceSink final : public VoiceSink
+    {
+        LiveVoiceSink( State& botState ) : m_botState( botState ) {}
+
+        bool sendOpusPacket( const uint8_t* opusData, const std::size_t opusLength ) override
+        {
+            return m_botState.sendOpusPacket( opusData, opusLength );
+        }
+
+        State& m_botState;
+    };
 
 
     State( app::ICoreServices& coreServices, const config::discord::Connection& configConnection )
@@ -57,7 +68,8 @@ struct Bot::State
 #endif
         ,            m_voiceState( Bot::VoiceState::NoConnection )
         ,    m_voiceChannelLiveID( 0 )
-        ,   m_opusDispatchRunning( false )
+        ,         m_liveVoiceSink( *this )
+        ,            m_voicePacer( VoicePacer::Options{} )
     {
         m_commandHandler.add_prefix( "." )
                         .add_prefix( "/" );
@@ -68,6 +80,8 @@ struct Bot::State
 
     ~State()
     {
+        m_voicePacer.stop();
+
         if ( m_opusStreamProcessorID != ssp::StreamProcessorInstanceID::invalid() )
         {
             m_appCoreServices.getAudioModule()->blockUntil(
@@ -195,6 +209,8 @@ struct Bot::State
         ABSL_ASSERT( m_opusStreamProcessorID == ssp::StreamProcessorInstanceID::invalid() );
         m_opusStreamProcessorID = m_opusStreamProcessor->getInstanceID();
         m_appCoreServices.getAudioModule()->attachSampleProcessor( m_opusStreamProcessor );
+
+        m_voicePacer.start( m_liveVoiceSink );
     }
 
     // called from compressor thread; take the data and return as fast as we can
@@ -203,7 +219,32 @@ struct Bot::State
         if ( m_voiceState != Bot::VoiceState::Joined )
             return;
 
-        m_opusQueue.enqueue( std::move( packets ) );
+        m_voicePacer.enqueueBlock( std::move( packets ) );
+    }
+
+    // called from the pacer thread with the next packet due to go out
+    bool sendOpusPacket( const uint8_t* opusData, const std::size_t opusLength )
+    {
+        std::lock_guard<std::mutex> voiceLock( m_liveVoiceGuard );
+        if ( m_voiceState != Bot::VoiceState::Joined || m_liveVoice == nullptr )
+            return false;
+
+        // translate our UDP tuning value into the enum in dpp
+        switch ( m_voiceUdpTuning.load() )
+        {
+            default:
+            case Bot::UdpTuning::Default:    m_liveVoice->udpSendTiming = dpp::discord_voice_client::UdpSendTiming::Default;     break;
+            case Bot::UdpTuning::Delicate:   m_liveVoice->udpSendTiming = dpp::discord_voice_client::UdpSendTiming::Delicate;    break;
+            case Bot::UdpTuning::Optimistic: m_liveVoice->udpSendTiming = dpp::discord_voice_client::UdpSendTiming::Optimistic;  break;
+            case Bot::UdpTuning::Aggressive: m_liveVoice->udpSendTiming = dpp::discord_voice_client::UdpSendTiming::Aggressive;  break;
+        }
+
+        // set working memory block with the data to send; dpp only reads from it
+        m_workingMemory.opusData   = const_cast<uint8_t*>( opusData );
+        m_workingMemory.opusLength = opusLength;
+
+        m_liveVoice->send_audio_opus_memopt( m_workingMemory );
+        return true;
     }
 
     // called once guild_get() returns something useful
@@ -285,7 +326,7 @@ struct Bot::State
 
         std::lock_guard<std::mutex> voiceLock( m_liveVoiceGuard );
         m_voiceState          = Bot::VoiceState::Flux;
-        m_opusDispatchRunning = false;
+        m_voicePacer.requestFlush();
 
         dpp::discord_client* clientForGuild = m_cluster.get_shard( m_guildMetadata->m_shardID );
         clientForGuild->connect_voice( m_guildSID, vc.m_id, false, true );
@@ -304,7 +345,7 @@ struct Bot::State
 
         std::lock_guard<std::mutex> voiceLock( m_liveVoiceGuard );
         m_voiceState          = Bot::VoiceState::Flux;
-        m_opusDispatchRunning = false;
+        m_voicePacer.requestFlush();
 
         dpp::discord_client* clientForGuild = m_cluster.get_shard( m_guildMetadata->m_shardID );
         clientForGuild->disconnect_voice( m_guildSID );
@@ -380,133 +421,55 @@ struct Bot::State
     ssp::StreamProcessorInstanceID          m_opusStreamProcessorID;
 
     dpp::discord_voice_client::OpusDispatchWorkingMemory
-                                            m_workingMemory;        // reusable memory block for encryption + send of opus packets
+                                            m_workingMemory;        // reusable memory block for encryption + send of opus packets, pacer thread only
 
     const dpp::snowflake                    m_guildSID;
     GuildMetadataOptional                   m_guildMetadata;
 
-    std::mutex                              m_liveVoiceGuard;       // defense against the packet processing loop on main thread getting
+    std::mutex                              m_liveVoiceGuard;       // defense against the packet pacing thread getting
                                                                     // blindsided by voice channel disconnection 
     dpp::discord_voice_client*              m_liveVoice;
     std::atomic_uint32_t                    m_voiceBufferQueueState;
-    Bot::UdpTuning::Enum                    m_voiceUdpTuning;
+    std::atomic< Bot::UdpTuning::Enum >     m_voiceUdpTuning;
 
     std::atomic< Bot::VoiceState >          m_voiceState;
     std::atomic< dpp::snowflake >           m_voiceChannelLiveID;   // if VoiceState is Joined, this is the ID of the one we're on
     VoiceChannelsAtomic                     m_voiceChannels;
     VoiceChannelNameMap                     m_voiceChannelNamesByID;
 
-    OpusPacketQueue                         m_opusQueue;
-    ssp::OpusPacketDataInstance             m_opusPacketInProgress;
-    ssp::OpusPacketDataInstance             m_opusPacketInReserve;
-    bool                                    m_opusDispatchRunning;
+    LiveVoiceSink                           m_liveVoiceSink;
+    VoicePacer                              m_voicePacer;           // owns the dispatch thread and jitter buffer
+
+    uint64_t                                m_lastPacketsSent       = 0;
+    uint64_t                                m_lastPacketsSentBytes  = 0;
 };
 
 // ---------------------------------------------------------------------------------------------------------------------
 void Bot::State::update( DispatchStats& stats )
 {
-    stats.m_packetsSentBytes    = 0;
-    stats.m_packetsSentCount    = 0;
-    stats.m_bufferingProgress   = -1;
+    stats.m_pacer                   = m_voicePacer.getStatistics();
+    stats.m_voiceBufferQueueState   = m_voiceBufferQueueState;
 
-    stats.m_voiceBufferQueueState = m_voiceBufferQueueState;
+    // report traffic as a delta since the last update
+    stats.m_packetsSentCount        = (uint32_t)( stats.m_pacer.m_packetsSent - m_lastPacketsSent );
+    stats.m_packetsSentBytes        = (uint32_t)( stats.m_pacer.m_packetsSentBytes - m_lastPacketsSentBytes );
+    m_lastPacketsSent               = stats.m_pacer.m_packetsSent;
+    m_lastPacketsSentBytes          = stats.m_pacer.m_packetsSentBytes;
 
-    const size_t maxPacketsDispatchedPerUpdate = 4;
+    stats.m_averagePacketSize       = stats.m_pacer.m_averagePacketSize;
+    stats.m_dispatchRunning         = stats.m_pacer.m_running;
+    stats.m_bufferingProgress       = -1;
 
-    // packet dispatch
+    if ( m_voiceState == Bot::VoiceState::Joined )
     {
-        std::lock_guard<std::mutex> voiceLock( m_liveVoiceGuard );
-        if ( m_voiceState == Bot::VoiceState::Joined && m_liveVoice != nullptr )
-        {
-            // translate our UDP tuning value into the enum in dpp
-            switch ( m_voiceUdpTuning )
-            {
-                default:
-                case Bot::UdpTuning::Default:    m_liveVoice->udpSendTiming = dpp::discord_voice_client::UdpSendTiming::Default;     break;
-                case Bot::UdpTuning::Delicate:   m_liveVoice->udpSendTiming = dpp::discord_voice_client::UdpSendTiming::Delicate;    break;
-                case Bot::UdpTuning::Optimistic: m_liveVoice->udpSendTiming = dpp::discord_voice_client::UdpSendTiming::Optimistic;  break;
-                case Bot::UdpTuning::Aggressive: m_liveVoice->udpSendTiming = dpp::discord_voice_client::UdpSendTiming::Aggressive;  break;
-            }
-            
-            // no current packet block being drained? switch in the reserve
-            if ( m_opusPacketInProgress == nullptr )
-            {
-                if ( m_opusPacketInReserve != nullptr )
-                    std::swap( m_opusPacketInProgress, m_opusPacketInReserve );
-            }
-            // reserve empty? try dequeing one from the compressor thread's pile
-            if ( m_opusPacketInReserve == nullptr )
-            {
-                m_opusQueue.try_dequeue( m_opusPacketInReserve );
-            }
-
-            // pre-buffer stage - wait until we've got a bunch of packets to begin working with before 
-            // starting for real
-            if ( !m_opusDispatchRunning )
-            {
-                const auto queueLength = m_opusQueue.size_approx();
-                if ( queueLength >= 2 &&
-                     m_opusPacketInProgress &&
-                     m_opusPacketInReserve )
-                    m_opusDispatchRunning = true;
-                else
-                {
-                    stats.m_bufferingProgress = (float)queueLength;
-                    if ( m_opusPacketInProgress )
-                        stats.m_bufferingProgress++;
-                    if ( m_opusPacketInReserve )
-                        stats.m_bufferingProgress++;
-                    stats.m_bufferingProgress /= 4.0f;
-                }
-            }
-
-            // voice transmission is live, continuously stream packets to Discord
-            if ( m_opusDispatchRunning && 
-                 m_opusPacketInProgress )
-            {
-                const auto remainingPackets = std::min( m_opusPacketInProgress->m_opusPacketSizes.size() - m_opusPacketInProgress->m_dispatchedPackets, maxPacketsDispatchedPerUpdate );
-                for ( auto pkt = 0; pkt < remainingPackets; pkt++ )
-                {
-                    const size_t packetLength = m_opusPacketInProgress->m_opusPacketSizes[m_opusPacketInProgress->m_dispatchedPackets];
-
-                    // set working memory block with the data to send
-                    m_workingMemory.opusData = &m_opusPacketInProgress->m_opusData[m_opusPacketInProgress->m_dispatchedSize];
-                    m_workingMemory.opusLength = packetLength;
-
-                    m_liveVoice->send_audio_opus_memopt( m_workingMemory );
-
-                    m_opusPacketInProgress->m_dispatchedPackets++;
-                    m_opusPacketInProgress->m_dispatchedSize += packetLength;
-
-                    stats.m_packetsSentCount++;
-                    stats.m_packetsSentBytes += (uint32_t)packetLength;
-                    stats.m_averagePacketSize = m_opusPacketInProgress->m_averagePacketSize;
-                }
-
-                // depleted the current block of packets; this will be swapped out the next time through
-                if ( m_opusPacketInProgress->m_dispatchedPackets >= m_opusPacketInProgress->m_opusPacketSizes.size() )
-                {
-                    m_opusPacketInProgress.reset();
-                }
-            }
-        }
-        else if ( m_voiceState == Bot::VoiceState::Flux )
-        {
-            // flush all the dispatch state when in Flux
-            ssp::OpusPacketDataInstance flushQueue;
-            while ( m_opusQueue.try_dequeue( flushQueue ) )
-            {
-                blog::discord( FMTX( "draining packet queue..." ) );
-                flushQueue.reset();
-            }
-            m_opusPacketInProgress.reset();
-            m_opusPacketInReserve.reset();
-            m_opusDispatchRunning = false;
-        }
+        if ( !stats.m_dispatchRunning )
+            stats.m_bufferingProgress = stats.m_pacer.m_bufferingProgress;
+    }
+    else if ( m_voiceState == Bot::VoiceState::Flux )
+    {
+        // keep the pacer empty while joining or leaving
+        m_voicePacer.requestFlush();
     }
-
-    stats.m_packetBlobQueueLength   = (uint32_t)m_opusQueue.size_approx();
-    stats.m_dispatchRunning         = m_opusDispatchRunning;
 }
 
 
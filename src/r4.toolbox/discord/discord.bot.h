@@ -13,6 +13,8 @@
 
 #include "ssp/ssp.stream.opus.h"
 
+#include "discord/discord.voice.pacer.h"
+
 namespace config::discord { struct Connection; }
 namespace app {
     struct ICoreServices;
@@ -81,9 +83,7 @@ struct Bot
 
     struct DispatchStats
     {
-        uint32_t    m_packetBlobQueueLength = 0;
-
-        uint32_t    m_packetsSentCount      = 0;
+        uint32_t    m_packetsSentCount      = 0;    // since the previous update() call
         uint32_t    m_packetsSentBytes      = 0;
 
         uint32_t    m_voiceBufferQueueState = 0;
@@ -91,6 +91,8 @@ struct Bot
 
         float       m_bufferingProgress     = 0;
         bool        m_dispatchRunning       = false;
+
+        VoicePacer::Statistics  m_pacer;            // jitter buffer depth, under/overruns, send latency histogram
     };
 
     Bot();
@@ -100,7 +102,8 @@ struct Bot
     constexpr bool isInitialised() const { return m_initialised && m_state != nullptr; }
 
 
-    // call from main thread to let bot do regular main-thread processing tasks
+    // call from main thread to let bot do regular main-thread processing tasks; packet dispatch itself
+    // runs on a separate pacing thread, this just gathers its stats
     void update( DispatchStats& stats );
 
 
@@ -209,7 +209,20 @@ void BotWithUI::imgui( app::CoreGUI& coreGUI )
                     const float minimumLatency = (float)stats.m_voiceBufferQueueState * ssp::OpusStream::cFrameTimeSec;
 
                     ImGui::Text( "Voice Buffer Queue : %3u ( + ~%.1fs latency )", stats.m_voiceBufferQueueState, minimumLatency );
+                    ImGui::Text( "Jitter Buffer      : %3u ( ~%.1fs )", stats.m_pacer.m_jitterBufferDepth, (float)stats.m_pacer.m_jitterBufferDepth * ssp::OpusStream::cFrameTimeSec );
                     ImGui::Text( "Packet Size  (avg) : %4i bytes", (int32_t)m_avgPacketSize.m_average );
+                    ImGui::Text( "Underrun / Overrun : %u / %u", stats.m_pacer.m_underruns, stats.m_pacer.m_overrunDrops );
+                    ImGui::CompactTooltip( "Underruns are when the jitter buffer ran dry and had to rebuffer\nOverruns count packets dropped because the buffer grew too deep" );
+
+                    if ( ImGui::TreeNode( "Send Latency" ) )
+                    {
+                        for ( std::size_t bucket = 0; bucket < VoicePacer::LatencyBucketCount; bucket++ )
+                        {
+                            ImGui::Text( "%-8s %6u", VoicePacer::getLatencyBucketName( bucket ), stats.m_pacer.m_sendLatencyHistogram[bucket] );
+                        }
+                        ImGui::Text( "worst deadline miss : %.1f ms", (float)stats.m_pacer.m_maxLatenessUs / 1000.0f );
+                        ImGui::TreePop();
+                    }
 
                     ImGui::PushItemWidth( discordViewWidth * 0.65f );
 
@@ -236,6 +249,22 @@ void BotWithUI::imgui( app::CoreGUI& coreGUI )
 
                     ImGui::PopItemWidth();
                 }
+
+                ImGui::Spacing();
+                {
+                    const bool verificationRunning = m_pacingVerification.valid();
+
+                    ImGui::BeginDisabledControls( verificationRunning );
+                    if ( ImGui::Button( verificationRunning ? "Verifying Pacing ..." : "Verify Pacing", ImVec2( -1.0f, 0.0f ) ) )
+                    {
+                        m_pacingVerification = std::async( std::launch::async, []()
+                        {
+                            return VoicePacer::verifyPacing( std::chrono::seconds( 5 ) );
+                        });
+                    }
+                    ImGui::EndDisabledControls( verificationRunning );
+                    ImGui::CompactTooltip( "Run a voice pacer against a fake sink for a few seconds and check the timing of its output" );
+                }
             } // botPhase == Ready
             else
             {
@@ -323,6 +352,29 @@ void BotWithUI::imgui( app::CoreGUI& coreGUI )
         }
     }
     ImGui::End();
+
+    // report back from a pacing verification run once it completes
+    if ( m_pacingVerification.valid() &&
+         m_pacingVerification.wait_for( std::chrono::seconds( 0 ) ) == std::future_status::ready )
+    {
+        const auto result = m_pacingVerification.get();
+
+        const auto summary = fmt::format( FMTX( "{} / {} packets, {} out of order, {} underruns, {} overruns\ninterval error mean {:.0f}us, max {:.0f}us" ),
+            result.m_packetsCaptured,
+            result.m_packetsProduced,
+            result.m_outOfOrder,
+            result.m_underruns,
+            result.m_overrunDrops,
+            result.m_meanIntervalErrorUs,
+            result.m_maxIntervalErrorUs );
+
+        blog::discord( FMTX( "voice pacing verification : {}" ), summary );
+
+        coreGUI.getEventBusClient().Send< ::events::AddToastNotification >(
+            result.passed() ? ::events::AddToastNotification::Type::Info : ::events::AddToastNotification::Type::Error,
+            result.passed() ? ICON_FA_CIRCLE_CHECK " Voice Pacing OK" : ICON_FA_TRIANGLE_EXCLAMATION " Voice Pacing Failed",
+            summary );
+    }
 }
 
 } // namespace discord
@@ -12,6 +12,7 @@
 #include "app/core.h"
 #include "base/utils.h"
 #include "discord/config.h"
+#include "discord/discord.voice.pacer.h"
 
 namespace discord {
 
@@ -36,6 +37,8 @@ private:
 
     base::RollingAverage< 10 >              m_avgPacketSize;
 
+    std::future< VoicePacer::Verification > m_pacingVerification;
+
     uint64_t                                m_trafficOutBytes;
     app::CoreGUI::UIInjectionHandleOptional m_trafficOutBytesStatusHandle;
 };
@@ -0,0 +1,476 @@
+//   _______ _______ ______ _______ ___ ___ _______ _______ _______ 
+//  |       |   |   |   __ \       |   |   |    ___|       |    |  |
+//  |   -   |   |   |      <   -   |   |   |    ___|   -   |       |
+//  |_______|_______|___|__|_______|\_____/|_______|_______|__|____|
+//  \\ harry denholm \\ ishani            ishani.org/shelf/ouroveon/
+//
+//  real-time paced dispatch of Opus packets to a voice connection, via
+//  a bounded jitter buffer running on its own thread
+//
+
+#include "pch.h"
+
+#include "discord/discord.voice.pacer.h"
+
+using namespace std::chrono_literals;
+
+namespace discord {
+
+// ---------------------------------------------------------------------------------------------------------------------
+const char* VoicePacer::getLatencyBucketName( const std::size_t bucket )
+{
+    static constexpr std::array< const char*, LatencyBucketCount > names = {
+        "< 250ms",
+        "< 500ms",
+        "< 1s",
+        "< 2s",
+        "< 3s",
+        "< 4.5s",
+        "< 6s",
+        "6s +"
+    };
+    return ( bucket < names.size() ) ? names[bucket] : "";
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+struct VoicePacer::State
+{
+    // block of packets as handed over from the compressor thread, stamped with when it arrived
+    struct QueuedBlock
+    {
+        ssp::OpusPacketDataInstance     m_packets;
+        Clock::time_point               m_arrivalTime;
+    };
+    using BlockQueue = mcc::ReaderWriterQueue< QueuedBlock >;
+
+
+    State( const Options& options )
+        : m_options( options )
+    {
+        m_options.m_prebufferPackets = std::max( m_options.m_prebufferPackets, 1U );
+        m_options.m_maximumPackets   = std::max( m_options.m_maximumPackets, m_options.m_prebufferPackets );
+        m_options.m_leadPackets      = std::min( m_options.m_leadPackets, m_options.m_prebufferPackets );
+    }
+
+    ~State()
+    {
+        stop();
+    }
+
+    void start( VoiceSink& sink )
+    {
+        stop();
+
+        m_sink      = &sink;
+        m_runThread = true;
+        m_thread    = std::make_unique<std::thread>( &State::pacerThreadLoop, this );
+    }
+
+    void stop()
+    {
+        if ( m_thread )
+        {
+            m_runThread = false;
+            m_thread->join();
+            m_thread = nullptr;
+        }
+        m_sink = nullptr;
+    }
+
+    void pacerThreadLoop();
+
+    // pull everything waiting in the lf queue into the jitter buffer
+    void drainIncoming();
+    // drop all buffered packets, back to prebuffering
+    void flushAll();
+    // discard oldest packets until the buffer is within its maximum depth
+    void trimOverrun();
+    // hand the next buffered packet to the sink; returns false if the buffer was empty
+    bool dispatchNextPacket( const Clock::time_point deadline );
+
+    void recordSendLatency( const Clock::duration latency );
+    void publishBufferState();
+
+
+    Options                             m_options;
+
+    BlockQueue                          m_incoming;
+    std::atomic_bool                    m_flushRequested    = false;
+
+    std::atomic_bool                    m_runThread         = false;
+    std::unique_ptr< std::thread >      m_thread;
+    VoiceSink*                          m_sink              = nullptr;
+
+    // jitter buffer, only touched by the pacer thread
+    std::deque< QueuedBlock >           m_jitterBlocks;
+    uint32_t                            m_jitterPackets     = 0;
+    bool                                m_running           = false;
+    Clock::time_point                   m_runStartTime;
+
+    // statistics, written by the pacer thread and read from anywhere
+    std::atomic_uint64_t                m_statPacketsSent       = 0;
+    std::atomic_uint64_t                m_statPacketsSentBytes  = 0;
+    std::atomic_uint32_t                m_statPacketsFailed     = 0;
+    std::atomic_uint32_t                m_statUnderruns         = 0;
+    std::atomic_uint32_t                m_statOverrunDrops      = 0;
+    std::atomic_uint32_t                m_statDeadlineResyncs   = 0;
+    std::atomic_uint32_t                m_statJitterDepth       = 0;
+    std::atomic_uint32_t                m_statAvgPacketSize     = 0;
+    std::atomic_bool                    m_statRunning           = false;
+    std::atomic_int64_t                 m_statMaxLatenessUs     = 0;
+
+    std::array< std::atomic_uint32_t, LatencyBucketCount >
+                                        m_statSendLatency       = {};
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+void VoicePacer::State::pacerThreadLoop()
+{
+    OuroveonThreadScope ots( "VoicePacer" );
+
+    const auto interval = m_options.m_packetInterval;
+
+    // if we wake up this far past a deadline (a stalled machine, a debugger break) then sending everything we owe
+    // in one burst would do more harm than good; just restart the clock from now
+    const auto resyncThreshold = interval * ( m_options.m_leadPackets + 4 );
+
+    Clock::time_point nextDeadline;
+
+    while ( m_runThread )
+    {
+        if ( m_flushRequested.exchange( false ) )
+            flushAll();
+
+        drainIncoming();
+        trimOverrun();
+
+        if ( !m_running )
+        {
+            if ( m_jitterPackets >= m_options.m_prebufferPackets )
+            {
+                // start the schedule in the past by the lead amount, so those first packets go straight out
+                m_running       = true;
+                m_runStartTime  = Clock::now();
+                nextDeadline    = m_runStartTime - ( interval * m_options.m_leadPackets );
+            }
+            else
+            {
+                publishBufferState();
+                std::this_thread::sleep_for( std::min< Clock::duration >( interval / 4, 5ms ) );
+                continue;
+            }
+        }
+
+        // sleep until just short of the next deadline and send as soon as we wake; a packet going out a fraction of
+        // a millisecond early is harmless given the lead we keep, whereas spinning out the remainder would burn a core
+        {
+            const auto wakeTime = nextDeadline - m_options.m_wakeMargin;
+            if ( Clock::now() < wakeTime )
+                std::this_thread::sleep_until( wakeTime );
+        }
+
+        // check once more for arrivals, we may have slept through one landing
+        drainIncoming();
+
+        const auto sendTime = Clock::now();
+        if ( sendTime - nextDeadline > resyncThreshold )
+        {
+            m_statDeadlineResyncs++;
+            nextDeadline = sendTime;
+        }
+
+        if ( !dispatchNextPacket( nextDeadline ) )
+        {
+            // ran dry; go back to prebuffering rather than sending packets the moment they trickle in
+            m_statUnderruns++;
+            m_running = false;
+            publishBufferState();
+            continue;
+        }
+
+        nextDeadline += interval;
+        publishBufferState();
+    }
+
+    m_running = false;
+    flushAll();
+    publishBufferState();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void VoicePacer::State::drainIncoming()
+{
+    QueuedBlock block;
+    while ( m_incoming.try_dequeue( block ) )
+    {
+        if ( block.m_packets == nullptr )
+            continue;
+
+        const auto packetsInBlock = block.m_packets->m_opusPacketSizes.size() - block.m_packets->m_dispatchedPackets;
+        if ( packetsInBlock == 0 )
+            continue;
+
+        m_jitterPackets += (uint32_t)packetsInBlock;
+        m_jitterBlocks.emplace_back( std::move( block ) );
+    }
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void VoicePacer::State::flushAll()
+{
+    QueuedBlock block;
+    while ( m_incoming.try_dequeue( block ) ) {}
+
+    m_jitterBlocks.clear();
+    m_jitterPackets = 0;
+    m_running       = false;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void VoicePacer::State::trimOverrun()
+{
+    while ( m_jitterPackets > m_options.m_maximumPackets && !m_jitterBlocks.empty() )
+    {
+        auto& oldest = *m_jitterBlocks.front().m_packets;
+
+        oldest.m_dispatchedSize += oldest.m_opusPacketSizes[oldest.m_dispatchedPackets];
+        oldest.m_dispatchedPackets++;
+        m_jitterPackets--;
+        m_statOverrunDrops++;
+
+        if ( oldest.m_dispatchedPackets >= oldest.m_opusPacketSizes.size() )
+            m_jitterBlocks.pop_front();
+    }
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+bool VoicePacer::State::dispatchNextPacket( const Clock::time_point deadline )
+{
+    if ( m_jitterBlocks.empty() )
+        return false;
+
+    auto& front  = m_jitterBlocks.front();
+    auto& block  = *front.m_packets;
+
+    const std::size_t packetIndex  = block.m_dispatchedPackets;
+    const std::size_t packetCount  = block.m_opusPacketSizes.size();
+    const std::size_t packetLength = block.m_opusPacketSizes[packetIndex];
+
+    const bool sent = m_sink->sendOpusPacket( &block.m_opusData[block.m_dispatchedSize], packetLength );
+    const auto sentTime = Clock::now();
+
+    if ( sent )
+    {
+        m_statPacketsSent++;
+        m_statPacketsSentBytes += packetLength;
+    }
+    else
+    {
+        m_statPacketsFailed++;
+    }
+    m_statAvgPacketSize = block.m_averagePacketSize;
+
+    // the block arrived once its final packet was encoded, so earlier packets in it were ready that much sooner
+    const auto encodedTime = front.m_arrivalTime - ( m_options.m_packetInterval * (int64_t)( packetCount - 1 - packetIndex ) );
+    recordSendLatency( sentTime - encodedTime );
+
+    // lead packets are deliberately early, only measure lateness against the real-time part of the schedule
+    if ( deadline >= m_runStartTime )
+    {
+        const int64_t latenessUs = std::chrono::duration_cast<std::chrono::microseconds>( sentTime - deadline ).count();
+        if ( latenessUs > m_statMaxLatenessUs )
+            m_statMaxLatenessUs = latenessUs;
+    }
+
+    block.m_dispatchedPackets++;
+    block.m_dispatchedSize += packetLength;
+    m_jitterPackets--;
+
+    if ( block.m_dispatchedPackets >= packetCount )
+        m_jitterBlocks.pop_front();
+
+    return true;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void VoicePacer::State::recordSendLatency( const Clock::duration latency )
+{
+    const auto latencyMs = std::chrono::duration_cast<std::chrono::milliseconds>( latency ).count();
+
+    std::size_t bucket = 0;
+    while ( bucket < LatencyBucketUpperMs.size() && latencyMs >= LatencyBucketUpperMs[bucket] )
+        bucket++;
+
+    m_statSendLatency[bucket]++;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+void VoicePacer::State::publishBufferState()
+{
+    m_statJitterDepth = m_jitterPackets;
+    m_statRunning     = m_running;
+}
+
+
+// ---------------------------------------------------------------------------------------------------------------------
+VoicePacer::VoicePacer( const Options& options )
+    : m_state( std::make_unique<State>( options ) )
+{
+}
+
+VoicePacer::~VoicePacer()
+{
+}
+
+void VoicePacer::start( VoiceSink& sink )
+{
+    m_state->start( sink );
+}
+
+void VoicePacer::stop()
+{
+    m_state->stop();
+}
+
+void VoicePacer::enqueueBlock( ssp::OpusPacketDataInstance&& packets )
+{
+    m_state->m_incoming.enqueue( { std::move( packets ), Clock::now() } );
+}
+
+void VoicePacer::requestFlush()
+{
+    m_state->m_flushRequested = true;
+}
+
+VoicePacer::Statistics VoicePacer::getStatistics() const
+{
+    Statistics stats;
+
+    stats.m_packetsSent         = m_state->m_statPacketsSent;
+    stats.m_packetsSentBytes    = m_state->m_statPacketsSentBytes;
+    stats.m_packetsFailed       = m_state->m_statPacketsFailed;
+    stats.m_underruns           = m_state->m_statUnderruns;
+    stats.m_overrunDrops        = m_state->m_statOverrunDrops;
+    stats.m_deadlineResyncs     = m_state->m_statDeadlineResyncs;
+    stats.m_jitterBufferDepth   = m_state->m_statJitterDepth;
+    stats.m_averagePacketSize   = m_state->m_statAvgPacketSize;
+    stats.m_running             = m_state->m_statRunning;
+    stats.m_maxLatenessUs       = m_state->m_statMaxLatenessUs;
+
+    stats.m_bufferingProgress   = stats.m_running ? 1.0f :
+        std::min( 1.0f, (float)stats.m_jitterBufferDepth / (float)m_state->m_options.m_prebufferPackets );
+
+    for ( std::size_t bucket = 0; bucket < LatencyBucketCount; bucket++ )
+        stats.m_sendLatencyHistogram[bucket] = m_state->m_statSendLatency[bucket];
+
+    return stats;
+}
+
+
+// ---------------------------------------------------------------------------------------------------------------------
+VoicePacer::Verification VoicePacer::verifyPacing( const std::chrono::milliseconds duration )
+{
+    // each fake packet carries its sequence number so the sink can check ordering
+    static constexpr uint32_t cPacketsPerBlock = 5;
+
+    struct CaptureSink final : public VoiceSink
+    {
+        bool sendOpusPacket( const uint8_t* opusData, const std::size_t opusLength ) override
+        {
+            uint32_t sequence = 0;
+            if ( opusLength >= sizeof( sequence ) )
+                std::memcpy( &sequence, opusData, sizeof( sequence ) );
+
+            std::lock_guard<std::mutex> captureLock( m_captureMutex );
+            m_captured.emplace_back( sequence, Clock::now() );
+            return true;
+        }
+
+        std::mutex                                                      m_captureMutex;
+        std::vector< std::pair< uint32_t, Clock::time_point > >         m_captured;
+    };
+
+    Options options;
+    options.m_packetInterval    = 20ms;
+    options.m_prebufferPackets  = cPacketsPerBlock * 3;
+    options.m_maximumPackets    = cPacketsPerBlock * 8;
+    options.m_leadPackets       = 2;
+
+    CaptureSink sink;
+    sink.m_captured.reserve( (std::size_t)( duration / options.m_packetInterval ) + 64 );
+
+    VoicePacer pacer( options );
+    pacer.start( sink );
+
+    // produce blocks at the real-time rate, but deliver each one up to a block-length late to mimic
+    // the compressor thread being at the mercy of the audio callback and the scheduler
+    Verification result;
+    {
+        std::mt19937 rng( 0x0C0FFEE );
+        std::uniform_int_distribution< int32_t > jitterMs( 0, (int32_t)( cPacketsPerBlock * 20 ) - 1 );
+
+        const auto blockInterval = options.m_packetInterval * cPacketsPerBlock;
+        const auto produceStart  = Clock::now();
+
+        uint32_t sequence = 0;
+        for ( uint32_t blockIndex = 0; ; blockIndex++ )
+        {
+            const auto blockDue = produceStart + ( blockInterval * ( blockIndex + 1 ) );
+            if ( blockDue - produceStart > duration )
+                break;
+
+            std::this_thread::sleep_until( blockDue + std::chrono::milliseconds( jitterMs( rng ) ) );
+
+            auto block = std::make_unique< ssp::OpusPacketData >( cPacketsPerBlock );
+            for ( uint32_t packet = 0; packet < cPacketsPerBlock; packet++, sequence++ )
+            {
+                std::memcpy( &block->m_opusData[block->m_dispatchedSize], &sequence, sizeof( sequence ) );
+                block->m_dispatchedSize += sizeof( sequence );
+                block->m_opusPacketSizes.emplace_back( (uint16_t)sizeof( sequence ) );
+            }
+            block->m_dispatchedSize    = 0;
+            block->m_averagePacketSize = sizeof( sequence );
+
+            pacer.enqueueBlock( std::move( block ) );
+        }
+        result.m_packetsProduced = sequence;
+
+        // give the pacer time to play out what it has buffered; once the last packet is out it will underrun on
+        // the next deadline as the producer has stopped, so poll tightly and snapshot the stats before that happens
+        const auto drainDeadline = Clock::now() + ( options.m_packetInterval * ( options.m_maximumPackets + 4 ) );
+        while ( Clock::now() < drainDeadline && pacer.getStatistics().m_packetsSent < sequence )
+            std::this_thread::sleep_for( 1ms );
+    }
+
+    const auto stats = pacer.getStatistics();
+    pacer.stop();
+
+    result.m_packetsCaptured = (uint32_t)sink.m_captured.size();
+    result.m_underruns       = stats.m_underruns;
+    result.m_overrunDrops    = stats.m_overrunDrops;
+
+    // the lead packets go out back-to-back by design; measure intervals from the real-time part onwards
+    const double expectedIntervalUs = (double)std::chrono::duration_cast<std::chrono::microseconds>( options.m_packetInterval ).count();
+    uint32_t intervalsMeasured = 0;
+    for ( std::size_t i = 1; i < sink.m_captured.size(); i++ )
+    {
+        if ( sink.m_captured[i].first != sink.m_captured[i - 1].first + 1 )
+            result.m_outOfOrder++;
+
+        if ( i <= options.m_leadPackets )
+            continue;
+
+        const double intervalUs  = (double)std::chrono::duration_cast<std::chrono::microseconds>( sink.m_captured[i].second - sink.m_captured[i - 1].second ).count();
+        const double errorUs     = std::abs( intervalUs - expectedIntervalUs );
+
+        result.m_meanIntervalErrorUs += errorUs;
+        result.m_maxIntervalErrorUs   = std::max( result.m_maxIntervalErrorUs, errorUs );
+        intervalsMeasured++;
+    }
+    if ( intervalsMeasured > 0 )
+        result.m_meanIntervalErrorUs /= (double)intervalsMeasured;
+
+    return result;
+}
+
+} // namespace discord
@@ -0,0 +1,119 @@
+//   _______ _______ ______ _______ ___ ___ _______ _______ _______ 
+//  |       |   |   |   __ \       |   |   |    ___|       |    |  |
+//  |   -   |   |   |      <   -   |   |   |    ___|   -   |       |
+//  |_______|_______|___|__|_______|\_____/|_______|_______|__|____|
+//  \\ harry denholm \\ ishani            ishani.org/shelf/ouroveon/
+//
+//  real-time paced dispatch of Opus packets to a voice connection, via
+//  a bounded jitter buffer running on its own thread
+//
+
+#pragma once
+
+#include "base/construction.h"
+
+#include "ssp/ssp.stream.opus.h"
+
+namespace discord {
+
+// ---------------------------------------------------------------------------------------------------------------------
+// destination for paced packets; called from the pacer thread, one packet at a time. return false if the packet
+// could not be delivered (eg. voice connection went away) - it still counts as consumed
+struct VoiceSink
+{
+    virtual ~VoiceSink() {}
+    virtual bool sendOpusPacket( const uint8_t* opusData, const std::size_t opusLength ) = 0;
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+// takes blocks of Opus packets from the compressor thread through a lock-free queue and feeds them to a VoiceSink
+// one at a time against a steady clock, one packet per frame time. packets are held in a jitter buffer that must
+// fill to a prebuffer target before sending starts (and again after an underrun); if it grows past the maximum
+// depth the oldest packets are dropped so latency can't grow without bound
+//
+struct VoicePacer
+{
+    DECLARE_NO_COPY_NO_MOVE( VoicePacer );
+
+    using Clock = std::chrono::steady_clock;
+
+    struct Options
+    {
+        Clock::duration     m_packetInterval    = std::chrono::microseconds( (int64_t)( ssp::OpusStream::cFrameTimeSec * 1'000'000.0f ) );
+        uint32_t            m_prebufferPackets  = ssp::OpusStream::cBufferedFrames * 2;    // packets buffered before sending begins
+        uint32_t            m_maximumPackets    = ssp::OpusStream::cBufferedFrames * 8;    // depth past which oldest packets are dropped
+        uint32_t            m_leadPackets       = 2;                                        // packets handed to the sink ahead of real-time
+        Clock::duration     m_wakeMargin        = std::chrono::microseconds( 500 );         // wake this far ahead of a deadline to cover scheduler slop
+    };
+
+    // send latency is measured from when a packet was encoded (estimated from its block's arrival time and position
+    // in the block) to when it was handed to the sink; ie. how much delay the jitter buffer is adding
+    static constexpr std::size_t                        LatencyBucketCount = 8;
+    static constexpr std::array< uint32_t, LatencyBucketCount - 1 >
+                                                        LatencyBucketUpperMs = { 250, 500, 1000, 2000, 3000, 4500, 6000 };
+    static const char*                                  getLatencyBucketName( const std::size_t bucket );
+
+    struct Statistics
+    {
+        uint64_t    m_packetsSent           = 0;
+        uint64_t    m_packetsSentBytes      = 0;
+        uint32_t    m_packetsFailed         = 0;    // sink refused the packet
+        uint32_t    m_underruns             = 0;    // jitter buffer ran dry while sending, forcing a rebuffer
+        uint32_t    m_overrunDrops          = 0;    // packets discarded because the jitter buffer was full
+        uint32_t    m_deadlineResyncs       = 0;    // pacer fell so far behind its clock it had to restart it
+
+        uint32_t    m_jitterBufferDepth     = 0;    // packets currently held
+        uint32_t    m_averagePacketSize     = 0;    // of the most recently sent block
+        float       m_bufferingProgress     = 0;    // 0..1 towards prebuffer target while not running
+        bool        m_running               = false;
+
+        int64_t     m_maxLatenessUs         = 0;    // worst observed gap between a deadline and the actual send
+
+        std::array< uint32_t, LatencyBucketCount >  m_sendLatencyHistogram = {};
+    };
+
+    VoicePacer( const Options& options );
+    ~VoicePacer();
+
+    // spin up / shut down the pacing thread; the sink must outlive the pacer, or the next stop() call
+    void start( VoiceSink& sink );
+    void stop();
+
+    // call from the compressor thread; never blocks
+    void enqueueBlock( ssp::OpusPacketDataInstance&& packets );
+
+    // ask the pacer thread to drop everything it has and go back to prebuffering
+    void requestFlush();
+
+    Statistics getStatistics() const;
+
+
+    // run a pacer against a fake sink that captures arrival times, with a producer delivering blocks at the
+    // real-time rate plus some jitter; checks ordering and inter-packet timing of the output
+    struct Verification
+    {
+        uint32_t    m_packetsProduced       = 0;
+        uint32_t    m_packetsCaptured       = 0;
+        uint32_t    m_outOfOrder            = 0;
+        uint32_t    m_underruns             = 0;
+        uint32_t    m_overrunDrops          = 0;
+        double      m_meanIntervalErrorUs   = 0;    // mean | actual interval - expected interval |
+        double      m_maxIntervalErrorUs    = 0;
+
+        bool passed() const
+        {
+            return m_packetsCaptured > 0 &&
+                   m_outOfOrder == 0 &&
+                   m_underruns == 0 &&
+                   m_meanIntervalErrorUs < 1000.0;
+        }
+    };
+    static Verification verifyPacing( const std::chrono::milliseconds duration );
+
+private:
+
+    struct State;
+    std::unique_ptr< State >    m_state;
+};
+
+} // namespace discord
@@ -77,12 +77,12 @@ void Preview::renderCurrentRiff(
     if ( samplesToWrite == 0 )
         return;
 
-    // burned through enough samples to send out latest stem data block. chuck the current data on the bus
+    // burned through enough samples to send out latest stem data block. publish the current data for the main thread
     // NB/TODO doesn't deal with crossing this boundary inside the update (eg. if samplesToWrite is big, bigger than SamplesBeforeReset..)
     // could do this at a higher level, break the render() into smaller samplesToWrite blocks to fit, probably overkill
     if ( m_stemDataAmalgamSamplesUsed >= m_stemDataAmalgamSamplesBeforeReset )
     {
-        m_eventBusClient.Send< ::events::StemDataAmalgamGenerated >( m_stemDataAmalgam );
+        m_stemDataChannel.publish( m_stemDataAmalgam );
 
         m_stemDataAmalgam.reset();
         m_stemDataAmalgamSamplesUsed = 0;
@@ -149,6 +149,8 @@ void Preview::renderCurrentRiff(
         float lastSampleRight = 0;
 
         auto& stemAnalysis = stemInst->getAnalysisData();
+        auto& stemReader   = m_stemReaders[stemI];
+        const auto& stemStorage = stemInst->getStorage();
 
         for ( auto sI = 0U; sI < samplesToWrite; sI++ )
         {
@@ -179,8 +181,10 @@ void Preview::renderCurrentRiff(
                 m_stemDataAmalgam.m_high[stemI] = std::max( m_stemDataAmalgam.m_high[stemI], stemHigh );
             }
 
-            lastSampleLeft  = stemInst->m_channel[0][finalSampleIdx] * stemGain * permGain;
-            lastSampleRight = stemInst->m_channel[1][finalSampleIdx] * stemGain * permGain;
+            stemReader.read( stemStorage, finalSampleIdx, lastSampleLeft, lastSampleRight );
+
+            lastSampleLeft  *= stemGain * permGain;
+            lastSampleRight *= stemGain * permGain;
             m_mixChannelLeft[stemI][outputOffset + sI]  = lastSampleLeft;
             m_mixChannelRight[stemI][outputOffset + sI] = lastSampleRight;
 
@@ -441,6 +445,7 @@ void Preview::update(
 
         // reset computed riff playback variables
         m_playbackProgression.reset();
+        m_playbackProgressionChannel.publish( m_playbackProgression );
 
         // force playback cursor back to the start while we have nothing to play; this means that 
         // the first riff enqueued to play after we've been idle will start from scratch rather
@@ -584,6 +589,7 @@ void Preview::update(
         timingData.ComputeProgressionAtSample(
             m_riffPlaybackSample,
             m_playbackProgression );
+        m_playbackProgressionChannel.publish( m_playbackProgression );
 
         m_timeInfo.samplePos          = (double)m_riffPlaybackSample;
         m_timeInfo.tempo              = timingData.m_bpm;
@@ -726,12 +732,14 @@ void Preview::imguiDefault()
         const float progressBarHeight = 5.0f;
         if ( currentRiffIsValid )
         {
+            const auto& playbackProgression = getPlaybackProgression();
+
             const bool waitingOnMultiBarCountdown = ( m_lockTransitionBarCount == TransitionBarCount::Many );
-            const int32_t remainingBarCounter = waitingOnMultiBarCountdown ? ( m_playbackProgression.m_playbackBar + m_lockTransitionBarCounter ) : -1;
+            const int32_t remainingBarCounter = waitingOnMultiBarCountdown ? ( playbackProgression.m_playbackBar + m_lockTransitionBarCounter ) : -1;
 
-            ImGui::ProgressBar( (float)m_playbackProgression.m_playbackPercentage, ImVec2( -1, progressBarHeight ), "" );
-            ImGui::BeatSegments( "##bars_play", currentRiff->m_timingDetails.m_barCount, m_playbackProgression.m_playbackBar, remainingBarCounter, progressBarHeight, riffTransitColourU32 );
-            ImGui::BeatSegments( "##beats", currentRiff->m_timingDetails.m_quarterBeats, m_playbackProgression.m_playbackBarSegment );
+            ImGui::ProgressBar( (float)playbackProgression.m_playbackPercentage, ImVec2( -1, progressBarHeight ), "" );
+            ImGui::BeatSegments( "##bars_play", currentRiff->m_timingDetails.m_barCount, playbackProgression.m_playbackBar, remainingBarCounter, progressBarHeight, riffTransitColourU32 );
+            ImGui::BeatSegments( "##beats", currentRiff->m_timingDetails.m_quarterBeats, playbackProgression.m_playbackBarSegment );
         }
         else
         {
@@ -14,6 +14,8 @@
 #include "mix/common.h"
 #include "mix/stem.amalgam.h"
 
+#include "endlesss/live.stem.storage.h"
+
 #include "app/module.audio.h"
 
 namespace app { struct StoragePaths; }
@@ -89,6 +91,16 @@ struct Preview final : public app::module::MixerInterface,
     inline void setLockTransitionToNextBar( bool onOff ) { m_lockTransitionToNextBar = onOff; }
     inline bool getLockTransitionToNextBar() const       { return m_lockTransitionToNextBar; }
 
+    // stem data blocks published by the mixer, to be handed to a StemDataProcessor
+    inline StemDataChannel& getStemDataChannel() { return m_stemDataChannel; }
+
+    // latest playback position published by the mixer; main thread only
+    inline const endlesss::live::RiffProgression& getPlaybackProgression()
+    {
+        m_playbackProgressionChannel.read( m_playbackProgressionUI );
+        return m_playbackProgressionUI;
+    }
+
 protected:
 
     static constexpr size_t     txBlendBufferSize = 128;
@@ -155,11 +167,18 @@ protected:
     TxBlendInterpArray              m_txBlendInterp;
     uint32_t                        m_txBlendSamplesRemaining   = 0;
 
+    std::array< endlesss::live::StemReader, 8 >
+                                    m_stemReaders;                      // per-layer read cursors for compact stem formats
+
     StemDataAmalgam                 m_stemDataAmalgam;
     uint32_t                        m_stemDataAmalgamSamplesBeforeReset;
     uint32_t                        m_stemDataAmalgamSamplesUsed;
+    StemDataChannel                 m_stemDataChannel;                  // audio -> main thread, latest block only
 
-    endlesss::live::RiffProgression m_playbackProgression;
+    endlesss::live::RiffProgression m_playbackProgression;              // audio thread
+    base::TelemetryChannel< endlesss::live::RiffProgression >
+                                    m_playbackProgressionChannel;
+    endlesss::live::RiffProgression m_playbackProgressionUI;            // main thread copy, see getPlaybackProgression()
 
     int32_t                         m_lockTransitionOnBeat      = 0;
     TransitionBarCount::Enum        m_lockTransitionBarCount    = TransitionBarCount::Once;
@@ -9,48 +9,47 @@
 
 #include "mix/stem.amalgam.h"
 
-namespace stdp = std::placeholders;
-
 namespace mix {
 
 // ---------------------------------------------------------------------------------------------------------------------
-absl::Status StemDataProcessor::connect( base::EventBusPtr appEventBus )
+absl::Status StemDataProcessor::connect( StemDataChannel& stemDataChannel )
 {
-    if ( m_eventListenerStemDataAmalgam != base::EventListenerID::invalid() )
-        return absl::UnknownError( "already connected to stem data event bus" );
+    if ( m_stemDataChannel != nullptr )
+        return absl::UnknownError( "already connected to stem data channel" );
 
-    m_eventListenerStemDataAmalgam = appEventBus->addListener(
-        events::StemDataAmalgamGenerated::ID, 
-        std::bind( &StemDataProcessor::handleNewStemAmalgam, this, stdp::_1 ) );
+    m_stemDataChannel = &stemDataChannel;
 
     return absl::OkStatus();
 }
 
 // ---------------------------------------------------------------------------------------------------------------------
-absl::Status StemDataProcessor::disconnect( base::EventBusPtr appEventBus )
+absl::Status StemDataProcessor::disconnect()
 {
-    if ( m_eventListenerStemDataAmalgam == base::EventListenerID::invalid() )
-        return absl::UnknownError( "not connected to stem data event bus" );
-
-    const auto status = appEventBus->removeListener( m_eventListenerStemDataAmalgam );
-    if ( !status.ok() )
-        return status;
+    if ( m_stemDataChannel == nullptr )
+        return absl::UnknownError( "not connected to stem data channel" );
 
-    m_eventListenerStemDataAmalgam = base::EventListenerID::invalid();
+    m_stemDataChannel = nullptr;
 
     return absl::OkStatus();
 }
 
 // ---------------------------------------------------------------------------------------------------------------------
-void StemDataProcessor::handleNewStemAmalgam( const base::IEvent& eventPtr )
+void StemDataProcessor::update( const float deltaTime, const float timeToDecayInSec )
 {
-    ABSL_ASSERT( eventPtr.getID() == events::StemDataAmalgamGenerated::ID );
+    const float decayValue = (1.0f / timeToDecayInSec) * deltaTime;
 
-    const events::StemDataAmalgamGenerated* stemDataEvent = dynamic_cast<const events::StemDataAmalgamGenerated*>(&eventPtr);
-    ABSL_ASSERT( stemDataEvent != nullptr );
+    m_stemAmalgamConsensus = std::max( 0.0f, m_stemAmalgamConsensus - decayValue );
 
-    m_stemAmalgam = stemDataEvent->m_stemDataAmalgam;
+    if ( m_stemDataChannel != nullptr &&
+         m_stemDataChannel->read( m_stemAmalgam ) )
+    {
+        handleNewStemAmalgam();
+    }
+}
 
+// ---------------------------------------------------------------------------------------------------------------------
+void StemDataProcessor::handleNewStemAmalgam()
+{
     int32_t simultaneousBeats = 0;
     for ( auto stemI = 0U; stemI < 8; stemI++ )
     {
@@ -8,7 +8,7 @@
 #pragma once
 
 #include "base/operations.h"
-#include "base/eventbus.h"
+#include "base/telemetry.h"
 
 #include "endlesss/toolkit.exchange.h"
 
@@ -32,6 +32,9 @@ struct StemDataAmalgam
     std::array< float, 8 >  m_high;
 };
 
+// mixer -> main thread route for the stem data blocks, written from inside the audio callback
+using StemDataChannel = base::TelemetryChannel< StemDataAmalgam >;
+
 // ---------------------------------------------------------------------------------------------------------------------
 struct StemDataProcessor
 {
@@ -40,9 +43,9 @@ struct StemDataProcessor
         reset();
     }
 
-    // add or remove listener for the stem amalgam message to update current state
-    absl::Status connect( base::EventBusPtr appEventBus );
-    absl::Status disconnect( base::EventBusPtr appEventBus );
+    // attach to / detach from the mixer's stem data channel; once connected, update() reads the latest block from it
+    absl::Status connect( StemDataChannel& stemDataChannel );
+    absl::Status disconnect();
 
     constexpr void reset()
     {
@@ -50,13 +53,8 @@ struct StemDataProcessor
         m_stemAmalgamConsensus = 0.0f;
     }
 
-    // tick value decays
-    constexpr void update( const float deltaTime, const float timeToDecayInSec )
-    {
-        const float decayValue = (1.0f / timeToDecayInSec) * deltaTime;
-
-        m_stemAmalgamConsensus = std::max( 0.0f, m_stemAmalgamConsensus - decayValue );
-    }
+    // pick up new stem data from the mixer, tick value decays
+    void update( const float deltaTime, const float timeToDecayInSec );
 
     // blit the current state into the given exchange data block
     constexpr void copyToExchangeData( endlesss::toolkit::Exchange& exchangeData )
@@ -78,23 +76,12 @@ struct StemDataProcessor
 
 protected:
 
-    base::EventListenerID                   m_eventListenerStemDataAmalgam = base::EventListenerID::invalid();
+    StemDataChannel*                        m_stemDataChannel = nullptr;
 
     StemDataAmalgam                         m_stemAmalgam;
     float                                   m_stemAmalgamConsensus;
 
-    void handleNewStemAmalgam( const base::IEvent& eventPtr );
+    void handleNewStemAmalgam();
 };
 
 } // namespace mix
-
-// ---------------------------------------------------------------------------------------------------------------------
-CREATE_EVENT_BEGIN( StemDataAmalgamGenerated )
-
-    StemDataAmalgamGenerated( const mix::StemDataAmalgam& amalgam )
-        : m_stemDataAmalgam( amalgam )
-    {}
-
-    mix::StemDataAmalgam        m_stemDataAmalgam;
-
-CREATE_EVENT_END()
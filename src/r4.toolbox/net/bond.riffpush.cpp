@@ -13,6 +13,10 @@
 
 #include "nlohmann/json.hpp"
 
+#include "cereal/archives/binary.hpp"
+#include "cereal/types/optional.hpp"
+#include "optional_binary.hpp"
+
 #include <websocketpp/config/asio_no_tls.hpp>
 #include <websocketpp/config/asio_no_tls_client.hpp>
 #include <websocketpp/client.hpp>
@@ -26,6 +30,64 @@ using ConnectionSet     = std::set<ConnectionHandle, std::owner_less<ConnectionH
 using ServerEndpoint    = websocketpp::server<websocketpp::config::asio>;
 using ClientEndpoint    = websocketpp::client<websocketpp::config::asio>;
 
+namespace {
+
+// leading tags on binary frames
+static constexpr char TagRiffPushBatch[4]       = { 'V', '3', 'R', 'B' };
+static constexpr char TagRiffPushPlayable[4]    = { 'V', '3', 'P', 'L' };
+
+inline int64_t steadyTimeUs()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>( std::chrono::steady_clock::now().time_since_epoch() ).count();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+template< typename _Message >
+std::string encodeMessage( const char ( &tag )[4], const _Message& message )
+{
+    std::ostringstream os( std::ios::binary );
+    os.write( tag, 4 );
+    {
+        cereal::BinaryOutputArchive archive( os );
+        archive( RiffPushProtocolVersion, message );
+    }
+    return os.str();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+template< typename _Message >
+absl::Status decodeMessage( const char ( &tag )[4], const std::string& payload, _Message& message )
+{
+    if ( payload.size() < 4 || memcmp( payload.data(), tag, 4 ) != 0 )
+        return absl::InvalidArgumentError( "unexpected message tag" );
+
+    try
+    {
+        std::istringstream is( payload.substr( 4 ), std::ios::binary );
+        cereal::BinaryInputArchive archive( is );
+
+        uint32_t protocolVersion = 0;
+        archive( protocolVersion );
+        if ( protocolVersion != RiffPushProtocolVersion )
+            return absl::UnimplementedError( fmt::format( "unsupported riff push protocol version {}", protocolVersion ) );
+
+        archive( message );
+    }
+    catch ( cereal::Exception& cEx )
+    {
+        return absl::DataLossError( fmt::format( "failed to decode riff push message; {}", cEx.what() ) );
+    }
+    // payloads come straight off the network; a corrupt or hostile length field can have cereal try to size a
+    // container to something absurd, which surfaces as bad_alloc / length_error rather than a cereal::Exception
+    catch ( std::exception& stdEx )
+    {
+        return absl::DataLossError( fmt::format( "riff push message rejected; {}", stdEx.what() ) );
+    }
+    return absl::OkStatus();
+}
+
+} // anonymous namespace
+
 
 
 // ---------------------------------------------------------------------------------------------------------------------
@@ -45,15 +107,37 @@ struct RiffPushServer::State
         {
             blog::app( "rp server opening connection" );
             m_connections.insert( hdl );
+
+            // messages are small and latency matters more than throughput; don't let Nagle sit on them
+            asio::error_code ec;
+            m_server.get_con_from_hdl( hdl )->get_raw_socket().set_option( asio::ip::tcp::no_delay( true ), ec );
         });
         m_server.set_close_handler( [this]( ConnectionHandle hdl )
         {
             blog::app( "rp server closing connection" );
             m_connections.erase( hdl );
+
+            // nobody left to tell about these
+            std::scoped_lock<std::mutex> pendingLock( m_pendingPlayableMutex );
+            for ( auto pendingIt = m_pendingPlayable.begin(); pendingIt != m_pendingPlayable.end(); )
+            {
+                const auto& connection = pendingIt->second.m_connection;
+                if ( !connection.owner_before( hdl ) && !hdl.owner_before( connection ) )
+                    m_pendingPlayable.erase( pendingIt++ );
+                else
+                    ++pendingIt;
+            }
         });
         m_server.set_message_handler( [this]( ConnectionHandle hdl, ServerEndpoint::message_ptr msg )
         {
-            const auto message = msg->get_payload();
+            const auto& message = msg->get_payload();
+
+            if ( msg->get_opcode() == websocketpp::frame::opcode::binary )
+            {
+                onRiffPushBatch( hdl, message );
+                return;
+            }
+
             blog::app( "rp server msg : {}", message );
 
             if ( message.starts_with("V2RP") && message.length() > 4 )
@@ -96,12 +180,15 @@ struct RiffPushServer::State
                     }
                 }
 
+                m_stats.m_riffsReceived++;
                 if ( m_riffPushCallback )
                 {
-                    m_riffPushCallback( 
-                        endlesss::types::JamCouchID( jamIDString ),
-                        endlesss::types::RiffCouchID( riffIDString ),
-                        permutationOpt );
+                    RiffPushEntry entry;
+                    entry.m_jamID       = endlesss::types::JamCouchID( jamIDString );
+                    entry.m_riffID      = endlesss::types::RiffCouchID( riffIDString );
+                    entry.m_permutation = permutationOpt;
+
+                    m_riffPushCallback( entry, 0 );
                 }
             }
         });
@@ -112,7 +199,7 @@ struct RiffPushServer::State
         std::ignore = stop();
     }
 
-    ouro_nodiscard absl::Status start()
+    ouro_nodiscard absl::Status start( const uint16_t port )
     {
         if ( m_serverRun )
         {
@@ -124,6 +211,7 @@ struct RiffPushServer::State
             return absl::AlreadyExistsError( "server already running" );
         }
 
+        m_serverPort    = port;
         m_serverState   = BondState::InFlux;
         m_serverRun     = true;
         m_serverThread  = std::make_unique<std::thread>( &State::serverThread, this );
@@ -156,6 +244,11 @@ struct RiffPushServer::State
         return m_serverState;
     }
 
+    ouro_nodiscard uint16_t getListeningPort() const
+    {
+        return m_listeningPort;
+    }
+
     void setRiffPushedCallback( const RiffPushCallback& cb )
     {
         m_riffPushCallback = cb;
@@ -166,17 +259,101 @@ struct RiffPushServer::State
         m_riffPushCallback = nullptr;
     }
 
+    void notifyRiffPlayable( const uint64_t pushID, const bool playable )
+    {
+        PendingPlayable pending;
+        {
+            std::scoped_lock<std::mutex> pendingLock( m_pendingPlayableMutex );
+
+            const auto pendingIt = m_pendingPlayable.find( pushID );
+            if ( pendingIt == m_pendingPlayable.end() )
+                return;
+
+            pending = pendingIt->second;
+            m_pendingPlayable.erase( pendingIt );
+        }
+
+        RiffPushPlayable reply;
+        reply.m_batchID         = pending.m_batchID;
+        reply.m_riffID          = pending.m_riffID;
+        reply.m_playable        = playable;
+        reply.m_clientSentAtUs  = pending.m_clientSentAtUs;
+        reply.m_serverHeldUs    = steadyTimeUs() - pending.m_receivedAtUs;
+
+        // connections are only touched from the server thread, hand the send over to it
+        asio::post( m_server.get_io_service(), [this, connection = pending.m_connection, payload = encodeMessage( TagRiffPushPlayable, reply )]()
+        {
+            websocketpp::lib::error_code ec;
+            m_server.send( connection, payload, websocketpp::frame::opcode::binary, ec );
+            if ( ec )
+                blog::error::app( "rp server failed to send playable notification; {}", ec.message() );
+        });
+    }
+
+    ouro_nodiscard RiffPushServer::Statistics getStatistics() const
+    {
+        RiffPushServer::Statistics result;
+        result.m_batchesReceived    = m_stats.m_batchesReceived;
+        result.m_riffsReceived      = m_stats.m_riffsReceived;
+        result.m_riffsPreResolved   = m_stats.m_riffsPreResolved;
+        result.m_decodeFailures     = m_stats.m_decodeFailures;
+        return result;
+    }
+
 private:
 
+    void onRiffPushBatch( ConnectionHandle hdl, const std::string& message )
+    {
+        RiffPushBatch batch;
+        if ( const auto decodeStatus = decodeMessage( TagRiffPushBatch, message, batch ); !decodeStatus.ok() )
+        {
+            blog::error::app( "V3RB {}", decodeStatus.ToString() );
+            m_stats.m_decodeFailures++;
+            return;
+        }
+
+        const int64_t receivedAtUs = steadyTimeUs();
+
+        // give every entry its own push ID, the same riff can be pushed again (even within one batch) before the
+        // first copy has finished loading and each one is owed its own reply
+        const uint64_t firstPushID = m_pushCounter.fetch_add( batch.m_entries.size() );
+
+        // register before handing off, the callback may well report a riff as playable before it returns
+        {
+            std::scoped_lock<std::mutex> pendingLock( m_pendingPlayableMutex );
+            for ( std::size_t entryI = 0; entryI < batch.m_entries.size(); entryI++ )
+            {
+                m_pendingPlayable.emplace( firstPushID + entryI,
+                    PendingPlayable{ hdl, batch.m_entries[entryI].m_riffID, batch.m_batchID, batch.m_clientSentAtUs, receivedAtUs } );
+            }
+        }
+
+        m_stats.m_batchesReceived++;
+        for ( std::size_t entryI = 0; entryI < batch.m_entries.size(); entryI++ )
+        {
+            const auto& entry = batch.m_entries[entryI];
+
+            m_stats.m_riffsReceived++;
+            if ( entry.m_resolved.has_value() )
+                m_stats.m_riffsPreResolved++;
+
+            if ( m_riffPushCallback )
+                m_riffPushCallback( entry, firstPushID + entryI );
+        }
+    }
+
     void serverThread()
     {
         OuroveonThreadScope ots( OURO_THREAD_PREFIX "RiffPushServer" );
 
         try
         {
-            m_server.listen( 9002 );
+            m_server.listen( m_serverPort );
             m_server.start_accept();
 
+            asio::error_code ec;
+            m_listeningPort = m_server.get_local_endpoint( ec ).port();
+
             blog::app( "RiffPushServer running ... " );
             while ( m_serverRun )
             {
@@ -187,6 +364,7 @@ private:
             m_serverState = BondState::InFlux;
 
             m_server.stop_listening();
+            m_listeningPort = 0;
         }
         catch ( websocketpp::exception const& e )
         {
@@ -209,12 +387,39 @@ private:
         }
     }
 
+    // binary-pushed riffs waiting to be reported back as playable, keyed by push ID
+    struct PendingPlayable
+    {
+        ConnectionHandle                m_connection;
+        endlesss::types::RiffCouchID    m_riffID;
+        uint64_t                        m_batchID           = 0;
+        int64_t                         m_clientSentAtUs    = 0;
+        int64_t                         m_receivedAtUs      = 0;
+    };
+    using PendingPlayableMap = absl::flat_hash_map< uint64_t, PendingPlayable >;
+
+    struct AtomicStatistics
+    {
+        std::atomic_uint64_t    m_batchesReceived   = 0;
+        std::atomic_uint64_t    m_riffsReceived     = 0;
+        std::atomic_uint64_t    m_riffsPreResolved  = 0;
+        std::atomic_uint64_t    m_decodeFailures    = 0;
+    };
+
     std::unique_ptr<std::thread>    m_serverThread;
     std::atomic_bool                m_serverRun     = false;
     std::atomic< BondState >        m_serverState   = BondState::Disconnected;
+    uint16_t                        m_serverPort    = RiffPushDefaultPort;
+    std::atomic_uint16_t            m_listeningPort = 0;
 
     RiffPushCallback                m_riffPushCallback;
 
+    std::mutex                      m_pendingPlayableMutex;
+    PendingPlayableMap              m_pendingPlayable;
+    std::atomic_uint64_t            m_pushCounter   = 1;    // 0 is reserved for pushes that can't be replied to
+
+    AtomicStatistics                m_stats;
+
     ServerEndpoint  m_server;
     ConnectionSet   m_connections;
 };
@@ -230,9 +435,9 @@ RiffPushServer::~RiffPushServer()
     
 }
 
-absl::Status RiffPushServer::start()
+absl::Status RiffPushServer::start( const uint16_t port )
 {
-    return m_state->start();
+    return m_state->start( port );
 }
 
 absl::Status RiffPushServer::stop()
@@ -245,6 +450,11 @@ BondState RiffPushServer::getState() const
     return m_state->getState();
 }
 
+uint16_t RiffPushServer::getListeningPort() const
+{
+    return m_state->getListeningPort();
+}
+
 void RiffPushServer::setRiffPushedCallback(const RiffPushCallback& cb)
 {
     m_state->setRiffPushedCallback( cb );
@@ -255,6 +465,16 @@ void RiffPushServer::clearRiffPushedCallback()
     m_state->clearRiffPushedCallback();
 }
 
+void RiffPushServer::notifyRiffPlayable( const uint64_t pushID, const bool playable )
+{
+    m_state->notifyRiffPlayable( pushID, playable );
+}
+
+RiffPushServer::Statistics RiffPushServer::getStatistics() const
+{
+    return m_state->getStatistics();
+}
+
 // ---------------------------------------------------------------------------------------------------------------------
 
 
@@ -277,6 +497,10 @@ struct RiffPushClient::State
         m_client.set_open_handler( [this]( ConnectionHandle hdl )
         {
             blog::app( "[RiffPushClient] -> connection opened" );
+
+            asio::error_code ec;
+            m_client.get_con_from_hdl( hdl )->get_raw_socket().set_option( asio::ip::tcp::no_delay( true ), ec );
+
             m_clientState = BondState::Connected;
         });
         m_client.set_close_handler( [this]( ConnectionHandle hdl )
@@ -297,6 +521,18 @@ struct RiffPushClient::State
         });
         m_client.set_message_handler( [this]( ConnectionHandle hdl, ServerEndpoint::message_ptr msg )
         {
+            if ( msg->get_opcode() == websocketpp::frame::opcode::binary )
+            {
+                RiffPushPlayable playable;
+                if ( const auto decodeStatus = decodeMessage( TagRiffPushPlayable, msg->get_payload(), playable ); !decodeStatus.ok() )
+                {
+                    blog::error::app( "[RiffPushClient] V3PL {}", decodeStatus.ToString() );
+                    return;
+                }
+                onRiffPlayable( playable );
+                return;
+            }
+
             blog::app( "[RiffPushClient] >> client msg : {}", msg->get_payload() );
         });
     }
@@ -361,30 +597,57 @@ struct RiffPushClient::State
         return m_clientState;
     }
 
-    void sendRiffID(
-        const endlesss::types::JamCouchID& jamID,
-        const endlesss::types::RiffCouchID& riffID,
-        const endlesss::types::RiffPlaybackPermutationOpt& permutationOpt )
+    ouro_nodiscard absl::Status sendBatch( std::vector< RiffPushEntry >&& entries )
     {
-        nlohmann::json msg = {
-            { "jam" , jamID.value() },
-            { "riff" , riffID.value() }
-        };
-        if ( permutationOpt.has_value() )
-        {
-            msg.emplace( "gains", permutationOpt->m_layerGainMultiplier );
-        }
+        if ( m_clientState != BondState::Connected )
+            return absl::UnavailableError( "client is not connected" );
+
+        if ( entries.empty() )
+            return absl::OkStatus();
+
+        RiffPushBatch batch;
+        batch.m_batchID         = ++m_batchCounter;
+        batch.m_clientSentAtUs  = steadyTimeUs();
+        batch.m_entries         = std::move( entries );
 
-        const std::string riffPushJson = "V2RP" + msg.dump();
+        websocketpp::lib::error_code ec;
         m_client.send( 
             m_clientConnectionHandle,
-            riffPushJson,
-            websocketpp::frame::opcode::text );
+            encodeMessage( TagRiffPushBatch, batch ),
+            websocketpp::frame::opcode::binary,
+            ec );
+
+        if ( ec )
+            return absl::UnknownError( fmt::format( "[RiffPushClient] send failed : {}", ec.message() ) );
+
+        return absl::OkStatus();
+    }
+
+    ouro_nodiscard RiffPushClient::LatencyStatistics getLatencyStatistics() const
+    {
+        std::scoped_lock<std::mutex> latencyLock( m_latencyMutex );
+        return m_latency;
     }
 
 
 private:
 
+    void onRiffPlayable( const RiffPushPlayable& playable )
+    {
+        const double roundTripMs = (double)( steadyTimeUs() - playable.m_clientSentAtUs ) / 1000.0;
+
+        std::scoped_lock<std::mutex> latencyLock( m_latencyMutex );
+
+        m_latency.m_acknowledged++;
+        if ( !playable.m_playable )
+            m_latency.m_unplayable++;
+
+        m_latency.m_lastMs              = roundTripMs;
+        m_latency.m_lastServerHeldMs    = (double)playable.m_serverHeldUs / 1000.0;
+        m_latency.m_averageMs          += ( roundTripMs - m_latency.m_averageMs ) / (double)m_latency.m_acknowledged;
+        m_latency.m_worstMs             = std::max( m_latency.m_worstMs, roundTripMs );
+    }
+
     void clientThreadStart()
     {
         // already running?
@@ -447,6 +710,11 @@ private:
     ClientEndpoint                  m_client;
     ClientEndpoint::connection_ptr  m_clientConnectionPtr;
     ConnectionHandle                m_clientConnectionHandle;
+
+    uint64_t                        m_batchCounter = 0;
+
+    mutable std::mutex                  m_latencyMutex;
+    RiffPushClient::LatencyStatistics   m_latency;
 };
 
 RiffPushClient::RiffPushClient( const std::string& appName )
@@ -475,14 +743,159 @@ BondState RiffPushClient::getState() const
     return m_state->getState();
 }
 
-void RiffPushClient::pushRiffById(
+absl::Status RiffPushClient::pushRiffById(
     const endlesss::types::JamCouchID& jamID,
     const endlesss::types::RiffCouchID& riffID,
     const endlesss::types::RiffPlaybackPermutationOpt& permutationOpt )
 {
-    m_state->sendRiffID( jamID, riffID, permutationOpt );
+    std::vector< RiffPushEntry > entries( 1 );
+    entries.front().m_jamID         = jamID;
+    entries.front().m_riffID        = riffID;
+    entries.front().m_permutation   = permutationOpt;
+
+    return m_state->sendBatch( std::move( entries ) );
+}
+
+absl::Status RiffPushClient::pushRiffBatch( std::vector< RiffPushEntry >&& entries )
+{
+    return m_state->sendBatch( std::move( entries ) );
+}
+
+RiffPushClient::LatencyStatistics RiffPushClient::getLatencyStatistics() const
+{
+    return m_state->getLatencyStatistics();
+}
+
+
+// ---------------------------------------------------------------------------------------------------------------------
+absl::StatusOr< RiffPushLoopbackResult > runRiffPushLoopbackTest(
+    const std::size_t batchCount,
+    const std::size_t riffsPerBatch,
+    const std::chrono::milliseconds timeout )
+{
+    const auto timeStart = std::chrono::steady_clock::now();
+    const auto waitFor = [&]( const std::function<bool()>& condition )
+    {
+        while ( !condition() )
+        {
+            if ( std::chrono::steady_clock::now() - timeStart > timeout )
+                return false;
+            std::this_thread::sleep_for( std::chrono::milliseconds( 5 ) );
+        }
+        return true;
+    };
+
+    // build everything we intend to send up-front so the server callback can check against it without locking
+    std::vector< std::vector< RiffPushEntry > > batches( batchCount );
+    absl::flat_hash_map< endlesss::types::RiffCouchID, const RiffPushEntry* > expectedByRiff;
+    for ( std::size_t batchI = 0; batchI < batchCount; batchI++ )
+    {
+        for ( std::size_t riffI = 0; riffI < riffsPerBatch; riffI++ )
+        {
+            RiffPushEntry& entry = batches[batchI].emplace_back();
+            entry.m_jamID   = endlesss::types::JamCouchID( "loopback_jam" );
+            entry.m_riffID  = endlesss::types::RiffCouchID( fmt::format( "loopback_riff_{}_{}", batchI, riffI ) );
+
+            if ( riffI & 1 )
+            {
+                endlesss::types::RiffPlaybackPermutation permutation;
+                permutation.m_layerGainMultiplier[riffI % 8] = 0.5f;
+                entry.m_permutation = permutation;
+
+                endlesss::types::RiffComplete resolved;
+                resolved.jam.couchID        = entry.m_jamID;
+                resolved.jam.displayName    = "Loopback";
+                resolved.riff.couchID       = entry.m_riffID;
+                resolved.riff.jamCouchID    = entry.m_jamID;
+                resolved.riff.BPS           = 2.0f;
+                resolved.riff.stemsOn[riffI % 8] = true;
+                resolved.stems[riffI % 8].couchID = endlesss::types::StemCouchID( fmt::format( "loopback_stem_{}_{}", batchI, riffI ) );
+                entry.m_resolved = std::move( resolved );
+            }
+        }
+    }
+    for ( const auto& batch : batches )
+        for ( const auto& entry : batch )
+            expectedByRiff.emplace( entry.m_riffID, &entry );
+
+    RiffPushLoopbackResult result;
+
+    RiffPushServer server;
+    server.setRiffPushedCallback( [&]( const RiffPushEntry& entry, const uint64_t pushID )
+    {
+        const auto expectedIt = expectedByRiff.find( entry.m_riffID );
+
+        bool matches = ( expectedIt != expectedByRiff.end() );
+        if ( matches )
+        {
+            const RiffPushEntry& expected = *expectedIt->second;
+
+            matches = ( entry.m_jamID == expected.m_jamID ) &&
+                      ( entry.m_permutation.has_value() == expected.m_permutation.has_value() ) &&
+                      ( entry.m_resolved.has_value() == expected.m_resolved.has_value() );
+
+            if ( matches && entry.m_permutation.has_value() )
+                matches = ( entry.m_permutation->m_layerGainMultiplier == expected.m_permutation->m_layerGainMultiplier );
+
+            if ( matches && entry.m_resolved.has_value() )
+            {
+                matches = ( entry.m_resolved->riff.couchID == expected.m_resolved->riff.couchID ) &&
+                          ( entry.m_resolved->riff.stemsOn == expected.m_resolved->riff.stemsOn ) &&
+                          ( entry.m_resolved->riff.BPS     == expected.m_resolved->riff.BPS );
+
+                for ( std::size_t stemI = 0; matches && stemI < 8; stemI++ )
+                    matches = ( entry.m_resolved->stems[stemI].couchID == expected.m_resolved->stems[stemI].couchID );
+            }
+        }
+        if ( !matches )
+            result.m_riffsMismatched++;
+
+        // nothing to actually load; report straight back
+        server.notifyRiffPlayable( pushID, true );
+    });
+
+    // port 0 has the OS choose a free one, read back what we got once the server is up
+    if ( const auto startStatus = server.start( 0 ); !startStatus.ok() )
+        return startStatus;
+
+    if ( !waitFor( [&]{ return server.getState() == BondState::Connected; } ) )
+        return absl::DeadlineExceededError( "loopback server did not start" );
+
+    const uint16_t port = server.getListeningPort();
+    if ( port == 0 )
+        return absl::UnavailableError( "loopback server did not report a listening port" );
+
+    RiffPushClient client( "loopback" );
+    if ( const auto connectStatus = client.connect( fmt::format( "ws://127.0.0.1:{}", port ) ); !connectStatus.ok() )
+        return connectStatus;
+
+    if ( !waitFor( [&]{ return client.getState() == BondState::Connected; } ) )
+        return absl::DeadlineExceededError( "loopback client did not connect" );
+
+    for ( const auto& batch : batches )
+    {
+        result.m_riffsSent += batch.size();
+        // send a copy, the server callback is still checking against the originals
+        if ( const auto pushStatus = client.pushRiffBatch( std::vector< RiffPushEntry >( batch ) ); !pushStatus.ok() )
+            return pushStatus;
+    }
+
+    const bool allAcknowledged = waitFor( [&]{ return client.getLatencyStatistics().m_acknowledged >= result.m_riffsSent; } );
+
+    const auto serverStats = server.getStatistics();
+    result.m_riffsReceived      = serverStats.m_riffsReceived;
+    result.m_riffsPreResolved   = serverStats.m_riffsPreResolved;
+    result.m_latency            = client.getLatencyStatistics();
+
+    std::ignore = client.disconnect();
+    waitFor( [&]{ return client.getState() == BondState::Disconnected; } );
+    std::ignore = server.stop();
+
+    if ( !allAcknowledged )
+        blog::error::app( "riff push loopback timed out with {} of {} riffs acknowledged", result.m_latency.m_acknowledged, result.m_riffsSent );
+
+    return result;
 }
 
 } // namespace bond
 } // namespace net
-
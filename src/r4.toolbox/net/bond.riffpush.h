@@ -21,23 +21,118 @@ enum BondState
     Connected
 };
 
+// ---------------------------------------------------------------------------------------------------------------------
+// riff push wire format; binary websocket frames holding a 4-byte tag and a protocol version followed by a cereal
+// binary archive of the message. the older "V2RP" JSON text messages are still understood by the server
+//
+struct RiffPushEntry
+{
+    endlesss::types::JamCouchID                     m_jamID;
+    endlesss::types::RiffCouchID                    m_riffID;
+    endlesss::types::RiffPlaybackPermutationOpt     m_permutation;
+
+    // optionally the full riff metadata, as the sender usually has it already; lets the receiver skip resolving
+    // the riff & stems from the network itself
+    std::optional< endlesss::types::RiffComplete >  m_resolved;
+
+    template<class Archive>
+    inline void serialize( Archive& archive )
+    {
+        archive( m_jamID
+               , m_riffID
+               , m_permutation
+               , m_resolved
+        );
+        // parts of the riff metadata that its own serialize() doesn't cover, but that playback needs
+        if ( m_resolved.has_value() )
+        {
+            archive( m_resolved->riff.stemsOn
+                   , m_resolved->riff.description
+                   , m_resolved->jam.description
+            );
+        }
+    }
+};
+
+// client -> server; one or more riffs to queue, in order
+struct RiffPushBatch
+{
+    uint64_t                        m_batchID           = 0;
+    int64_t                         m_clientSentAtUs    = 0;    // sender's steady clock, echoed back in RiffPushPlayable
+    std::vector< RiffPushEntry >    m_entries;
+
+    template<class Archive>
+    inline void serialize( Archive& archive )
+    {
+        archive( m_batchID
+               , m_clientSentAtUs
+               , m_entries
+        );
+    }
+};
+
+// server -> client; sent once per pushed riff when it has been loaded and handed to the mixer (or failed to be)
+// so the client can measure push-to-playable time against its own clock
+struct RiffPushPlayable
+{
+    uint64_t                        m_batchID           = 0;
+    endlesss::types::RiffCouchID    m_riffID;
+    bool                            m_playable          = false;
+    int64_t                         m_clientSentAtUs    = 0;    // as sent in the RiffPushBatch
+    int64_t                         m_serverHeldUs      = 0;    // time from the server receiving the batch to this riff being playable
+
+    template<class Archive>
+    inline void serialize( Archive& archive )
+    {
+        archive( m_batchID
+               , m_riffID
+               , m_playable
+               , m_clientSentAtUs
+               , m_serverHeldUs
+        );
+    }
+};
+
+static constexpr uint32_t RiffPushProtocolVersion = 1;
+static constexpr uint16_t RiffPushDefaultPort     = 9002;
+
 // ---------------------------------------------------------------------------------------------------------------------
 struct RiffPushServer
 {
-    using RiffPushCallback = std::function< void( const endlesss::types::JamCouchID&, const endlesss::types::RiffCouchID&, const endlesss::types::RiffPlaybackPermutationOpt& permutationOpt ) >;
+    // called from the server thread for each riff received, in the order they were pushed; `pushID` is unique to
+    // this arrival of the riff and is what to hand back to notifyRiffPlayable(). riffs pushed with the older text
+    // protocol have nobody to notify and get a pushID of 0
+    using RiffPushCallback = std::function< void( const RiffPushEntry&, const uint64_t pushID ) >;
+
+    struct Statistics
+    {
+        uint64_t    m_batchesReceived   = 0;
+        uint64_t    m_riffsReceived     = 0;
+        uint64_t    m_riffsPreResolved  = 0;    // arrived with metadata attached
+        uint64_t    m_decodeFailures    = 0;
+    };
 
     DECLARE_NO_COPY_NO_MOVE( RiffPushServer );
 
     RiffPushServer();
     ~RiffPushServer();
 
-    ouro_nodiscard absl::Status start();
+    ouro_nodiscard absl::Status start( const uint16_t port = RiffPushDefaultPort );
     ouro_nodiscard absl::Status stop();
     ouro_nodiscard BondState getState() const;
 
+    // port the server is listening on once connected; useful when started on port 0 to let the OS pick one
+    ouro_nodiscard uint16_t getListeningPort() const;
+
     void setRiffPushedCallback( const RiffPushCallback& cb );
     void clearRiffPushedCallback();
 
+    // report back to whichever client made push `pushID` that its riff is now loaded and playing (or couldn't be
+    // loaded); safe to call from any thread, does nothing if the riff didn't arrive via a binary push
+    void notifyRiffPlayable( const uint64_t pushID, const bool playable );
+
+    ouro_nodiscard Statistics getStatistics() const;
+
 private:
     struct State;
     std::unique_ptr< State >    m_state;
@@ -48,6 +143,17 @@ struct RiffPushClient
 {
     DECLARE_NO_COPY_NO_MOVE( RiffPushClient );
 
+    // round-trip times from sending a riff to the server reporting it playable
+    struct LatencyStatistics
+    {
+        uint64_t    m_acknowledged      = 0;
+        uint64_t    m_unplayable        = 0;    // server reported a failure to load
+        double      m_lastMs            = 0;
+        double      m_averageMs         = 0;
+        double      m_worstMs           = 0;
+        double      m_lastServerHeldMs  = 0;    // portion of the last round-trip spent on the server loading the riff
+    };
+
     RiffPushClient( const std::string& appName );
     ~RiffPushClient();
 
@@ -55,23 +161,62 @@ struct RiffPushClient
     ouro_nodiscard absl::Status disconnect();
     ouro_nodiscard BondState getState() const;
 
-    inline void pushRiff(
+    // send the full riff metadata along with the IDs so the server needn't resolve it again
+    inline absl::Status pushRiff(
         const endlesss::types::RiffComplete& riff,
         const endlesss::types::RiffPlaybackPermutationOpt& permutationOpt )
     {
-        pushRiffById( riff.jam.couchID, riff.riff.couchID, permutationOpt );
+        std::vector< RiffPushEntry > entries( 1 );
+        entries.front().m_jamID         = riff.jam.couchID;
+        entries.front().m_riffID        = riff.riff.couchID;
+        entries.front().m_permutation   = permutationOpt;
+        entries.front().m_resolved      = riff;
+
+        return pushRiffBatch( std::move( entries ) );
     }
 
-    void pushRiffById( 
+    absl::Status pushRiffById( 
         const endlesss::types::JamCouchID& jamID,
         const endlesss::types::RiffCouchID& riffID,
         const endlesss::types::RiffPlaybackPermutationOpt& permutationOpt );
 
+    // send a group of riffs in a single message, to be queued on the server in order
+    absl::Status pushRiffBatch( std::vector< RiffPushEntry >&& entries );
+
+    ouro_nodiscard LatencyStatistics getLatencyStatistics() const;
+
 private:
     struct State;
     std::unique_ptr< State >    m_state;
 };
 
+// ---------------------------------------------------------------------------------------------------------------------
+// run a server and client against each other on the loopback interface, pushing batches of riffs (half of them with
+// pre-resolved metadata) and waiting for every one to be acknowledged as playable. the server listens on whatever
+// free port the OS hands out so the test can't collide with a running server
+//
+struct RiffPushLoopbackResult
+{
+    uint64_t                            m_riffsSent         = 0;
+    uint64_t                            m_riffsReceived     = 0;
+    uint64_t                            m_riffsPreResolved  = 0;
+    uint64_t                            m_riffsMismatched   = 0;    // arrived with different IDs or metadata to what was sent
+    RiffPushClient::LatencyStatistics   m_latency;
+
+    ouro_nodiscard constexpr bool passed() const
+    {
+        return m_riffsSent > 0 &&
+               m_riffsReceived == m_riffsSent &&
+               m_riffsMismatched == 0 &&
+               m_latency.m_acknowledged == m_riffsSent;
+    }
+};
+
+absl::StatusOr< RiffPushLoopbackResult > runRiffPushLoopbackTest(
+    const std::size_t batchCount,
+    const std::size_t riffsPerBatch,
+    const std::chrono::milliseconds timeout );
+
 } // namespace bond
 } // namespace net
 
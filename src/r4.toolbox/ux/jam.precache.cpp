@@ -158,11 +158,12 @@ void JamPrecacheState::imgui(
                 bool bFoundStemData = warehouse.fetchSingleStemByID( stemID, stemData );
                 if ( bFoundStemData )
                 {
-                    const fs::path stemCachePath = fetchProvider->getStemCache().getCachePathForStem( stemData );
+                    const auto& stemCache = fetchProvider->getStemCache();
+                    const fs::path stemCachePath = stemCache.getCachePathForStem( stemData );
 
-                    // early out if the stem already exists in the cache -- although this is checked in the stem-live code,
-                    // saves on allocation and work if we check it here too
-                    if ( fs::exists( stemCachePath / stemData.couchID.value() ) )
+                    // early out if the stem already exists in the cache (or stem pack) -- although this is checked in
+                    // the stem-live code, saves on allocation and work if we check it here too
+                    if ( stemCache.isCached( stemData ) )
                     {
                         m_statsStemsAlreadyInCache++;
                     }
@@ -170,16 +171,30 @@ void JamPrecacheState::imgui(
                     {
                         ++m_downloadsDispatched;
 
-                        // kick out an untethered async task to initialise a live Stem object
-                        // doing so will go through the default machinery of downloading / validating it, same as
-                        // when we do this for playing riffs back in the rest of the app - difference being that 
-                        // we don't keep the live Stem around, it's just immediately tossed
-                        taskExecutor.silent_async( [=]()
+                        // kick out an untethered async task to pull the stem through the stem cache; this goes through
+                        // the default machinery of downloading / validating it, same as when we do this for playing riffs
+                        // back in the rest of the app - difference being that we don't keep the live Stem around.
+                        // claiming it the same way riff loading does means a riff asking for this stem while we are busy
+                        // with it waits for our download rather than starting a second one (and vice versa)
+                        taskExecutor.silent_async( [=]() mutable
                             {
-                                auto stemLivePtr = std::make_shared<endlesss::live::Stem>( stemData, 8000 );   // any sample rate is fine, we aren't keeping the data
-                                stemLivePtr->fetch(
-                                    fetchProvider->getNetConfiguration(),
-                                    stemCachePath );
+                                auto& liveStemCache = fetchProvider->getStemCache();
+
+                                endlesss::live::StemPtr stemLivePtr = liveStemCache.request( stemData );
+                                if ( stemLivePtr->claimFetch() )
+                                {
+                                    stemLivePtr->fetch(
+                                        fetchProvider->getNetConfiguration(),
+                                        stemCachePath );
+
+                                    // with progressive decoding the cache copy is only written once the whole stream
+                                    // has decoded, so see it through
+                                    stemLivePtr->completeDecode();
+                                }
+                                else
+                                {
+                                    stemLivePtr->waitForFetch();
+                                }
 
                                 if ( stemLivePtr->hasFailed() )
                                 {
@@ -191,6 +206,11 @@ void JamPrecacheState::imgui(
                                     ++m_statsStemsDownloaded;
                                 }
 
+                                // don't let precaching a whole jam fill the live stem cache; unless a riff picked this
+                                // stem up meanwhile, drop it again now it is safely on disk
+                                stemLivePtr.reset();
+                                liveStemCache.releaseIfUnused( stemData );
+
                                 // tag that we are done with this task so that the cycle can kick more off
                                 --m_downloadsDispatched;
                             } );
@@ -7,9 +7,12 @@
 
 #include "pch.h"
 
+#include "app/imgui.ext.h"
 #include "app/module.frontend.fonts.h"
+#include "base/text.h"
 #include "colour/preset.h"
 #include "endlesss/all.h"
+#include "spacetime/moment.h"
 
 namespace ImGui {
 namespace ux {
@@ -26,8 +29,200 @@ struct StemAnalysisState
 
     endlesss::live::Stem::Processing::UPtr  m_processing;
     endlesss::live::StemAnalysisData        m_analysis;
+    endlesss::live::StemAnalysisData::Accuracy
+                                            m_analysisAccuracy;
+
+    // plotting reads straight from the stem's shared float samples where it still has them; compact storage
+    // formats don't keep those around, so fall back to a decoded copy of the left channel
+    endlesss::live::StemSlab::Ptr           m_waveformSlab;
+    std::vector< float >                    m_waveform;
+
+    // comparison of the in-memory stem storage formats against the currently selected stem
+    struct StorageBenchmarkResult
+    {
+        config::StemStorageFormat::Enum     m_format;
+        std::size_t                         m_bytes;
+        double                              m_encodeMs;
+        double                              m_decodeUsPerCallback;
+        double                              m_snrDb;
+    };
+    std::vector< StorageBenchmarkResult >   m_storageBenchmark;
+
+    // per-sample beat queries vs. one range query per callback, as the mixers would issue them
+    struct BeatQueryBenchmarkResult
+    {
+        int32_t                             m_callbackFrames;
+        double                              m_perSampleUsPerCallback;
+        double                              m_rangeUsPerCallback;
+        int32_t                             m_missed;           // callbacks where the range query missed a per-sample beat
+        int32_t                             m_recovered;        // .. and where it found one a stretched per-sample walk skipped
+    };
+    std::vector< BeatQueryBenchmarkResult > m_beatQueryBenchmark;
 };
 
+// ---------------------------------------------------------------------------------------------------------------------
+// encode the stem in each storage format, then replay it through a StemReader in callback-sized chunks to measure
+// the per-callback decode cost against the memory each format needs
+static void runStorageBenchmark( const endlesss::live::Stem& liveStem, std::vector< StemAnalysisState::StorageBenchmarkResult >& results )
+{
+    using namespace endlesss::live;
+
+    static constexpr int32_t callbackFrames = 512;
+
+    const int32_t sampleCount = liveStem.m_sampleCount;
+
+    // reference data is whatever the stem currently holds; only truly lossless if the app is running with Float32
+    std::vector< float > referenceLeft( sampleCount ), referenceRight( sampleCount );
+    liveStem.getStorage().decode( referenceLeft.data(), referenceRight.data() );
+
+    results.clear();
+
+    META_FOREACH( config::StemStorageFormat, format )
+    {
+        StemAnalysisState::StorageBenchmarkResult result;
+        result.m_format = format;
+
+        StemStorage storage;
+        {
+            spacetime::Moment encodeTimer;
+            storage.encode( format, referenceLeft.data(), referenceRight.data(), sampleCount );
+            result.m_encodeMs = (double)encodeTimer.delta< std::chrono::microseconds >().count() / 1000.0;
+        }
+        result.m_bytes = ( format == config::StemStorageFormat::Float32 ) ?
+            ( static_cast<std::size_t>( sampleCount ) * 2 * sizeof( float ) ) :
+            storage.estimateMemoryUsageBytes();
+
+        StemReader reader;
+        std::vector< float > decodedLeft( sampleCount ), decodedRight( sampleCount );
+
+        int32_t callbackCount = 0;
+
+        spacetime::Moment decodeTimer;
+        for ( int32_t callbackStart = 0; callbackStart < sampleCount; callbackStart += callbackFrames, callbackCount++ )
+        {
+            const int32_t callbackEnd = std::min( callbackStart + callbackFrames, sampleCount );
+            for ( int32_t sI = callbackStart; sI < callbackEnd; sI++ )
+            {
+                reader.read( storage, sI, decodedLeft[sI], decodedRight[sI] );
+            }
+        }
+        const double decodeUs = (double)decodeTimer.delta< std::chrono::microseconds >().count();
+
+        double signalPower = 0;
+        double noisePower  = 0;
+        for ( int32_t sI = 0; sI < sampleCount; sI++ )
+        {
+            const double errorLeft  = (double)decodedLeft[sI]  - (double)referenceLeft[sI];
+            const double errorRight = (double)decodedRight[sI] - (double)referenceRight[sI];
+
+            signalPower += ( (double)referenceLeft[sI] * (double)referenceLeft[sI] ) + ( (double)referenceRight[sI] * (double)referenceRight[sI] );
+            noisePower  += ( errorLeft * errorLeft ) + ( errorRight * errorRight );
+        }
+
+        result.m_decodeUsPerCallback = callbackCount > 0 ? ( decodeUs / (double)callbackCount ) : 0.0;
+        result.m_snrDb = ( noisePower > 0.0 ) ? ( 10.0 * std::log10( signalPower / noisePower ) ) : std::numeric_limits<double>::infinity();
+
+        blog::app( FMTX( "[stem storage] {:>8} : {:>10} bytes, encode {:.2f} ms, {:.2f} us per {}-frame callback, SNR {:.1f} dB" ),
+            config::StemStorageFormat::toString( format ),
+            result.m_bytes,
+            result.m_encodeMs,
+            result.m_decodeUsPerCallback,
+            callbackFrames,
+            result.m_snrDb );
+
+        results.emplace_back( result );
+    }
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+// walk the stem in callback-sized chunks asking "was there a beat in this chunk" both one sample at a time and with a
+// single range query, timing each and checking the range query never misses a beat the per-sample walk finds
+static void runBeatQueryBenchmark(
+    const endlesss::live::Stem& liveStem,
+    const endlesss::live::StemAnalysisData& analysis,
+    std::vector< StemAnalysisState::BeatQueryBenchmarkResult >& results )
+{
+    static constexpr std::array< int32_t, 5 > callbackSizes  = { 64, 128, 256, 512, 1024 };
+    static constexpr std::array< float, 3 >   timeStretches  = { 0.5f, 1.0f, 2.0f };
+
+    const int64_t sampleCount = liveStem.m_sampleCount;
+
+    // play through a few loops' worth so the wrap is exercised and timings are large enough to mean something
+    const int64_t playbackLength = sampleCount * 4;
+
+    results.clear();
+
+    for ( const int32_t callbackFrames : callbackSizes )
+    {
+        StemAnalysisState::BeatQueryBenchmarkResult result;
+        result.m_callbackFrames = callbackFrames;
+        result.m_missed         = 0;
+        result.m_recovered      = 0;
+
+        int64_t callbackCount  = 0;
+        int64_t perSampleUs    = 0;
+        int64_t rangeUs        = 0;
+        int32_t beatsSeen      = 0;     // consumed so the timed loops can't be optimised away
+
+        for ( const float timeStretch : timeStretches )
+        {
+            std::vector< uint8_t > perSampleHits;
+            perSampleHits.reserve( ( playbackLength / callbackFrames ) + 1 );
+
+            {
+                spacetime::Moment perSampleTimer;
+                for ( int64_t callbackStart = 0; callbackStart < playbackLength; callbackStart += callbackFrames )
+                {
+                    const int64_t callbackEnd = std::min( callbackStart + callbackFrames, playbackLength );
+
+                    bool hasBeat = false;
+                    for ( int64_t sI = callbackStart; sI < callbackEnd; sI++ )
+                    {
+                        const int64_t stemSample = ( timeStretch == 1.0f ) ? sI : static_cast<int64_t>( (double)sI * timeStretch );
+                        hasBeat |= analysis.queryBeatAtSample( stemSample % sampleCount );
+                    }
+                    perSampleHits.emplace_back( hasBeat ? 1 : 0 );
+                }
+                perSampleUs += perSampleTimer.delta< std::chrono::microseconds >().count();
+            }
+            {
+                std::size_t callbackIndex = 0;
+
+                spacetime::Moment rangeTimer;
+                for ( int64_t callbackStart = 0; callbackStart < playbackLength; callbackStart += callbackFrames, callbackIndex++ )
+                {
+                    const int64_t callbackEnd = std::min( callbackStart + callbackFrames, playbackLength );
+
+                    const bool hasBeat = analysis.queryBeatInPlayback( callbackStart, callbackEnd - callbackStart, timeStretch, sampleCount );
+                    const bool perSampleBeat = ( perSampleHits[callbackIndex] != 0 );
+                    if ( perSampleBeat && !hasBeat )
+                        result.m_missed++;
+                    if ( hasBeat && !perSampleBeat )
+                        result.m_recovered++;
+
+                    beatsSeen += hasBeat ? 1 : 0;
+                }
+                rangeUs += rangeTimer.delta< std::chrono::microseconds >().count();
+
+                callbackCount += (int64_t)callbackIndex;
+            }
+        }
+
+        result.m_perSampleUsPerCallback = callbackCount > 0 ? ( (double)perSampleUs / (double)callbackCount ) : 0.0;
+        result.m_rangeUsPerCallback     = callbackCount > 0 ? ( (double)rangeUs     / (double)callbackCount ) : 0.0;
+
+        blog::app( FMTX( "[beat query] {:>4}-frame callbacks : per-sample {:.3f} us, range {:.3f} us, {} missed, {} recovered ({} beat callbacks)" ),
+            callbackFrames,
+            result.m_perSampleUsPerCallback,
+            result.m_rangeUsPerCallback,
+            result.m_missed,
+            result.m_recovered,
+            beatsSeen );
+
+        results.emplace_back( result );
+    }
+}
+
 void StemAnalysis( endlesss::live::RiffPtr& liveRiff, const int32_t audioSampleRate )
 {
     static StemAnalysisState state;
@@ -49,6 +244,8 @@ void StemAnalysis( endlesss::live::RiffPtr& liveRiff, const int32_t audioSampleR
         {
             state.m_currentRiffID = liveRiff->m_riffData.riff.couchID;
             state.m_runAnalysis = true;
+            state.m_storageBenchmark.clear();
+            state.m_beatQueryBenchmark.clear();
         }
 
         if ( ImGui::InputFloat( "Peak Follow Duration", &state.m_processing->m_tuning.m_beatFollowDuration, 0.01f, 0.05f, "%.3f", ImGuiInputTextFlags_EnterReturnsTrue ) )
@@ -60,7 +257,11 @@ void StemAnalysis( endlesss::live::RiffPtr& liveRiff, const int32_t audioSampleR
         if ( ImGui::InputFloat( "Tracker Hysteresis", &state.m_processing->m_tuning.m_trackerHysteresis, 0.01f, 0.05f, "%.3f", ImGuiInputTextFlags_EnterReturnsTrue ) )
             state.m_runAnalysis = true;
         if ( ImGui::SliderInt( "Stem", &state.m_stemIndex, 1, 8 ) )
+        {
             state.m_runAnalysis = true;
+            state.m_storageBenchmark.clear();
+            state.m_beatQueryBenchmark.clear();
+        }
 
         // load requested stem from riff
         const endlesss::live::Stem* liveStem = liveRiff->m_stemPtrs[state.m_stemIndex - 1];
@@ -87,7 +288,20 @@ void StemAnalysis( endlesss::live::RiffPtr& liveRiff, const int32_t audioSampleR
         // constantly update a local analysis chunk
         if ( state.m_runAnalysis )
         {
-            liveStem->analyse( *state.m_processing, state.m_analysis );
+            liveStem->analyse( *state.m_processing, state.m_analysis, &state.m_analysisAccuracy );
+
+            state.m_waveformSlab = liveStem->getSampleSlab();
+            if ( state.m_waveformSlab == nullptr )
+            {
+                std::vector< float > discardRight( liveStem->m_sampleCount );
+                state.m_waveform.resize( liveStem->m_sampleCount );
+                liveStem->getStorage().decode( state.m_waveform.data(), discardRight.data() );
+            }
+            else
+            {
+                state.m_waveform = {};
+            }
+
             state.m_runAnalysis = false;
         }
 
@@ -97,7 +311,8 @@ void StemAnalysis( endlesss::live::RiffPtr& liveRiff, const int32_t audioSampleR
             ImPlot::SetupAxis( ImAxis_Y1, nullptr, ImPlotAxisFlags_NoDecorations | ImPlotAxisFlags_LockMin );
 
             ImPlot::SetNextFillStyle( colour::shades::blue_gray.dark(), 0.8f );
-            ImPlot::PlotBars( "##waveform", liveStem->m_channel[0], steppedSampleCount, 0.67, 0, 0, 0, sizeof(float) * sampleStep );
+            const float* waveform = ( state.m_waveformSlab != nullptr ) ? state.m_waveformSlab->getChannel( 0 ).data() : state.m_waveform.data();
+            ImPlot::PlotBars( "##waveform", waveform, steppedSampleCount, 0.67, 0, 0, 0, sizeof(float) * sampleStep );
 
             ImPlot::EndPlot();
         }
@@ -118,37 +333,136 @@ void StemAnalysis( endlesss::live::RiffPtr& liveRiff, const int32_t audioSampleR
 
             ImPlot::SetNextFillStyle( colour::shades::toast.neutral() );
 
+            // envelopes hold one entry per block, so step through them at the equivalent rate
+            static constexpr int32_t envelopeStep = sampleStep >> endlesss::live::StemAnalysisData::EnvelopeShift;
+            static_assert( envelopeStep > 0 );
+
             switch ( state.m_dataView )
             {
             case 0:
-                ImPlot::PlotBars( "##energy", state.m_analysis.m_psaWave.data(), steppedSampleCount, 0.67, 0, 0, 0, sizeof( uint8_t ) * sampleStep );
+                ImPlot::PlotBars( "##energy", state.m_analysis.m_envWave.data(), steppedSampleCount, 0.67, 0, 0, 0, sizeof( uint8_t ) * envelopeStep );
                 break;
             case 1:
-                ImPlot::PlotBars( "##energy", state.m_analysis.m_psaBeat.data(), steppedSampleCount, 0.67, 0, 0, 0, sizeof( uint8_t ) * sampleStep );
+                ImPlot::PlotBars( "##energy", state.m_analysis.m_envBeat.data(), steppedSampleCount, 0.67, 0, 0, 0, sizeof( uint8_t ) * envelopeStep );
                 break;
             case 2:
-                ImPlot::PlotBars( "##energy", state.m_analysis.m_psaLowFreq.data(), steppedSampleCount, 0.67, 0, 0, 0, sizeof( uint8_t ) * sampleStep );
+                ImPlot::PlotBars( "##energy", state.m_analysis.m_envLowFreq.data(), steppedSampleCount, 0.67, 0, 0, 0, sizeof( uint8_t ) * envelopeStep );
                 break;
             case 3:
-                ImPlot::PlotBars( "##energy", state.m_analysis.m_psaHighFreq.data(), steppedSampleCount, 0.67, 0, 0, 0, sizeof( uint8_t ) * sampleStep );
+                ImPlot::PlotBars( "##energy", state.m_analysis.m_envHighFreq.data(), steppedSampleCount, 0.67, 0, 0, 0, sizeof( uint8_t ) * envelopeStep );
                 break;
             }
 
-            for ( auto aI = 0; aI < state.m_analysis.m_beatBitfield.size(); aI++ )
+            for ( const auto onset : state.m_analysis.m_beatOnsets )
+            {
+                ImPlot::OverlayLineX( (float)onset / (float)sampleStep, colour::shades::lime.neutral(0.6f) );
+            }
+
+            ImPlot::EndPlot();
+        }
+
+        // how closely the stored envelopes track the per-sample data the analysis pass generated
+        {
+            const auto& accuracy = state.m_analysisAccuracy;
+
+            ImGui::Text( "Analysis data : %s (per-sample would be %s), %lli beats, %lli query mismatches",
+                base::humaniseByteSize( "", accuracy.m_compactBytes ).c_str(),
+                base::humaniseByteSize( "", accuracy.m_perSampleBytes ).c_str(),
+                accuracy.m_beatOnsetCount,
+                accuracy.m_beatQueryMismatches );
+
+            if ( ImGui::BeginTable( "##analysis_accuracy", 5, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg ) )
             {
-                for ( int32_t bI = 0; bI < 64; bI++ )
+                ImGui::TableSetupColumn( "Error" );
+                ImGui::TableSetupColumn( "Wave" );
+                ImGui::TableSetupColumn( "Beat" );
+                ImGui::TableSetupColumn( "Low Freq" );
+                ImGui::TableSetupColumn( "High Freq" );
+                ImGui::TableHeadersRow();
+
+                ImGui::TableNextColumn(); ImGui::TextUnformatted( "Mean" );
+                for ( const auto error : accuracy.m_meanError )
                 {
-                    if ( state.m_analysis.m_beatBitfield[aI] & 1ULL << bI )
-                    {
-                        uint64_t bitSample = ( ( aI * 64 ) + bI );
-                        ImPlot::OverlayLineX( (float)bitSample / (float)sampleStep, colour::shades::lime.neutral(0.6f) );
-                    }
+                    ImGui::TableNextColumn(); ImGui::Text( "%.4f", error );
                 }
+                ImGui::TableNextColumn(); ImGui::TextUnformatted( "Max" );
+                for ( const auto error : accuracy.m_maxError )
+                {
+                    ImGui::TableNextColumn(); ImGui::Text( "%.4f", error );
+                }
+                ImGui::EndTable();
             }
+        }
 
-            ImPlot::EndPlot();
+        ImGui::SeparatorBreak();
+        ImGui::TextUnformatted( "In-Memory Storage" );
+        ImGui::SameLine();
+        ImGui::TextDisabled( "[ %s ]", config::StemStorageFormat::toString( liveStem->getStorage().getFormat() ) );
+        if ( ImGui::Button( "Benchmark Formats" ) )
+            runStorageBenchmark( *liveStem, state.m_storageBenchmark );
+
+        {
+            const auto slabStats = endlesss::live::StemSlabArena::getStatistics();
+
+            ImGui::Text( "Sample slabs : %u live, %s reserved, %.1f%% fragmentation",
+                (uint32_t)slabStats.m_liveSlabs,
+                base::humaniseByteSize( "", slabStats.m_liveReservedBytes ).c_str(),
+                slabStats.getFragmentation() * 100.0f );
+            ImGui::Text( "  high water : %u slabs, %s",
+                (uint32_t)slabStats.m_highWaterSlabs,
+                base::humaniseByteSize( "", slabStats.m_highWaterReservedBytes ).c_str() );
+            ImGui::SameLine();
+            if ( ImGui::SmallButton( "Reset" ) )
+                endlesss::live::StemSlabArena::resetHighWater();
+        }
+
+        if ( !state.m_storageBenchmark.empty() &&
+             ImGui::BeginTable( "##storage_bench", 5, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg ) )
+        {
+            ImGui::TableSetupColumn( "Format" );
+            ImGui::TableSetupColumn( "Memory" );
+            ImGui::TableSetupColumn( "Encode (ms)" );
+            ImGui::TableSetupColumn( "Decode (us / callback)" );
+            ImGui::TableSetupColumn( "SNR (dB)" );
+            ImGui::TableHeadersRow();
+
+            const double referenceBytes = (double)state.m_storageBenchmark.front().m_bytes;
+            for ( const auto& result : state.m_storageBenchmark )
+            {
+                ImGui::TableNextColumn(); ImGui::TextUnformatted( config::StemStorageFormat::toString( result.m_format ) );
+                ImGui::TableNextColumn(); ImGui::Text( "%s (%.1fx)", base::humaniseByteSize( "", result.m_bytes ).c_str(), referenceBytes / (double)std::max< std::size_t >( result.m_bytes, 1 ) );
+                ImGui::TableNextColumn(); ImGui::Text( "%.2f", result.m_encodeMs );
+                ImGui::TableNextColumn(); ImGui::Text( "%.2f", result.m_decodeUsPerCallback );
+                ImGui::TableNextColumn(); ImGui::Text( "%.1f", result.m_snrDb );
+            }
+            ImGui::EndTable();
         }
 
+        ImGui::SeparatorBreak();
+        ImGui::TextUnformatted( "Beat Queries" );
+        if ( ImGui::Button( "Benchmark Queries" ) )
+            runBeatQueryBenchmark( *liveStem, state.m_analysis, state.m_beatQueryBenchmark );
+
+        if ( !state.m_beatQueryBenchmark.empty() &&
+             ImGui::BeginTable( "##beat_query_bench", 5, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg ) )
+        {
+            ImGui::TableSetupColumn( "Callback" );
+            ImGui::TableSetupColumn( "Per-Sample (us / callback)" );
+            ImGui::TableSetupColumn( "Range (us / callback)" );
+            ImGui::TableSetupColumn( "Missed" );
+            ImGui::TableSetupColumn( "Recovered" );
+            ImGui::TableHeadersRow();
+
+            for ( const auto& result : state.m_beatQueryBenchmark )
+            {
+                ImGui::TableNextColumn(); ImGui::Text( "%i", result.m_callbackFrames );
+                ImGui::TableNextColumn(); ImGui::Text( "%.3f", result.m_perSampleUsPerCallback );
+                ImGui::TableNextColumn(); ImGui::Text( "%.3f", result.m_rangeUsPerCallback );
+                ImGui::TableNextColumn(); ImGui::Text( "%i", result.m_missed );
+                ImGui::TableNextColumn(); ImGui::Text( "%i", result.m_recovered );
+            }
+            ImGui::EndTable();
+        }
     }
     ImGui::End();
 }
@@ -7,6 +7,7 @@
 
 #include "pch.h"
 #include "base/mathematics.h"
+#include "app/imgui.ext.h"
 
 #include "ux/stem.beats.h"
 
@@ -23,6 +24,14 @@ void StemBeats( const char* label, const endlesss::toolkit::Exchange& data, cons
 
     ImGui::InvisibleButton( label, panelSize );
 
+    // driven by the audio engine, so keep frames coming while anything is moving
+    if ( data.m_consensusBeat > 0.0f ||
+         std::any_of( std::begin( data.m_stemBeat ),   std::end( data.m_stemBeat ),   []( const float v ) { return v > 0.0f; } ) ||
+         std::any_of( std::begin( data.m_stemWaveLF ), std::end( data.m_stemWaveLF ), []( const float v ) { return v > 0.0f; } ) )
+    {
+        ImGui::RequestRedraw();
+    }
+
     const ImU32 colFG = ImGui::GetColorU32( ImGuiCol_Text );
     const ImU32 colBG = ImGui::GetColorU32( ImVec4( 1.0f, 1.0f, 1.0f, 0.1f ) );
     const ImU32 colCN = ImGui::GetColorU32( ImVec4( 1.0f, 1.0f, 1.0f, 0.025f + data.m_consensusBeat ) );
@@ -147,6 +147,14 @@ struct MixEngine : public app::module::MixerInterface,
     std::array< float*, 8 >     m_mixChannelLeft;
     std::array< float*, 8 >     m_mixChannelRight;
 
+    // scratch for gathering the incoming riff's stem audio before it is crossfaded over m_mixChannelLeft/Right
+    float*                      m_transitionLeft;
+    float*                      m_transitionRight;
+
+    // read cursors for current riff stems [0..7] and the riff being transitioned to [8..15]
+    std::array< endlesss::live::StemReader, 16 >
+                                m_stemReaders;
+
     app::AudioPlaybackTimeInfo  m_unifiedTimeInfo;
 
     uint64_t                    m_samplePosition;
@@ -197,6 +205,9 @@ struct MixEngine : public app::module::MixerInterface,
             m_mixChannelLeft[mI]  = mem::alloc16<float>( m_audioBufferSize );
             m_mixChannelRight[mI] = mem::alloc16<float>( m_audioBufferSize );
         }
+
+        m_transitionLeft  = mem::alloc16<float>( m_audioBufferSize );
+        m_transitionRight = mem::alloc16<float>( m_audioBufferSize );
     }
 
     virtual ~MixEngine()
@@ -208,6 +219,11 @@ struct MixEngine : public app::module::MixerInterface,
         for ( float* channel : m_mixChannelRight )
             mem::free16( channel );
         m_mixChannelRight.fill( nullptr );
+
+        mem::free16( m_transitionLeft );
+        mem::free16( m_transitionRight );
+        m_transitionLeft  = nullptr;
+        m_transitionRight = nullptr;
     }
 
     inline void addNextRiff( const endlesss::live::RiffPtr& nextRiff )
@@ -333,22 +349,33 @@ struct MixEngine : public app::module::MixerInterface,
 
     struct StemBeats
     {
-        std::vector< float >    m_hits;
-        float                   m_pulse;
+        // ages of recent hits, newest first; fixed capacity so that the per-frame update never touches the heap.
+        // hits expire after a second so this only fills if frames are arriving faster than ~cMaxHits per second
+        // with a beat on every one, in which case the oldest are dropped
+        static constexpr std::size_t cMaxHits = 32;
+
+        std::array< float, cMaxHits >   m_hits;
+        std::size_t                     m_hitCount = 0;
+        float                           m_pulse;
 
         inline void update( float dT, const float beatRate )
         {
-            std::vector< float > newHits;
-            if ( m_pulse == 1.0f )
-                newHits.push_back( 0.0f );
-
-            for ( auto i = 0; i < m_hits.size(); i++ )
+            std::size_t liveHits = 0;
+            for ( std::size_t i = 0; i < m_hitCount; i++ )
             {
                 const float c = m_hits[i] + dT;
                 if ( c < 1.0f )
-                    newHits.push_back( c );
+                    m_hits[liveHits++] = c;
+            }
+
+            if ( m_pulse == 1.0f )
+            {
+                liveHits = std::min( liveHits, cMaxHits - 1 );
+                std::copy_backward( m_hits.begin(), m_hits.begin() + liveHits, m_hits.begin() + liveHits + 1 );
+                m_hits[0] = 0.0f;
+                liveHits++;
             }
-            m_hits = std::move( newHits );
+            m_hitCount = liveHits;
 
             m_pulse += ( -0.1f - m_pulse ) * ( dT * beatRate );
             m_pulse = std::clamp( m_pulse, 0.0f, 1.0f );
@@ -712,13 +739,149 @@ void MixEngine::update(
     decodeTransitionalRiffData();
 
 
+    // fill a span of output samples from one stem, starting at the given riff-relative sample; the stretch-free
+    // case walks the stem with a running index rather than re-deriving it with a modulo each sample
+    const auto gatherStemSpan = [&](
+        const endlesss::live::Stem*     stemInst,
+        endlesss::live::StemReader&     stemReader,
+        const float                     stemTimeStretch,
+        const float                     stemGain,
+        const uint32_t                  riffLength,
+        uint64_t                        riffSample,
+        const uint32_t                  spanLength,
+        float*                          outLeft,
+        float*                          outRight,
+        bool*                           outHasBeat )
+    {
+        const auto  sampleCount     = stemInst->m_sampleCount;
+        const auto& stemStorage     = stemInst->getStorage();
+
+        // beats are checked across the whole span in one go; only the current riff asks for them and its spans
+        // never cross a riff edge, so the run of stem samples is contiguous (modulo the stem's own loop)
+        if ( outHasBeat != nullptr && stemInst->isAnalysisComplete() )
+        {
+            assert( riffSample + spanLength <= riffLength );
+            *outHasBeat |= stemInst->getAnalysisData().queryBeatInPlayback( (int64_t)riffSample, spanLength, stemTimeStretch, sampleCount );
+        }
+
+        if ( stemTimeStretch == 1.0f )
+        {
+            uint64_t finalSampleIdx = riffSample % sampleCount;
+
+            for ( uint32_t i = 0; i < spanLength; i++ )
+            {
+                float stemSampleLeft, stemSampleRight;
+                stemReader.read( stemStorage, finalSampleIdx, stemSampleLeft, stemSampleRight );
+
+                outLeft[i]  = stemSampleLeft  * stemGain;
+                outRight[i] = stemSampleRight * stemGain;
+
+                // riff wrap restarts the stem too, regardless of where it had got to
+                if ( ++riffSample >= riffLength )
+                {
+                    riffSample     = 0;
+                    finalSampleIdx = 0;
+                }
+                else if ( ++finalSampleIdx >= sampleCount )
+                {
+                    finalSampleIdx = 0;
+                }
+            }
+        }
+        else
+        {
+            for ( uint32_t i = 0; i < spanLength; i++ )
+            {
+                const uint64_t finalSampleIdx = (uint64_t)( (double)riffSample * stemTimeStretch ) % sampleCount;
+
+                float stemSampleLeft, stemSampleRight;
+                stemReader.read( stemStorage, finalSampleIdx, stemSampleLeft, stemSampleRight );
+
+                outLeft[i]  = stemSampleLeft  * stemGain;
+                outRight[i] = stemSampleRight * stemGain;
+
+                if ( ++riffSample >= riffLength )
+                    riffSample = 0;
+            }
+        }
+    };
+
+    // render a run of samples that contains no bar or riff edges; the current riff is written straight into the mix
+    // channels and, if we're blending, the next riff is gathered into scratch and crossfaded over the top
+    const auto renderSpan = [&]( const uint32_t spanStart, const uint32_t spanLength, const uint64_t riffSample )
+    {
+        for ( auto stemI = 0U; stemI < 8; stemI++ )
+        {
+            const endlesss::live::Stem* stemInst = stemPtr[stemI];
+
+            float* mixLeft  = m_mixChannelLeft[stemI]  + spanStart;
+            float* mixRight = m_mixChannelRight[stemI] + spanStart;
+
+            if ( stemInst == nullptr || stemInst->hasFailed() )
+            {
+                std::fill_n( mixLeft,  spanLength, 0.0f );
+                std::fill_n( mixRight, spanLength, 0.0f );
+                continue;
+            }
+
+            gatherStemSpan(
+                stemInst,
+                m_stemReaders[stemI],
+                stemTimeStretch[stemI],
+                stemGains[stemI],
+                riffLengthInSamples[0],
+                riffSample,
+                spanLength,
+                mixLeft,
+                mixRight,
+                &stemHasBeat[stemI] );
+        }
+
+        if ( m_transitionValue > 0 )
+        {
+            uint64_t nextRiffSample = riffWrappedSampleStart[1] + spanStart;
+            if ( nextRiffSample >= riffLengthInSamples[1] )
+                nextRiffSample -= riffLengthInSamples[1];
+
+            for ( auto stemI = 0U; stemI < 8; stemI++ )
+            {
+                const endlesss::live::Stem* stemInst = stemPtr[ 8 + stemI ];
+
+                float* mixLeft  = m_mixChannelLeft[stemI]  + spanStart;
+                float* mixRight = m_mixChannelRight[stemI] + spanStart;
+
+                // when transitioning, a missing/muted stem means we need to transition down to silence, not just skip entirely
+                if ( stemInst == nullptr || stemInst->hasFailed() )
+                {
+                    buffer::fade_to_silence_stereo( m_transitionValue, (int)spanLength, mixLeft, mixRight );
+                    continue;
+                }
+
+                gatherStemSpan(
+                    stemInst,
+                    m_stemReaders[ 8 + stemI ],
+                    stemTimeStretch[ 8 + stemI ],
+                    stemGains[ 8 + stemI ],
+                    riffLengthInSamples[1],
+                    nextRiffSample,
+                    spanLength,
+                    m_transitionLeft,
+                    m_transitionRight,
+                    nullptr );
+
+                buffer::crossfade_stereo( m_transitionValue, (int)spanLength, mixLeft, mixRight, m_transitionLeft, m_transitionRight );
+            }
+        }
+    };
+
+
     const auto segmentLengthInSamples   = currentRiff->m_timingDetails.m_lengthInSamplesPerBar;
           auto segmentSampleStart       = samplePosition % segmentLengthInSamples;
 
-    for ( auto sI = 0U; sI < samplesToWrite; sI++ )
+    // walk the buffer a span at a time; spans end on bar or riff edges (or the end of the buffer) so the progression
+    // and RepCom state machine only has to be run once at the head of each one, not on every sample
+    for ( uint32_t sI = 0U; sI < samplesToWrite; )
     {
-        const uint64_t sample = samplePosition + sI;
-
         // get sample position in context of the riff
         uint64_t riffSample   = riffWrappedSampleStart[0] + sI;
         if ( riffSample >= riffLengthInSamples[0] )
@@ -733,7 +896,7 @@ void MixEngine::update(
                 m_playbackProgression.m_playbackBar = 0;
         }
 
-        const uint64_t segmentSample = segmentSampleStart++;
+        const uint64_t segmentSample = segmentSampleStart;
 
 
         if ( segmentSample == 0 )
@@ -806,77 +969,16 @@ void MixEngine::update(
             }
         }
 
+        // run up to whichever comes first out of the next bar edge, the next riff edge or the end of the buffer
+        const uint32_t spanLength = (uint32_t)std::min( {
+            (uint64_t)( samplesToWrite - sI ),
+            (uint64_t)( segmentLengthInSamples - segmentSample ),
+            (uint64_t)( riffLengthInSamples[0] - riffSample ) } );
 
-        for ( auto stemI = 0U; stemI < 8; stemI++ )
-        {
-            const endlesss::live::Stem* stemInst = stemPtr[stemI];
-            const float       stemGain = stemGains[stemI];
-
-            if ( stemInst == nullptr || stemInst->hasFailed() )
-            {
-                m_mixChannelLeft[stemI][sI] = 0;
-                m_mixChannelRight[stemI][sI] = 0;
-                continue;
-            }
-
-            const auto sampleCount = stemInst->m_sampleCount;
-            uint64_t finalSampleIdx = riffSample;
-
-            if (stemTimeStretch[stemI] != 1.0f)
-            {
-                double scaleSample = (double)finalSampleIdx * stemTimeStretch[stemI];
-                finalSampleIdx = (uint64_t)scaleSample;
-            }
-            finalSampleIdx %= sampleCount;
-
-
-            // #TODO replace with new system
-            if ( stemInst->isAnalysisComplete() )
-            {
-                const auto& stemAnalysis = stemInst->getAnalysisData();
-
-                stemHasBeat[stemI] |= stemAnalysis.queryBeatAtSample( finalSampleIdx );
-                //stemEnergy[stemI] = std::max( stemEnergy[stemI], stemAnalysis.m_peak[finalSampleIdx] );
-            }
-
-            m_mixChannelLeft[stemI][sI]  = stemInst->m_channel[0][finalSampleIdx] * stemGain;
-            m_mixChannelRight[stemI][sI] = stemInst->m_channel[1][finalSampleIdx] * stemGain;
-        }
-
-        if ( m_transitionValue > 0 )
-        {
-            riffSample = riffWrappedSampleStart[1] + sI;
-            if ( riffSample >= riffLengthInSamples[1] )
-                riffSample -= riffLengthInSamples[1];
-
-            for ( auto stemI = 0U; stemI < 8; stemI++ )
-            {
-                const endlesss::live::Stem* stemInst = stemPtr[ 8 + stemI ];
-                const float       stemGain = stemGains[ 8 + stemI ];
-        
-                // when transitioning, a missing/muted stem means we need to transition down to silence, not just skip entirely
-                if ( stemInst == nullptr || stemInst->hasFailed() )
-                {
-                    m_mixChannelLeft[stemI][sI]     = base::lerp( m_mixChannelLeft[stemI][sI], 0.0f, m_transitionValue );
-                    m_mixChannelRight[stemI][sI]    = base::lerp( m_mixChannelRight[stemI][sI], 0.0f, m_transitionValue );
-
-                    continue;
-                }
-        
-                const auto sampleCount = stemInst->m_sampleCount;
-                uint64_t finalSampleIdx = riffSample;
-        
-                if ( stemTimeStretch[ 8 + stemI ] != 1.0f )
-                {
-                    double scaleSample = (double)finalSampleIdx * stemTimeStretch[ 8 + stemI ];
-                    finalSampleIdx = (uint64_t)scaleSample;
-                }
-                finalSampleIdx %= sampleCount;
+        renderSpan( sI, spanLength, riffSample );
 
-                m_mixChannelLeft[stemI][sI]         = base::lerp( m_mixChannelLeft[stemI][sI], stemInst->m_channel[0][finalSampleIdx] * stemGain, m_transitionValue );
-                m_mixChannelRight[stemI][sI]        = base::lerp( m_mixChannelRight[stemI][sI], stemInst->m_channel[1][finalSampleIdx] * stemGain, m_transitionValue );
-            }
-        }
+        segmentSampleStart += spanLength;
+        sI                 += spanLength;
     }
 
     // #TODO replace with new system
@@ -1036,20 +1138,76 @@ int BeamApp::EntrypointOuro()
         m_trackedJamCouchID = newJamCID;
     };
 
+    // riffs pushed to us with their metadata attached are held here until played, skipping the network resolve
+    std::mutex                                                                      preResolvedRiffsMutex;
+    absl::flat_hash_map< endlesss::types::RiffCouchID, endlesss::types::RiffComplete > preResolvedRiffs;
+
+    // push IDs of riffs handed to the pipeline, oldest first; it only ever sees pushed riffs and reports each request
+    // exactly once in the order they were made, so the front of this is always the push that just finished
+    std::mutex                                                                      pipelinePushIDsMutex;
+    std::deque< uint64_t >                                                          pipelinePushIDs;
+
+    const auto networkRiffResolver = [&, this]( const endlesss::types::RiffIdentity& request, endlesss::types::RiffComplete& result ) -> bool
+    {
+        {
+            std::scoped_lock<std::mutex> preResolvedLock( preResolvedRiffsMutex );
+
+            const auto preResolvedIt = preResolvedRiffs.find( request.getRiffID() );
+            if ( preResolvedIt != preResolvedRiffs.end() )
+            {
+                result = preResolvedIt->second;
+                return true;
+            }
+        }
+        return endlesss::toolkit::Pipeline::defaultNetworkResolver( *m_networkConfiguration, request, result );
+    };
+
+    // pushed riffs queue up behind one another in the pipeline; the prefetcher works ahead of it, pulling stems for
+    // the later requests in while the pipeline is still busy with the earlier ones
+    std::unique_ptr< endlesss::toolkit::RiffPrefetch > riffPrefetch;
+    if ( m_configPerf.riffPrefetchCount > 0 )
+    {
+        riffPrefetch = std::make_unique< endlesss::toolkit::RiffPrefetch >(
+            riffFetchProvider,
+            networkRiffResolver,
+            m_configPerf.riffPrefetchMemoryBudgetBytes() );
+    }
+
+    net::bond::RiffPushServer rpServer;
+
     endlesss::toolkit::Pipeline riffPipeline(
         m_appEventBus,
         riffFetchProvider,
         32,
-        [this]( const endlesss::types::RiffIdentity& request, endlesss::types::RiffComplete& result) -> bool
-        {
-            return endlesss::toolkit::Pipeline::defaultNetworkResolver( *m_networkConfiguration, request, result );
-        },
-        [&mixEngine]( const endlesss::types::RiffIdentity& request, endlesss::live::RiffPtr& loadedRiff, const endlesss::types::RiffPlaybackPermutationOpt& playbackPermutationOpt )
+        networkRiffResolver,
+        [&]( const endlesss::types::RiffIdentity& request, endlesss::live::RiffPtr& loadedRiff, const endlesss::types::RiffPlaybackPermutationOpt& playbackPermutationOpt )
         {
             // TODO playbackPermutationOpt
 
             if ( loadedRiff )
                 mixEngine.addNextRiff( loadedRiff );
+
+            // the live riff holds the stems now
+            if ( riffPrefetch )
+                riffPrefetch->release( request.getRiffID() );
+
+            {
+                std::scoped_lock<std::mutex> preResolvedLock( preResolvedRiffsMutex );
+                preResolvedRiffs.erase( request.getRiffID() );
+            }
+
+            // let whoever pushed it know how long it took to get here
+            uint64_t pushID = 0;
+            {
+                std::scoped_lock<std::mutex> pushIDsLock( pipelinePushIDsMutex );
+                ABSL_ASSERT( !pipelinePushIDs.empty() );
+                if ( !pipelinePushIDs.empty() )
+                {
+                    pushID = pipelinePushIDs.front();
+                    pipelinePushIDs.pop_front();
+                }
+            }
+            rpServer.notifyRiffPlayable( pushID, loadedRiff != nullptr );
         },
         []()
         {
@@ -1057,21 +1215,86 @@ int BeamApp::EntrypointOuro()
 
     static constexpr base::OperationVariant OV_RiffPlayback{ 0xBB };
 
-    net::bond::RiffPushServer rpServer;
-    rpServer.setRiffPushedCallback([&]( 
-        const endlesss::types::JamCouchID&                  jamID,
-        const endlesss::types::RiffCouchID&                 riffID,
-        const endlesss::types::RiffPlaybackPermutationOpt&  permutationOpt )
+    rpServer.setRiffPushedCallback([&]( const net::bond::RiffPushEntry& pushed, const uint64_t pushID )
     {
         const auto operationID = base::Operations::newID( OV_RiffPlayback );
 
-        riffPipeline.requestRiff( { { jamID, riffID }, permutationOpt, operationID } );
+        if ( pushed.m_resolved.has_value() )
+        {
+            std::scoped_lock<std::mutex> preResolvedLock( preResolvedRiffsMutex );
+
+            // don't let riffs that never make it to playback accumulate forever
+            if ( preResolvedRiffs.size() >= 256 )
+                preResolvedRiffs.clear();
+
+            preResolvedRiffs.insert_or_assign( pushed.m_riffID, pushed.m_resolved.value() );
+        }
+
+        // keep no more than the configured number of riffs waiting to be warmed
+        if ( riffPrefetch )
+            riffPrefetch->append( { pushed.m_jamID, pushed.m_riffID }, static_cast<std::size_t>( m_configPerf.riffPrefetchCount ) );
+
+        {
+            std::scoped_lock<std::mutex> pushIDsLock( pipelinePushIDsMutex );
+            pipelinePushIDs.push_back( pushID );
+        }
+        riffPipeline.requestRiff( { { pushed.m_jamID, pushed.m_riffID }, pushed.m_permutation, operationID } );
     });
     std::ignore = rpServer.start();
 
+    // loopback test opens its own server and client and can take a few seconds, so it runs off the main thread
+    std::future< void > riffPushLoopbackTask;
+
+    registerMainMenuEntry( 2, "PUSH", [&rpServer, &riffPushLoopbackTask, this]()
+    {
+        const auto pushStats = rpServer.getStatistics();
+        ImGui::TextDisabled( "%" PRIu64 " riffs in %" PRIu64 " batches, %" PRIu64 " pre-resolved",
+            pushStats.m_riffsReceived,
+            pushStats.m_batchesReceived,
+            pushStats.m_riffsPreResolved );
+
+        const bool loopbackRunning = riffPushLoopbackTask.valid() &&
+                                     riffPushLoopbackTask.wait_for( std::chrono::seconds( 0 ) ) != std::future_status::ready;
+
+        ImGui::Separator();
+        if ( ImGui::MenuItem( "Run Loopback Test", nullptr, false, !loopbackRunning ) )
+        {
+            riffPushLoopbackTask = std::async( std::launch::async, [this]()
+            {
+                const auto loopbackResult = net::bond::runRiffPushLoopbackTest( 16, 8, std::chrono::seconds( 5 ) );
+                if ( !loopbackResult.ok() )
+                {
+                    m_appEventBus->send<::events::AddToastNotification>( ::events::AddToastNotification::Type::Error,
+                        "Riff Push Loopback Failed",
+                        loopbackResult.status().ToString() );
+                }
+                else
+                {
+                    const auto loopbackSummary = fmt::format( FMTX( "{} sent, {} received, {} mismatched\npush-to-playable avg {:.2f}ms, worst {:.2f}ms" ),
+                        loopbackResult->m_riffsSent,
+                        loopbackResult->m_riffsReceived,
+                        loopbackResult->m_riffsMismatched,
+                        loopbackResult->m_latency.m_averageMs,
+                        loopbackResult->m_latency.m_worstMs );
+
+                    blog::app( FMTX( "riff push loopback : {}" ), loopbackSummary );
+
+                    m_appEventBus->send<::events::AddToastNotification>(
+                        loopbackResult->passed() ? ::events::AddToastNotification::Type::Info : ::events::AddToastNotification::Type::Error,
+                        loopbackResult->passed() ? "Riff Push Loopback Passed" : "Riff Push Loopback Failed",
+                        loopbackSummary );
+                }
+            });
+        }
+    });
+
 
     // == MAIN LOOP ====================================================================================================
 
+    endlesss::cache::Jams::Data     trackedJamData;
+    endlesss::types::JamCouchID     trackedJamDataCouchID;
+    bool                            trackedJamDataResolved = false;
+
     while ( beginInterfaceLayout( (app::CoreGUI::ViewportFlags)(
         app::CoreGUI::VF_WithDocking   |
         app::CoreGUI::VF_WithMainMenu  |
@@ -1088,17 +1311,24 @@ int BeamApp::EntrypointOuro()
         ux::modalUniversalJamBrowser( modalJamBrowserTitle, m_jamLibrary, jamBrowserBehaviour, *this );
 
 
-        // #HDD just do this on tracked choice change, doesn't need to be every frame
-        endlesss::cache::Jams::Data trackedJamData;
-        if ( m_trackedJamCouchID.empty() )
+        // only re-resolve the tracked jam details when the choice changes, or while the library can't yet find them
+        if ( !trackedJamDataResolved || trackedJamDataCouchID != m_trackedJamCouchID )
         {
-            trackedJamData.m_displayName = "[ none selected ]";
-        }
-        else
-        {
-            if ( !m_jamLibrary.loadDataForDatabaseID( m_trackedJamCouchID, trackedJamData ) )
+            trackedJamDataCouchID   = m_trackedJamCouchID;
+            trackedJamData          = {};
+            trackedJamDataResolved  = true;
+
+            if ( m_trackedJamCouchID.empty() )
+            {
+                trackedJamData.m_displayName = "[ none selected ]";
+            }
+            else
             {
-                trackedJamData.m_displayName = "[ error ]";
+                if ( !m_jamLibrary.loadDataForDatabaseID( m_trackedJamCouchID, trackedJamData ) )
+                {
+                    trackedJamData.m_displayName = "[ error ]";
+                    trackedJamDataResolved = false;
+                }
             }
         }
 
@@ -1446,6 +1676,10 @@ int BeamApp::EntrypointOuro()
         finishInterfaceLayoutAndRender();
     }
 
+    // the loopback test task reports back through the app; let it finish if one is still going
+    if ( riffPushLoopbackTask.valid() )
+        riffPushLoopbackTask.wait();
+
     m_discordBotUI.reset();
 
     m_mdAudio->blockUntil( m_mdAudio->installMixer( nullptr ) );
@@ -1463,8 +1697,8 @@ int BeamApp::EntrypointOuro()
 int main( int argc, char** argv )
 {
     BeamApp beam;
-    const int result = beam.Run();
-    if ( result != 0 )
+    const int result = beam.Run( argc, argv );
+    if ( result != 0 && !beam.isHeadlessRun() )
         app::Core::waitForConsoleKey();
 
     return result;
@@ -475,6 +475,7 @@ protected:
 protected:
 
     using RiffPipeline          = std::unique_ptr< endlesss::toolkit::Pipeline >;
+    using RiffPrefetch          = std::unique_ptr< endlesss::toolkit::RiffPrefetch >;
     using SyncAndPlaybackQueue  = mcc::ReaderWriterQueue< endlesss::types::RiffCouchID >;
 
     // take the completed IDs posted back from the worker thread and prune them from
@@ -493,6 +494,7 @@ protected:
     }
 
     RiffPipeline                    m_riffPipeline;
+    RiffPrefetch                    m_riffPrefetch;                 // optional, warms riffs that follow the current one in the jam view
 
     SyncAndPlaybackQueue            m_syncAndPlaybackQueue;         // riffs to fetch & play - written to by main thread, read from worker
     SyncAndPlaybackQueue            m_syncAndPlaybackCompletions;   // riffs that have been fetched & played - written to by worker, read by main thread
@@ -560,7 +562,11 @@ protected:
 
         // might be a empty riff, only track actual riffs
         if ( eventData->m_riff != nullptr )
+        {
             m_riffsDequedByMixer.emplace( m_nowPlayingRiff->m_riffData.riff.couchID );
+
+            schedulePrefetchAfterRiff( m_nowPlayingRiff->m_riffData.riff.couchID );
+        }
     }
 
     void event_OperationComplete( const events::OperationComplete* eventData )
@@ -1479,6 +1485,35 @@ protected:
         ImGui::MakeTabVisible( "###jam_view" );
     }
 
+    // when something from the currently viewed jam starts playing, warm the riffs that follow it on the timeline
+    // so that stepping forward through the jam doesn't stall on loading
+    void schedulePrefetchAfterRiff( const endlesss::types::RiffCouchID& riffCouchID )
+    {
+        if ( m_riffPrefetch == nullptr )
+            return;
+
+        std::scoped_lock<std::mutex> sliceLock( m_jamSliceMapLock );
+
+        const endlesss::toolkit::Warehouse::JamSlice* currentSlice = m_jamSlice.get();
+        if ( currentSlice == nullptr && m_jamSliceSketch != nullptr )
+            currentSlice = m_jamSliceSketch->m_slice.get();
+
+        if ( currentSlice == nullptr )
+            return;
+
+        const auto upcomingRiffs = endlesss::toolkit::RiffPrefetch::collectFollowingRiffs(
+            *currentSlice,
+            m_currentViewedJam,
+            riffCouchID,
+            m_configPerf.riffPrefetchCount );
+
+        // riff wasn't from the jam we're looking at; leave whatever plan we had alone
+        if ( upcomingRiffs.empty() )
+            return;
+
+        m_riffPrefetch->schedule( upcomingRiffs );
+    }
+
     void clearJamSlice()
     {
         std::scoped_lock<std::mutex> sliceLock( m_jamSliceMapLock );
@@ -1864,70 +1899,99 @@ protected:
 
 
 // ---------------------------------------------------------------------------------------------------------------------
-// a dumb little utility for moving all the stems from a v1 cache to the new v2 format
+// front-end for the stem cache maintenance engine; validates the cache and migrates stems from a v1 cache to v2
 protected:
 
-    struct MigrationState
+    struct MaintenanceState
     {
-        using recursive_iterator = fs::recursive_directory_iterator;
-
-        MigrationState( const fs::path& cacheCommonRootPath )
+        MaintenanceState( const fs::path& cacheCommonRootPath )
             : m_cacheRoot( cacheCommonRootPath )
             , m_rootPathVersion1( cacheCommonRootPath / endlesss::cache::Stems::getCachePathRoot( endlesss::cache::Stems::CacheVersion::Version1 ) )
-            , m_rootPathVersion2( cacheCommonRootPath / endlesss::cache::Stems::getCachePathRoot( endlesss::cache::Stems::CacheVersion::Version2 ) )
         {
+            m_options.m_migrateVersion1 = fs::exists( m_rootPathVersion1 );
         }
 
-        fs::path            m_cacheRoot;
-        fs::path            m_rootPathVersion1;
-        fs::path            m_rootPathVersion2;
-        recursive_iterator  m_iterator;
+        fs::path                                    m_cacheRoot;
+        fs::path                                    m_rootPathVersion1;
 
-        std::vector< fs::path >         m_resolverOriginalFiles;
-        endlesss::types::StemCouchIDs   m_resolverInputs;
-        endlesss::types::JamCouchIDs    m_resolverOutputs;
-
-        bool                m_running = false;
-        uint32_t            m_filesExamined = 0;
-        uint32_t            m_filesMigrated = 0;
+        endlesss::cache::StemMaintenance::Options   m_options;
+        endlesss::cache::StemMaintenance            m_engine;
     };
 
-    void doStemCacheMigrationPopup( const char* title, MigrationState& state )
+    void doStemCacheMaintenancePopup( const char* title, MaintenanceState& state )
     {
+        using StemMaintenance = endlesss::cache::StemMaintenance;
+
         const ImVec2 buttonSize( 240.0f, 32.0f );
 
-        const ImVec2 configWindowSize( 600.0f, 320.0f );
+        const ImVec2 configWindowSize( 600.0f, 420.0f );
         ImGui::SetNextWindowContentSize( configWindowSize );
 
         if ( ImGui::BeginPopupModal( title, nullptr, ImGuiWindowFlags_NoSavedSettings | ImGuiWindowFlags_NoResize ) )
         {
-            if ( !fs::exists( state.m_rootPathVersion1 ) )
+            const bool maintenanceRunning = state.m_engine.isRunning();
+            const bool hasVersion1Cache   = fs::exists( state.m_rootPathVersion1 );
+
+            ImGui::TextWrapped( "Checks every stem in your cache is complete and decodable, in parallel. Results are recorded so that later runs only look at new or changed files, and an interrupted run carries on where it left off." );
+            ImGui::Spacing();
+            if ( hasVersion1Cache )
             {
-                ImGui::TextWrapped( "This tool is for migrating older OUROVEON stem caches but you do not appear to have one in your installation" );
+                ImGui::TextWrapped( "An older OUROVEON stem cache was found; enable migration to copy its stems into the current format as part of the run." );
+                ImGui::Spacing();
             }
-            else
+            ImGui::SeparatorBreak();
+
             {
-                ImGui::TextWrapped( "This is a tool to migrate your older OUROVEON stem cache to the latest format. This process involves identifying & copying the old stem files; it may take a moment to complete, depending on the size of your cache." );
-                ImGui::Spacing();
-                ImGui::TextWrapped( "Click [Run Migration] and wait for it to complete. You only need do this process once." );
-                ImGui::Spacing();
-                ImGui::SeparatorBreak();
+                ImGui::Scoped::Disabled sd( maintenanceRunning );
 
                 {
-                    ImGui::Scoped::ToggleButton tbl( state.m_running, true );
-                    if ( ImGui::Button( "Run Migration", buttonSize ) )
+                    ImGui::Scoped::Disabled sdv1( !hasVersion1Cache );
+                    ImGui::Checkbox( "Migrate V1 cache", &state.m_options.m_migrateVersion1 );
+                }
+                ImGui::Checkbox( "Full decode (slow, catches truncated FLAC)", &state.m_options.m_fullDecode );
+                ImGui::Checkbox( "Quarantine corrupt stems", &state.m_options.m_quarantine );
+                ImGui::Checkbox( "Re-validate everything", &state.m_options.m_revalidateAll );
+            }
+            ImGui::Spacing();
+
+            {
+                ImGui::Scoped::ToggleButton tbl( maintenanceRunning, true );
+                if ( ImGui::Button( maintenanceRunning ? "Cancel" : "Run Maintenance", buttonSize ) )
+                {
+                    if ( maintenanceRunning )
                     {
-                        state.m_running = !state.m_running;
-                        state.m_filesExamined = 0;
-                        state.m_iterator = MigrationState::recursive_iterator( state.m_rootPathVersion1, std::filesystem::directory_options::skip_permission_denied );
+                        state.m_engine.cancel();
+                    }
+                    else
+                    {
+                        auto options = state.m_options;
+                        options.m_migrateVersion1 &= hasVersion1Cache;
+
+                        state.m_engine.start(
+                            getTaskExecutor(),
+                            state.m_cacheRoot,
+                            options,
+                            [this]( const endlesss::types::StemCouchIDs& stems, endlesss::types::JamCouchIDs& result )
+                            {
+                                return m_warehouse->batchFindJamIDForStem( stems, result );
+                            });
                     }
                 }
-                ImGui::Text( "Stems Examined : %u", state.m_filesExamined );
-                ImGui::Text( "Stems Migrated : %u", state.m_filesMigrated );
+            }
+
+            const auto progress = state.m_engine.getProgress();
+            ImGui::Text( "Status : %s", StemMaintenance::getPhaseName( progress.m_phase ) );
+            ImGui::TextUnformatted( fmt::format( FMTX( "Stems Found : {} ({} unchanged)" ), progress.m_filesFound, progress.m_filesUnchanged ).c_str() );
+            ImGui::TextUnformatted( fmt::format( FMTX( "Stems Checked : {}, {}" ), progress.m_filesProcessed, base::humaniseByteSize( "", progress.m_bytesExamined ) ).c_str() );
+            ImGui::TextUnformatted( fmt::format( FMTX( "Valid : {}  Corrupt : {}  Quarantined : {}  Recent : {}" ), progress.m_filesValid, progress.m_filesCorrupt, progress.m_filesQuarantined, progress.m_filesRecent ).c_str() );
+            if ( state.m_options.m_migrateVersion1 )
+                ImGui::TextUnformatted( fmt::format( FMTX( "Migrated : {}  Unresolved : {}" ), progress.m_filesMigrated, progress.m_filesUnresolved ).c_str() );
 
+            if ( hasVersion1Cache )
+            {
                 ImGui::Spacing();
                 ImGui::SeparatorBreak();
-                ImGui::TextWrapped( "Once complete, you can delete the old cache folder : " );
+                ImGui::TextWrapped( "Once migrated, you can delete the old cache folder : " );
                 if ( ImGui::Button( "Open..." ) )
                 {
                     xpOpenURL( state.m_cacheRoot.string().c_str() );
@@ -1935,101 +1999,6 @@ protected:
                 ImGui::SameLine( 0, 12.0f );
                 ImGui::AlignTextToFramePadding();
                 ImGui::TextColored( colour::shades::callout.neutral(), state.m_rootPathVersion1.string().c_str() );
-
-
-                if ( state.m_running )
-                {
-                    state.m_resolverOriginalFiles.clear();
-                    state.m_resolverInputs.clear();
-                    state.m_resolverOutputs.clear();
-
-                    int32_t runs = 8;
-                    try
-                    {
-                        std::error_code osError;
-                        auto i = fs::begin(state.m_iterator);
-                        for (; i != fs::end(state.m_iterator); i = i.increment(osError))
-                        {
-                            if ( osError )
-                                break;
-                            
-                            if ( i->is_directory() )
-                                continue;
-                            
-                            if ( runs <= 0 )
-                                break;
-                            runs--;
-                            
-                            const std::string filename = i->path().stem().string();
-                            if ( filename.size() > 10 &&
-                                filename[0] == 's' &&
-                                filename[1] == 't' &&
-                                filename[2] == 'e' &&
-                                filename[3] == 'm' )
-                            {
-                                const auto stemID = filename.substr( 5 );
-                                state.m_resolverInputs.emplace_back( stemID );
-                                state.m_resolverOriginalFiles.emplace_back( i->path() );
-                                
-                                state.m_filesExamined++;
-                            }
-                        }
-                        bool bHitEnd = i == fs::end(state.m_iterator);
-                        if ( bHitEnd )
-                            state.m_running = false;
-                    }
-                    catch ( std::exception& cEx )
-                    {
-                        blog::cache( FMTX( "stopping cache walk on exception : {}" ), cEx.what() );
-                        state.m_running = false;
-                    }
-                    
-                    if ( state.m_resolverInputs.empty() )
-                    {
-                        state.m_running = false;
-                    }
-
-                    // ask warehouse about where we should be relocating these
-                    m_warehouse->batchFindJamIDForStem( state.m_resolverInputs, state.m_resolverOutputs );
-                    ABSL_ASSERT( state.m_resolverInputs.size() == state.m_resolverOutputs.size() );
-
-                    for ( auto idx = 0U; idx < state.m_resolverInputs.size(); idx++ )
-                    {
-                        if ( state.m_resolverOutputs[idx].empty() )
-                            continue;
-
-                        const auto stemID = state.m_resolverInputs[idx];
-
-                        const auto copyToPath = endlesss::cache::Stems::getCachePathForStemData(
-                            state.m_rootPathVersion2,
-                            state.m_resolverOutputs[idx],
-                            stemID ) ;
-                        const auto copyToFile = copyToPath / stemID.value();
-
-                        if ( !fs::exists( copyToFile ) )
-                        {
-    //                         blog::cache( FMTX( "{} = {} >> {}" ),
-    //                             state.m_resolverInputs[idx],
-    //                             state.m_resolverOutputs[idx],
-    //                             copyToFile.string() );
-
-                            absl::Status directoryBuildStatus = filesys::ensureDirectoryExists( copyToPath );
-                            if ( directoryBuildStatus.ok() )
-                            {
-                                try
-                                {
-                                    fs::copy_file( state.m_resolverOriginalFiles[idx], copyToFile );
-                                }
-                                catch ( fs::filesystem_error& fsE )
-                                {
-                                    blog::error::cache( FMTX( "error while copying [{}] : {}" ), copyToFile.string(), fsE.what() );
-                                }
-                            }
-
-                            state.m_filesMigrated++;
-                        }
-                    }
-                }
             }
 
             const auto panelRegionAvail = ImGui::GetContentRegionAvail();
@@ -2039,7 +2008,7 @@ protected:
             }
 
             {
-                ImGui::Scoped::Disabled sd( state.m_running );
+                ImGui::Scoped::Disabled sd( maintenanceRunning );
                 if ( ImGui::Button( "Close", buttonSize ) )
                 {
                     ImGui::CloseCurrentPopup();
@@ -2063,13 +2032,13 @@ int LoreApp::EntrypointOuro()
     // build cache control menu
     registerMainMenuEntry( 2, "CACHE", [this]()
         {
-            if ( ImGui::MenuItem( "Migration..." ) )
+            if ( ImGui::MenuItem( "Maintenance..." ) )
             {
-                activateModalPopup( "Stem Cache Migration", [
+                activateModalPopup( "Stem Cache Maintenance", [
                     this,
-                    state = std::make_shared<MigrationState>( m_storagePaths->cacheCommon ) ]( const char* title ) mutable
+                    state = std::make_shared<MaintenanceState>( m_storagePaths->cacheCommon ) ]( const char* title ) mutable
                 {
-                    doStemCacheMigrationPopup( title, *state );
+                    doStemCacheMaintenancePopup( title, *state );
                 });
             }
         });
@@ -2078,7 +2047,8 @@ int LoreApp::EntrypointOuro()
     m_warehouse = std::make_unique<endlesss::toolkit::Warehouse>(
         m_storagePaths.value(),
         m_networkConfiguration,
-        m_appEventBus );
+        m_appEventBus,
+        m_configPerf.warehouseBackfillConcurrency );
 
     m_warehouse->upsertJamDictionaryFromCache( m_jamLibrary );             // update warehouse list of jam IDs -> names from the current cache
     m_warehouse->extractJamDictionary( m_jamHistoricalFromWarehouse );     // pull full list of jam IDs -> names from warehouse as "historical" list
@@ -2162,7 +2132,7 @@ int LoreApp::EntrypointOuro()
         APP_EVENT_BIND_TO( RequestNavigationToRiff );
     }
 
-    checkedCoreCall( "add stem listener", [this] { return m_stemDataProcessor.connect( m_appEventBus ); } );
+    checkedCoreCall( "add stem listener", [&] { return m_stemDataProcessor.connect( mixPreview.getStemDataChannel() ); } );
 
 
 #if OURO_FEATURE_VST24
@@ -2172,21 +2142,23 @@ int LoreApp::EntrypointOuro()
 #endif // OURO_FEATURE_VST24
 
 
+    const auto warehouseRiffResolver = [this]( const endlesss::types::RiffIdentity& request, endlesss::types::RiffComplete& result ) -> bool
+    {
+        // most requests can be serviced direct from the DB
+        if ( m_warehouse->fetchSingleRiffByID( request.getRiffID(), result ) )
+        {
+            endlesss::toolkit::Pipeline::applyRequestCustomNaming( request, result );
+            return true;
+        }
+
+        return endlesss::toolkit::Pipeline::defaultNetworkResolver( *m_networkConfiguration, request, result );
+    };
+
     m_riffPipeline = std::make_unique< endlesss::toolkit::Pipeline >(
         m_appEventBus,
         riffFetchProvider,
         m_configPerf.liveRiffInstancePoolSize,
-        [this]( const endlesss::types::RiffIdentity& request, endlesss::types::RiffComplete& result) -> bool
-        {
-            // most requests can be serviced direct from the DB
-            if ( m_warehouse->fetchSingleRiffByID( request.getRiffID(), result ) )
-            {
-                endlesss::toolkit::Pipeline::applyRequestCustomNaming( request, result );
-                return true;
-            }
-
-            return endlesss::toolkit::Pipeline::defaultNetworkResolver( *m_networkConfiguration, request, result );
-        },
+        warehouseRiffResolver,
         [&mixPreview, this]( const endlesss::types::RiffIdentity& request, endlesss::live::RiffPtr& loadedRiff, const endlesss::types::RiffPlaybackPermutationOpt& playbackPermutationOpt )
         {
             // if the provided riff is valid, hand it over to the mixer to enqueue for playing
@@ -2214,21 +2186,19 @@ int LoreApp::EntrypointOuro()
             m_riffPipelineClearInProgress = false;
         });
 
+    if ( m_configPerf.riffPrefetchCount > 0 )
+    {
+        m_riffPrefetch = std::make_unique< endlesss::toolkit::RiffPrefetch >(
+            riffFetchProvider,
+            warehouseRiffResolver,
+            m_configPerf.riffPrefetchMemoryBudgetBytes() );
+    }
+
     m_riffExportPipeline = std::make_unique< endlesss::toolkit::Pipeline >(
         m_appEventBus,
         riffFetchProvider,
         0, // no internal cache - we don't want riffs saved as we can modify jam/riff descriptions during batch exports which would then be ignored
-        [this]( const endlesss::types::RiffIdentity& request, endlesss::types::RiffComplete& result ) -> bool
-        {
-            // most requests can be serviced direct from the DB
-            if ( m_warehouse->fetchSingleRiffByID( request.getRiffID(), result ) )
-            {
-                endlesss::toolkit::Pipeline::applyRequestCustomNaming( request, result );
-                return true;
-            }
-
-            return endlesss::toolkit::Pipeline::defaultNetworkResolver( *m_networkConfiguration, request, result );
-        },
+        warehouseRiffResolver,
         [this]( const endlesss::types::RiffIdentity& request, endlesss::live::RiffPtr& loadedRiff, const endlesss::types::RiffPlaybackPermutationOpt& )
         {
             ::events::ExportRiff exportRiffData( loadedRiff, {} );
@@ -2311,15 +2281,8 @@ int LoreApp::EntrypointOuro()
                 // copy in the current stem energy/pulse data that may have arrived from the mixer
                 m_stemDataProcessor.copyToExchangeData( m_endlesssExchange );
 
-                // compute the progression (bar/percentage through riff) of playback based on the current sample, embed in Exchange
-                endlesss::live::RiffProgression playbackProgression;
-
-                const auto& timingData = currentRiff->getTimingDetails();
-                timingData.ComputeProgressionAtSample(
-                    (uint64_t)mixPreview.getTimeInfoPtr()->samplePos,
-                    playbackProgression );
-
-                endlesss::toolkit::Exchange::copyDetailsFromProgression( m_endlesssExchange, playbackProgression );
+                // embed the progression (bar/percentage through riff) of playback, as last published by the mixer
+                endlesss::toolkit::Exchange::copyDetailsFromProgression( m_endlesssExchange, mixPreview.getPlaybackProgression() );
 
                 // take a snapshot of the mixer layer gains and apply that to the exchange data so "stem gain" is 
                 // more representative of what's coming out of the audio pipeline
@@ -2387,6 +2350,9 @@ int LoreApp::EntrypointOuro()
                     {
                         m_riffPipelineClearInProgress = true;
                         m_riffPipeline->requestClear();
+
+                        if ( m_riffPrefetch )
+                            m_riffPrefetch->cancel();
                     }
                     ImGui::CompactTooltip( "Panic stop all playback, buffering, pre-fetching, etc" );
                 }
@@ -3625,7 +3591,10 @@ int LoreApp::EntrypointOuro()
                     ImGui::Scoped::ButtonTextAlignLeft leftAlign;
                     const ImVec2 toolbarButtonSize{ 140.0f, 0.0f };
 
-                    ImGui::RightAlignSameLine( toolbarButtonSize.x );
+                    if ( warehouseView == WarehouseView::Maintenance )
+                        ImGui::RightAlignSameLine( ( toolbarButtonSize.x * 2.0f ) + ImGui::GetStyle().ItemSpacing.x );
+                    else
+                        ImGui::RightAlignSameLine( toolbarButtonSize.x );
 
                     // extra tools in a pile
                     if ( warehouseView == WarehouseView::Default )
@@ -3652,6 +3621,16 @@ int LoreApp::EntrypointOuro()
                         // note if the warehouse is running ops, if not then disable new-task buttons
                         const bool bWarehouseIsPaused = m_warehouse->workerIsPaused();
 
+                        ImGui::BeginDisabledControls( bWarehouseIsPaused );
+                        if ( ImGui::Button( ICON_FA_LIST_CHECK " Check Stats", toolbarButtonSize ) )
+                        {
+                            // recount everything and rebuild the running statistics if they have drifted
+                            m_warehouse->requestContentsAudit( true );
+                        }
+                        ImGui::CompactTooltip( "Recount every jam from scratch and compare against the stored statistics" );
+                        ImGui::EndDisabledControls( bWarehouseIsPaused );
+                        ImGui::SameLine();
+
                         {
                             // enable or disable the worker thread
                             ImGui::Scoped::ToggleButton highlightButton( !bWarehouseIsPaused, true );
@@ -3941,6 +3920,7 @@ int LoreApp::EntrypointOuro()
 
     unregisterStatusBarBlock( sbbWarehouseID );
 
+    m_riffPrefetch.reset();
     m_riffPipeline.reset();
 
     m_discordBotUI.reset();
@@ -3955,7 +3935,7 @@ int LoreApp::EntrypointOuro()
     m_mdAudio->blockUntil( m_mdAudio->effectClearAll() );
 
     // unregister any listeners
-    checkedCoreCall( "remove stem listener", [this] { return m_stemDataProcessor.disconnect( m_appEventBus ); } );
+    checkedCoreCall( "remove stem listener", [this] { return m_stemDataProcessor.disconnect(); } );
 
 
 #if OURO_FEATURE_VST24
@@ -3972,8 +3952,8 @@ int LoreApp::EntrypointOuro()
 int main( int argc, char** argv )
 {
     LoreApp lore;
-    const int result = lore.Run();
-    if ( result != 0 )
+    const int result = lore.Run( argc, argv );
+    if ( result != 0 && !lore.isHeadlessRun() )
         app::Core::waitForConsoleKey();
 
     return result;